@@ -34,6 +34,7 @@
 #include "linden_common.h"
 #include "aistatemachine.h"
 #include "aicondition.h"
+#include "llformat.h"
 #include "lltimer.h"
 
 //==================================================================
@@ -284,8 +285,13 @@ char const* HelloWorld::state_str_impl(state_type run_state) const
 
 void AIEngine::add(AIStateMachine* state_machine)
 {
-  Dout(dc::statemachine(state_machine->mSMDebug), "Adding state machine [" << (void*)state_machine << "] to " << mName);
   engine_state_type_wat engine_state_w(mEngineState);
+  queue(engine_state_w, state_machine);
+}
+
+void AIEngine::queue(engine_state_type_wat& engine_state_w, AIStateMachine* state_machine)
+{
+  Dout(dc::statemachine(state_machine->mSMDebug), "Adding state machine [" << (void*)state_machine << "] to " << mName);
   engine_state_w->list.push_back(QueueElement(state_machine));
   if (engine_state_w->waiting)
   {
@@ -294,8 +300,8 @@ void AIEngine::add(AIStateMachine* state_machine)
 }
 
 #if STATE_MACHINE_PROFILING
-// Called from AIStateMachine::mainloop
-void print_statemachine_diagnostics(U64 total_clocks, AIStateMachine::StateTimerBase::TimeData& slowest_timer, AIEngine::queued_type::const_reference slowest_element)
+// Called from AIEngine::mainloop and AIEngine::threadloop
+void print_statemachine_diagnostics(char const* loop, U64 total_clocks, AIStateMachine::StateTimerBase::TimeData& slowest_timer, AIEngine::queued_type::const_reference slowest_element)
 {
 	AIStateMachine const& slowest_state_machine = slowest_element.statemachine();
 	F64 const tfactor = 1000 / calc_clock_frequency();
@@ -305,11 +311,11 @@ void print_statemachine_diagnostics(U64 total_clocks, AIStateMachine::StateTimer
 
 	if (total_clocks > max_delta)
 	{
-		msg << "AIStateMachine::mainloop did run for " << (total_clocks * tfactor) << " ms. The slowest ";
+		msg << loop << " did run for " << (total_clocks * tfactor) << " ms. The slowest ";
 	}
 	else
 	{
-		msg << "AIStateMachine::mainloop: A ";
+		msg << loop << ": A ";
 	}
 	msg << "state machine " << "(" << slowest_state_machine.getName() << ") " << "ran for " << (max_delta * tfactor) << " ms";
 	if (slowest_state_machine.getRuntime() > max_delta)
@@ -361,7 +367,7 @@ void AIEngine::mainloop(void)
 #endif
 	}
 
-	bool active = state_machine.active(this);		// This locks mState shortly, so it must be called before locking mEngineState because add() locks mEngineState while holding mState.
+	bool active = state_machine.active(mOwner);		// This locks mState shortly, so it must be called before locking mEngineState because add() locks mEngineState while holding mState.
 	engine_state_type_wat engine_state_w(mEngineState);
 	if (!active)
 	{
@@ -375,7 +381,7 @@ void AIEngine::mainloop(void)
 	if (total_clocks >= sMaxCount)
 	{
 #if STATE_MACHINE_PROFILING
-		print_statemachine_diagnostics(total_clocks, slowest_timer, slowest_element);
+		print_statemachine_diagnostics("AIStateMachine::mainloop", total_clocks, slowest_timer, slowest_element);
 #endif
 	  Dout(dc::statemachine, "Sorting " << engine_state_w->list.size() << " state machines.");
 	  engine_state_w->list.sort(QueueElementComp());
@@ -787,8 +793,8 @@ void AIStateMachine::multiplex(event_type event)
 }
 
 #if STATE_MACHINE_PROFILING
-std::vector<AIStateMachine::StateTimerBase*> AIStateMachine::StateTimerBase::mTimerStack;
-AIStateMachine::StateTimerBase::TimeData AIStateMachine::StateTimerBase::TimeData::sRoot("");
+thread_local std::vector<AIStateMachine::StateTimerBase*> AIStateMachine::StateTimerBase::mTimerStack;
+thread_local AIStateMachine::StateTimerBase::TimeData AIStateMachine::StateTimerBase::TimeData::sRoot("");
 void AIStateMachine::StateTimer::TimeData::DumpTimer(std::ostringstream& msg, std::string prefix)
 {
 	F64 const tfactor = 1000 / calc_clock_frequency();
@@ -1364,7 +1370,7 @@ char const* AIStateMachine::state_str(base_state_type state)
 }
 
 AIEngine gMainThreadEngine("gMainThreadEngine");
-AIEngine gStateMachineThreadEngine("gStateMachineThreadEngine");
+AIThreadPoolEngine gStateMachineThreadEngine("gStateMachineThreadEngine");
 
 // State Machine Thread main loop.
 void AIEngine::threadloop(void)
@@ -1386,8 +1392,24 @@ void AIEngine::threadloop(void)
   do
   {
 	AIStateMachine& state_machine(queued_element->statemachine());
-	state_machine.multiplex(AIStateMachine::normal_run);
-	bool active = state_machine.active(this);		// This locks mState shortly, so it must be called before locking mEngineState because add() locks mEngineState while holding mState.
+	AIStateMachine::StateTimerBase::TimeData time_data;
+	{
+		AIStateMachine::StateTimerRoot timer(state_machine.getName());
+		state_machine.multiplex(AIStateMachine::normal_run);
+		time_data = timer.GetTimerData();
+	}
+	if (U64 delta = time_data.GetDuration())
+	{
+		state_machine.add(delta);
+#if STATE_MACHINE_PROFILING
+		// There is no frame to hold up here, but the other state machines of this thread wait for it.
+		if (delta >= sMaxCount)
+		{
+			print_statemachine_diagnostics(mName, delta, time_data, *queued_element);
+		}
+#endif
+	}
+	bool active = state_machine.active(mOwner);		// This locks mState shortly, so it must be called before locking mEngineState because add() locks mEngineState while holding mState.
 	engine_state_type_wat engine_state_w(mEngineState);
 	if (!active)
 	{
@@ -1417,22 +1439,21 @@ void AIEngine::wake_up(void)
 class AIEngineThread : public LLThread
 {
   public:
-	static AIEngineThread* sInstance;
 	bool volatile mRunning;
 
   public:
     // MAIN-THREAD
-    AIEngineThread(void);
+    AIEngineThread(AIEngine& engine, std::string const& name);
     virtual ~AIEngineThread();
 
   protected:
 	virtual void run(void);
-};
 
-//static
-AIEngineThread* AIEngineThread::sInstance;
+  private:
+	AIEngine& mEngine;
+};
 
-AIEngineThread::AIEngineThread(void) : LLThread("AIEngineThread"), mRunning(true)
+AIEngineThread::AIEngineThread(AIEngine& engine, std::string const& name) : LLThread(name), mRunning(true), mEngine(engine)
 {
 }
 
@@ -1444,25 +1465,157 @@ void AIEngineThread::run(void)
 {
   while(mRunning)
   {
-	gStateMachineThreadEngine.threadloop();
+	mEngine.threadloop();
+  }
+}
+
+//-----------------------------------------------------------------------------
+// AIThreadPoolEngine
+
+// One thread of an AIThreadPoolEngine, with the queue of the state machines that run on it.
+class AIThreadPoolEngine::Lane
+{
+  public:
+	Lane(AIThreadPoolEngine* owner, S32 index) :
+		mName(llformat("%s #%d", owner->name(), index)), mEngine(mName.c_str(), owner), mThread(new AIEngineThread(mEngine, mName)) { }
+
+	std::string mName;
+	AIEngine mEngine;
+	AIEngineThread* mThread;
+};
+
+AIThreadPoolEngine::~AIThreadPoolEngine()
+{
+  // The threads were stopped, or we are exiting and they are left running.
+  for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
+  {
+	if (!(*iter)->mThread)
+	{
+	  delete *iter;
+	}
   }
 }
 
-void startEngineThread(void)
+void AIThreadPoolEngine::start(S32 thread_count)
 {
-  AIEngineThread::sInstance = new AIEngineThread;
-  AIEngineThread::sInstance->start();
+  llassert(AIThreadID::in_main_thread() && mLanes.empty());
+  thread_count = llmax(thread_count, 1);
+  for (S32 i = 0; i < thread_count; ++i)
+  {
+	mLanes.push_back(new Lane(this, i + 1));
+	mLanes.back()->mThread->start();
+  }
+
+  // Hand the state machines added so far to the threads.  mThreadCount is
+  // published with the list locked, so that add() either queued here before
+  // or sees the threads.
+  queued_type waiting;
+  {
+	engine_state_type_wat engine_state_w(mEngineState);
+	mThreadCount = thread_count;
+	waiting.swap(engine_state_w->list);
+  }
+  for (queued_type::iterator iter = waiting.begin(); iter != waiting.end(); ++iter)
+  {
+	add(&iter->statemachine());
+  }
 }
 
-void stopEngineThread(void)
+void AIThreadPoolEngine::stop(void)
 {
-  AIEngineThread::sInstance->mRunning = false;
-  gStateMachineThreadEngine.wake_up();
+  if (!mThreadCount)
+  {
+	return;
+  }
+  // From now on state machines wait in the engine again, for flush().
+  mThreadCount = 0;
+  for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
+  {
+	(*iter)->mThread->mRunning = false;
+  }
+  wake_up();
   int count = 401;
-  while(--count && !AIEngineThread::sInstance->isStopped())
+  bool stopped = false;
+  while (--count && !stopped)
+  {
+	stopped = true;
+	for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
+	{
+	  stopped = stopped && (*iter)->mThread->isStopped();
+	}
+	if (!stopped)
+	{
+	  ms_sleep(10);
+	}
+  }
+  LL_INFOS() << "State machine threads of " << name() << (!stopped ? " not" : "") << " stopped after " << ((400 - count) * 10) << "ms." << LL_ENDL;
+  if (stopped)
+  {
+	for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
+	{
+	  delete (*iter)->mThread;
+	  (*iter)->mThread = NULL;
+	}
+  }
+}
+
+void AIThreadPoolEngine::add(AIStateMachine* state_machine)
+{
+  S32 count = mThreadCount;
+  if (!count)
+  {
+	// Not started yet, unless start() got in first.
+	engine_state_type_wat engine_state_w(mEngineState);
+	count = mThreadCount;
+	if (!count)
+	{
+	  queue(engine_state_w, state_machine);
+	  return;
+	}
+  }
+  // This is called from multiplex() with mState of the state machine locked, which protects mLane.
+  if (state_machine->mLane < 0)
+  {
+	S32 lane = 0;
+	size_t least = mLanes[0]->mEngine.size();
+	for (S32 i = 1; i < count && least; ++i)
+	{
+	  size_t queued = mLanes[i]->mEngine.size();
+	  if (queued < least)
+	  {
+		lane = i;
+		least = queued;
+	  }
+	}
+	state_machine->mLane = lane;
+  }
+  mLanes[state_machine->mLane % count]->mEngine.add(state_machine);
+}
+
+void AIThreadPoolEngine::wake_up(void)
+{
+  AIEngine::wake_up();
+  for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
   {
-	ms_sleep(10);
+	(*iter)->mEngine.wake_up();
   }
-  LL_INFOS() << "State machine thread" << (!AIEngineThread::sInstance->isStopped() ? " not" : "") << " stopped after " << ((400 - count) * 10) << "ms." << LL_ENDL;
 }
 
+void AIThreadPoolEngine::flush(void)
+{
+  AIEngine::flush();
+  for (std::vector<Lane*>::iterator iter = mLanes.begin(); iter != mLanes.end(); ++iter)
+  {
+	(*iter)->mEngine.flush();
+  }
+}
+
+void startEngineThread(S32 thread_count)
+{
+  gStateMachineThreadEngine.start(thread_count);
+}
+
+void stopEngineThread(void)
+{
+  gStateMachineThreadEngine.stop();
+}
@@ -37,7 +37,10 @@
 #include "aithreadsafe.h"
 #include <llpointer.h>
 #include "lltimer.h"
+#include <atomic>
 #include <list>
+#include <string>
+#include <vector>
 #include <boost/signals2.hpp>
 
 class AIConditionBase;
@@ -72,32 +75,73 @@ class AIEngine
 	  engine_state_type(void) : waiting(false) { }
 	};
 
-  private:
+  protected:
 	AIThreadSafeSimpleDC<engine_state_type, LLCondition>	mEngineState;
 	typedef AIAccessConst<engine_state_type, LLCondition>	engine_state_type_crat;
 	typedef AIAccess<engine_state_type, LLCondition>		engine_state_type_rat;
 	typedef AIAccess<engine_state_type, LLCondition>		engine_state_type_wat;
+
+	// Queues state_machine in this engine, with mEngineState locked by the caller.
+	void queue(engine_state_type_wat& engine_state_w, AIStateMachine* state_machine);
+
+  private:
 	char const* mName;
+	AIEngine* mOwner;			// The engine that the state machines in this queue are added to: this, or the AIThreadPoolEngine this is a thread of.
 
 	static U64 sMaxCount;
 
   public:
-	AIEngine(char const* name) : mName(name) { }
+	AIEngine(char const* name, AIEngine* owner = NULL) : mName(name), mOwner(owner ? owner : this) { }
+	virtual ~AIEngine() { }
 
-	void add(AIStateMachine* state_machine);
+	virtual void add(AIStateMachine* state_machine);
 
 	void mainloop(void);
 	void threadloop(void);
-	void wake_up(void);
-	void flush(void);
+	virtual void wake_up(void);
+	virtual void flush(void);
 
 	char const* name(void) const { return mName; }
+	// Number of state machines queued.
+	size_t size(void) const { return engine_state_type_crat(mEngineState)->list.size(); }
 
 	static void setMaxCount(F32 StateMachineMaxTime);
 };
 
+// An engine that runs its state machines on a pool of threads, so that
+// independent state machines run in parallel.  The first time a state
+// machine is added it is given the thread with the fewest state machines
+// queued, and from then on it only runs on that one: it never runs on two
+// threads at once, can keep thread local state, and idle(), yield() and
+// yield(engine) work as they do with the other engines.  The same thread
+// index is used in every AIThreadPoolEngine, so yielding to another one
+// and back does not move a state machine either.
+//
+// State machines added before start() wait in the engine until then.
+class AIThreadPoolEngine : public AIEngine
+{
+  public:
+	AIThreadPoolEngine(char const* name) : AIEngine(name), mThreadCount(0) { }
+	/*virtual*/ ~AIThreadPoolEngine();
+
+	// MAIN-THREAD
+	void start(S32 thread_count);
+	void stop(void);
+
+	S32 getThreadCount(void) const { return mThreadCount; }
+
+	/*virtual*/ void add(AIStateMachine* state_machine);
+	/*virtual*/ void wake_up(void);
+	/*virtual*/ void flush(void);
+
+  private:
+	class Lane;
+	std::vector<Lane*> mLanes;
+	std::atomic<S32> mThreadCount;			// The size of mLanes, once they are running.
+};
+
 extern AIEngine gMainThreadEngine;
-extern AIEngine gStateMachineThreadEngine;
+extern AIThreadPoolEngine gStateMachineThreadEngine;
 
 #ifndef STATE_MACHINE_PROFILING
 #ifndef LL_RELEASE_FOR_DOWNLOAD
@@ -112,7 +156,8 @@ class AIStateMachine : public LLThreadSafeRefCount
 
 	// A simple timer class that will calculate time delta between ctor and GetTimerData call.
 	// Time data is stored as a nested TimeData object.
-	// If STATE_MACHINE_PROFILING is defined then a stack of all StateTimers from root is maintained for debug output.
+	// If STATE_MACHINE_PROFILING is defined then a stack of all StateTimers from root is maintained for debug output,
+	// one per thread, so that the threads of an AIThreadPoolEngine time their state machines too.
 	class StateTimerBase
 	{
 	public:
@@ -132,7 +177,7 @@ class AIStateMachine : public LLThreadSafeRefCount
 			void DumpTimer(std::ostringstream& msg, std::string prefix);
 			std::vector<TimeData> mChildren;
 			std::string mName;	
-			static TimeData sRoot;
+			static thread_local TimeData sRoot;
 #endif
 		};
 #if !STATE_MACHINE_PROFILING
@@ -164,9 +209,6 @@ class AIStateMachine : public LLThreadSafeRefCount
 		// Also hide internals from everything except StateTimerRoot and StateTimer
 		bool AddAsRoot(const std::string& name)
 		{
-			
-			if (!is_main_thread())
-				return true;	//Ignoring this timer, but pretending it was added.
 			if (!mTimerStack.empty())
 				return false;
 			TimeData::sRoot = TimeData(name);
@@ -177,8 +219,7 @@ class AIStateMachine : public LLThreadSafeRefCount
 		}
 		bool AddAsChild(const std::string& name)
 		{
-			if (!is_main_thread())
-				return true;	//Ignoring this timer, but pretending it was added.
+			// Only timed below the StateTimerRoot of an engine; ignored in other threads.
 			if (mTimerStack.empty())
 				return false;
 			mTimerStack.back()->mData->mChildren.push_back(TimeData(name));
@@ -188,7 +229,7 @@ class AIStateMachine : public LLThreadSafeRefCount
 		}
 
 		TimeData* mData;
-		static std::vector<StateTimerBase*> mTimerStack;
+		static thread_local std::vector<StateTimerBase*> mTimerStack;
 
 	public:
 		// Debug spew
@@ -318,6 +359,7 @@ public:
 	// Engine stuff.
 	AIEngine* mDefaultEngine;					// Default engine.
 	AIEngine* mYieldEngine;						// Requested engine.
+	S32 mLane;									// The thread of an AIThreadPoolEngine this runs on, or -1 before it was added to one.
 
 #ifdef SHOW_ASSERT
 	// Debug stuff.
@@ -335,10 +377,10 @@ public:
 	bool mSMDebug;								// Print debug output only when true.
 #endif
   private:
-	U64 mRuntime;								// Total time spent running in the main thread (in clocks).
+	std::atomic<U64> mRuntime;					// Total time spent running from an engine (in clocks).
 
   public:
-	AIStateMachine(CWD_ONLY(bool debug)) : mCallback(NULL), mDefaultEngine(NULL), mYieldEngine(NULL),
+	AIStateMachine(CWD_ONLY(bool debug)) : mCallback(NULL), mDefaultEngine(NULL), mYieldEngine(NULL), mLane(-1),
 #ifdef SHOW_ASSERT
 		mThreadId(AIThreadID::none), mDebugLastState(bs_killed), mDebugShouldRun(false), mDebugAborted(false), mDebugContPending(false),
 		mDebugSetStatePending(false), mDebugAdvanceStatePending(false), mDebugRefCalled(false),
@@ -463,6 +505,7 @@ public:
 	}
 
 	friend class AIEngine;						// Calls multiplex() and force_killed().
+	friend class AIThreadPoolEngine;			// Sets mLane.
 };
 
 bool AIEngine::QueueElementComp::operator()(QueueElement const& e1, QueueElement const& e2) const
@@ -0,0 +1,167 @@
+/**
+ * @file aiengine_test.cpp
+ * @brief Tests for the state machine engine that runs on a pool of threads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../aistatemachine.h"
+#include "lltimer.h"
+
+#include <atomic>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// Yields between its steps, alternately to engine_a and engine_b, and
+	// remembers the threads it ran on from each.
+	class Stepper : public AIStateMachine
+	{
+	  protected:
+		typedef AIStateMachine direct_base_type;
+
+		enum stepper_state_type {
+		  Stepper_step = direct_base_type::max_state,
+		};
+
+	  public:
+		Stepper(AIEngine* engine_a, AIEngine* engine_b, S32 steps) :
+#ifdef CWDEBUG
+			AIStateMachine(false),
+#endif
+			mEngineA(engine_a), mEngineB(engine_b), mSteps(steps), mStep(0) { }
+
+		std::set<std::thread::id> mThreadsA;
+		std::set<std::thread::id> mThreadsB;
+
+		/*virtual*/ const char* getName() const { return "Stepper"; }
+
+	  protected:
+		/*virtual*/ ~Stepper() { }
+
+		/*virtual*/ void initialize_impl(void)
+		{
+			set_state(Stepper_step);
+		}
+
+		/*virtual*/ void multiplex_impl(state_type run_state)
+		{
+			bool in_b = mStep % 2;
+			(in_b ? mThreadsB : mThreadsA).insert(std::this_thread::get_id());
+			if (++mStep == mSteps)
+			{
+				finish();
+			}
+			else
+			{
+				yield(in_b ? mEngineA : mEngineB);
+			}
+		}
+
+		/*virtual*/ char const* state_str_impl(state_type run_state) const
+		{
+			switch(run_state)
+			{
+				AI_CASE_RETURN(Stepper_step);
+			}
+			return "UNKNOWN STATE";
+		}
+
+	  private:
+		AIEngine* mEngineA;
+		AIEngine* mEngineB;
+		S32 mSteps;
+		S32 mStep;
+	};
+}
+
+namespace tut
+{
+	struct aiengine_test
+	{
+	};
+	typedef test_group<aiengine_test> aiengine_group_t;
+	typedef aiengine_group_t::object aiengine_object_t;
+	tut::aiengine_group_t aiengine_instance("AIEngine");
+
+	// State machines run on the threads of an AIThreadPoolEngine, each always
+	// on the same thread of a pool, also when they yield to another engine and
+	// come back.
+	template<> template<>
+	void aiengine_object_t::test<1>()
+	{
+		AIEngine::setMaxCount(1000.f);
+
+		AIThreadPoolEngine engine_a("Test Engine A");
+		AIThreadPoolEngine engine_b("Test Engine B");
+		const S32 COUNT = 24;
+		std::vector<LLPointer<Stepper> > steppers;
+		std::atomic<S32> finished(0);
+		std::atomic<S32> succeeded(0);
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			steppers.push_back(new Stepper(&engine_a, &engine_b, 2000));
+			// Added before the engine starts: waits until it does
+			if (i == COUNT / 2)
+			{
+				engine_a.start(3);
+				engine_b.start(2);
+				ensure_equals("threads", engine_a.getThreadCount(), 3);
+			}
+			steppers.back()->run([&finished, &succeeded](bool success)
+				{
+					succeeded += success;
+					++finished;
+				}, &engine_a);
+		}
+
+		LLTimer timer;
+		while (finished < COUNT && timer.getElapsedTimeF32() < 30.f)
+		{
+			ms_sleep(1);
+		}
+		ensure_equals("all finished", (S32)finished, COUNT);
+		ensure_equals("all succeeded", (S32)succeeded, COUNT);
+
+		std::set<std::thread::id> used;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("one thread of engine a", steppers[i]->mThreadsA.size(), (size_t)1);
+			ensure_equals("one thread of engine b", steppers[i]->mThreadsB.size(), (size_t)1);
+			used.insert(*steppers[i]->mThreadsA.begin());
+			ensure("engines have their own threads", !steppers[i]->mThreadsB.count(*steppers[i]->mThreadsA.begin()));
+		}
+		ensure("state machines spread over the threads", used.size() > 1);
+
+		engine_a.stop();
+		engine_b.stop();
+		ensure_equals("stopped", engine_a.getThreadCount(), 0);
+		engine_a.flush();
+		engine_b.flush();
+	}
+}
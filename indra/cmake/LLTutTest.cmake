@@ -0,0 +1,50 @@
+# -*- cmake -*-
+
+if(NOT DEFINED ${CMAKE_CURRENT_LIST_FILE}_INCLUDED)
+set(${CMAKE_CURRENT_LIST_FILE}_INCLUDED "YES")
+
+include(APR)
+include(LLCommon)
+include(LLMath)
+include(Linking)
+include(Tut)
+
+# Builds tests/<testname>_test.cpp with the shared tut runner (test/test.cpp)
+# and ensure helpers (test/lltut.cpp) against library_dependencies, and
+# registers it with ctest.  Each run touches a stamp file on success so that a
+# failing test is rerun even if nothing it depends on was rebuilt.
+#
+# autobuild.xml carries no tut package: configure with -DSTANDALONE_tut=ON to
+# use the tut headers installed on the system.
+MACRO(LL_ADD_TUT_TEST testname library_dependencies)
+  set(target TUT_TEST_${testname})
+
+  add_executable(${target}
+      tests/${testname}_test.cpp
+      ${LIBS_OPEN_DIR}/test/test.cpp
+      ${LIBS_OPEN_DIR}/test/lltut.cpp
+      )
+  target_include_directories(${target} PRIVATE
+      ${CMAKE_CURRENT_SOURCE_DIR}
+      ${LLCOMMON_INCLUDE_DIRS}
+      ${LLMATH_INCLUDE_DIRS}
+      ${LIBS_OPEN_DIR}/test
+      ${TUT_INCLUDE_DIR}
+      )
+  target_link_libraries(${target}
+      ${library_dependencies}
+      ${LLCOMMON_LIBRARIES}
+      ${APRUTIL_LIBRARIES}
+      ${APR_LIBRARIES}
+      ${PTHREAD_LIBRARY}
+      )
+
+  add_test(NAME ${testname}
+           COMMAND $<TARGET_FILE:${target}>
+                   --touch ${CMAKE_CURRENT_BINARY_DIR}/${testname}_test_ok.txt
+                   --sourcedir ${CMAKE_CURRENT_SOURCE_DIR}
+           WORKING_DIRECTORY ${CMAKE_CURRENT_BINARY_DIR}
+           )
+ENDMACRO(LL_ADD_TUT_TEST)
+
+endif(NOT DEFINED ${CMAKE_CURRENT_LIST_FILE}_INCLUDED)
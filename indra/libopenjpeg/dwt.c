@@ -37,6 +37,12 @@
 #ifdef __SSE__
 #include <xmmintrin.h>
 #endif
+#ifdef OPJ_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+#ifdef OPJ_HAVE_AVX2
+#include <immintrin.h>
+#endif
 
 #if defined(__GNUC__)
 #pragma GCC poison malloc calloc realloc free
@@ -69,6 +75,17 @@ typedef struct v4dwt_local {
 	int		cas ;
 } v4dwt_t ;
 
+typedef union {
+	float	f[8];
+} v8;
+
+typedef struct v8dwt_local {
+	v8*	wavelet ;
+	int		dn ;
+	int		sn ;
+	int		cas ;
+} v8dwt_t ;
+
 static const float dwt_alpha =  1.586134342f; /*  12994 */
 static const float dwt_beta  =  0.052980118f; /*    434 */
 static const float dwt_gamma = -0.882911075f; /*  -7233 */
@@ -123,7 +140,7 @@ static void dwt_encode_stepsize(int stepsize, int numbps, opj_stepsize_t *bandno
 /**
 Inverse wavelet transform in 2-D.
 */
-static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int i, DWT1DFN fn);
+static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int i, DWT1DFN fn, int simd);
 
 /*@}*/
 
@@ -273,6 +290,78 @@ static void dwt_decode_1(dwt_t *v) {
 	dwt_decode_1_(v->mem, v->dn, v->sn, v->cas);
 }
 
+#ifdef OPJ_HAVE_SSE2
+/* <summary>                                                  */
+/* Inverse 5-3 wavelet transform in 1-D of 4 columns at once. */
+/* Needs sn > 0 and dn > 0.                                   */
+/* </summary>                                                 */
+static void dwt_decode_1_sse2(__m128i *a, int dn, int sn, int cas) {
+	const __m128i two = _mm_set1_epi32(2);
+	int i;
+
+	if (!cas) {
+		for (i = 0; i < sn; i++) S(i) = _mm_sub_epi32(S(i), _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(D_(i - 1), D_(i)), two), 2));
+		for (i = 0; i < dn; i++) D(i) = _mm_add_epi32(D(i), _mm_srai_epi32(_mm_add_epi32(S_(i), S_(i + 1)), 1));
+	} else {
+		for (i = 0; i < sn; i++) D(i) = _mm_sub_epi32(D(i), _mm_srai_epi32(_mm_add_epi32(_mm_add_epi32(SS_(i), SS_(i + 1)), two), 2));
+		for (i = 0; i < dn; i++) S(i) = _mm_add_epi32(S(i), _mm_srai_epi32(_mm_add_epi32(DD_(i), DD_(i - 1)), 1));
+	}
+}
+
+/* <summary>                                                   */
+/* Inverse 5-3 wavelet transform of 4 columns of a tile (vertical). */
+/* </summary>                                                  */
+static void dwt_decode_v_sse2(dwt_t* v, __m128i* OPJ_RESTRICT mem, int* OPJ_RESTRICT a, int x) {
+	int i;
+	for (i = 0; i < v->sn; ++i) {
+		mem[v->cas + i * 2] = _mm_loadu_si128((const __m128i*) &a[i * x]);
+	}
+	for (i = 0; i < v->dn; ++i) {
+		mem[1 - v->cas + i * 2] = _mm_loadu_si128((const __m128i*) &a[(v->sn + i) * x]);
+	}
+	dwt_decode_1_sse2(mem, v->dn, v->sn, v->cas);
+	for (i = 0; i < v->sn + v->dn; ++i) {
+		_mm_storeu_si128((__m128i*) &a[i * x], mem[i]);
+	}
+}
+#endif
+
+#ifdef OPJ_HAVE_AVX2
+/* <summary>                                                  */
+/* Inverse 5-3 wavelet transform in 1-D of 8 columns at once. */
+/* Needs sn > 0 and dn > 0.                                   */
+/* </summary>                                                 */
+static OPJ_TARGET_AVX2 void dwt_decode_1_avx2(__m256i *a, int dn, int sn, int cas) {
+	const __m256i two = _mm256_set1_epi32(2);
+	int i;
+
+	if (!cas) {
+		for (i = 0; i < sn; i++) S(i) = _mm256_sub_epi32(S(i), _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(D_(i - 1), D_(i)), two), 2));
+		for (i = 0; i < dn; i++) D(i) = _mm256_add_epi32(D(i), _mm256_srai_epi32(_mm256_add_epi32(S_(i), S_(i + 1)), 1));
+	} else {
+		for (i = 0; i < sn; i++) D(i) = _mm256_sub_epi32(D(i), _mm256_srai_epi32(_mm256_add_epi32(_mm256_add_epi32(SS_(i), SS_(i + 1)), two), 2));
+		for (i = 0; i < dn; i++) S(i) = _mm256_add_epi32(S(i), _mm256_srai_epi32(_mm256_add_epi32(DD_(i), DD_(i - 1)), 1));
+	}
+}
+
+/* <summary>                                                   */
+/* Inverse 5-3 wavelet transform of 8 columns of a tile (vertical). */
+/* </summary>                                                  */
+static OPJ_TARGET_AVX2 void dwt_decode_v_avx2(dwt_t* v, __m256i* OPJ_RESTRICT mem, int* OPJ_RESTRICT a, int x) {
+	int i;
+	for (i = 0; i < v->sn; ++i) {
+		mem[v->cas + i * 2] = _mm256_loadu_si256((const __m256i*) &a[i * x]);
+	}
+	for (i = 0; i < v->dn; ++i) {
+		mem[1 - v->cas + i * 2] = _mm256_loadu_si256((const __m256i*) &a[(v->sn + i) * x]);
+	}
+	dwt_decode_1_avx2(mem, v->dn, v->sn, v->cas);
+	for (i = 0; i < v->sn + v->dn; ++i) {
+		_mm256_storeu_si256((__m256i*) &a[i * x], mem[i]);
+	}
+}
+#endif
+
 /* <summary>                             */
 /* Forward 9-7 wavelet transform in 1-D. */
 /* </summary>                            */
@@ -384,8 +473,8 @@ void dwt_encode(opj_tcd_tilecomp_t * tilec) {
 /* <summary>                            */
 /* Inverse 5-3 wavelet transform in 2-D. */
 /* </summary>                           */
-void dwt_decode(opj_tcd_tilecomp_t* tilec, int numres) {
-	dwt_decode_tile(tilec, numres, &dwt_decode_1);
+void dwt_decode(opj_tcd_tilecomp_t* tilec, int numres, int simd) {
+	dwt_decode_tile(tilec, numres, &dwt_decode_1, simd);
 }
 
 
@@ -521,9 +610,11 @@ static int dwt_decode_max_resolution(opj_tcd_resolution_t* OPJ_RESTRICT r, int i
 /* <summary>                            */
 /* Inverse wavelet transform in 2-D.     */
 /* </summary>                           */
-static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1D) {
+static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1D, int simd) {
 	dwt_t h;
 	dwt_t v;
+	/* columns transformed side by side, one vector per row */
+	void* lanes = NULL;
 
 	opj_tcd_resolution_t* tr = tilec->resolutions;
 
@@ -534,6 +625,9 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 
 	h.mem = (int*)opj_aligned_malloc(dwt_decode_max_resolution(tr, numres) * sizeof(int));
 	v.mem = h.mem;
+	if (simd != OPJ_SIMD_NONE) {
+		lanes = opj_aligned_32_malloc(dwt_decode_max_resolution(tr, numres) * 32);
+	}
 
 	while( --numres) {
 		int * OPJ_RESTRICT tiledp = tilec->data;
@@ -558,7 +652,22 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 		v.dn = rh - v.sn;
 		v.cas = tr->y0 % 2;
 
-		for(j = 0; j < rw; ++j){
+		j = 0;
+		if (lanes && v.sn > 0 && v.dn > 0) {
+#ifdef OPJ_HAVE_AVX2
+			if (simd >= OPJ_SIMD_AVX2) {
+				for (; j + 8 <= rw; j += 8) {
+					dwt_decode_v_avx2(&v, (__m256i*) lanes, &tiledp[j], w);
+				}
+			}
+#endif
+#ifdef OPJ_HAVE_SSE2
+			for (; j + 4 <= rw; j += 4) {
+				dwt_decode_v_sse2(&v, (__m128i*) lanes, &tiledp[j], w);
+			}
+#endif
+		}
+		for(; j < rw; ++j){
 			int k;
 			dwt_interleave_v(&v, &tiledp[j], w);
 			(dwt_1D)(&v);
@@ -567,6 +676,7 @@ static void dwt_decode_tile(opj_tcd_tilecomp_t* tilec, int numres, DWT1DFN dwt_1
 			}
 		}
 	}
+	opj_aligned_free(lanes);
 	opj_aligned_free(h.mem);
 }
 
@@ -690,7 +800,7 @@ static void v4dwt_decode_step2_sse(v4* l, v4* w, int k, int m, __m128 c){
 	}
 }
 
-#else
+#endif
 
 static void v4dwt_decode_step1(v4* w, int count, const float c){
 	float* OPJ_RESTRICT fw = (float*) w;
@@ -755,12 +865,105 @@ static void v4dwt_decode_step2(v4* l, v4* w, int k, int m, float c){
 	}
 }
 
+#ifdef OPJ_HAVE_AVX2
+
+static OPJ_TARGET_AVX2 void v8dwt_interleave_h(v8dwt_t* OPJ_RESTRICT w, float* OPJ_RESTRICT a, int x) {
+	float* OPJ_RESTRICT bi = (float*)(w->wavelet + w->cas);
+	int count = w->sn;
+	int i, k, r;
+	for (k = 0; k < 2; ++k) {
+		for (i = 0; i < count; ++i) {
+			for (r = 0; r < 8; ++r) {
+				bi[i * 16 + r] = a[i + r * x];
+			}
+		}
+		bi = (float*)(w->wavelet + 1 - w->cas);
+		a += w->sn;
+		count = w->dn;
+	}
+}
+
+static OPJ_TARGET_AVX2 void v8dwt_interleave_v(v8dwt_t* OPJ_RESTRICT v , float* OPJ_RESTRICT a , int x){
+	__m256* OPJ_RESTRICT bi = (__m256*)(v->wavelet + v->cas);
+	int i;
+	for(i = 0; i < v->sn; ++i){
+		bi[i*2] = _mm256_loadu_ps(&a[i*x]);
+	}
+	a += v->sn * x;
+	bi = (__m256*)(v->wavelet + 1 - v->cas);
+	for(i = 0; i < v->dn; ++i){
+		bi[i*2] = _mm256_loadu_ps(&a[i*x]);
+	}
+}
+
+static OPJ_TARGET_AVX2 void v8dwt_decode_step1_avx2(v8* w, int count, const __m256 c){
+	__m256* OPJ_RESTRICT vw = (__m256*) w;
+	int i;
+	for(i = 0; i < count; ++i){
+		vw[i*2] = _mm256_mul_ps(vw[i*2], c);
+	}
+}
+
+/* same operations as v4dwt_decode_step2_sse, 8 lanes wide */
+static OPJ_TARGET_AVX2 void v8dwt_decode_step2_avx2(v8* l, v8* w, int k, int m, __m256 c){
+	__m256* OPJ_RESTRICT vw = (__m256*) w;
+	int i;
+	__m256 tmp1 = *(__m256*) l;
+	for (i = 0; i < m; ++i) {
+		__m256 tmp2 = vw[-1];
+		__m256 tmp3 = vw[0];
+		vw[-1] = _mm256_add_ps(tmp2, _mm256_mul_ps(_mm256_add_ps(tmp1, tmp3), c));
+		tmp1 = tmp3;
+		vw += 2;
+	}
+	if(m >= k){
+		return;
+	}
+	c = _mm256_add_ps(c, c);
+	c = _mm256_mul_ps(c, vw[-2]);
+	for(; m < k; ++m){
+		__m256 tmp = vw[-1];
+		vw[-1] = _mm256_add_ps(tmp, c);
+		vw += 2;
+	}
+}
+
+/* <summary>                                            */
+/* Inverse 9-7 wavelet transform in 1-D, 8 rows or columns at once. */
+/* </summary>                                           */
+static OPJ_TARGET_AVX2 void v8dwt_decode(v8dwt_t* OPJ_RESTRICT dwt){
+	int a, b;
+	v8* waveleta;
+	v8* waveletb;
+	if(dwt->cas == 0) {
+		if (dwt->dn <= 0 && dwt->sn <= 1) {
+			return;
+		}
+		a = 0;
+		b = 1;
+	}else{
+		if (dwt->sn <= 0 && dwt->dn <= 1) {
+			return;
+		}
+		a = 1;
+		b = 0;
+	}
+	waveleta = dwt->wavelet + a;
+	waveletb = dwt->wavelet + b;
+	v8dwt_decode_step1_avx2(waveleta, dwt->sn, _mm256_set1_ps(K));
+	v8dwt_decode_step1_avx2(waveletb, dwt->dn, _mm256_set1_ps(c13318));
+	v8dwt_decode_step2_avx2(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm256_set1_ps(dwt_delta));
+	v8dwt_decode_step2_avx2(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm256_set1_ps(dwt_gamma));
+	v8dwt_decode_step2_avx2(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm256_set1_ps(dwt_beta));
+	v8dwt_decode_step2_avx2(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm256_set1_ps(dwt_alpha));
+}
+
 #endif
 
 /* <summary>                             */
 /* Inverse 9-7 wavelet transform in 1-D. */
 /* </summary>                            */
-static void v4dwt_decode(v4dwt_t* OPJ_RESTRICT dwt){
+static void v4dwt_decode(v4dwt_t* OPJ_RESTRICT dwt, int simd){
 	int a, b;
 	if(dwt->cas == 0) {
 		if (dwt->dn <= 0 && dwt->sn <= 1) {
@@ -778,28 +981,34 @@ static void v4dwt_decode(v4dwt_t* OPJ_RESTRICT dwt){
 	v4* OPJ_RESTRICT waveleta = dwt->wavelet + a;
 	v4* OPJ_RESTRICT waveletb = dwt->wavelet + b;
 #ifdef __SSE__
-	v4dwt_decode_step1_sse(waveleta, dwt->sn, _mm_set1_ps(K));
-	v4dwt_decode_step1_sse(waveletb, dwt->dn, _mm_set1_ps(c13318));
-	v4dwt_decode_step2_sse(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm_set1_ps(dwt_delta));
-	v4dwt_decode_step2_sse(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm_set1_ps(dwt_gamma));
-	v4dwt_decode_step2_sse(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm_set1_ps(dwt_beta));
-	v4dwt_decode_step2_sse(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm_set1_ps(dwt_alpha));
-#else
+	if (simd != OPJ_SIMD_NONE) {
+		v4dwt_decode_step1_sse(waveleta, dwt->sn, _mm_set1_ps(K));
+		v4dwt_decode_step1_sse(waveletb, dwt->dn, _mm_set1_ps(c13318));
+		v4dwt_decode_step2_sse(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm_set1_ps(dwt_delta));
+		v4dwt_decode_step2_sse(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm_set1_ps(dwt_gamma));
+		v4dwt_decode_step2_sse(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), _mm_set1_ps(dwt_beta));
+		v4dwt_decode_step2_sse(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), _mm_set1_ps(dwt_alpha));
+		return;
+	}
+#endif
 	v4dwt_decode_step1(waveleta, dwt->sn, K);
 	v4dwt_decode_step1(waveletb, dwt->dn, c13318);
 	v4dwt_decode_step2(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), dwt_delta);
 	v4dwt_decode_step2(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), dwt_gamma);
 	v4dwt_decode_step2(waveletb, waveleta + 1, dwt->sn, int_min(dwt->sn, dwt->dn-a), dwt_beta);
 	v4dwt_decode_step2(waveleta, waveletb + 1, dwt->dn, int_min(dwt->dn, dwt->sn-b), dwt_alpha);
-#endif
 }
 
 /* <summary>                             */
 /* Inverse 9-7 wavelet transform in 2-D. */
 /* </summary>                            */
-void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
+void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres, int simd){
 	v4dwt_t h;
 	v4dwt_t v;
+#ifdef OPJ_HAVE_AVX2
+	v8dwt_t rows8;
+	v8dwt_t cols8;
+#endif
 
 	opj_tcd_resolution_t* res = tilec->resolutions;
 
@@ -808,6 +1017,14 @@ void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
 
 	int w = tilec->x1 - tilec->x0;
 
+#ifdef OPJ_HAVE_AVX2
+	if (simd >= OPJ_SIMD_AVX2) {
+		/* 8 rows or columns at once, the 4 wide code for what remains */
+		rows8.wavelet = (v8*) opj_aligned_32_malloc((dwt_decode_max_resolution(res, numres)+5) * sizeof(v8));
+		cols8.wavelet = rows8.wavelet;
+		h.wavelet = (v4*) rows8.wavelet;
+	} else
+#endif
 	h.wavelet = (v4*) opj_aligned_malloc((dwt_decode_max_resolution(res, numres)+5) * sizeof(v4));
 	v.wavelet = h.wavelet;
 
@@ -827,10 +1044,30 @@ void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
 		h.dn = rw - h.sn;
 		h.cas = res->x0 % 2;
 
-		for(j = rh; j > 3; j -= 4){
+		j = rh;
+#ifdef OPJ_HAVE_AVX2
+		if (simd >= OPJ_SIMD_AVX2) {
+			rows8.sn = h.sn;
+			rows8.dn = h.dn;
+			rows8.cas = h.cas;
+			for(; j > 7; j -= 8){
+				int k, r;
+				v8dwt_interleave_h(&rows8, aj, w);
+				v8dwt_decode(&rows8);
+				for(k = rw; --k >= 0;){
+					for(r = 0; r < 8; ++r){
+						aj[k + w*r] = rows8.wavelet[k].f[r];
+					}
+				}
+				aj += w*8;
+				bufsize -= w*8;
+			}
+		}
+#endif
+		for(; j > 3; j -= 4){
 			int k;
 			v4dwt_interleave_h(&h, aj, w, bufsize);
-			v4dwt_decode(&h);
+			v4dwt_decode(&h, simd);
 				for(k = rw; --k >= 0;){
 					aj[k    ] = h.wavelet[k].f[0];
 					aj[k+w  ] = h.wavelet[k].f[1];
@@ -844,7 +1081,7 @@ void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
 				int k;
 			j = rh & 0x03;
 			v4dwt_interleave_h(&h, aj, w, bufsize);
-			v4dwt_decode(&h);
+			v4dwt_decode(&h, simd);
 				for(k = rw; --k >= 0;){
 					switch(j) {
 						case 3: aj[k+w*2] = h.wavelet[k].f[2];
@@ -858,10 +1095,27 @@ void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
 		v.cas = res->y0 % 2;
 
 		aj = (float*) tilec->data;
-		for(j = rw; j > 3; j -= 4){
+		j = rw;
+#ifdef OPJ_HAVE_AVX2
+		if (simd >= OPJ_SIMD_AVX2) {
+			cols8.sn = v.sn;
+			cols8.dn = v.dn;
+			cols8.cas = v.cas;
+			for(; j > 7; j -= 8){
+				int k;
+				v8dwt_interleave_v(&cols8, aj, w);
+				v8dwt_decode(&cols8);
+				for(k = 0; k < rh; ++k){
+					memcpy(&aj[k*w], &cols8.wavelet[k], 8 * sizeof(float));
+				}
+				aj += 8;
+			}
+		}
+#endif
+		for(; j > 3; j -= 4){
 			int k;
 			v4dwt_interleave_v(&v, aj, w);
-			v4dwt_decode(&v);
+			v4dwt_decode(&v, simd);
 				for(k = 0; k < rh; ++k){
 					memcpy(&aj[k*w], &v.wavelet[k], 4 * sizeof(float));
 				}
@@ -871,7 +1125,7 @@ void dwt_decode_real(opj_tcd_tilecomp_t* OPJ_RESTRICT tilec, int numres){
 				int k;
 			j = rw & 0x03;
 			v4dwt_interleave_v(&v, aj, w);
-			v4dwt_decode(&v);
+			v4dwt_decode(&v, simd);
 				for(k = 0; k < rh; ++k){
 					memcpy(&aj[k*w], &v.wavelet[k], j * sizeof(float));
 				}
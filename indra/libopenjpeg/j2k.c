@@ -1488,7 +1488,7 @@ static void j2k_write_sod(opj_j2k_t *j2k, void *tile_coder) {
 	cio_write(cio, totlen, 4);
 	cio_seek(cio, j2k->sot_start + totlen);
 	/* Writing Ttlm and Ptlm in TLM marker */
-	if(cp->cinema){
+	if(cp->cinema || cp->tp_on){
 		cio_seek(cio, j2k->tlm_start + 6 + (5*j2k->cur_tp_num));
 		cio_write(cio, j2k->curtileno, 1);
 		cio_write(cio, totlen, 4);
@@ -1845,6 +1845,15 @@ void j2k_setup_decoder(opj_j2k_t *j2k, opj_dparameters_t *parameters) {
 		cp->reduce = parameters->cp_reduce;	
 		cp->layer = parameters->cp_layer;
 		cp->limit_decoding = parameters->cp_limit_decoding;
+		cp->cache = parameters->cp_cache;
+		cp->simd = opj_simd_level();
+		if (parameters->flags & OPJ_DPARAMETERS_NO_SIMD_FLAG) {
+			cp->simd = OPJ_SIMD_NONE;
+		} else if ((parameters->flags & OPJ_DPARAMETERS_NO_AVX2_FLAG) && cp->simd > OPJ_SIMD_SSE2) {
+			cp->simd = OPJ_SIMD_SSE2;
+		}
+		cp->run_jobs = parameters->cp_run_jobs;
+		cp->runner = parameters->cp_runner;
 
 #ifdef USE_JPWL
 		cp->correct = parameters->jpwl_correct;
@@ -1876,7 +1885,16 @@ opj_image_t* j2k_decode(opj_j2k_t *j2k, opj_cio_t *cio, opj_codestream_info_t *c
 
 	for (;;) {
 		opj_dec_mstabent_t *e;
-		int id = cio_read(cio, 2);
+		int id;
+
+		/* A codestream that stops right after a tile-part, as when only the
+		   resolutions that are needed were fetched, is truncated: decode what
+		   there is. */
+		if (j2k->state == J2K_STATE_TPHSOT && cio_numbytesleft(cio) <= 0) {
+			j2k->state = J2K_STATE_NEOC;
+			break;
+		}
+		id = cio_read(cio, 2);
 
 #ifdef USE_JPWL
 		/* we try to honor JPWL correction power */
@@ -2404,6 +2422,9 @@ opj_bool j2k_encode(opj_j2k_t *j2k, opj_cio_t *cio, opj_image_t *image, opj_code
 		if (cp->cinema == CINEMA4K_24) {
 			j2k_write_poc(j2k);
 		}
+	} else if(cp->tp_on){
+		/* lets readers find the tile-parts from the main header */
+		j2k_write_tlm(j2k);
 	}
 
 	/* uncomment only for testing JPSEC marker writing */
@@ -228,6 +228,14 @@ typedef struct opj_cp {
 	int layer;
 	/** if == NO_LIMITATION, decode entire codestream; if == LIMIT_TO_MAIN_HEADER then only decode the main header */
 	OPJ_LIMIT_DECODING limit_decoding;
+	/** decoded code-blocks kept across decodes of a growing codestream, NULL if none */
+	opj_decode_cache_t *cache;
+	/** instruction set of the DWT and the MCT, OPJ_SIMD_NONE, OPJ_SIMD_SSE2 or OPJ_SIMD_AVX2 */
+	int simd;
+	/** job runner for the tier-1 decoding, NULL to decode on the calling thread */
+	opj_run_jobs_fn run_jobs;
+	/** passed to run_jobs */
+	void *runner;
 	/** XTOsiz */
 	int tx0;
 	/** YTOsiz */
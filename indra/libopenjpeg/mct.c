@@ -40,6 +40,10 @@
 #  include <smmintrin.h>
 #endif
 
+#ifdef OPJ_HAVE_AVX2
+#  include <immintrin.h>
+#endif
+
 #if defined(__GNUC__)
 #pragma GCC poison malloc calloc realloc free
 #endif
@@ -98,6 +102,34 @@ void mct_encode(
 	}
 }
 
+#ifdef OPJ_HAVE_AVX2
+/* <summary> */
+/* Inverse reversible MCT, 8 samples at once. */
+/* Returns the number of samples done. */
+/* </summary> */
+static OPJ_TARGET_AVX2 int mct_decode_avx2(
+		int* OPJ_RESTRICT c0,
+		int* OPJ_RESTRICT c1,
+		int* OPJ_RESTRICT c2,
+		int n)
+{
+	int i;
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256i r, g, b;
+		__m256i y = _mm256_loadu_si256((const __m256i*) & (c0[i]));
+		__m256i u = _mm256_loadu_si256((const __m256i*) & (c1[i]));
+		__m256i v = _mm256_loadu_si256((const __m256i*) & (c2[i]));
+		g = _mm256_sub_epi32(y, _mm256_srai_epi32(_mm256_add_epi32(u, v), 2));
+		r = _mm256_add_epi32(v, g);
+		b = _mm256_add_epi32(u, g);
+		_mm256_storeu_si256((__m256i*) & (c0[i]), r);
+		_mm256_storeu_si256((__m256i*) & (c1[i]), g);
+		_mm256_storeu_si256((__m256i*) & (c2[i]), b);
+	}
+	return i;
+}
+#endif
+
 /* <summary> */
 /* Inverse reversible MCT. */
 /* </summary> */
@@ -105,12 +137,18 @@ void mct_decode(
 		int* OPJ_RESTRICT c0,
 		int* OPJ_RESTRICT c1,
 		int* OPJ_RESTRICT c2,
-		int n)
+		int n,
+		int simd)
 {
 	int i = 0;
+#ifdef OPJ_HAVE_AVX2
+	if (simd >= OPJ_SIMD_AVX2) {
+		i = mct_decode_avx2(c0, c1, c2, n);
+	}
+#endif
 #ifdef __SSE2__
 	/* Buffers are normally aligned on 16 bytes... */
-	if (((size_t)c0 & 0xf) == 0 && ((size_t)c1 & 0xf) == 0 && ((size_t)c2 & 0xf) == 0) {
+	if (simd != OPJ_SIMD_NONE && ((size_t)c0 & 0xf) == 0 && ((size_t)c1 & 0xf) == 0 && ((size_t)c2 & 0xf) == 0) {
 		const int cnt = n & ~3U;
 		for (; i < cnt; i += 4) {
 			__m128i r, g, b;
@@ -276,6 +314,38 @@ void mct_encode_real(
 	}
 }
 
+#ifdef OPJ_HAVE_AVX2
+/* <summary> */
+/* Inverse irreversible MCT, 8 samples at once. */
+/* Returns the number of samples done. */
+/* </summary> */
+static OPJ_TARGET_AVX2 int mct_decode_real_avx2(
+		float* OPJ_RESTRICT c0,
+		float* OPJ_RESTRICT c1,
+		float* OPJ_RESTRICT c2,
+		int n)
+{
+	const __m256 vrv = _mm256_set1_ps(1.402f);
+	const __m256 vgu = _mm256_set1_ps(0.34413f);
+	const __m256 vgv = _mm256_set1_ps(0.71414f);
+	const __m256 vbu = _mm256_set1_ps(1.772f);
+	int i;
+	for (i = 0; i + 8 <= n; i += 8) {
+		__m256 vy = _mm256_loadu_ps(&c0[i]);
+		__m256 vu = _mm256_loadu_ps(&c1[i]);
+		__m256 vv = _mm256_loadu_ps(&c2[i]);
+		/* multiplies and adds kept apart, a fused multiply-add would round differently */
+		__m256 vr = _mm256_add_ps(vy, _mm256_mul_ps(vv, vrv));
+		__m256 vg = _mm256_sub_ps(_mm256_sub_ps(vy, _mm256_mul_ps(vu, vgu)), _mm256_mul_ps(vv, vgv));
+		__m256 vb = _mm256_add_ps(vy, _mm256_mul_ps(vu, vbu));
+		_mm256_storeu_ps(&c0[i], vr);
+		_mm256_storeu_ps(&c1[i], vg);
+		_mm256_storeu_ps(&c2[i], vb);
+	}
+	return i;
+}
+#endif
+
 /* <summary> */
 /* Inverse irreversible MCT. */
 /* </summary> */
@@ -283,48 +353,60 @@ void mct_decode_real(
 		float* OPJ_RESTRICT c0,
 		float* OPJ_RESTRICT c1,
 		float* OPJ_RESTRICT c2,
-		int n)
+		int n,
+		int simd)
 {
 	int i;
+#ifdef OPJ_HAVE_AVX2
+	if (simd >= OPJ_SIMD_AVX2) {
+		i = mct_decode_real_avx2(c0, c1, c2, n);
+		c0 += i;
+		c1 += i;
+		c2 += i;
+		n -= i;
+	}
+#endif
 #ifdef __SSE__
-	int count;
-	__m128 vrv, vgu, vgv, vbu;
-	vrv = _mm_set1_ps(1.402f);
-	vgu = _mm_set1_ps(0.34413f);
-	vgv = _mm_set1_ps(0.71414f);
-	vbu = _mm_set1_ps(1.772f);
-	count = n >> 3;
-	for (i = 0; i < count; ++i) {
-		__m128 vy, vu, vv;
-		__m128 vr, vg, vb;
+	if (simd != OPJ_SIMD_NONE) {
+		int count;
+		__m128 vrv, vgu, vgv, vbu;
+		vrv = _mm_set1_ps(1.402f);
+		vgu = _mm_set1_ps(0.34413f);
+		vgv = _mm_set1_ps(0.71414f);
+		vbu = _mm_set1_ps(1.772f);
+		count = n >> 3;
+		for (i = 0; i < count; ++i) {
+			__m128 vy, vu, vv;
+			__m128 vr, vg, vb;
 
-		vy = _mm_load_ps(c0);
-		vu = _mm_load_ps(c1);
-		vv = _mm_load_ps(c2);
-		vr = _mm_add_ps(vy, _mm_mul_ps(vv, vrv));
-		vg = _mm_sub_ps(_mm_sub_ps(vy, _mm_mul_ps(vu, vgu)), _mm_mul_ps(vv, vgv));
-		vb = _mm_add_ps(vy, _mm_mul_ps(vu, vbu));
-		_mm_store_ps(c0, vr);
-		_mm_store_ps(c1, vg);
-		_mm_store_ps(c2, vb);
-		c0 += 4;
-		c1 += 4;
-		c2 += 4;
+			vy = _mm_load_ps(c0);
+			vu = _mm_load_ps(c1);
+			vv = _mm_load_ps(c2);
+			vr = _mm_add_ps(vy, _mm_mul_ps(vv, vrv));
+			vg = _mm_sub_ps(_mm_sub_ps(vy, _mm_mul_ps(vu, vgu)), _mm_mul_ps(vv, vgv));
+			vb = _mm_add_ps(vy, _mm_mul_ps(vu, vbu));
+			_mm_store_ps(c0, vr);
+			_mm_store_ps(c1, vg);
+			_mm_store_ps(c2, vb);
+			c0 += 4;
+			c1 += 4;
+			c2 += 4;
 
-		vy = _mm_load_ps(c0);
-		vu = _mm_load_ps(c1);
-		vv = _mm_load_ps(c2);
-		vr = _mm_add_ps(vy, _mm_mul_ps(vv, vrv));
-		vg = _mm_sub_ps(_mm_sub_ps(vy, _mm_mul_ps(vu, vgu)), _mm_mul_ps(vv, vgv));
-		vb = _mm_add_ps(vy, _mm_mul_ps(vu, vbu));
-		_mm_store_ps(c0, vr);
-		_mm_store_ps(c1, vg);
-		_mm_store_ps(c2, vb);
-		c0 += 4;
-		c1 += 4;
-		c2 += 4;
+			vy = _mm_load_ps(c0);
+			vu = _mm_load_ps(c1);
+			vv = _mm_load_ps(c2);
+			vr = _mm_add_ps(vy, _mm_mul_ps(vv, vrv));
+			vg = _mm_sub_ps(_mm_sub_ps(vy, _mm_mul_ps(vu, vgu)), _mm_mul_ps(vv, vgv));
+			vb = _mm_add_ps(vy, _mm_mul_ps(vu, vbu));
+			_mm_store_ps(c0, vr);
+			_mm_store_ps(c1, vg);
+			_mm_store_ps(c2, vb);
+			c0 += 4;
+			c1 += 4;
+			c2 += 4;
+		}
+		n &= 7;
 	}
-	n &= 7;
 #endif
 	for(i = 0; i < n; ++i) {
 		float y = c0[i];
@@ -59,8 +59,9 @@ Apply a reversible multi-component inverse transform to an image
 @param c1 Samples for red chrominance component
 @param c2 Samples for blue chrominance component
 @param n Number of samples for each component
+@param simd Instruction set to use, OPJ_SIMD_NONE, OPJ_SIMD_SSE2 or OPJ_SIMD_AVX2
 */
-void mct_decode(int *c0, int *c1, int *c2, int n);
+void mct_decode(int *c0, int *c1, int *c2, int n, int simd);
 /**
 Get norm of the basis function used for the reversible multi-component transform
 @param compno Number of the component (0->Y, 1->U, 2->V)
@@ -82,8 +83,9 @@ Apply an irreversible multi-component inverse transform to an image
 @param c1 Samples for red chrominance component
 @param c2 Samples for blue chrominance component
 @param n Number of samples for each component
+@param simd Instruction set to use, OPJ_SIMD_NONE, OPJ_SIMD_SSE2 or OPJ_SIMD_AVX2
 */
-void mct_decode_real(float* c0, float* c1, float* c2, int n);
+void mct_decode_real(float* c0, float* c1, float* c2, int n, int simd);
 /**
 Get norm of the basis function used for the irreversible multi-component transform
 @param compno Number of the component (0->Y, 1->U, 2->V)
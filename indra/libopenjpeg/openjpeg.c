@@ -326,6 +326,26 @@ opj_bool OPJ_CALLCONV opj_encode_with_info(opj_cinfo_t *cinfo, opj_cio_t *cio, o
 	return OPJ_FALSE;
 }
 
+opj_decode_cache_t* OPJ_CALLCONV opj_create_decode_cache(void) {
+	return (opj_decode_cache_t*) opj_calloc(1, sizeof(opj_decode_cache_t));
+}
+
+void OPJ_CALLCONV opj_destroy_decode_cache(opj_decode_cache_t *cache) {
+	if (cache) {
+		t1_clear_cache(cache);
+		opj_free(cache);
+	}
+}
+
+void OPJ_CALLCONV opj_get_decode_cache_stats(opj_decode_cache_t *cache, int *reused, int *decoded) {
+	*reused = cache ? cache->reused : 0;
+	*decoded = cache ? cache->decoded : 0;
+}
+
+OPJ_SIZE_T OPJ_CALLCONV opj_get_decode_cache_size(opj_decode_cache_t *cache) {
+	return cache ? t1_cache_size(cache) : 0;
+}
+
 void OPJ_CALLCONV opj_destroy_cstr_info(opj_codestream_info_t *cstr_info) {
 	if (cstr_info) {
 		int tileno;
@@ -394,6 +394,31 @@ typedef struct opj_cparameters {
 } opj_cparameters_t;
 
 #define OPJ_DPARAMETERS_IGNORE_PCLR_CMAP_CDEF_FLAG	0x0001
+/** Decode with the scalar code only, e.g. to check the SSE2 and AVX2 code against */
+#define OPJ_DPARAMETERS_NO_SIMD_FLAG	0x0002
+/** Decode with the SSE2 code even on processors that have AVX2 */
+#define OPJ_DPARAMETERS_NO_AVX2_FLAG	0x0004
+
+/**
+Decoded code-blocks kept from one decode of a codestream to the next
+*/
+typedef struct opj_decode_cache opj_decode_cache_t;
+
+/**
+Job of a batch handed to opj_dparameters_t::cp_run_jobs
+@param data Data of the batch
+@param index Index of the job in the batch
+*/
+typedef void (*opj_job_fn)(void *data, int index);
+/**
+Runs job(data, 0) .. job(data, count - 1), in any order and on any threads,
+and returns when they are all done
+@param runner opj_dparameters_t::cp_runner
+@param count Number of jobs
+@param job Function to call for each job
+@param data Data of the batch
+*/
+typedef void (*opj_run_jobs_fn)(void *runner, int count, opj_job_fn job, void *data);
 
 /**
 Decompression parameters
@@ -448,6 +473,23 @@ typedef struct opj_dparameters {
 	OPJ_LIMIT_DECODING cp_limit_decoding;
 
 	unsigned int flags;
+
+	/**
+	Decode cache, see opj_create_decode_cache.
+	if != NULL, code-blocks of a single tile codestream that are unchanged since the
+	previous decode with the same cache are taken from it instead of being decoded again;
+	if == NULL, every code-block is decoded
+	*/
+	opj_decode_cache_t *cp_cache;
+
+	/**
+	Job runner for the tier-1 decoding.
+	if != NULL, the code-blocks of a tile are decoded in batches run by cp_run_jobs(cp_runner, ...);
+	if == NULL, they are decoded one after the other by the calling thread
+	*/
+	opj_run_jobs_fn cp_run_jobs;
+	/** Passed to cp_run_jobs */
+	void *cp_runner;
 } opj_dparameters_t;
 
 /** Common fields between JPEG-2000 compression and decompression master structs. */
@@ -944,6 +986,39 @@ Destroy Codestream information after compression or decompression
 */
 OPJ_API void OPJ_CALLCONV opj_destroy_cstr_info(opj_codestream_info_t *cstr_info);
 
+/* 
+==========================================================
+   decode cache functions definitions
+==========================================================
+*/
+
+/**
+Create a decode cache, to pass in opj_dparameters_t::cp_cache when the same
+codestream is decoded again with more of its data or a smaller reduce factor.
+Code-blocks are only kept by decodes with a reduce factor, a decode at the
+full resolution has nothing left to refine.
+@return Returns a new decode cache if successful, returns NULL otherwise
+*/
+OPJ_API opj_decode_cache_t* OPJ_CALLCONV opj_create_decode_cache(void);
+/**
+Destroy a decode cache and the code-blocks it keeps
+@param cache Decode cache to destroy
+*/
+OPJ_API void OPJ_CALLCONV opj_destroy_decode_cache(opj_decode_cache_t *cache);
+/**
+Get the number of code-blocks taken from a decode cache and decoded while it was used
+@param cache Decode cache
+@param reused Returns the number of code-blocks taken from the cache
+@param decoded Returns the number of code-blocks decoded
+*/
+OPJ_API void OPJ_CALLCONV opj_get_decode_cache_stats(opj_decode_cache_t *cache, int *reused, int *decoded);
+/**
+Get the memory a decode cache keeps the coefficients of its code-blocks in
+@param cache Decode cache
+@return Returns the size of the kept coefficients in bytes, 0 if cache is NULL
+*/
+OPJ_API OPJ_SIZE_T OPJ_CALLCONV opj_get_decode_cache_size(opj_decode_cache_t *cache);
+
 
 #ifdef __cplusplus
 }
@@ -167,6 +167,7 @@ typedef unsigned int OPJ_BITFIELD;
 
 #include "j2k_lib.h"
 #include "opj_malloc.h"
+#include "simd.h"
 #include "event.h"
 #include "bio.h"
 #include "cio.h"
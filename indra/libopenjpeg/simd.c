@@ -0,0 +1,100 @@
+/*
+ * The copyright in this software is being made available under the 2-clauses
+ * BSD License, included below. This software may be subject to other third
+ * party and contributor rights, including patent rights, and no such rights
+ * are granted under this license.
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#define OPJ_SKIP_POISON
+#include "opj_includes.h"
+
+#if defined(OPJ_HAVE_AVX2)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+#if defined(__GNUC__)
+#pragma GCC poison malloc calloc realloc free
+#endif
+
+#if defined(OPJ_HAVE_AVX2)
+/* <summary> */
+/* Whether the processor and the operating system support AVX2. */
+/* </summary> */
+static opj_bool opj_has_avx2(void) {
+	unsigned int regs[4];
+	unsigned int xcr0;
+#if defined(_MSC_VER)
+	__cpuid((int*)regs, 0);
+	if (regs[0] < 7) {
+		return OPJ_FALSE;
+	}
+	__cpuid((int*)regs, 1);
+#else
+	if (__get_cpuid_max(0, NULL) < 7) {
+		return OPJ_FALSE;
+	}
+	__cpuid(1, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	/* AVX, and XGETBV to ask whether the OS saves the YMM registers */
+	if ((regs[2] & (1 << 27)) == 0 || (regs[2] & (1 << 28)) == 0) {
+		return OPJ_FALSE;
+	}
+#if defined(_MSC_VER)
+	xcr0 = (unsigned int)_xgetbv(0);
+#else
+	__asm__ __volatile__ (".byte 0x0f, 0x01, 0xd0" : "=a" (xcr0) : "c" (0) : "%edx");
+#endif
+	if ((xcr0 & 6) != 6) {
+		return OPJ_FALSE;
+	}
+#if defined(_MSC_VER)
+	__cpuidex((int*)regs, 7, 0);
+#else
+	__cpuid_count(7, 0, regs[0], regs[1], regs[2], regs[3]);
+#endif
+	return (regs[1] & (1 << 5)) != 0;
+}
+#endif
+
+int opj_simd_level(void) {
+	/* detected once; threads racing here all store the same value */
+	static int level = -1;
+	if (level < 0) {
+#if defined(OPJ_HAVE_AVX2)
+		level = opj_has_avx2() ? OPJ_SIMD_AVX2 : OPJ_SIMD_SSE2;
+#elif defined(OPJ_HAVE_SSE2)
+		level = OPJ_SIMD_SSE2;
+#else
+		level = OPJ_SIMD_NONE;
+#endif
+	}
+	return level;
+}
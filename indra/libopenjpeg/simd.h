@@ -0,0 +1,81 @@
+/*
+ * The copyright in this software is being made available under the 2-clauses
+ * BSD License, included below. This software may be subject to other third
+ * party and contributor rights, including patent rights, and no such rights
+ * are granted under this license.
+ *
+ * Copyright (c) 2026, Linden Research, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in the
+ *    documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS `AS IS'
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIMD_H
+#define __SIMD_H
+/**
+@file simd.h
+@brief Vector instruction sets used by the decoder
+
+The SSE2 code of DWT.C and MCT.C is built whenever the compiler targets SSE2,
+as every x86-64 compiler does. The AVX2 code is built alongside it by compilers
+that can target AVX2 per function (GCC 4.9, clang and MSVC 2013 or later) and
+is only used on processors that have it, so that the library still runs on the
+oldest processors the viewer supports.
+*/
+
+/** @defgroup SIMD SIMD - Vector instruction sets */
+/*@{*/
+
+#if defined(__SSE2__)
+#define OPJ_HAVE_SSE2
+#endif
+
+#if defined(OPJ_HAVE_SSE2) && (defined(__clang__) || (defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+#define OPJ_HAVE_AVX2
+/** Builds a function for AVX2 whatever the instruction set of the rest of the file */
+#define OPJ_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(OPJ_HAVE_SSE2) && defined(_MSC_VER) && (_MSC_VER >= 1800)
+#define OPJ_HAVE_AVX2
+#define OPJ_TARGET_AVX2
+#endif
+
+/** Scalar code only */
+#define OPJ_SIMD_NONE	0
+/** SSE2 code where there is some */
+#define OPJ_SIMD_SSE2	1
+/** AVX2 code where there is some, SSE2 code elsewhere */
+#define OPJ_SIMD_AVX2	2
+
+/** @name Exported functions */
+/*@{*/
+/* ----------------------------------------------------------------------- */
+/**
+Get the most capable instruction set both built in and supported by the processor
+@return Returns OPJ_SIMD_NONE, OPJ_SIMD_SSE2 or OPJ_SIMD_AVX2
+*/
+int opj_simd_level(void);
+/* ----------------------------------------------------------------------- */
+/*@}*/
+
+/*@}*/
+
+#endif /* __SIMD_H */
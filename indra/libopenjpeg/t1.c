@@ -1504,14 +1504,112 @@ void t1_encode_cblks(
 	} /* compno  */
 }
 
-void t1_decode_cblks(
-		opj_t1_t* t1,
+static int t1_count_cblks(opj_tcd_tilecomp_t* tilec) {
+	int resno, bandno, precno;
+	int numcblks = 0;
+
+	for (resno = 0; resno < tilec->numresolutions; ++resno) {
+		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
+		for (bandno = 0; bandno < res->numbands; ++bandno) {
+			opj_tcd_band_t* band = &res->bands[bandno];
+			for (precno = 0; precno < res->pw * res->ph; ++precno) {
+				numcblks += band->precincts[precno].cw * band->precincts[precno].ch;
+			}
+		}
+	}
+	return numcblks;
+}
+
+/* FNV-1a, far cheaper than decoding the data it tells apart */
+static unsigned int t1_checksum(const unsigned char* data, int len) {
+	unsigned int sum = 2166136261u;
+	int i;
+
+	for (i = 0; i < len; ++i) {
+		sum = (sum ^ data[i]) * 16777619u;
+	}
+	return sum;
+}
+
+void t1_clear_cache(opj_decode_cache_t* cache) {
+	int compno, cblkno;
+
+	for (compno = 0; compno < cache->numcomps; ++compno) {
+		opj_comp_cache_t* comp = &cache->comps[compno];
+		if (comp->cblks) {
+			for (cblkno = 0; cblkno < comp->numcblks; ++cblkno) {
+				opj_free(comp->cblks[cblkno].data);
+			}
+			opj_free(comp->cblks);
+		}
+	}
+	opj_free(cache->comps);
+	cache->comps = NULL;
+	cache->numcomps = 0;
+}
+
+size_t t1_cache_size(opj_decode_cache_t* cache) {
+	int compno, cblkno;
+	size_t size = 0;
+
+	for (compno = 0; compno < cache->numcomps; ++compno) {
+		opj_comp_cache_t* comp = &cache->comps[compno];
+		for (cblkno = 0; comp->cblks && cblkno < comp->numcblks; ++cblkno) {
+			size += comp->cblks[cblkno].size;
+		}
+	}
+	return size;
+}
+
+opj_bool t1_setup_cache(opj_decode_cache_t* cache, opj_tcd_tile_t* tile) {
+	int compno;
+	opj_bool same = cache->numcomps == tile->numcomps;
+
+	for (compno = 0; same && compno < tile->numcomps; ++compno) {
+		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
+		opj_comp_cache_t* comp = &cache->comps[compno];
+		same = comp->x0 == tilec->x0 && comp->y0 == tilec->y0 && comp->x1 == tilec->x1 && comp->y1 == tilec->y1
+			&& comp->numresolutions == tilec->numresolutions && comp->numcblks == t1_count_cblks(tilec);
+	}
+	if (same) {
+		return OPJ_TRUE;
+	}
+
+	t1_clear_cache(cache);
+	cache->comps = (opj_comp_cache_t*) opj_calloc(tile->numcomps, sizeof(opj_comp_cache_t));
+	if (!cache->comps) {
+		return OPJ_FALSE;
+	}
+	cache->numcomps = tile->numcomps;
+	for (compno = 0; compno < tile->numcomps; ++compno) {
+		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
+		opj_comp_cache_t* comp = &cache->comps[compno];
+		comp->x0 = tilec->x0;
+		comp->y0 = tilec->y0;
+		comp->x1 = tilec->x1;
+		comp->y1 = tilec->y1;
+		comp->numresolutions = tilec->numresolutions;
+		comp->numcblks = t1_count_cblks(tilec);
+		comp->cblks = (opj_cblk_cache_t*) opj_calloc(comp->numcblks + 1, sizeof(opj_cblk_cache_t));
+		if (!comp->cblks) {
+			t1_clear_cache(cache);
+			return OPJ_FALSE;
+		}
+	}
+	return OPJ_TRUE;
+}
+
+int t1_list_cblks(
 		opj_tcd_tilecomp_t* tilec,
-		opj_tccp_t* tccp)
+		opj_tccp_t* tccp,
+		int numres,
+		opj_decode_cache_t* cache,
+		int compno,
+		opj_t1_cblk_job_t* jobs)
 {
 	int resno, bandno, precno, cblkno;
-
-	int tile_w = tilec->x1 - tilec->x0;
+	int numjobs = 0;
+	opj_cblk_cache_t* cached = cache ? cache->comps[compno].cblks : NULL;
 
 	for (resno = 0; resno < tilec->numresolutions; ++resno) {
 		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
@@ -1524,75 +1622,169 @@ void t1_decode_cblks(
 
 				for (cblkno = 0; cblkno < precinct->cw * precinct->ch; ++cblkno) {
 					opj_tcd_cblk_dec_t* cblk = &precinct->cblks.dec[cblkno];
-					int* OPJ_RESTRICT datap;
-					int cblk_w, cblk_h;
-					int x, y;
-					int i, j;
-
-					t1_decode_cblk(
-							t1,
-							cblk,
-							band->bandno,
-							tccp->roishift,
-							tccp->cblksty);
-
-					x = cblk->x0 - band->x0;
-					y = cblk->y0 - band->y0;
+					opj_cblk_cache_t* kept = cached ? cached++ : NULL;
+					opj_t1_cblk_job_t* job;
+
+					/* resolutions above the one asked for aren't used by the DWT */
+					if (resno >= numres) {
+						continue;
+					}
+					if (!jobs) {
+						++numjobs;
+						continue;
+					}
+
+					job = &jobs[numjobs++];
+					job->tilec = tilec;
+					job->tccp = tccp;
+					job->band = band;
+					job->cblk = cblk;
+					job->kept = kept;
+					job->reused = OPJ_FALSE;
+					job->decoded = OPJ_FALSE;
+					job->x = cblk->x0 - band->x0;
+					job->y = cblk->y0 - band->y0;
 					if (band->bandno & 1) {
 						opj_tcd_resolution_t* pres = &tilec->resolutions[resno - 1];
-						x += pres->x1 - pres->x0;
+						job->x += pres->x1 - pres->x0;
 					}
 					if (band->bandno & 2) {
 						opj_tcd_resolution_t* pres = &tilec->resolutions[resno - 1];
-						y += pres->y1 - pres->y0;
+						job->y += pres->y1 - pres->y0;
 					}
+				} /* cblkno */
+			} /* precno */
+		} /* bandno */
+	} /* resno */
+	return numjobs;
+}
 
-					datap=t1->data;
-					cblk_w = t1->w;
-					cblk_h = t1->h;
-
-					if (tccp->roishift) {
-						int thresh = 1 << tccp->roishift;
-						for (j = 0; j < cblk_h; ++j) {
-							for (i = 0; i < cblk_w; ++i) {
-								int val = datap[(j * cblk_w) + i];
-								int mag = abs(val);
-								if (mag >= thresh) {
-									mag >>= tccp->roishift;
-									datap[(j * cblk_w) + i] = val < 0 ? -mag : mag;
-								}
-							}
-						}
-					}
+void t1_decode_cblk_job(opj_t1_t* t1, opj_t1_cblk_job_t* job, opj_bool keep) {
+	opj_tcd_tilecomp_t* tilec = job->tilec;
+	opj_tccp_t* tccp = job->tccp;
+	opj_tcd_band_t* OPJ_RESTRICT band = job->band;
+	opj_tcd_cblk_dec_t* cblk = job->cblk;
+	opj_cblk_cache_t* kept = job->kept;
+	int tile_w = tilec->x1 - tilec->x0;
+	int x = job->x;
+	int y = job->y;
+	int* OPJ_RESTRICT datap;
+	int cblk_w, cblk_h;
+	int i, j;
+	int segno, numpasses;
+	unsigned int sum;
+
+	if (kept) {
+		numpasses = 0;
+		for (segno = 0; segno < cblk->numsegs; ++segno) {
+			numpasses += cblk->segs[segno].numpasses;
+		}
+		sum = t1_checksum(cblk->data, cblk->len);
+		if (kept->data && kept->len == cblk->len && kept->sum == sum && kept->numsegs == cblk->numsegs
+			&& kept->numpasses == numpasses && kept->numbps == cblk->numbps) {
+			/* nothing new for this code-block since it was kept */
+			cblk_w = cblk->x1 - cblk->x0;
+			cblk_h = cblk->y1 - cblk->y0;
+			for (j = 0; j < cblk_h; ++j) {
+				memcpy(&tilec->data[((y + j) * tile_w) + x], &kept->data[j * cblk_w], cblk_w * sizeof(int));
+			}
+			job->reused = OPJ_TRUE;
+			return;
+		}
+		opj_free(kept->data);
+		kept->data = NULL;
+		kept->size = 0;
+		kept->len = cblk->len;
+		kept->sum = sum;
+		kept->numsegs = cblk->numsegs;
+		kept->numpasses = numpasses;
+		kept->numbps = cblk->numbps;
+		job->decoded = cblk->numsegs > 0;
+	}
 
-					if (tccp->qmfbid == 1) {
-						int* OPJ_RESTRICT tiledp = &tilec->data[(y * tile_w) + x];
-						for (j = 0; j < cblk_h; ++j) {
-							for (i = 0; i < cblk_w; ++i) {
-								int tmp = datap[(j * cblk_w) + i];
-								((int*)tiledp)[(j * tile_w) + i] = tmp / 2;
-							}
-						}
-					} else {		/* if (tccp->qmfbid == 0) */
-						float* OPJ_RESTRICT tiledp = (float*) &tilec->data[(y * tile_w) + x];
-						for (j = 0; j < cblk_h; ++j) {
-							float* OPJ_RESTRICT tiledp2 = tiledp;
-							for (i = 0; i < cblk_w; ++i) {
-								float tmp = *datap * band->stepsize;
-								*tiledp2 = tmp;
-								datap++;
-								tiledp2++;
-							}
-							tiledp += tile_w;
-						}
-					}
+	t1_decode_cblk(
+			t1,
+			cblk,
+			band->bandno,
+			tccp->roishift,
+			tccp->cblksty);
+
+	datap=t1->data;
+	cblk_w = t1->w;
+	cblk_h = t1->h;
+
+	if (tccp->roishift) {
+		int thresh = 1 << tccp->roishift;
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int val = datap[(j * cblk_w) + i];
+				int mag = abs(val);
+				if (mag >= thresh) {
+					mag >>= tccp->roishift;
+					datap[(j * cblk_w) + i] = val < 0 ? -mag : mag;
+				}
+			}
+		}
+	}
+
+	if (tccp->qmfbid == 1) {
+		int* OPJ_RESTRICT tiledp = &tilec->data[(y * tile_w) + x];
+		for (j = 0; j < cblk_h; ++j) {
+			for (i = 0; i < cblk_w; ++i) {
+				int tmp = datap[(j * cblk_w) + i];
+				((int*)tiledp)[(j * tile_w) + i] = tmp / 2;
+			}
+		}
+	} else {		/* if (tccp->qmfbid == 0) */
+		float* OPJ_RESTRICT tiledp = (float*) &tilec->data[(y * tile_w) + x];
+		for (j = 0; j < cblk_h; ++j) {
+			float* OPJ_RESTRICT tiledp2 = tiledp;
+			for (i = 0; i < cblk_w; ++i) {
+				float tmp = *datap * band->stepsize;
+				*tiledp2 = tmp;
+				datap++;
+				tiledp2++;
+			}
+			tiledp += tile_w;
+		}
+	}
+
+	/* keep what was decoded for a later decode with more data */
+	if (kept && keep && cblk->numsegs > 0) {
+		kept->data = (int*) opj_malloc(cblk_w * cblk_h * sizeof(int));
+		if (kept->data) {
+			kept->size = cblk_w * cblk_h * sizeof(int);
+			for (j = 0; j < cblk_h; ++j) {
+				memcpy(&kept->data[j * cblk_w], &tilec->data[((y + j) * tile_w) + x], cblk_w * sizeof(int));
+			}
+		}
+	}
+}
+
+void t1_free_cblks(opj_tcd_tilecomp_t* tilec) {
+	int resno, bandno, precno, cblkno;
+
+	for (resno = 0; resno < tilec->numresolutions; ++resno) {
+		opj_tcd_resolution_t* res = &tilec->resolutions[resno];
+
+		for (bandno = 0; bandno < res->numbands; ++bandno) {
+			opj_tcd_band_t* band = &res->bands[bandno];
+
+			for (precno = 0; precno < res->pw * res->ph; ++precno) {
+				opj_tcd_precinct_t* precinct = &band->precincts[precno];
+
+				if (!precinct->cblks.dec) {
+					continue;
+				}
+				for (cblkno = 0; cblkno < precinct->cw * precinct->ch; ++cblkno) {
+					opj_tcd_cblk_dec_t* cblk = &precinct->cblks.dec[cblkno];
 					opj_free(cblk->data);
 					opj_free(cblk->segs);
-				} /* cblkno */
+				}
 				opj_free(precinct->cblks.dec);
-                precinct->cblks.dec = NULL;
-			} /* precno */
-		} /* bandno */
-	} /* resno */
+				precinct->cblks.dec = NULL;
+			}
+		}
+	}
 }
 
@@ -110,6 +110,68 @@ typedef struct opj_t1 {
 
 #define MACRO_t1_flags(x,y) t1->flags[((x)*(t1->flags_stride))+(y)]
 
+/**
+Code-block kept by a decode cache
+*/
+typedef struct opj_cblk_cache {
+	/** length of the code-block data it was decoded from */
+	int len;
+	/** checksum of that data */
+	unsigned int sum;
+	/** number of segments and coding passes decoded */
+	int numsegs;
+	int numpasses;
+	/** number of bit-planes, from the packet headers */
+	int numbps;
+	/** coefficients as written into the tile, NULL when none are kept */
+	int *data;
+	/** size of data in bytes */
+	int size;
+} opj_cblk_cache_t;
+
+/**
+Code-blocks kept for one tile-component, in decoding order
+*/
+typedef struct opj_comp_cache {
+	int x0, y0, x1, y1;
+	int numresolutions;
+	int numcblks;
+	opj_cblk_cache_t *cblks;
+} opj_comp_cache_t;
+
+/**
+Decoded code-blocks of a single tile image, kept from one decode of its
+codestream to the next so that a decode with more of the codestream only
+runs tier-1 on the code-blocks that got new data.
+*/
+struct opj_decode_cache {
+	int numcomps;
+	opj_comp_cache_t *comps;
+	/** keep the code-blocks decoded by the current decode */
+	opj_bool keep;
+	/** code-blocks taken from the cache and decoded, since it was created */
+	int reused;
+	int decoded;
+};
+
+/**
+Code-block of a tile to decode, as listed by t1_list_cblks
+*/
+typedef struct opj_t1_cblk_job {
+	opj_tcd_tilecomp_t *tilec;
+	opj_tccp_t *tccp;
+	opj_tcd_band_t *band;
+	opj_tcd_cblk_dec_t *cblk;
+	/** position of the code-block in the tile-component data */
+	int x, y;
+	/** entry of the decode cache for the code-block, NULL if none */
+	opj_cblk_cache_t *kept;
+	/** set by t1_decode_cblk_job: taken from the cache */
+	opj_bool reused;
+	/** set by t1_decode_cblk_job: decoded with the cache from data it didn't have */
+	opj_bool decoded;
+} opj_t1_cblk_job_t;
+
 /** @name Exported functions */
 /*@{*/
 /* ----------------------------------------------------------------------- */
@@ -133,12 +195,49 @@ Encode the code-blocks of a tile
 */
 void t1_encode_cblks(opj_t1_t *t1, opj_tcd_tile_t *tile, opj_tcp_t *tcp);
 /**
-Decode the code-blocks of a tile
-@param t1 T1 handle
-@param tilec The tile to decode
+List the code-blocks of a tile-component to decode. Each one is decoded by
+t1_decode_cblk_job independently of the others, so that they can be spread
+over several threads with a T1 handle each.
+@param tilec The tile-component to decode
 @param tccp Tile coding parameters
+@param numres Number of resolutions to decode, the code-blocks of the others aren't listed
+@param cache Decoded code-blocks kept for the tile, NULL if none are kept
+@param compno Component of the tile
+@param jobs Array to fill, NULL to only count the code-blocks
+@return Returns the number of code-blocks listed
+*/
+int t1_list_cblks(opj_tcd_tilecomp_t* tilec, opj_tccp_t* tccp, int numres, opj_decode_cache_t* cache, int compno, opj_t1_cblk_job_t* jobs);
+/**
+Decode a code-block into its tile-component data
+@param t1 T1 handle, used by one thread at a time
+@param job Code-block listed by t1_list_cblks
+@param keep Keep the decoded coefficients in the decode cache
+*/
+void t1_decode_cblk_job(opj_t1_t* t1, opj_t1_cblk_job_t* job, opj_bool keep);
+/**
+Free the code-block data of a tile-component once it is decoded
+@param tilec The tile-component
+*/
+void t1_free_cblks(opj_tcd_tilecomp_t* tilec);
+/**
+Make a decode cache match the geometry of a tile, dropping what it kept
+for another one
+@param cache Decode cache
+@param tile Tile about to be decoded
+@return Returns false if the cache couldn't be allocated
+*/
+opj_bool t1_setup_cache(opj_decode_cache_t* cache, opj_tcd_tile_t* tile);
+/**
+Free what a decode cache keeps
+@param cache Decode cache
+*/
+void t1_clear_cache(opj_decode_cache_t* cache);
+/**
+Get the memory a decode cache keeps code-blocks in
+@param cache Decode cache
+@return Returns the size of the kept coefficients in bytes
 */
-void t1_decode_cblks(opj_t1_t* t1, opj_tcd_tilecomp_t* tilec, opj_tccp_t* tccp);
+size_t t1_cache_size(opj_decode_cache_t* cache);
 /* ----------------------------------------------------------------------- */
 /*@}*/
 
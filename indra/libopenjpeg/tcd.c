@@ -837,6 +837,8 @@ void tcd_malloc_decode_tile(opj_tcd_t *tcd, opj_image_t * image, opj_cp_t * cp,
 						cblk->x1 = int_min(cblkxend, prc->x1);
 						cblk->y1 = int_min(cblkyend, prc->y1);
 						cblk->numsegs = 0;
+						cblk->len = 0;
+						cblk->numbps = 0;
 					}
 				} /* precno */
 			} /* bandno */
@@ -1327,6 +1329,40 @@ int tcd_encode_tile(opj_tcd_t *tcd, int tileno, unsigned char *dest, int len, op
 	return l;
 }
 
+/* code-blocks per batch handed to the job runner, enough to make up for creating a T1 handle per batch */
+#define TCD_CBLKS_PER_BATCH 8
+
+/**
+Code-blocks of a tile decoded in batches by opj_cp_t::run_jobs
+*/
+typedef struct opj_tcd_cblk_batches {
+	opj_common_ptr cinfo;
+	opj_t1_cblk_job_t *jobs;
+	int numjobs;
+	opj_bool keep;
+	/** set when a batch couldn't get a T1 handle */
+	opj_bool failed;
+} opj_tcd_cblk_batches_t;
+
+static void tcd_decode_cblk_batch(void *data, int index) {
+	opj_tcd_cblk_batches_t *batches = (opj_tcd_cblk_batches_t*) data;
+	int first = index * TCD_CBLKS_PER_BATCH;
+	int last = int_min(first + TCD_CBLKS_PER_BATCH, batches->numjobs);
+	opj_t1_t *t1 = t1_create(batches->cinfo);
+	int i;
+
+	if (t1 == NULL) {
+		batches->failed = OPJ_TRUE;
+		return;
+	}
+	/* the code-blocks of the higher resolutions are listed last and are the largest:
+	   hand them out first so that the batches end together */
+	for (i = batches->numjobs - last; i < batches->numjobs - first; ++i) {
+		t1_decode_cblk_job(t1, &batches->jobs[i], batches->keep);
+	}
+	t1_destroy(t1);
+}
+
 opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno, opj_codestream_info_t *cstr_info) {
 	int l;
 	int compno;
@@ -1336,6 +1372,10 @@ opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno
 
 	opj_t1_t *t1 = NULL;		/* T1 component */
 	opj_t2_t *t2 = NULL;		/* T2 component */
+	opj_decode_cache_t *cache = NULL;
+	opj_t1_cblk_job_t *jobs = NULL;
+	int numjobs, jobno;
+	opj_bool ok = OPJ_TRUE;
 	
 	tcd->tcd_tileno = tileno;
 	tcd->tcd_tile = &(tcd->tcd_image->tiles[tileno]);
@@ -1386,16 +1426,20 @@ opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno
 	/*------------------TIER1-----------------*/
 	
 	t1_time = opj_clock();	/* time needed to decode a tile */
-	t1 = t1_create(tcd->cinfo);
-    if (t1 == NULL)
-    {
-        opj_event_msg(tcd->cinfo, EVT_ERROR, "Out of memory\n");
-        t1_destroy(t1);
-        return OPJ_FALSE;
-    }
 
+	/* textures are a single tile, the cache only keeps one */
+	cache = tcd->cp->tw * tcd->cp->th == 1 ? tcd->cp->cache : NULL;
+	if (cache) {
+		cache->keep = tcd->cp->reduce != 0;
+		if (!t1_setup_cache(cache, tile)) {
+			cache = NULL;
+		}
+	}
+
+	numjobs = 0;
 	for (compno = 0; compno < tile->numcomps; ++compno) {
 		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
+		int numres = tilec->numresolutions - tcd->cp->reduce;
 		/* The +3 is headroom required by the vectorized DWT */
 		tilec->data = (int*) opj_aligned_malloc((((tilec->x1 - tilec->x0) * (tilec->y1 - tilec->y0))+3) * sizeof(int));
         if (tilec->data == NULL)
@@ -1403,10 +1447,58 @@ opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno
             opj_event_msg(tcd->cinfo, EVT_ERROR, "Out of memory\n");
             return OPJ_FALSE;
         }
+		numjobs += t1_list_cblks(tilec, &tcd->tcp->tccps[compno], numres > 0 ? numres : tilec->numresolutions, cache, compno, NULL);
+	}
 
-		t1_decode_cblks(t1, tilec, &tcd->tcp->tccps[compno]);
+	/* the code-blocks of every component, decoded one after the other or spread
+	   over the threads of the job runner */
+	jobs = (opj_t1_cblk_job_t*) opj_malloc(int_max(numjobs, 1) * sizeof(opj_t1_cblk_job_t));
+	if (jobs == NULL) {
+		opj_event_msg(tcd->cinfo, EVT_ERROR, "Out of memory\n");
+		return OPJ_FALSE;
+	}
+	numjobs = 0;
+	for (compno = 0; compno < tile->numcomps; ++compno) {
+		opj_tcd_tilecomp_t* tilec = &tile->comps[compno];
+		int numres = tilec->numresolutions - tcd->cp->reduce;
+		numjobs += t1_list_cblks(tilec, &tcd->tcp->tccps[compno], numres > 0 ? numres : tilec->numresolutions, cache, compno, &jobs[numjobs]);
+	}
+
+	if (tcd->cp->run_jobs && numjobs > TCD_CBLKS_PER_BATCH) {
+		opj_tcd_cblk_batches_t batches;
+		batches.cinfo = tcd->cinfo;
+		batches.jobs = jobs;
+		batches.numjobs = numjobs;
+		batches.keep = cache && cache->keep;
+		batches.failed = OPJ_FALSE;
+		tcd->cp->run_jobs(tcd->cp->runner, (numjobs + TCD_CBLKS_PER_BATCH - 1) / TCD_CBLKS_PER_BATCH, tcd_decode_cblk_batch, &batches);
+		ok = !batches.failed;
+	} else {
+		t1 = t1_create(tcd->cinfo);
+		if (t1 == NULL) {
+			ok = OPJ_FALSE;
+		} else {
+			for (jobno = 0; jobno < numjobs; ++jobno) {
+				t1_decode_cblk_job(t1, &jobs[jobno], cache && cache->keep);
+			}
+			t1_destroy(t1);
+		}
+	}
+
+	if (cache) {
+		for (jobno = 0; jobno < numjobs; ++jobno) {
+			cache->reused += jobs[jobno].reused;
+			cache->decoded += jobs[jobno].decoded;
+		}
+	}
+	opj_free(jobs);
+	for (compno = 0; compno < tile->numcomps; ++compno) {
+		t1_free_cblks(&tile->comps[compno]);
+	}
+	if (!ok) {
+		opj_event_msg(tcd->cinfo, EVT_ERROR, "Out of memory\n");
+		return OPJ_FALSE;
 	}
-	t1_destroy(t1);
 	t1_time = opj_clock() - t1_time;
 	opj_event_msg(tcd->cinfo, EVT_INFO, "- tiers-1 took %f s\n", t1_time);
 	
@@ -1437,9 +1529,9 @@ opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno
 		numres2decode = tcd->image->comps[compno].resno_decoded + 1;
 		if(numres2decode > 0){
 			if (tcd->tcp->tccps[compno].qmfbid == 1) {
-				dwt_decode(tilec, numres2decode);
+				dwt_decode(tilec, numres2decode, tcd->cp->simd);
 			} else {
-				dwt_decode_real(tilec, numres2decode);
+				dwt_decode_real(tilec, numres2decode, tcd->cp->simd);
 			}
 		}
 	}
@@ -1457,13 +1549,15 @@ opj_bool tcd_decode_tile(opj_tcd_t *tcd, unsigned char *src, int len, int tileno
 						tile->comps[0].data,
 						tile->comps[1].data,
 						tile->comps[2].data,
-						n);
+						n,
+						tcd->cp->simd);
 			} else {
 				mct_decode_real(
 						(float*)tile->comps[0].data,
 						(float*)tile->comps[1].data,
 						(float*)tile->comps[2].data,
-						n);
+						n,
+						tcd->cp->simd);
 			}
 		} else{
 			opj_event_msg(tcd->cinfo, EVT_WARNING,"Number of components (%d) is inconsistent with a MCT. Skip the MCT step.\n",tile->numcomps);
@@ -32,7 +32,10 @@
 #include "llavatarjointmesh.h"
 #include "llstl.h"
 #include "imageids.h"
+#include "llcrc.h"
+#include "lldatapacker.h"
 #include "lldir.h"
+#include "lldriverparam.h"
 #include "llpolymorph.h"
 #include "llpolymesh.h"
 #include "llpolyskeletaldistortion.h"
@@ -80,6 +83,8 @@ public:
 		mChildList.clear();
 	}
 	BOOL parseXml(LLXmlTreeNode* node);
+	BOOL pack(LLDataPacker& dp) const;
+	BOOL unpack(LLDataPacker& dp);
 	
 private:
 	std::string mName;
@@ -111,6 +116,8 @@ public:
 		mBoneInfoList.clear();
 	}
 	BOOL parseXml(LLXmlTreeNode* node);
+	BOOL pack(LLDataPacker& dp) const;
+	BOOL unpack(LLDataPacker& dp);
 	S32 getNumBones() const { return mNumBones; }
 	S32 getNumCollisionVolumes() const { return mNumCollisionVolumes; }
 	
@@ -169,6 +176,7 @@ LLXmlTree LLAvatarAppearance::sXMLTree;
 LLXmlTree LLAvatarAppearance::sSkeletonXMLTree;
 LLAvatarSkeletonInfo* LLAvatarAppearance::sAvatarSkeletonInfo = NULL;
 LLAvatarAppearance::LLAvatarXmlInfo* LLAvatarAppearance::sAvatarXmlInfo = NULL;
+bool LLAvatarAppearance::sUseDefinitionCache = true;
 
 
 LLAvatarAppearance::LLAvatarAppearance(LLWearableData* wearable_data) :
@@ -328,6 +336,8 @@ LLAvatarAppearance::~LLAvatarAppearance()
 	mMeshLOD.clear();
 }
 
+static LLTrace::BlockTimerStatHandle FTM_LOAD_AVATAR_DEFINITION("Load Avatar Definition");
+
 //static
 void LLAvatarAppearance::initClass()
 {
@@ -347,6 +357,19 @@ void LLAvatarAppearance::initClass(const std::string& avatar_file_name_arg, cons
     {
         avatar_file_name = gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER,AVATAR_DEFAULT_CHAR + "_lad.xml");
     }
+
+	LL_RECORD_BLOCK_TIME(FTM_LOAD_AVATAR_DEFINITION);
+
+	// this can happen if a login attempt failed
+	delete_and_clear(sAvatarSkeletonInfo);
+	delete_and_clear(sAvatarXmlInfo);
+
+	if (loadDefinitionCache(avatar_file_name, skeleton_file_name_arg))
+	{
+		LL_DEBUGS("Avatar") << "Loaded avatar definition from cache for " << avatar_file_name << LL_ENDL;
+		return;
+	}
+
 	BOOL success = sXMLTree.parseFile( avatar_file_name, FALSE );
 	if (!success)
 	{
@@ -408,20 +431,12 @@ void LLAvatarAppearance::initClass(const std::string& avatar_file_name_arg, cons
 	// Process XML data
 
 	// avatar_skeleton.xml
-	if (sAvatarSkeletonInfo)
-	{ //this can happen if a login attempt failed
-		delete sAvatarSkeletonInfo;
-	}
 	sAvatarSkeletonInfo = new LLAvatarSkeletonInfo;
 	if (!sAvatarSkeletonInfo->parseXml(sSkeletonXMLTree.getRoot()))
 	{
 		LL_ERRS() << "Error parsing skeleton XML file: " << skeleton_path << LL_ENDL;
 	}
 	// parse avatar_lad.xml
-	if (sAvatarXmlInfo)
-	{ //this can happen if a login attempt failed
-		delete_and_clear(sAvatarXmlInfo);
-	}
 	sAvatarXmlInfo = new LLAvatarXmlInfo;
 	if (!sAvatarXmlInfo->parseXmlSkeletonNode(root))
 	{
@@ -447,6 +462,205 @@ void LLAvatarAppearance::initClass(const std::string& avatar_file_name_arg, cons
 	{
 		LL_ERRS() << "Error parsing skeleton node in avatar XML file: " << skeleton_path << LL_ENDL;
 	}
+
+	saveDefinitionCache(avatar_file_name, skeleton_file_name, wearable_def_version);
+}
+
+//-----------------------------------------------------------------------------
+// Avatar definition cache
+// avatar_lad.xml and avatar_skeleton.xml only change with a viewer update, so
+// the infos built from them are written to the cache dir once and read back on
+// later launches without touching expat. An entry is keyed on the size and
+// modification time of both source files.
+//-----------------------------------------------------------------------------
+static const U32 AVATAR_DEFINITION_CACHE_MAGIC = 0x44414c4c; // "LLAD"
+static const U32 AVATAR_DEFINITION_CACHE_VERSION = 1;
+static const S32 AVATAR_DEFINITION_CACHE_HEADER_SIZE = 16; // magic, version, payload size, payload crc
+
+static bool get_definition_file_stamp(const std::string& filename, U32& size, U32& mtime)
+{
+	llstat stat_data;
+	if (LLFile::stat(filename, &stat_data) != 0)
+	{
+		return false;
+	}
+	size = (U32)stat_data.st_size;
+	mtime = (U32)stat_data.st_mtime;
+	return true;
+}
+
+static std::string get_definition_cache_filename(const std::string& avatar_file_name)
+{
+	return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, gDirUtilp->getBaseFileName(avatar_file_name, true) + ".bin");
+}
+
+//static
+BOOL LLAvatarAppearance::loadDefinitionCache(const std::string& avatar_file_name, const std::string& skeleton_file_name)
+{
+	U32 avatar_size = 0, avatar_mtime = 0;
+	if (!sUseDefinitionCache || gDirUtilp->getCacheDir().empty()
+		|| !get_definition_file_stamp(avatar_file_name, avatar_size, avatar_mtime))
+	{
+		return FALSE;
+	}
+
+	std::string cache_filename = get_definition_cache_filename(avatar_file_name);
+	llstat cache_stat;
+	if (LLFile::stat(cache_filename, &cache_stat) != 0 || cache_stat.st_size <= AVATAR_DEFINITION_CACHE_HEADER_SIZE)
+	{
+		return FALSE;
+	}
+	LLFILE* fp = LLFile::fopen(cache_filename, "rb");
+	if (!fp)
+	{
+		return FALSE;
+	}
+	S32 file_size = (S32)cache_stat.st_size;
+	// The extra zero byte keeps unpackString()'s strlen inside the buffer
+	std::vector<U8> buffer(file_size + 1, 0);
+	size_t bytes_read = fread(&buffer[0], 1, file_size, fp);
+	LLFile::close(fp);
+	if (bytes_read != (size_t)file_size)
+	{
+		return FALSE;
+	}
+
+	U32 magic = 0, version = 0, payload_crc = 0;
+	S32 payload_size = 0;
+	LLDataPackerBinaryBuffer header(&buffer[0], AVATAR_DEFINITION_CACHE_HEADER_SIZE);
+	header.unpackU32(magic, "magic");
+	header.unpackU32(version, "version");
+	header.unpackS32(payload_size, "payload_size");
+	header.unpackU32(payload_crc, "payload_crc");
+	if (magic != AVATAR_DEFINITION_CACHE_MAGIC || version != AVATAR_DEFINITION_CACHE_VERSION
+		|| payload_size != file_size - AVATAR_DEFINITION_CACHE_HEADER_SIZE)
+	{
+		return FALSE;
+	}
+	// The crc guards the unpack() calls below, which trust the counts they read
+	LLCRC crc;
+	crc.update(&buffer[AVATAR_DEFINITION_CACHE_HEADER_SIZE], payload_size);
+	if (crc.getCRC() != payload_crc)
+	{
+		LL_WARNS("Avatar") << "Discarding corrupt avatar definition cache " << cache_filename << LL_ENDL;
+		return FALSE;
+	}
+
+	LLDataPackerBinaryBuffer dp(&buffer[AVATAR_DEFINITION_CACHE_HEADER_SIZE], payload_size);
+	std::string cached_avatar_file_name;
+	std::string cached_skeleton_file_name;
+	U32 size = 0, mtime = 0;
+	dp.unpackString(cached_avatar_file_name, "avatar_file_name");
+	dp.unpackU32(size, "avatar_file_size");
+	dp.unpackU32(mtime, "avatar_file_mtime");
+	if (cached_avatar_file_name != avatar_file_name || size != avatar_size || mtime != avatar_mtime)
+	{
+		return FALSE;
+	}
+	dp.unpackString(cached_skeleton_file_name, "skeleton_file_name");
+	dp.unpackU32(size, "skeleton_file_size");
+	dp.unpackU32(mtime, "skeleton_file_mtime");
+	if (!skeleton_file_name.empty() && skeleton_file_name != cached_skeleton_file_name)
+	{
+		return FALSE;
+	}
+	U32 skeleton_size = 0, skeleton_mtime = 0;
+	std::string skeleton_path = gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER, cached_skeleton_file_name);
+	if (!get_definition_file_stamp(skeleton_path, skeleton_size, skeleton_mtime)
+		|| size != skeleton_size || mtime != skeleton_mtime)
+	{
+		return FALSE;
+	}
+
+	S32 wearable_def_version = 1;
+	LLAvatarSkeletonInfo* skeleton_info = new LLAvatarSkeletonInfo;
+	LLAvatarXmlInfo* xml_info = new LLAvatarXmlInfo;
+	if (!dp.unpackS32(wearable_def_version, "wearable_definition_version")
+		|| !skeleton_info->unpack(dp)
+		|| !xml_info->unpack(dp))
+	{
+		LL_WARNS("Avatar") << "Failed to read avatar definition cache " << cache_filename << LL_ENDL;
+		delete skeleton_info;
+		delete xml_info;
+		return FALSE;
+	}
+
+	LLWearable::setCurrentDefinitionVersion(wearable_def_version);
+	sAvatarSkeletonInfo = skeleton_info;
+	sAvatarXmlInfo = xml_info;
+	return TRUE;
+}
+
+//static
+void LLAvatarAppearance::saveDefinitionCache(const std::string& avatar_file_name, const std::string& skeleton_file_name, S32 wearable_def_version)
+{
+	if (!sUseDefinitionCache || gDirUtilp->getCacheDir().empty())
+	{
+		return;
+	}
+	U32 avatar_size = 0, avatar_mtime = 0;
+	U32 skeleton_size = 0, skeleton_mtime = 0;
+	std::string skeleton_path = gDirUtilp->getExpandedFilename(LL_PATH_CHARACTER, skeleton_file_name);
+	if (!get_definition_file_stamp(avatar_file_name, avatar_size, avatar_mtime)
+		|| !get_definition_file_stamp(skeleton_path, skeleton_size, skeleton_mtime))
+	{
+		return;
+	}
+
+	auto pack_payload = [&](LLDataPacker& dp)
+	{
+		BOOL success = dp.packString(avatar_file_name, "avatar_file_name");
+		success &= dp.packU32(avatar_size, "avatar_file_size");
+		success &= dp.packU32(avatar_mtime, "avatar_file_mtime");
+		success &= dp.packString(skeleton_file_name, "skeleton_file_name");
+		success &= dp.packU32(skeleton_size, "skeleton_file_size");
+		success &= dp.packU32(skeleton_mtime, "skeleton_file_mtime");
+		success &= dp.packS32(wearable_def_version, "wearable_definition_version");
+		success &= sAvatarSkeletonInfo->pack(dp);
+		success &= sAvatarXmlInfo->pack(dp);
+		return success;
+	};
+
+	// Size the buffer with a counting pass first
+	LLDataPackerBinaryBuffer counter;
+	pack_payload(counter);
+	S32 payload_size = counter.getCurrentSize();
+
+	std::vector<U8> buffer(AVATAR_DEFINITION_CACHE_HEADER_SIZE + payload_size);
+	LLDataPackerBinaryBuffer dp(&buffer[AVATAR_DEFINITION_CACHE_HEADER_SIZE], payload_size);
+	if (!pack_payload(dp))
+	{
+		LL_WARNS("Avatar") << "Failed to pack avatar definition cache" << LL_ENDL;
+		return;
+	}
+	LLCRC crc;
+	crc.update(&buffer[AVATAR_DEFINITION_CACHE_HEADER_SIZE], payload_size);
+	LLDataPackerBinaryBuffer header(&buffer[0], AVATAR_DEFINITION_CACHE_HEADER_SIZE);
+	header.packU32(AVATAR_DEFINITION_CACHE_MAGIC, "magic");
+	header.packU32(AVATAR_DEFINITION_CACHE_VERSION, "version");
+	header.packS32(payload_size, "payload_size");
+	header.packU32(crc.getCRC(), "payload_crc");
+
+	// Write to a temporary and rename it over the old entry so that another
+	// viewer starting up at the same time never reads a partial file.
+	std::string cache_filename = get_definition_cache_filename(avatar_file_name);
+	std::string temp_filename = cache_filename + ".tmp";
+	LLFILE* fp = LLFile::fopen(temp_filename, "wb");
+	if (!fp)
+	{
+		return;
+	}
+	bool written = fwrite(&buffer[0], 1, buffer.size(), fp) == buffer.size();
+	LLFile::close(fp);
+	if (written)
+	{
+		LLFile::remove(cache_filename, ENOENT);
+		written = LLFile::rename(temp_filename, cache_filename) == 0;
+	}
+	if (!written)
+	{
+		LLFile::remove(temp_filename);
+	}
 }
 
 void LLAvatarAppearance::cleanupClass()
@@ -1803,6 +2017,82 @@ BOOL LLAvatarSkeletonInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// LLAvatarBoneInfo::pack()/unpack()
+//-----------------------------------------------------------------------------
+BOOL LLAvatarBoneInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packString(mName, "name");
+	success &= dp.packString(mSupport, "support");
+	success &= dp.packString(mAliases, "aliases");
+	success &= dp.packU8((U8)mIsJoint, "is_joint");
+	success &= dp.packVector3(mPos, "pos");
+	success &= dp.packVector3(mEnd, "end");
+	success &= dp.packVector3(mRot, "rot");
+	success &= dp.packVector3(mScale, "scale");
+	success &= dp.packVector3(mPivot, "pivot");
+	success &= dp.packS32((S32)mChildList.size(), "num_children");
+	for (child_list_t::const_iterator iter = mChildList.begin(); iter != mChildList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+	return success;
+}
+
+BOOL LLAvatarBoneInfo::unpack(LLDataPacker& dp)
+{
+	U8 is_joint = 0;
+	S32 num_children = 0;
+	BOOL success = dp.unpackString(mName, "name");
+	success &= dp.unpackString(mSupport, "support");
+	success &= dp.unpackString(mAliases, "aliases");
+	success &= dp.unpackU8(is_joint, "is_joint");
+	success &= dp.unpackVector3(mPos, "pos");
+	success &= dp.unpackVector3(mEnd, "end");
+	success &= dp.unpackVector3(mRot, "rot");
+	success &= dp.unpackVector3(mScale, "scale");
+	success &= dp.unpackVector3(mPivot, "pivot");
+	success &= dp.unpackS32(num_children, "num_children");
+	mIsJoint = is_joint;
+	for (S32 i = 0; success && i < num_children; ++i)
+	{
+		LLAvatarBoneInfo* child_info = new LLAvatarBoneInfo;
+		success &= child_info->unpack(dp);
+		mChildList.push_back(child_info);
+	}
+	return success;
+}
+
+//-----------------------------------------------------------------------------
+// LLAvatarSkeletonInfo::pack()/unpack()
+//-----------------------------------------------------------------------------
+BOOL LLAvatarSkeletonInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packS32(mNumBones, "num_bones");
+	success &= dp.packS32(mNumCollisionVolumes, "num_collision_volumes");
+	success &= dp.packS32((S32)mBoneInfoList.size(), "num_root_bones");
+	for (bone_info_list_t::const_iterator iter = mBoneInfoList.begin(); iter != mBoneInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+	return success;
+}
+
+BOOL LLAvatarSkeletonInfo::unpack(LLDataPacker& dp)
+{
+	S32 num_root_bones = 0;
+	BOOL success = dp.unpackS32(mNumBones, "num_bones");
+	success &= dp.unpackS32(mNumCollisionVolumes, "num_collision_volumes");
+	success &= dp.unpackS32(num_root_bones, "num_root_bones");
+	for (S32 i = 0; success && i < num_root_bones; ++i)
+	{
+		LLAvatarBoneInfo* info = new LLAvatarBoneInfo;
+		success &= info->unpack(dp);
+		mBoneInfoList.push_back(info);
+	}
+	return success;
+}
+
 //Make aliases for joint and push to map.
 void LLAvatarAppearance::makeJointAliases(LLAvatarBoneInfo *bone_info)
 {
@@ -2237,6 +2527,198 @@ BOOL LLAvatarAppearance::LLAvatarXmlInfo::parseXmlMorphNodes(LLXmlTreeNode* root
 	return TRUE;
 }
 
+//-----------------------------------------------------------------------------
+// pack(): writes everything the parseXml*Nodes() calls produced
+//-----------------------------------------------------------------------------
+BOOL LLAvatarAppearance::LLAvatarXmlInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packS32((S32)mMeshInfoList.size(), "num_meshes");
+	for (mesh_info_list_t::const_iterator iter = mMeshInfoList.begin(); iter != mMeshInfoList.end(); ++iter)
+	{
+		const LLAvatarMeshInfo* info = *iter;
+		success &= dp.packString(info->mType, "type");
+		success &= dp.packS32(info->mLOD, "lod");
+		success &= dp.packString(info->mMeshFileName, "file_name");
+		success &= dp.packString(info->mReferenceMeshName, "reference");
+		success &= dp.packF32(info->mMinPixelArea, "min_pixel_area");
+		success &= dp.packS32((S32)info->mPolyMorphTargetInfoList.size(), "num_morphs");
+		for (LLAvatarMeshInfo::morph_info_list_t::const_iterator morph_iter = info->mPolyMorphTargetInfoList.begin();
+			 morph_iter != info->mPolyMorphTargetInfoList.end();
+			 ++morph_iter)
+		{
+			success &= morph_iter->first->pack(dp);
+			success &= dp.packU8((U8)morph_iter->second, "shared");
+		}
+	}
+
+	success &= dp.packS32((S32)mSkeletalDistortionInfoList.size(), "num_skeletal_distortions");
+	for (skeletal_distortion_info_list_t::const_iterator iter = mSkeletalDistortionInfoList.begin(); iter != mSkeletalDistortionInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+
+	success &= dp.packS32((S32)mAttachmentInfoList.size(), "num_attachments");
+	for (attachment_info_list_t::const_iterator iter = mAttachmentInfoList.begin(); iter != mAttachmentInfoList.end(); ++iter)
+	{
+		const LLAvatarAttachmentInfo* info = *iter;
+		success &= dp.packString(info->mName, "name");
+		success &= dp.packString(info->mJointName, "joint");
+		success &= dp.packVector3(info->mPosition, "position");
+		success &= dp.packVector3(info->mRotationEuler, "rotation");
+		success &= dp.packS32(info->mGroup, "group");
+		success &= dp.packS32(info->mAttachmentID, "id");
+		success &= dp.packS32(info->mPieMenuSlice, "pie_slice");
+		success &= dp.packU8((U8)info->mVisibleFirstPerson, "visible_in_first_person");
+		success &= dp.packU8((U8)info->mIsHUDAttachment, "hud");
+		success &= dp.packU8((U8)info->mHasPosition, "has_position");
+		success &= dp.packU8((U8)info->mHasRotation, "has_rotation");
+	}
+
+	const LLTexGlobalColorInfo* color_infos[] = { mTexSkinColorInfo, mTexHairColorInfo, mTexEyeColorInfo };
+	for (U32 i = 0; i < LL_ARRAY_SIZE(color_infos); ++i)
+	{
+		success &= dp.packU8(color_infos[i] ? 1 : 0, "has_global_color");
+		if (color_infos[i])
+		{
+			success &= color_infos[i]->pack(dp);
+		}
+	}
+
+	success &= dp.packS32((S32)mLayerInfoList.size(), "num_layer_sets");
+	for (layer_info_list_t::const_iterator iter = mLayerInfoList.begin(); iter != mLayerInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+
+	success &= dp.packS32((S32)mDriverInfoList.size(), "num_drivers");
+	for (driver_info_list_t::const_iterator iter = mDriverInfoList.begin(); iter != mDriverInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+
+	success &= dp.packS32((S32)mMorphMaskInfoList.size(), "num_morph_masks");
+	for (morph_info_list_t::const_iterator iter = mMorphMaskInfoList.begin(); iter != mMorphMaskInfoList.end(); ++iter)
+	{
+		const LLAvatarMorphInfo* info = *iter;
+		success &= dp.packString(info->mName, "morph_name");
+		success &= dp.packString(info->mRegion, "body_region");
+		success &= dp.packString(info->mLayer, "layer");
+		success &= dp.packU8((U8)info->mInvert, "invert");
+	}
+	return success;
+}
+
+//-----------------------------------------------------------------------------
+// unpack(): the inverse of pack(). Stops at the first short read; whatever was
+// read so far is owned by this object and released by the destructor.
+//-----------------------------------------------------------------------------
+BOOL LLAvatarAppearance::LLAvatarXmlInfo::unpack(LLDataPacker& dp)
+{
+	S32 count = 0;
+	BOOL success = dp.unpackS32(count, "num_meshes");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLAvatarMeshInfo* info = new LLAvatarMeshInfo;
+		mMeshInfoList.push_back(info);
+		S32 num_morphs = 0;
+		success &= dp.unpackString(info->mType, "type");
+		success &= dp.unpackS32(info->mLOD, "lod");
+		success &= dp.unpackString(info->mMeshFileName, "file_name");
+		success &= dp.unpackString(info->mReferenceMeshName, "reference");
+		success &= dp.unpackF32(info->mMinPixelArea, "min_pixel_area");
+		success &= dp.unpackS32(num_morphs, "num_morphs");
+		for (S32 j = 0; success && j < num_morphs; ++j)
+		{
+			LLPolyMorphTargetInfo* morphinfo = new LLPolyMorphTargetInfo();
+			U8 shared = 0;
+			success &= morphinfo->unpack(dp);
+			success &= dp.unpackU8(shared, "shared");
+			info->mPolyMorphTargetInfoList.push_back(LLAvatarMeshInfo::morph_info_pair_t(morphinfo, shared));
+		}
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_skeletal_distortions");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLPolySkeletalDistortionInfo* info = new LLPolySkeletalDistortionInfo;
+		success &= info->unpack(dp);
+		mSkeletalDistortionInfoList.push_back(info);
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_attachments");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLAvatarAttachmentInfo* info = new LLAvatarAttachmentInfo();
+		mAttachmentInfoList.push_back(info);
+		U8 visible_first_person = 0;
+		U8 is_hud = 0;
+		U8 has_position = 0;
+		U8 has_rotation = 0;
+		success &= dp.unpackString(info->mName, "name");
+		success &= dp.unpackString(info->mJointName, "joint");
+		success &= dp.unpackVector3(info->mPosition, "position");
+		success &= dp.unpackVector3(info->mRotationEuler, "rotation");
+		success &= dp.unpackS32(info->mGroup, "group");
+		success &= dp.unpackS32(info->mAttachmentID, "id");
+		success &= dp.unpackS32(info->mPieMenuSlice, "pie_slice");
+		success &= dp.unpackU8(visible_first_person, "visible_in_first_person");
+		success &= dp.unpackU8(is_hud, "hud");
+		success &= dp.unpackU8(has_position, "has_position");
+		success &= dp.unpackU8(has_rotation, "has_rotation");
+		info->mVisibleFirstPerson = visible_first_person;
+		info->mIsHUDAttachment = is_hud;
+		info->mHasPosition = has_position;
+		info->mHasRotation = has_rotation;
+	}
+
+	LLTexGlobalColorInfo** color_infos[] = { &mTexSkinColorInfo, &mTexHairColorInfo, &mTexEyeColorInfo };
+	for (U32 i = 0; success && i < LL_ARRAY_SIZE(color_infos); ++i)
+	{
+		U8 has_color = 0;
+		success &= dp.unpackU8(has_color, "has_global_color");
+		if (success && has_color)
+		{
+			*color_infos[i] = new LLTexGlobalColorInfo;
+			success &= (*color_infos[i])->unpack(dp);
+		}
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_layer_sets");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLTexLayerSetInfo* info = new LLTexLayerSetInfo();
+		success &= info->unpack(dp);
+		mLayerInfoList.push_back(info);
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_drivers");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLDriverParamInfo* info = new LLDriverParamInfo();
+		success &= info->unpack(dp);
+		mDriverInfoList.push_back(info);
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_morph_masks");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLAvatarMorphInfo* info = new LLAvatarMorphInfo();
+		mMorphMaskInfoList.push_back(info);
+		U8 invert = 0;
+		success &= dp.unpackString(info->mName, "morph_name");
+		success &= dp.unpackString(info->mRegion, "body_region");
+		success &= dp.unpackString(info->mLayer, "layer");
+		success &= dp.unpackU8(invert, "invert");
+		info->mInvert = invert;
+	}
+	return success;
+}
+
 //virtual 
 LLAvatarAppearance::LLMaskedMorph::LLMaskedMorph(LLVisualParam *morph_target, BOOL invert, std::string layer) :
 			mMorphTarget(morph_target), 
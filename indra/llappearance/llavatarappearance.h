@@ -36,6 +36,7 @@
 #include "llxmltree.h"
 
 #include <boost/container/flat_map.hpp> // <alchemy/>
+class LLDataPacker;
 class LLTexLayerSet;
 class LLTexGlobalColor;
 class LLTexGlobalColorInfo;
@@ -70,12 +71,17 @@ public:
 	static void			initClass(const std::string& avatar_file_name, const std::string& skeleton_file_name); // initializes static members
 	static void			initClass(); // initializes static members
 	static void			cleanupClass();	// Cleanup data that's only init'd once per class.
+	static bool			sUseDefinitionCache; // load the parsed avatar_lad.xml and avatar_skeleton.xml from the cache dir
 	virtual void 		initInstance(); // Called after construction to initialize the instance.
 	S32					mInitFlags;
 	virtual BOOL		loadSkeletonNode();
 	BOOL				loadMeshNodes();
 	BOOL				loadLayersets();
 
+private:
+	static BOOL			loadDefinitionCache(const std::string& avatar_file_name, const std::string& skeleton_file_name);
+	static void			saveDefinitionCache(const std::string& avatar_file_name, const std::string& skeleton_file_name, S32 wearable_def_version);
+
 
 /**                    Initialization
  **                                                                            **
@@ -384,6 +390,9 @@ protected:
 		BOOL 	parseXmlDriverNodes(LLXmlTreeNode* root);
 		BOOL	parseXmlMorphNodes(LLXmlTreeNode* root);
 
+		BOOL	pack(LLDataPacker& dp) const;
+		BOOL	unpack(LLDataPacker& dp);
+
 		struct LLAvatarMeshInfo
 		{
 			typedef std::pair<LLViewerVisualParamInfo*,BOOL> morph_info_pair_t; // LLPolyMorphTargetInfo stored here
@@ -29,6 +29,7 @@
 #include "lldriverparam.h"
 
 #include "llavatarappearance.h"
+#include "lldatapacker.h"
 #include "llwearable.h"
 #include "llwearabledata.h"
 
@@ -96,6 +97,43 @@ BOOL LLDriverParamInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLDriverParamInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLViewerVisualParamInfo::pack(dp);
+	success &= dp.packS32((S32)mDrivenInfoList.size(), "num_driven");
+	for (entry_info_list_t::const_iterator iter = mDrivenInfoList.begin(); iter != mDrivenInfoList.end(); ++iter)
+	{
+		success &= dp.packS32(iter->mDrivenID, "id");
+		success &= dp.packF32(iter->mMin1, "min1");
+		success &= dp.packF32(iter->mMax1, "max1");
+		success &= dp.packF32(iter->mMax2, "max2");
+		success &= dp.packF32(iter->mMin2, "min2");
+	}
+	return success;
+}
+
+//virtual
+BOOL LLDriverParamInfo::unpack(LLDataPacker& dp)
+{
+	S32 num_driven = 0;
+	BOOL success = LLViewerVisualParamInfo::unpack(dp);
+	success &= dp.unpackS32(num_driven, "num_driven");
+	for (S32 i = 0; success && i < num_driven; ++i)
+	{
+		S32 driven_id = 0;
+		F32 min1, max1, max2, min2;
+		success &= dp.unpackS32(driven_id, "id");
+		success &= dp.unpackF32(min1, "min1");
+		success &= dp.unpackF32(max1, "max1");
+		success &= dp.unpackF32(max2, "max2");
+		success &= dp.unpackF32(min2, "min2");
+		// Packed in list order, which parseXml() already reversed
+		mDrivenInfoList.push_back(LLDrivenEntryInfo(driven_id, min1, max1, max2, min2));
+	}
+	return success;
+}
+
 //virtual 
 void LLDriverParamInfo::toStream(std::ostream &out)
 {
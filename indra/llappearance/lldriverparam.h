@@ -66,6 +66,8 @@ public:
 	/*virtual*/ ~LLDriverParamInfo() {};
 	
 	/*virtual*/ BOOL parseXml(LLXmlTreeNode* node);
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 
 	/*virtual*/ void toStream(std::ostream &out);	
 
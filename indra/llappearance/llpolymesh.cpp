@@ -287,6 +287,18 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		return FALSE;
 	}
 
+	// The vertex and morph sections are read a few bytes at a time;
+	// buffer the whole file so that it is pulled in with a single read.
+	std::vector<char> read_buffer;
+	llstat file_status;
+	if (!LLFile::stat(fileName, &file_status) && file_status.st_size > 0)
+	{
+		read_buffer.resize(file_status.st_size + 1);
+		setvbuf(fp, &read_buffer[0], _IOFBF, read_buffer.size());
+	}
+	// Declared after read_buffer so the file is closed on every return path before the buffer goes away.
+	std::unique_ptr<LLFILE, int (*)(LLFILE*)> file_closer(fp, &LLFile::close);
+
 	//-------------------------------------------------------------------------
 	// Read a chunk
 	//-------------------------------------------------------------------------
@@ -713,8 +725,6 @@ BOOL LLPolyMeshSharedData::loadMesh( const std::string& fileName )
 		allocateJointNames(1);
 	}
 
-	fclose( fp );
-
 	return status;
 }
 
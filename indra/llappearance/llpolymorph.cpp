@@ -34,6 +34,7 @@
 #include "llavatarjoint.h"
 //#include "llwearable.h"
 #include "llxmltree.h"
+#include "lldatapacker.h"
 #include "llendianswizzle.h"
 #include "llpolymesh.h"
 #include "v2math.h"
@@ -608,6 +609,45 @@ BOOL LLPolyMorphTargetInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLPolyMorphTargetInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLViewerVisualParamInfo::pack(dp);
+	success &= dp.packString(mMorphName, "morph_name");
+	success &= dp.packU8((U8)mIsClothingMorph, "clothing_morph");
+	success &= dp.packS32((S32)mVolumeInfoList.size(), "num_volume_morphs");
+	for (volume_info_list_t::const_iterator iter = mVolumeInfoList.begin(); iter != mVolumeInfoList.end(); ++iter)
+	{
+		success &= dp.packString(iter->mName, "name");
+		success &= dp.packVector3(iter->mScale, "scale");
+		success &= dp.packVector3(iter->mPos, "pos");
+	}
+	return success;
+}
+
+//virtual
+BOOL LLPolyMorphTargetInfo::unpack(LLDataPacker& dp)
+{
+	U8 clothing_morph = 0;
+	S32 num_volume_morphs = 0;
+	BOOL success = LLViewerVisualParamInfo::unpack(dp);
+	success &= dp.unpackString(mMorphName, "morph_name");
+	success &= dp.unpackU8(clothing_morph, "clothing_morph");
+	success &= dp.unpackS32(num_volume_morphs, "num_volume_morphs");
+	mIsClothingMorph = clothing_morph;
+	for (S32 i = 0; success && i < num_volume_morphs; ++i)
+	{
+		std::string name;
+		LLVector3 scale;
+		LLVector3 pos;
+		success &= dp.unpackString(name, "name");
+		success &= dp.unpackVector3(scale, "scale");
+		success &= dp.unpackVector3(pos, "pos");
+		mVolumeInfoList.push_back(LLPolyVolumeMorphInfo(name, scale, pos));
+	}
+	return success;
+}
+
 //-----------------------------------------------------------------------------
 // LLPolyMorphTarget()
 //-----------------------------------------------------------------------------
@@ -144,6 +144,8 @@ public:
 	/*virtual*/ ~LLPolyMorphTargetInfo() {};
 	
 	/*virtual*/ BOOL parseXml(LLXmlTreeNode* node);
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 
 protected:
 	std::string		mMorphName;
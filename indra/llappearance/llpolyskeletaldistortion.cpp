@@ -37,6 +37,7 @@
 //#include "llxmltree.h"
 //#include "llvoavatar.h"
 #include "llwearable.h"
+#include "lldatapacker.h"
 //#include "lldir.h"
 //#include "llvolume.h"
 //#include "llendianswizzle.h"
@@ -106,6 +107,42 @@ BOOL LLPolySkeletalDistortionInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLPolySkeletalDistortionInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLViewerVisualParamInfo::pack(dp);
+	success &= dp.packS32((S32)mBoneInfoList.size(), "num_bones");
+	for (bone_info_list_t::const_iterator iter = mBoneInfoList.begin(); iter != mBoneInfoList.end(); ++iter)
+	{
+		success &= dp.packString(iter->mBoneName, "name");
+		success &= dp.packVector3(iter->mScaleDeformation, "scale");
+		success &= dp.packVector3(iter->mPositionDeformation, "offset");
+		success &= dp.packU8((U8)iter->mHasPositionDeformation, "has_offset");
+	}
+	return success;
+}
+
+//virtual
+BOOL LLPolySkeletalDistortionInfo::unpack(LLDataPacker& dp)
+{
+	S32 num_bones = 0;
+	BOOL success = LLViewerVisualParamInfo::unpack(dp);
+	success &= dp.unpackS32(num_bones, "num_bones");
+	for (S32 i = 0; success && i < num_bones; ++i)
+	{
+		std::string name;
+		LLVector3 scale;
+		LLVector3 pos;
+		U8 haspos = 0;
+		success &= dp.unpackString(name, "name");
+		success &= dp.unpackVector3(scale, "scale");
+		success &= dp.unpackVector3(pos, "offset");
+		success &= dp.unpackU8(haspos, "has_offset");
+		mBoneInfoList.push_back(LLPolySkeletalBoneInfo(name, scale, pos, haspos));
+	}
+	return success;
+}
+
 //-----------------------------------------------------------------------------
 // LLPolySkeletalDistortion()
 //-----------------------------------------------------------------------------
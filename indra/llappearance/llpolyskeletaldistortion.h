@@ -72,6 +72,8 @@ public:
 	/*virtual*/ ~LLPolySkeletalDistortionInfo() {};
 	
 	/*virtual*/ BOOL parseXml(LLXmlTreeNode* node);
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 
 
 
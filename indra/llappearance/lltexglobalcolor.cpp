@@ -26,6 +26,7 @@
 
 #include "linden_common.h"
 #include "llavatarappearance.h"
+#include "lldatapacker.h"
 #include "lltexlayer.h"
 #include "lltexglobalcolor.h"
 
@@ -166,3 +167,28 @@ BOOL LLTexGlobalColorInfo::parseXml(LLXmlTreeNode* node)
 	}
 	return TRUE;
 }
+
+BOOL LLTexGlobalColorInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packString(mName, "name");
+	success &= dp.packS32((S32)mParamColorInfoList.size(), "num_params");
+	for (param_color_info_list_t::const_iterator iter = mParamColorInfoList.begin(); iter != mParamColorInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+	return success;
+}
+
+BOOL LLTexGlobalColorInfo::unpack(LLDataPacker& dp)
+{
+	S32 num_params = 0;
+	BOOL success = dp.unpackString(mName, "name");
+	success &= dp.unpackS32(num_params, "num_params");
+	for (S32 i = 0; success && i < num_params; ++i)
+	{
+		LLTexLayerParamColorInfo* info = new LLTexLayerParamColorInfo();
+		success &= info->unpack(dp);
+		mParamColorInfoList.push_back(info);
+	}
+	return success;
+}
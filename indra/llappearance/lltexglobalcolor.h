@@ -32,6 +32,7 @@
 
 class LLAvatarAppearance;
 class LLWearable;
+class LLDataPacker;
 class LLTexGlobalColorInfo;
 
 class LLTexGlobalColor
@@ -63,6 +64,8 @@ public:
 	~LLTexGlobalColorInfo();
 
 	BOOL parseXml(LLXmlTreeNode* node);
+	BOOL pack(LLDataPacker& dp) const;
+	BOOL unpack(LLDataPacker& dp);
 
 private:
 	param_color_info_list_t		mParamColorInfoList;
@@ -30,12 +30,14 @@
 
 #include "llavatarappearance.h"
 #include "llcrc.h"
+#include "lldatapacker.h"
 #include "imageids.h"
 #include "llimagej2c.h"
 #include "llimagetga.h"
 #include "lldir.h"
 #include "llvfile.h"
 #include "llvfs.h"
+#include "lltexlayercompositor.h"
 #include "lltexlayerparams.h"
 #include "lltexturemanagerbridge.h"
 #include "llrender2dutils.h"
@@ -62,6 +64,8 @@ public:
 	~LLTexLayerInfo();
 
 	BOOL parseXml(LLXmlTreeNode* node);
+	BOOL pack(LLDataPacker& dp) const;
+	BOOL unpack(LLDataPacker& dp);
 	BOOL createVisualParams(LLAvatarAppearance *appearance);
 	BOOL isUserSettable() { return mLocalTexture != -1;	}
 	S32  getLocalTexture() const { return mLocalTexture; }
@@ -160,8 +164,11 @@ BOOL LLTexLayerSetBuffer::renderTexLayerSet()
 
 	// Composite the color data
 	LLGLSUIDefault gls_ui;
-	success &= mTexLayerSet->render( getCompositeOriginX(), getCompositeOriginY(), 
-									 getCompositeWidth(), getCompositeHeight() );
+	if (!LLTexLayerSet::sUseCPUCompositor || !renderTexLayerSetCPU())
+	{
+		success &= mTexLayerSet->render( getCompositeOriginX(), getCompositeOriginY(), 
+										 getCompositeWidth(), getCompositeHeight() );
+	}
 	gGL.flush();
 
 	midRenderTexLayerSet(success);
@@ -180,6 +187,52 @@ BOOL LLTexLayerSetBuffer::renderTexLayerSet()
 	return success;
 }
 
+// Composites the layer set on the CPU and copies the result into the render target.
+// Returns FALSE, without touching the render target, if the CPU composite couldn't be made.
+static LLTrace::BlockTimerStatHandle FTM_RENDER_TEX_LAYER_SET_CPU("Bake Composite CPU");
+BOOL LLTexLayerSetBuffer::renderTexLayerSetCPU()
+{
+	LL_RECORD_BLOCK_TIME(FTM_RENDER_TEX_LAYER_SET_CPU);
+	const S32 width = getCompositeWidth();
+	const S32 height = getCompositeHeight();
+
+	LLPointer<LLImageRaw> composite = new LLImageRaw(width, height, 4);
+	if (!mTexLayerSet->renderCPU(composite, width, height))
+	{
+		LL_DEBUGS("Avatar") << "CPU composite not possible for " << mTexLayerSet->getBodyRegionName() << ", using GL" << LL_ENDL;
+		return FALSE;
+	}
+
+	llassert(gTextureManagerBridgep);
+	LLPointer<LLGLTexture> tex = gTextureManagerBridgep->getLocalTexture(width, height, 4, FALSE);
+	tex->createGLTexture(0, composite, nullptr, TRUE, LLGLTexture::LOCAL);
+
+	bool use_shaders = LLGLSLShader::sNoFixedFunction;
+
+	gGL.flush();
+	{
+		LLGLDisable<GL_ALPHA_TEST> no_alpha;
+		if (use_shaders)
+		{
+			gAlphaMaskProgram.setMinimumAlpha(0.f);
+		}
+		gGL.setSceneBlendType(LLRender::BT_REPLACE);
+		gGL.getTexUnit(0)->bind(tex);
+		gGL.getTexUnit(0)->setTextureBlendType(LLTexUnit::TB_REPLACE);
+		gl_rect_2d_simple_tex(width, height);
+		gGL.flush();
+		gGL.getTexUnit(0)->unbind(LLTexUnit::TT_TEXTURE);
+		gGL.getTexUnit(0)->setTextureBlendType(LLTexUnit::TB_MULT);
+		gGL.setSceneBlendType(LLRender::BT_ALPHA);
+		if (use_shaders)
+		{
+			gAlphaMaskProgram.setMinimumAlpha(0.004f);
+		}
+	}
+
+	return TRUE;
+}
+
 //-----------------------------------------------------------------------------
 // LLTexLayerSetInfo
 // An ordered set of texture layers that get composited into a single texture.
@@ -250,6 +303,41 @@ BOOL LLTexLayerSetInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+BOOL LLTexLayerSetInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packString(mBodyRegion, "body_region");
+	success &= dp.packS32(mWidth, "width");
+	success &= dp.packS32(mHeight, "height");
+	success &= dp.packString(mStaticAlphaFileName, "alpha_tga_file");
+	success &= dp.packU8((U8)mClearAlpha, "clear_alpha");
+	success &= dp.packS32((S32)mLayerInfoList.size(), "num_layers");
+	for (layer_info_list_t::const_iterator iter = mLayerInfoList.begin(); iter != mLayerInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+	return success;
+}
+
+BOOL LLTexLayerSetInfo::unpack(LLDataPacker& dp)
+{
+	U8 clear_alpha = 0;
+	S32 num_layers = 0;
+	BOOL success = dp.unpackString(mBodyRegion, "body_region");
+	success &= dp.unpackS32(mWidth, "width");
+	success &= dp.unpackS32(mHeight, "height");
+	success &= dp.unpackString(mStaticAlphaFileName, "alpha_tga_file");
+	success &= dp.unpackU8(clear_alpha, "clear_alpha");
+	success &= dp.unpackS32(num_layers, "num_layers");
+	mClearAlpha = clear_alpha;
+	for (S32 i = 0; success && i < num_layers; ++i)
+	{
+		LLTexLayerInfo* info = new LLTexLayerInfo();
+		success &= info->unpack(dp);
+		mLayerInfoList.push_back(info);
+	}
+	return success;
+}
+
 // creates visual params without generating layersets or layers
 void LLTexLayerSetInfo::createVisualParams(LLAvatarAppearance *appearance)
 {
@@ -269,6 +357,7 @@ void LLTexLayerSetInfo::createVisualParams(LLAvatarAppearance *appearance)
 //-----------------------------------------------------------------------------
 
 BOOL LLTexLayerSet::sHasCaches = FALSE;
+bool LLTexLayerSet::sUseCPUCompositor = false;
 
 LLTexLayerSet::LLTexLayerSet(LLAvatarAppearance* const appearance) :
 	mAvatarAppearance( appearance ),
@@ -459,6 +548,63 @@ BOOL LLTexLayerSet::render( S32 x, S32 y, S32 width, S32 height )
 	return success;
 }
 
+// CPU version of render(). The steps and blend modes are the same, see LLTexLayerCompositor.
+// Returns FALSE if some texture isn't available on the CPU side, in which case the caller should use render().
+static LLTrace::BlockTimerStatHandle FTM_TEX_LAYER_SET_RENDER_CPU("Layer Set Render CPU");
+BOOL LLTexLayerSet::renderCPU(LLImageRaw* composite, S32 width, S32 height)
+{
+	LL_RECORD_BLOCK_TIME(FTM_TEX_LAYER_SET_RENDER_CPU);
+	BOOL success = TRUE;
+	mIsVisible = TRUE;
+
+	for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); ++iter)
+	{
+		LLTexLayerInterface* layer = *iter;
+		if (layer->isInvisibleAlphaMask())
+		{
+			mIsVisible = FALSE;
+		}
+	}
+
+	LLTexLayerCompositor compositor(width, height);
+
+	// clear buffer area
+	compositor.setMinimumAlpha(0.f);
+	compositor.setSceneBlendType(LLRender::BT_REPLACE);
+	compositor.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+	compositor.setSceneBlendType(LLRender::BT_ALPHA);
+	compositor.setMinimumAlpha(0.004f);
+
+	if (mIsVisible)
+	{
+		// composite color layers
+		for (layer_list_t::iterator iter = mLayerList.begin(); iter != mLayerList.end() && success; ++iter)
+		{
+			LLTexLayerInterface* layer = *iter;
+			if (layer->getRenderPass() == LLTexLayer::RP_COLOR)
+			{
+				success &= layer->renderCPU(compositor);
+			}
+		}
+
+		success = success && renderAlphaMaskTexturesCPU(compositor, false);
+	}
+	else
+	{
+		compositor.setSceneBlendType(LLRender::BT_REPLACE);
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawRect(LLColor4(0.f, 0.f, 0.f, 0.f));
+		compositor.setSceneBlendType(LLRender::BT_ALPHA);
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	if (success)
+	{
+		compositor.readPixels(composite);
+	}
+	return success;
+}
+
 
 BOOL LLTexLayerSet::isBodyRegion(const std::string& region) const 
 { 
@@ -608,6 +754,47 @@ void LLTexLayerSet::renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height,
 	gGL.setSceneBlendType(LLRender::BT_ALPHA);
 }
 
+BOOL LLTexLayerSet::renderAlphaMaskTexturesCPU(LLTexLayerCompositor& compositor, bool forceClear)
+{
+	const LLTexLayerSetInfo *info = getInfo();
+	BOOL success = TRUE;
+
+	compositor.setColorMask(false, true);
+	compositor.setSceneBlendType(LLRender::BT_REPLACE);
+
+	// (Optionally) replace alpha with a single component image from a tga file.
+	if (!info->mStaticAlphaFileName.empty())
+	{
+		LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(info->mStaticAlphaFileName, TRUE);
+		if (image)
+		{
+			compositor.drawImage(image, LLColor4::white);
+		}
+	}
+	else if (forceClear || info->mClearAlpha || (mMaskLayerList.size() > 0))
+	{
+		// Set the alpha channel to one (clean up after previous blending)
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawRect(LLColor4(0.f, 0.f, 0.f, 1.f));
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	// (Optional) Mask out part of the baked texture with alpha masks
+	if (mMaskLayerList.size() > 0)
+	{
+		compositor.setSceneBlendType(LLRender::BT_MULT_ALPHA);
+		for (layer_list_t::iterator iter = mMaskLayerList.begin(); iter != mMaskLayerList.end(); ++iter)
+		{
+			LLTexLayerInterface* layer = *iter;
+			success &= layer->blendAlphaTextureCPU(compositor);
+		}
+	}
+
+	compositor.setColorMask(true, true);
+	compositor.setSceneBlendType(LLRender::BT_ALPHA);
+	return success;
+}
+
 void LLTexLayerSet::applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components)
 {
 	mAvatarAppearance->applyMorphMask(tex_data, width, height, num_components, mBakedTexIndex);
@@ -796,6 +983,94 @@ BOOL LLTexLayerInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+BOOL LLTexLayerInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packString(mName, "name");
+	success &= dp.packU8((U8)mWriteAllChannels, "write_all_channels");
+	success &= dp.packU8((U8)mRenderPass, "render_pass");
+	success &= dp.packString(mGlobalColor, "global_color");
+	success &= dp.packColor4(mFixedColor, "fixed_color");
+	success &= dp.packS32(mLocalTexture, "local_texture");
+	success &= dp.packString(mStaticImageFileName, "tga_file");
+	success &= dp.packU8((U8)mStaticImageIsMask, "file_is_mask");
+	success &= dp.packU8((U8)mUseLocalTextureAlphaOnly, "local_texture_alpha_only");
+	success &= dp.packU8((U8)mIsVisibilityMask, "visibility_mask");
+
+	success &= dp.packS32((S32)mMorphNameList.size(), "num_morph_masks");
+	for (morph_name_list_t::const_iterator iter = mMorphNameList.begin(); iter != mMorphNameList.end(); ++iter)
+	{
+		success &= dp.packString(iter->first, "morph_name");
+		success &= dp.packU8((U8)iter->second, "invert");
+	}
+
+	success &= dp.packS32((S32)mParamColorInfoList.size(), "num_color_params");
+	for (param_color_info_list_t::const_iterator iter = mParamColorInfoList.begin(); iter != mParamColorInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+
+	success &= dp.packS32((S32)mParamAlphaInfoList.size(), "num_alpha_params");
+	for (param_alpha_info_list_t::const_iterator iter = mParamAlphaInfoList.begin(); iter != mParamAlphaInfoList.end(); ++iter)
+	{
+		success &= (*iter)->pack(dp);
+	}
+	return success;
+}
+
+BOOL LLTexLayerInfo::unpack(LLDataPacker& dp)
+{
+	U8 write_all_channels = 0;
+	U8 render_pass = 0;
+	U8 file_is_mask = 0;
+	U8 alpha_only = 0;
+	U8 visibility_mask = 0;
+	BOOL success = dp.unpackString(mName, "name");
+	success &= dp.unpackU8(write_all_channels, "write_all_channels");
+	success &= dp.unpackU8(render_pass, "render_pass");
+	success &= dp.unpackString(mGlobalColor, "global_color");
+	success &= dp.unpackColor4(mFixedColor, "fixed_color");
+	success &= dp.unpackS32(mLocalTexture, "local_texture");
+	success &= dp.unpackString(mStaticImageFileName, "tga_file");
+	success &= dp.unpackU8(file_is_mask, "file_is_mask");
+	success &= dp.unpackU8(alpha_only, "local_texture_alpha_only");
+	success &= dp.unpackU8(visibility_mask, "visibility_mask");
+	mWriteAllChannels = write_all_channels;
+	mRenderPass = (LLTexLayerInterface::ERenderPass)render_pass;
+	mStaticImageIsMask = file_is_mask;
+	mUseLocalTextureAlphaOnly = alpha_only;
+	mIsVisibilityMask = visibility_mask;
+
+	S32 count = 0;
+	success &= dp.unpackS32(count, "num_morph_masks");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		std::string morph_name;
+		U8 invert = 0;
+		success &= dp.unpackString(morph_name, "morph_name");
+		success &= dp.unpackU8(invert, "invert");
+		mMorphNameList.push_back(std::pair<std::string,BOOL>(morph_name, invert));
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_color_params");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLTexLayerParamColorInfo* info = new LLTexLayerParamColorInfo();
+		success &= info->unpack(dp);
+		mParamColorInfoList.push_back(info);
+	}
+
+	count = 0;
+	success &= dp.unpackS32(count, "num_alpha_params");
+	for (S32 i = 0; success && i < count; ++i)
+	{
+		LLTexLayerParamAlphaInfo* info = new LLTexLayerParamAlphaInfo();
+		success &= info->unpack(dp);
+		mParamAlphaInfoList.push_back(info);
+	}
+	return success;
+}
+
 BOOL LLTexLayerInfo::createVisualParams(LLAvatarAppearance *appearance)
 {
 	BOOL success = TRUE;
@@ -1300,6 +1575,108 @@ BOOL LLTexLayer::render(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// CPU version of render(). Returns FALSE if the local texture has no pixels on the CPU side.
+BOOL LLTexLayer::renderCPU(LLTexLayerCompositor& compositor)
+{
+	LLColor4 net_color;
+	BOOL color_specified = findNetColor(&net_color);
+
+	if (mTexLayerSet->getAvatarAppearance()->mIsDummy)
+	{
+		color_specified = true;
+		net_color = LLAvatarAppearance::getDummyColor();
+	}
+
+	BOOL success = TRUE;
+
+	// If you can't see the layer, don't render it.
+	if( is_approx_zero( net_color.mV[VW] ) )
+	{
+		return success;
+	}
+
+	BOOL alpha_mask_specified = FALSE;
+	if (!mParamAlphaList.empty())
+	{
+		const bool force_render = true;
+		if (!renderMorphMasksCPU(compositor, net_color, force_render))
+		{
+			return FALSE;
+		}
+		alpha_mask_specified = TRUE;
+		compositor.blendFunc(LLRender::BF_DEST_ALPHA, LLRender::BF_ONE_MINUS_DEST_ALPHA);
+	}
+
+	if( getInfo()->mWriteAllChannels )
+	{
+		compositor.setSceneBlendType(LLRender::BT_REPLACE);
+	}
+
+	if( (getInfo()->mLocalTexture != -1) && !getInfo()->mUseLocalTextureAlphaOnly )
+	{
+		LLGLTexture* tex = NULL;
+		if (mLocalTextureObject && mLocalTextureObject->getImage())
+		{
+			tex = mLocalTextureObject->getImage();
+			if (mLocalTextureObject->getID() == IMG_DEFAULT_AVATAR)
+			{
+				tex = NULL;
+			}
+		}
+
+		if( tex )
+		{
+			LLImageRaw* image = gTextureManagerBridgep->getRawImage(tex);
+			if (!image)
+			{
+				return FALSE;
+			}
+
+			bool no_alpha_test = getInfo()->mWriteAllChannels;
+			if (no_alpha_test)
+			{
+				compositor.setMinimumAlpha(0.f);
+			}
+			compositor.drawImage(image, net_color);
+			if (no_alpha_test)
+			{
+				compositor.setMinimumAlpha(0.004f);
+			}
+		}
+	}
+
+	if( !getInfo()->mStaticImageFileName.empty() )
+	{
+		LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+		if( image )
+		{
+			compositor.drawImage(image, net_color);
+		}
+		else
+		{
+			success = FALSE;
+		}
+	}
+
+	if(((-1 == getInfo()->mLocalTexture) ||
+		 getInfo()->mUseLocalTextureAlphaOnly) &&
+		getInfo()->mStaticImageFileName.empty() &&
+		color_specified )
+	{
+		compositor.setMinimumAlpha(0.f);
+		compositor.drawRect(net_color);
+		compositor.setMinimumAlpha(0.004f);
+	}
+
+	if( alpha_mask_specified || getInfo()->mWriteAllChannels )
+	{
+		// Restore standard blend func value
+		compositor.setSceneBlendType(LLRender::BT_ALPHA);
+	}
+
+	return success;
+}
+
 const U8*	LLTexLayer::getAlphaData() const
 {
 	LLCRC alpha_mask_crc;
@@ -1422,6 +1799,46 @@ BOOL LLTexLayer::blendAlphaTexture(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+BOOL LLTexLayer::blendAlphaTextureCPU(LLTexLayerCompositor& compositor)
+{
+	BOOL success = TRUE;
+
+	if( !getInfo()->mStaticImageFileName.empty() )
+	{
+		LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw( getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask );
+		if( image )
+		{
+			compositor.setMinimumAlpha(0.f);
+			compositor.drawImage(image, LLColor4::white);
+			compositor.setMinimumAlpha(0.004f);
+		}
+		else
+		{
+			success = FALSE;
+		}
+	}
+	else
+	{
+		if (getInfo()->mLocalTexture >=0 && getInfo()->mLocalTexture < TEX_NUM_INDICES && mLocalTextureObject)
+		{
+			LLGLTexture* tex = mLocalTextureObject->getImage();
+			if (tex)
+			{
+				LLImageRaw* image = gTextureManagerBridgep->getRawImage(tex);
+				if (!image)
+				{
+					return FALSE;
+				}
+				compositor.setMinimumAlpha(0.f);
+				compositor.drawImage(image, LLColor4::white);
+				compositor.setMinimumAlpha(0.004f);
+			}
+		}
+	}
+
+	return success;
+}
+
 /*virtual*/ void LLTexLayer::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
 	addAlphaMask(data, originX, originY, width, height);
@@ -1585,6 +2002,134 @@ void LLTexLayer::renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLC
 	}
 }
 
+// CPU version of renderMorphMasks(). Returns FALSE if the morph masks couldn't be rendered.
+static LLTrace::BlockTimerStatHandle FTM_RENDER_MORPH_MASKS_CPU("renderMorphMasksCPU");
+BOOL LLTexLayer::renderMorphMasksCPU(LLTexLayerCompositor& compositor, const LLColor4 &layer_color, bool force_render)
+{
+	if (!force_render && !hasMorph())
+	{
+		return TRUE;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_RENDER_MORPH_MASKS_CPU);
+	BOOL success = TRUE;
+
+	llassert( !mParamAlphaList.empty() );
+
+	compositor.setMinimumAlpha(0.f);
+	compositor.setColorMask(false, true);
+
+	LLTexLayerParamAlpha* first_param = *mParamAlphaList.begin();
+	// Note: if the first param is a mulitply, multiply against the current buffer's alpha
+	if( !first_param || !first_param->getMultiplyBlend() )
+	{
+		// Clear the alpha
+		compositor.setSceneBlendType(LLRender::BT_REPLACE);
+		compositor.drawRect(LLColor4(0.f, 0.f, 0.f, 0.f));
+	}
+
+	// Accumulate alphas
+	for (param_alpha_list_t::iterator iter = mParamAlphaList.begin(); iter != mParamAlphaList.end(); ++iter)
+	{
+		LLTexLayerParamAlpha* param = *iter;
+		success &= param->renderCPU(compositor);
+		if (!success && !force_render)
+		{
+			compositor.setMinimumAlpha(0.004f);
+			compositor.setColorMask(true, true);
+			return FALSE;
+		}
+	}
+
+	// Approximates a min() function
+	compositor.setSceneBlendType(LLRender::BT_MULT_ALPHA);
+
+	// Accumulate the alpha component of the texture
+	if( getInfo()->mLocalTexture != -1 )
+	{
+		LLGLTexture* tex = mLocalTextureObject ? mLocalTextureObject->getImage() : NULL;
+		if( tex && (tex->getComponents() == 4) )
+		{
+			LLImageRaw* image = gTextureManagerBridgep->getRawImage(tex);
+			if (!image)
+			{
+				compositor.setMinimumAlpha(0.004f);
+				compositor.setColorMask(true, true);
+				return FALSE;
+			}
+			compositor.drawImage(image, LLColor4::white);
+		}
+	}
+
+	if( !getInfo()->mStaticImageFileName.empty() && getInfo()->mStaticImageIsMask )
+	{
+		LLImageRaw* image = LLTexLayerStaticImageList::getInstance()->getImageRaw(getInfo()->mStaticImageFileName, getInfo()->mStaticImageIsMask);
+		if( image )
+		{
+			if(	(image->getComponents() == 4) || (image->getComponents() == 1) )
+			{
+				compositor.drawImage(image, LLColor4::white);
+			}
+			else
+			{
+				LL_WARNS() << "Skipping rendering of " << getInfo()->mStaticImageFileName 
+						<< "; expected 1 or 4 components." << LL_ENDL;
+			}
+		}
+	}
+
+	// Draw a rectangle with the layer color to multiply the alpha by that color's alpha.
+	if ( !is_approx_equal(layer_color.mV[VW], 1.f) )
+	{
+		compositor.drawRect(layer_color);
+	}
+
+	compositor.setMinimumAlpha(0.004f);
+	compositor.setColorMask(true, true);
+
+	if (hasMorph() && success)
+	{
+		LLCRC alpha_mask_crc;
+		const LLUUID& uuid = getUUID();
+		alpha_mask_crc.update((U8*)(&uuid.mData), UUID_BYTES);
+
+		for (param_alpha_list_t::const_iterator iter = mParamAlphaList.begin(); iter != mParamAlphaList.end(); ++iter)
+		{
+			const LLTexLayerParamAlpha* param = *iter;
+			F32 param_weight = param->getWeight();
+			alpha_mask_crc.update((U8*)&param_weight, sizeof(F32));
+		}
+
+		U32 cache_index = alpha_mask_crc.getCRC();
+
+		// Like renderMorphMasks(), don't trust a cached mask, but read it back from the compositor.
+		S32 max_cache_entries = getTexLayerSet()->getAvatarAppearance()->isSelf() ? 4 : 1;
+		alpha_cache_t::iterator cached = mAlphaCache.find(cache_index);
+		if (cached != mAlphaCache.end())
+		{
+			delete [] cached->second;
+			mAlphaCache.erase(cached);
+		}
+		while ((S32)mAlphaCache.size() >= max_cache_entries)
+		{
+			alpha_cache_t::iterator iter2 = mAlphaCache.begin(); // arbitrarily grab the first entry
+			delete [] iter2->second;
+			mAlphaCache.erase(iter2);
+		}
+		const S32 width = compositor.getWidth();
+		const S32 height = compositor.getHeight();
+		U8* alpha_data = new U8[width * height];
+		compositor.readAlpha(alpha_data);
+		mAlphaCache[cache_index] = alpha_data;
+
+		getTexLayerSet()->getAvatarAppearance()->dirtyMesh();
+
+		mMorphMasksValid = TRUE;
+		getTexLayerSet()->applyMorphMask(alpha_data, width, height, 1);
+	}
+
+	return success;
+}
+
 static LLTrace::BlockTimerStatHandle FTM_ADD_ALPHA_MASK("addAlphaMask");
 void LLTexLayer::addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
@@ -1781,6 +2326,54 @@ LLTexLayer* LLTexLayerTemplate::getLayer(U32 i) const
 	return success;
 }
 
+/*virtual*/ BOOL LLTexLayerTemplate::renderCPU(LLTexLayerCompositor& compositor)
+{
+	if(!mInfo)
+	{
+		return FALSE ;
+	}
+
+	BOOL success = TRUE;
+	updateWearableCache();
+	for (wearable_cache_t::const_iterator iter = mWearableCache.begin(); iter!= mWearableCache.end() && success; ++iter)
+	{
+		LLWearable* wearable = *iter;
+		LLLocalTextureObject *lto = NULL;
+		LLTexLayer *layer = NULL;
+		if (wearable)
+		{
+			lto = wearable->getLocalTextureObject(mInfo->mLocalTexture);
+		}
+		if (lto)
+		{
+			layer = lto->getTexLayer(getName());
+		}
+		if (layer)
+		{
+			wearable->writeToAvatar(mAvatarAppearance);
+			layer->setLTO(lto);
+			success &= layer->renderCPU(compositor);
+		}
+	}
+
+	return success;
+}
+
+/*virtual*/ BOOL LLTexLayerTemplate::blendAlphaTextureCPU(LLTexLayerCompositor& compositor)
+{
+	BOOL success = TRUE;
+	U32 num_wearables = updateWearableCache();
+	for (U32 i = 0; i < num_wearables; i++)
+	{
+		LLTexLayer *layer = getLayer(i);
+		if (layer)
+		{
+			success &= layer->blendAlphaTextureCPU(compositor);
+		}
+	}
+	return success;
+}
+
 /*virtual*/ void LLTexLayerTemplate::gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height)
 {
 	U32 num_wearables = updateWearableCache();
@@ -1889,6 +2482,7 @@ void LLTexLayerSet::cloneTemplates(LLLocalTextureObject *lto, LLAvatarAppearance
 LLTexLayerStaticImageList::LLTexLayerStaticImageList() :
 	mGLBytes(0),
 	mTGABytes(0),
+	mRawBytes(0),
 	mImageNames(16384)
 {
 }
@@ -1902,24 +2496,28 @@ void LLTexLayerStaticImageList::dumpByteCount() const
 {
 	LL_INFOS() << "Avatar Static Textures " <<
 		"KB GL:" << (mGLBytes / 1024) <<
-		"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+		"KB TGA:" << (mTGABytes / 1024) <<
+		"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
 }
 
 void LLTexLayerStaticImageList::deleteCachedImages()
 {
-	if( mGLBytes || mTGABytes )
+	if( mGLBytes || mTGABytes || mRawBytes )
 	{
 		LL_INFOS() << "Clearing Static Textures " <<
 			"KB GL:" << (mGLBytes / 1024) <<
-			"KB TGA:" << (mTGABytes / 1024) << "KB" << LL_ENDL;
+			"KB TGA:" << (mTGABytes / 1024) <<
+			"KB Raw:" << (mRawBytes / 1024) << "KB" << LL_ENDL;
 
 		//mStaticImageLists uses LLPointers, clear() will cause deletion
 		
 		mStaticImageListTGA.clear();
 		mStaticImageList.clear();
+		mStaticImageListRaw.clear();
 		
 		mGLBytes = 0;
 		mTGABytes = 0;
+		mRawBytes = 0;
 	}
 }
 
@@ -2007,6 +2605,39 @@ LLGLTexture* LLTexLayerStaticImageList::getTexture(const std::string& file_name,
 	return tex;
 }
 
+// Returns the decoded data from a tga file named file_name, converted the same way as in getTexture().
+// Used by the CPU compositor. Caches the result to speed identical subsequent requests.
+static LLTrace::BlockTimerStatHandle FTM_LOAD_STATIC_RAW("getImageRaw");
+LLImageRaw* LLTexLayerStaticImageList::getImageRaw(const std::string& file_name, BOOL is_mask)
+{
+	LL_RECORD_BLOCK_TIME(FTM_LOAD_STATIC_RAW);
+	const char *namekey = mImageNames.addString(file_name);
+
+	image_raw_map_t::const_iterator iter = mStaticImageListRaw.find(namekey);
+	if( iter != mStaticImageListRaw.end() )
+	{
+		return iter->second;
+	}
+
+	LLPointer<LLImageRaw> image_raw = new LLImageRaw;
+	if( !loadImageRaw( file_name, image_raw ) )
+	{
+		return NULL;
+	}
+	if( (image_raw->getComponents() == 1) && is_mask )
+	{
+		// Convert grayscale alpha masks from single channel into RGBA, like getTexture().
+		LLPointer<LLImageRaw> alpha_image_raw = image_raw;
+		image_raw = new LLImageRaw(image_raw->getWidth(),
+								   image_raw->getHeight(),
+								   4);
+		image_raw->copyUnscaledAlphaMask(alpha_image_raw, LLColor4U::black);
+	}
+	mStaticImageListRaw[ namekey ] = image_raw;
+	mRawBytes += image_raw->getDataSize();
+	return image_raw;
+}
+
 // Reads a .tga file, decodes it, and puts the decoded data in image_raw.
 // Returns TRUE if successful.
 static LLTrace::BlockTimerStatHandle FTM_LOAD_IMAGE_RAW("loadImageRaw");
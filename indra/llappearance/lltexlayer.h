@@ -34,6 +34,7 @@
 #include "lltexlayerparams.h"
 
 class LLAvatarAppearance;
+class LLDataPacker;
 class LLImageTGA;
 class LLImageRaw;
 class LLLocalTextureObject;
@@ -42,6 +43,7 @@ class LLTexLayerSet;
 class LLTexLayerSetInfo;
 class LLTexLayerInfo;
 class LLTexLayerSetBuffer;
+class LLTexLayerCompositor;
 class LLWearable;
 class LLViewerVisualParam;
 
@@ -70,6 +72,11 @@ public:
 	virtual BOOL			blendAlphaTexture(S32 x, S32 y, S32 width, S32 height) = 0;
 	virtual BOOL			isInvisibleAlphaMask() const = 0;
 
+	// CPU versions of render() and blendAlphaTexture(). These return FALSE when
+	// a texture that the layer uses has no image data on the CPU side.
+	virtual BOOL			renderCPU(LLTexLayerCompositor& compositor) = 0;
+	virtual BOOL			blendAlphaTextureCPU(LLTexLayerCompositor& compositor) = 0;
+
 	const LLTexLayerInfo* 	getInfo() const 			{ return mInfo; }
 	virtual BOOL			setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // sets mInfo, calls initialization functions
 	LLWearableType::EType	getWearableType() const;
@@ -124,6 +131,8 @@ public:
 	/*virtual*/ BOOL		render(S32 x, S32 y, S32 width, S32 height);
 	/*virtual*/ BOOL		setInfo(const LLTexLayerInfo *info, LLWearable* wearable); // This sets mInfo and calls initialization functions
 	/*virtual*/ BOOL		blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
+	/*virtual*/ BOOL		renderCPU(LLTexLayerCompositor& compositor);
+	/*virtual*/ BOOL		blendAlphaTextureCPU(LLTexLayerCompositor& compositor);
 	/*virtual*/ void		gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height);
 	/*virtual*/ void		setHasMorph(BOOL newval);
 	/*virtual*/ void		deleteCaches();
@@ -161,6 +170,9 @@ public:
 	/*virtual*/ BOOL		blendAlphaTexture(S32 x, S32 y, S32 width, S32 height); // Multiplies a single alpha texture against the frame buffer
 	/*virtual*/ void		gatherAlphaMasks(U8 *data, S32 originX, S32 originY, S32 width, S32 height);
 	void					renderMorphMasks(S32 x, S32 y, S32 width, S32 height, const LLColor4 &layer_color, bool force_render);
+	/*virtual*/ BOOL		renderCPU(LLTexLayerCompositor& compositor);
+	/*virtual*/ BOOL		blendAlphaTextureCPU(LLTexLayerCompositor& compositor);
+	BOOL					renderMorphMasksCPU(LLTexLayerCompositor& compositor, const LLColor4 &layer_color, bool force_render);
 	void					addAlphaMask(U8 *data, S32 originX, S32 originY, S32 width, S32 height);
 	/*virtual*/ BOOL		isInvisibleAlphaMask() const;
 
@@ -202,6 +214,11 @@ public:
 	BOOL						render(S32 x, S32 y, S32 width, S32 height);
 	void						renderAlphaMaskTextures(S32 x, S32 y, S32 width, S32 height, bool forceClear = false);
 
+	// Composites the layer set on the CPU into an RGBA image, with the same semantics as render().
+	// Doesn't need a GL context, so it can be used for headless baking and to check the GPU path.
+	BOOL						renderCPU(LLImageRaw* composite, S32 width, S32 height);
+	BOOL						renderAlphaMaskTexturesCPU(LLTexLayerCompositor& compositor, bool forceClear = false);
+
 	BOOL						isBodyRegion(const std::string& region) const;
 	void						applyMorphMask(U8* tex_data, S32 width, S32 height, S32 num_components);
 	BOOL						isMorphValid() const;
@@ -219,6 +236,7 @@ public:
 	BOOL						isVisible() const 			{ return mIsVisible; }
 
 	static BOOL					sHasCaches;
+	static bool					sUseCPUCompositor;	// Composite bakes with LLTexLayerCompositor instead of the GPU.
 
 	virtual void				asLLSD(LLSD& sd) const;
 
@@ -246,6 +264,8 @@ public:
 	LLTexLayerSetInfo();
 	~LLTexLayerSetInfo();
 	BOOL parseXml(LLXmlTreeNode* node);
+	BOOL pack(LLDataPacker& dp) const;
+	BOOL unpack(LLDataPacker& dp);
 	void createVisualParams(LLAvatarAppearance *appearance);
 	S32 getWidth() const { return mWidth; }
 	S32 getHeight() const { return mHeight; }
@@ -283,6 +303,7 @@ protected:
 	virtual S32				getCompositeWidth() const = 0;
 	virtual S32				getCompositeHeight() const = 0;
 	BOOL					renderTexLayerSet();
+	BOOL					renderTexLayerSetCPU();
 
 	LLTexLayerSet* const	mTexLayerSet;
 };
@@ -298,6 +319,7 @@ public:
 	~LLTexLayerStaticImageList();
 	LLGLTexture*		getTexture(const std::string& file_name, BOOL is_mask);
 	LLImageTGA*			getImageTGA(const std::string& file_name);
+	LLImageRaw*			getImageRaw(const std::string& file_name, BOOL is_mask);	// Decoded image for the CPU compositor, same content as getTexture().
 	void				deleteCachedImages();
 	void				dumpByteCount() const;
 protected:
@@ -308,8 +330,11 @@ private:
 	texture_map_t 		mStaticImageList;
 	typedef std::map<const char*, LLPointer<LLImageTGA> > image_tga_map_t;
 	image_tga_map_t 	mStaticImageListTGA;
+	typedef std::map<const char*, LLPointer<LLImageRaw> > image_raw_map_t;
+	image_raw_map_t 	mStaticImageListRaw;
 	S32 				mGLBytes;
 	S32 				mTGABytes;
+	S32 				mRawBytes;
 };
 
 #endif  // LL_LLTEXLAYER_H
@@ -0,0 +1,446 @@
+/**
+ * @file lltexlayercompositor.cpp
+ * @brief CPU implementation of the blending used to composite avatar texture layers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "lltexlayercompositor.h"
+
+#include "llfasttimer.h"
+#include "llimage.h"
+#include "lljobsystem.h"
+#include "llmemory.h"
+#include "llvector4a.h"
+#include "llvector4logical.h"
+
+//-----------------------------------------------------------------------------
+// LLTexLayerCompositor
+//-----------------------------------------------------------------------------
+
+// static
+S32 LLTexLayerCompositor::sThreadCount = 0;
+
+LLTexLayerCompositor::LLTexLayerCompositor(S32 width, S32 height) :
+	mWidth(width),
+	mHeight(height),
+	mPixels(NULL),
+	mWriteColor(true),
+	mWriteAlpha(true),
+	mSrcFactor(LLRender::BF_SOURCE_ALPHA),
+	mDstFactor(LLRender::BF_ONE_MINUS_SOURCE_ALPHA),
+	mMinimumAlpha(0.004f)
+{
+	llassert(width > 0 && height > 0);
+	mPixels = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * width * height);
+	for (S32 i = 0; i < width * height; ++i)
+	{
+		mPixels[i].clear();
+	}
+}
+
+LLTexLayerCompositor::~LLTexLayerCompositor()
+{
+	ll_aligned_free_16(mPixels);
+}
+
+void LLTexLayerCompositor::setColorMask(bool write_color, bool write_alpha)
+{
+	mWriteColor = write_color;
+	mWriteAlpha = write_alpha;
+}
+
+void LLTexLayerCompositor::setSceneBlendType(LLRender::eBlendType type)
+{
+	switch (type)
+	{
+		case LLRender::BT_ALPHA:
+			blendFunc(LLRender::BF_SOURCE_ALPHA, LLRender::BF_ONE_MINUS_SOURCE_ALPHA);
+			break;
+		case LLRender::BT_ADD:
+			blendFunc(LLRender::BF_ONE, LLRender::BF_ONE);
+			break;
+		case LLRender::BT_ADD_WITH_ALPHA:
+			blendFunc(LLRender::BF_SOURCE_ALPHA, LLRender::BF_ONE);
+			break;
+		case LLRender::BT_MULT:
+			blendFunc(LLRender::BF_DEST_COLOR, LLRender::BF_ZERO);
+			break;
+		case LLRender::BT_MULT_ALPHA:
+			blendFunc(LLRender::BF_DEST_ALPHA, LLRender::BF_ZERO);
+			break;
+		case LLRender::BT_MULT_X2:
+			blendFunc(LLRender::BF_DEST_COLOR, LLRender::BF_SOURCE_COLOR);
+			break;
+		case LLRender::BT_REPLACE:
+			blendFunc(LLRender::BF_ONE, LLRender::BF_ZERO);
+			break;
+		default:
+			LL_ERRS() << "Unknown Scene Blend Type: " << type << LL_ENDL;
+			break;
+	}
+}
+
+void LLTexLayerCompositor::blendFunc(LLRender::eBlendFactor sfactor, LLRender::eBlendFactor dfactor)
+{
+	mSrcFactor = sfactor;
+	mDstFactor = dfactor;
+}
+
+void LLTexLayerCompositor::drawRect(const LLColor4& color)
+{
+	addOp(color, NULL, false);
+}
+
+void LLTexLayerCompositor::drawImage(const LLImageRaw* image, const LLColor4& color, bool alpha_only)
+{
+	if (!image || !image->getData())
+	{
+		return;
+	}
+
+	LLPointer<LLImageRaw>& scaled = mScaledImages[image];
+	if (scaled.isNull())
+	{
+		// Hold on to the source too, so that its address can't be reused by another image while it is a key.
+		mSourceImages.push_back(const_cast<LLImageRaw*>(image));
+		if (image->getWidth() == mWidth && image->getHeight() == mHeight)
+		{
+			scaled = const_cast<LLImageRaw*>(image);
+		}
+		else
+		{
+			scaled = new LLImageRaw(image->getWidth(), image->getHeight(), image->getComponents());
+			memcpy(scaled->getData(), image->getData(), image->getDataSize());
+			scaled->scale(mWidth, mHeight);
+		}
+	}
+	addOp(color, scaled, alpha_only);
+}
+
+void LLTexLayerCompositor::addOp(const LLColor4& color, LLImageRaw* image, bool alpha_only)
+{
+	if (!mWriteColor && !mWriteAlpha)
+	{
+		return;
+	}
+	mOps.push_back(DrawOp());
+	DrawOp& op = mOps.back();
+	op.mSrcFactor = mSrcFactor;
+	op.mDstFactor = mDstFactor;
+	op.mWriteColor = mWriteColor;
+	op.mWriteAlpha = mWriteAlpha;
+	op.mAlphaOnly = alpha_only;
+	op.mMinimumAlpha = mMinimumAlpha;
+	op.mColor = color;
+	op.mImage = image;
+}
+
+static LLTrace::BlockTimerStatHandle FTM_TEX_LAYER_COMPOSITOR_FLUSH("Composite Bake on CPU");
+
+void LLTexLayerCompositor::flush()
+{
+	if (mOps.empty())
+	{
+		return;
+	}
+	LL_RECORD_BLOCK_TIME(FTM_TEX_LAYER_COMPOSITOR_FLUSH);
+
+	// Bands of at least 16 rows so that small targets don't pay for the hand-off.
+	S32 num_bands = gJobSystem ? llmin(sThreadCount + 1, llmax(1, mHeight / 16)) : 1;
+	S32 rows_per_band = (mHeight + num_bands - 1) / num_bands;
+	if (num_bands > 1)
+	{
+		gJobSystem->parallelFor(num_bands, [this, rows_per_band](S32 band)
+			{
+				S32 begin_row = band * rows_per_band;
+				executeRows(begin_row, llmin(mHeight, begin_row + rows_per_band));
+			}, sThreadCount);
+	}
+	else
+	{
+		executeRows(0, mHeight);
+	}
+
+	mOps.clear();
+}
+
+void LLTexLayerCompositor::executeRows(S32 begin_row, S32 end_row) const
+{
+	// One row of source colors, reused by every draw.
+	LLVector4a* src_row = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a) * mWidth);
+
+	// Run every draw over this band before moving on, so the band stays in cache.
+	for (draw_op_list_t::const_iterator iter = mOps.begin(); iter != mOps.end(); ++iter)
+	{
+		executeOp(*iter, begin_row, end_row, src_row);
+	}
+
+	ll_aligned_free_16(src_row);
+}
+
+//-----------------------------------------------------------------------------
+// Row kernels
+// The texel format and the blend factors are template parameters, so each
+// kernel is a branch free loop of SSE operations; executeOp() picks one per
+// draw instead of deciding per pixel.
+//-----------------------------------------------------------------------------
+
+// Converts a row of texels to colors, modulated by color (already scaled by 1/255).
+template <S32 COMPONENTS, bool ALPHA_ONLY>
+static void fetch_row(LLVector4a* __restrict src, const U8* __restrict texel, S32 count, const LLVector4a& color)
+{
+	for (S32 x = 0; x < count; ++x, texel += COMPONENTS)
+	{
+		if (COMPONENTS == 4)
+		{
+			src[x].set(texel[0], texel[1], texel[2], texel[3]);
+		}
+		else if (COMPONENTS == 3)
+		{
+			src[x].set(texel[0], texel[1], texel[2], 255.f);
+		}
+		else if (COMPONENTS == 2)
+		{
+			src[x].set(texel[0], texel[0], texel[0], texel[1]);
+		}
+		else if (ALPHA_ONLY)
+		{
+			src[x].set(0.f, 0.f, 0.f, texel[0]);
+		}
+		else
+		{
+			src[x].set(texel[0], texel[0], texel[0], 255.f);
+		}
+		src[x].mul(color);
+	}
+}
+
+typedef void (*fetch_row_func_t)(LLVector4a*, const U8*, S32, const LLVector4a&);
+
+static fetch_row_func_t get_fetch_row_func(S32 components, bool alpha_only)
+{
+	switch (components)
+	{
+		case 4:		return &fetch_row<4, false>;
+		case 3:		return &fetch_row<3, false>;
+		case 2:		return &fetch_row<2, false>;
+		default:	return alpha_only ? &fetch_row<1, true> : &fetch_row<1, false>;
+	}
+}
+
+static inline void get_blend_factor(LLVector4a& factor, LLRender::eBlendFactor type, const LLVector4a& src, const LLVector4a& dst, const LLVector4a& one)
+{
+	switch (type)
+	{
+		case LLRender::BF_ONE:
+			factor = one;
+			break;
+		case LLRender::BF_DEST_COLOR:
+			factor = dst;
+			break;
+		case LLRender::BF_SOURCE_COLOR:
+			factor = src;
+			break;
+		case LLRender::BF_ONE_MINUS_DEST_COLOR:
+			factor.setSub(one, dst);
+			break;
+		case LLRender::BF_ONE_MINUS_SOURCE_COLOR:
+			factor.setSub(one, src);
+			break;
+		case LLRender::BF_DEST_ALPHA:
+			factor.splat<3>(dst);
+			break;
+		case LLRender::BF_SOURCE_ALPHA:
+			factor.splat<3>(src);
+			break;
+		case LLRender::BF_ONE_MINUS_DEST_ALPHA:
+			factor.splat<3>(dst);
+			factor.setSub(one, factor);
+			break;
+		case LLRender::BF_ONE_MINUS_SOURCE_ALPHA:
+			factor.splat<3>(src);
+			factor.setSub(one, factor);
+			break;
+		case LLRender::BF_ZERO:
+		default:
+			factor.clear();
+			break;
+	}
+}
+
+static inline void blend_pixel(LLVector4a& dst, const LLVector4a& src,
+							   LLRender::eBlendFactor src_type, LLRender::eBlendFactor dst_type,
+							   const LLVector4a& one, const LLVector4a& minimum_alpha, const LLVector4Logical& write_mask)
+{
+	LLVector4a src_factor;
+	LLVector4a dst_factor;
+	get_blend_factor(src_factor, src_type, src, dst, one);
+	get_blend_factor(dst_factor, dst_type, src, dst, one);
+
+	LLVector4a result;
+	result.setMul(src, src_factor);
+	dst_factor.mul(dst);
+	result.add(dst_factor);
+	result.clamp(LLVector4a::getZero(), one);
+
+	// Same test as the alpha mask shader: discard fragments below the minimum alpha.
+	LLVector4a alpha;
+	alpha.splat<3>(src);
+	LLVector4Logical mask = _mm_and_ps(alpha.greaterEqual(minimum_alpha), write_mask);
+	dst.setSelectWithMask(mask, result, dst);
+}
+
+// Blends a row of source colors into dst. With SRC and DST known at compile
+// time the switches in get_blend_factor() fold away.
+template <LLRender::eBlendFactor SRC, LLRender::eBlendFactor DST>
+static void blend_row(LLVector4a* __restrict dst, const LLVector4a* __restrict src, S32 count,
+					  const LLVector4a& minimum_alpha, const LLVector4Logical& write_mask)
+{
+	LLVector4a one;
+	one.splat(1.f);
+	for (S32 x = 0; x < count; ++x)
+	{
+		blend_pixel(dst[x], src[x], SRC, DST, one, minimum_alpha, write_mask);
+	}
+}
+
+typedef void (*blend_row_func_t)(LLVector4a*, const LLVector4a*, S32, const LLVector4a&, const LLVector4Logical&);
+
+// The factor pairs set by the layer code; see setSceneBlendType().
+static blend_row_func_t get_blend_row_func(LLRender::eBlendFactor src, LLRender::eBlendFactor dst)
+{
+#define BLEND_ROW_CASE(SRC, DST) \
+	if (src == LLRender::SRC && dst == LLRender::DST) return &blend_row<LLRender::SRC, LLRender::DST>;
+
+	BLEND_ROW_CASE(BF_SOURCE_ALPHA, BF_ONE_MINUS_SOURCE_ALPHA)
+	BLEND_ROW_CASE(BF_ONE, BF_ONE)
+	BLEND_ROW_CASE(BF_SOURCE_ALPHA, BF_ONE)
+	BLEND_ROW_CASE(BF_DEST_COLOR, BF_ZERO)
+	BLEND_ROW_CASE(BF_DEST_ALPHA, BF_ZERO)
+	BLEND_ROW_CASE(BF_DEST_COLOR, BF_SOURCE_COLOR)
+	BLEND_ROW_CASE(BF_ONE, BF_ZERO)
+	BLEND_ROW_CASE(BF_DEST_ALPHA, BF_ONE_MINUS_DEST_ALPHA)
+#undef BLEND_ROW_CASE
+	return NULL;
+}
+
+void LLTexLayerCompositor::executeOp(const DrawOp& op, S32 begin_row, S32 end_row, LLVector4a* src_row) const
+{
+	LLVector4a color;
+	color.loadua(op.mColor.mV);
+
+	LLVector4a one;
+	one.splat(1.f);
+	LLVector4a minimum_alpha;
+	minimum_alpha.splat(op.mMinimumAlpha);
+
+	LLVector4Logical write_mask;
+	write_mask.clear();
+	if (op.mWriteColor)
+	{
+		write_mask.setElement<0>();
+		write_mask.setElement<1>();
+		write_mask.setElement<2>();
+	}
+	if (op.mWriteAlpha)
+	{
+		write_mask.setElement<3>();
+	}
+
+	const U8* image_data = op.mImage.notNull() ? op.mImage->getData() : NULL;
+	const S32 components = op.mImage.notNull() ? op.mImage->getComponents() : 0;
+	fetch_row_func_t fetch = NULL;
+	if (image_data)
+	{
+		fetch = get_fetch_row_func(components, op.mAlphaOnly);
+		color.mul(1.f / 255.f);
+	}
+	else
+	{
+		// A plain rectangle has the same source color everywhere.
+		for (S32 x = 0; x < mWidth; ++x)
+		{
+			src_row[x] = color;
+		}
+	}
+	blend_row_func_t blend = get_blend_row_func(op.mSrcFactor, op.mDstFactor);
+
+	for (S32 y = begin_row; y < end_row; ++y)
+	{
+		LLVector4a* dst = mPixels + y * mWidth;
+		if (fetch)
+		{
+			fetch(src_row, image_data + y * mWidth * components, mWidth, color);
+		}
+		if (blend)
+		{
+			blend(dst, src_row, mWidth, minimum_alpha, write_mask);
+		}
+		else
+		{
+			// Any other pair decides per pixel.
+			for (S32 x = 0; x < mWidth; ++x)
+			{
+				blend_pixel(dst[x], src_row[x], op.mSrcFactor, op.mDstFactor, one, minimum_alpha, write_mask);
+			}
+		}
+	}
+}
+
+void LLTexLayerCompositor::readPixels(LLImageRaw* image)
+{
+	flush();
+
+	llassert(image);
+	if (image->getWidth() != mWidth || image->getHeight() != mHeight || image->getComponents() != 4)
+	{
+		image->resize(mWidth, mHeight, 4);
+	}
+	U8* data = image->getData();
+	for (S32 i = 0; i < mWidth * mHeight; ++i, data += 4)
+	{
+		const F32* pixel = mPixels[i].getF32ptr();
+		for (S32 c = 0; c < 4; ++c)
+		{
+			data[c] = (U8)ll_round(pixel[c] * 255.f);
+		}
+	}
+}
+
+void LLTexLayerCompositor::readAlpha(U8* data)
+{
+	flush();
+
+	for (S32 i = 0; i < mWidth * mHeight; ++i)
+	{
+		data[i] = (U8)ll_round(mPixels[i][VW] * 255.f);
+	}
+}
+
+// static
+void LLTexLayerCompositor::setThreadCount(S32 count)
+{
+	sThreadCount = llclamp(count, 0, 16);
+}
@@ -0,0 +1,126 @@
+/**
+ * @file lltexlayercompositor.h
+ * @brief CPU implementation of the blending used to composite avatar texture layers.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLTEXLAYERCOMPOSITOR_H
+#define LL_LLTEXLAYERCOMPOSITOR_H
+
+#include <map>
+#include <vector>
+#include "llpointer.h"
+#include "llrender.h"
+#include "v4color.h"
+
+class LLImageRaw;
+class LLVector4a;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLTexLayerCompositor
+//
+// Software stand-in for the render target used by LLTexLayerSet::render().
+// It mirrors the small part of the gGL state machine that the layer code uses
+// (color mask, blend function, minimum alpha and full-target quads), so that
+// the CPU path in lltexlayer.cpp reads the same as the GL path.
+//
+// Draw calls are recorded and only executed on flush(), which splits the
+// target into horizontal bands and runs every recorded draw over each band,
+// spread over gJobSystem when helpers are allowed. Pixels never depend on
+// their neighbours, so the result is identical for any thread count.
+//
+// Only use from one thread at a time (normally the main thread).
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLTexLayerCompositor
+{
+public:
+	LLTexLayerCompositor(S32 width, S32 height);
+	~LLTexLayerCompositor();
+
+	S32					getWidth() const				{ return mWidth; }
+	S32					getHeight() const				{ return mHeight; }
+
+	// State, same meaning as the gGL calls with the same name.
+	void				setColorMask(bool write_color, bool write_alpha);
+	void				setSceneBlendType(LLRender::eBlendType type);
+	void				blendFunc(LLRender::eBlendFactor sfactor, LLRender::eBlendFactor dfactor);
+	void				setMinimumAlpha(F32 minimum_alpha)	{ mMinimumAlpha = minimum_alpha; }
+
+	// Equivalent of gl_rect_2d_simple(): fills the whole target with color.
+	void				drawRect(const LLColor4& color);
+	// Equivalent of gl_rect_2d_simple_tex(): stretches image over the whole target, modulated by color.
+	// Single channel images are sampled as luminance, or as alpha when alpha_only is set (GL_ALPHA textures).
+	void				drawImage(const LLImageRaw* image, const LLColor4& color, bool alpha_only = false);
+
+	// Executes all recorded draws.
+	void				flush();
+
+	// Copy the current contents of the target (after an implicit flush).
+	void				readPixels(LLImageRaw* image);
+	void				readAlpha(U8* data);
+
+	// Number of job system workers that may help the calling thread.
+	static void			setThreadCount(S32 count);
+	static S32			getThreadCount()				{ return sThreadCount; }
+
+private:
+	struct DrawOp
+	{
+		LLRender::eBlendFactor	mSrcFactor;
+		LLRender::eBlendFactor	mDstFactor;
+		bool					mWriteColor;
+		bool					mWriteAlpha;
+		bool					mAlphaOnly;
+		F32						mMinimumAlpha;
+		LLColor4				mColor;
+		LLPointer<LLImageRaw>	mImage;		// NULL for a plain rectangle; otherwise scaled to the target size.
+	};
+
+	void				addOp(const LLColor4& color, LLImageRaw* image, bool alpha_only);
+	// Executes the recorded draws on rows [begin_row, end_row). Called from job system workers.
+	void				executeRows(S32 begin_row, S32 end_row) const;
+	void				executeOp(const DrawOp& op, S32 begin_row, S32 end_row, LLVector4a* src_row) const;
+
+private:
+	S32						mWidth;
+	S32						mHeight;
+	LLVector4a*				mPixels;		// RGBA, bottom row first, like the GL render target.
+
+	bool					mWriteColor;
+	bool					mWriteAlpha;
+	LLRender::eBlendFactor	mSrcFactor;
+	LLRender::eBlendFactor	mDstFactor;
+	F32						mMinimumAlpha;
+
+	typedef std::vector<DrawOp> draw_op_list_t;
+	draw_op_list_t			mOps;
+
+	// Source images scaled to the target size, so that a texture used by several layers is only resampled once.
+	typedef std::map<const LLImageRaw*, LLPointer<LLImageRaw> > scaled_image_map_t;
+	scaled_image_map_t		mScaledImages;
+	std::vector<LLPointer<LLImageRaw> > mSourceImages;
+
+	static S32				sThreadCount;
+};
+
+#endif  // LL_LLTEXLAYERCOMPOSITOR_H
@@ -29,9 +29,11 @@
 #include "lltexlayerparams.h"
 
 #include "llavatarappearance.h"
+#include "lldatapacker.h"
 #include "llimagetga.h"
 #include "llquantize.h"
 #include "lltexlayer.h"
+#include "lltexlayercompositor.h"
 #include "lltexturemanagerbridge.h"
 #include "llrender2dutils.h"
 #include "llwearable.h"
@@ -372,6 +374,73 @@ BOOL LLTexLayerParamAlpha::render(S32 x, S32 y, S32 width, S32 height)
 	return success;
 }
 
+// Same as render(), but accumulates into the CPU compositor. Uses mStaticImageRaw directly
+// instead of the GL texture made from it.
+static LLTrace::BlockTimerStatHandle FTM_TEX_LAYER_PARAM_ALPHA_CPU("alpha render CPU");
+BOOL LLTexLayerParamAlpha::renderCPU(LLTexLayerCompositor& compositor)
+{
+	LL_RECORD_BLOCK_TIME(FTM_TEX_LAYER_PARAM_ALPHA_CPU);
+	BOOL success = TRUE;
+
+	if (!mTexLayer)
+	{
+		return success;
+	}
+
+	F32 effective_weight = (mTexLayer->getTexLayerSet()->getAvatarAppearance()->getSex() & getSex()) ? mCurWeight : getDefaultWeight();
+	BOOL weight_changed = effective_weight != mCachedEffectiveWeight;
+	if (getSkip())
+	{
+		return success;
+	}
+
+	LLTexLayerParamAlphaInfo *info = (LLTexLayerParamAlphaInfo *)getInfo();
+	if (info->mMultiplyBlend)
+	{
+		compositor.blendFunc(LLRender::BF_DEST_ALPHA, LLRender::BF_ZERO); // Multiplication: approximates a min() function
+	}
+	else
+	{
+		compositor.setSceneBlendType(LLRender::BT_ADD);  // Addition: approximates a max() function
+	}
+
+	if (!info->mStaticImageFileName.empty() && !mStaticImageInvalid)
+	{
+		if (mStaticImageTGA.isNull())
+		{
+			mStaticImageTGA = LLTexLayerStaticImageList::getInstance()->getImageTGA(info->mStaticImageFileName);
+			LLTexLayerSet::sHasCaches |= mStaticImageTGA.notNull() ? TRUE : FALSE;
+
+			if (mStaticImageTGA.isNull())
+			{
+				LL_WARNS() << "Unable to load static file: " << info->mStaticImageFileName << LL_ENDL;
+				mStaticImageInvalid = TRUE; // don't try again.
+				return FALSE;
+			}
+		}
+
+		if (mStaticImageRaw.isNull() || weight_changed)
+		{
+			mCachedEffectiveWeight = effective_weight;
+
+			// Applies domain and effective weight to data as it is decoded.
+			mStaticImageRaw = new LLImageRaw;
+			mStaticImageTGA->decodeAndProcess(mStaticImageRaw, info->mDomain, effective_weight);
+			// The GL texture, if any, is stale now.
+			mNeedsCreateTexture = TRUE;
+		}
+
+		// The processed image is GL_ALPHA in the GL path.
+		compositor.drawImage(mStaticImageRaw, LLColor4::white, true);
+	}
+	else
+	{
+		compositor.drawRect(LLColor4(0.f, 0.f, 0.f, effective_weight));
+	}
+
+	return success;
+}
+
 //-----------------------------------------------------------------------------
 // LLTexLayerParamAlphaInfo
 //-----------------------------------------------------------------------------
@@ -417,6 +486,32 @@ BOOL LLTexLayerParamAlphaInfo::parseXml(LLXmlTreeNode* node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLTexLayerParamAlphaInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLViewerVisualParamInfo::pack(dp);
+	success &= dp.packString(mStaticImageFileName, "tga_file");
+	success &= dp.packU8((U8)mMultiplyBlend, "multiply_blend");
+	success &= dp.packU8((U8)mSkipIfZeroWeight, "skip_if_zero");
+	success &= dp.packF32(mDomain, "domain");
+	return success;
+}
+
+//virtual
+BOOL LLTexLayerParamAlphaInfo::unpack(LLDataPacker& dp)
+{
+	U8 multiply_blend = 0;
+	U8 skip_if_zero = 0;
+	BOOL success = LLViewerVisualParamInfo::unpack(dp);
+	success &= dp.unpackString(mStaticImageFileName, "tga_file");
+	success &= dp.unpackU8(multiply_blend, "multiply_blend");
+	success &= dp.unpackU8(skip_if_zero, "skip_if_zero");
+	success &= dp.unpackF32(mDomain, "domain");
+	mMultiplyBlend = multiply_blend;
+	mSkipIfZeroWeight = skip_if_zero;
+	return success;
+}
+
 
 
 
@@ -595,3 +690,35 @@ BOOL LLTexLayerParamColorInfo::parseXml(LLXmlTreeNode *node)
 	
 	return TRUE;
 }
+
+//virtual
+BOOL LLTexLayerParamColorInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLViewerVisualParamInfo::pack(dp);
+	success &= dp.packU8((U8)mOperation, "operation");
+	success &= dp.packS32(mNumColors, "num_colors");
+	for (S32 i = 0; i < mNumColors; ++i)
+	{
+		success &= dp.packColor4(mColors[i], "color");
+	}
+	return success;
+}
+
+//virtual
+BOOL LLTexLayerParamColorInfo::unpack(LLDataPacker& dp)
+{
+	U8 operation = 0;
+	BOOL success = LLViewerVisualParamInfo::unpack(dp);
+	success &= dp.unpackU8(operation, "operation");
+	success &= dp.unpackS32(mNumColors, "num_colors");
+	if (!success || operation >= LLTexLayerParamColor::OP_COUNT || mNumColors <= 0 || mNumColors > MAX_COLOR_VALUES)
+	{
+		return FALSE;
+	}
+	mOperation = (LLTexLayerParamColor::EColorOperation)operation;
+	for (S32 i = 0; i < mNumColors; ++i)
+	{
+		success &= dp.unpackColor4(mColors[i], "color");
+	}
+	return success;
+}
@@ -36,6 +36,7 @@ class LLImageRaw;
 class LLImageTGA;
 class LLTexLayer;
 class LLTexLayerInterface;
+class LLTexLayerCompositor;
 class LLGLTexture;
 class LLWearable;
 
@@ -100,6 +101,7 @@ public:
 
 	// New functions
 	BOOL					render( S32 x, S32 y, S32 width, S32 height );
+	BOOL					renderCPU(LLTexLayerCompositor& compositor);
 	BOOL					getSkip() const;
 	void					deleteCaches();
 	BOOL					getMultiplyBlend() const;
@@ -131,6 +133,8 @@ public:
 	/*virtual*/ ~LLTexLayerParamAlphaInfo() {};
 
 	/*virtual*/ BOOL parseXml(LLXmlTreeNode* node);
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 
 private:
 	std::string				mStaticImageFileName;
@@ -210,6 +214,8 @@ public:
 	LLTexLayerParamColorInfo();
 	virtual ~LLTexLayerParamColorInfo() {};
 	BOOL parseXml( LLXmlTreeNode* node );
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 	LLTexLayerParamColor::EColorOperation getOperation() const { return mOperation; }
 private:
 	enum { MAX_COLOR_VALUES = 20 };
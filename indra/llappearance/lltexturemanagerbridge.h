@@ -40,6 +40,8 @@ public:
 	virtual LLPointer<LLGLTexture> getLocalTexture(BOOL usemipmaps = TRUE, BOOL generate_gl_tex = TRUE) = 0;
 	virtual LLPointer<LLGLTexture> getLocalTexture(const U32 width, const U32 height, const U8 components, BOOL usemipmaps, BOOL generate_gl_tex = TRUE) = 0;
 	virtual LLGLTexture* getFetchedTexture(const LLUUID &image_id) = 0;
+	// Decoded pixels of tex, if the viewer keeps a copy of them. Used to composite bakes without GL.
+	virtual LLImageRaw* getRawImage(LLGLTexture* tex) { return NULL; }
 };
 
 extern LLTextureManagerBridge* gTextureManagerBridgep;
@@ -30,6 +30,7 @@
 #include "linden_common.h"
 
 #include "llviewervisualparam.h"
+#include "lldatapacker.h"
 #include "llxmltree.h"
 #include "llwearable.h"
 
@@ -112,6 +113,38 @@ BOOL LLViewerVisualParamInfo::parseXml(LLXmlTreeNode *node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLViewerVisualParamInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = LLVisualParamInfo::pack(dp);
+	success &= dp.packS32(mWearableType, "wearable");
+	success &= dp.packU8((U8)mCrossWearable, "cross_wearable");
+	success &= dp.packString(mEditGroup, "edit_group");
+	success &= dp.packF32(mCamDist, "camera_distance");
+	success &= dp.packF32(mCamAngle, "camera_angle");
+	success &= dp.packF32(mCamElevation, "camera_elevation");
+	success &= dp.packString(mCamTargetName, "camera_target");
+	success &= dp.packF32(mEditGroupDisplayOrder, "edit_group_order");
+	return success;
+}
+
+//virtual
+BOOL LLViewerVisualParamInfo::unpack(LLDataPacker& dp)
+{
+	U8 cross_wearable = 0;
+	BOOL success = LLVisualParamInfo::unpack(dp);
+	success &= dp.unpackS32(mWearableType, "wearable");
+	success &= dp.unpackU8(cross_wearable, "cross_wearable");
+	success &= dp.unpackString(mEditGroup, "edit_group");
+	success &= dp.unpackF32(mCamDist, "camera_distance");
+	success &= dp.unpackF32(mCamAngle, "camera_angle");
+	success &= dp.unpackF32(mCamElevation, "camera_elevation");
+	success &= dp.unpackString(mCamTargetName, "camera_target");
+	success &= dp.unpackF32(mEditGroupDisplayOrder, "edit_group_order");
+	mCrossWearable = cross_wearable;
+	return success;
+}
+
 /*virtual*/ void LLViewerVisualParamInfo::toStream(std::ostream &out)
 {
 	LLVisualParamInfo::toStream(out);
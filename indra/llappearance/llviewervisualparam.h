@@ -44,6 +44,8 @@ public:
 	/*virtual*/ ~LLViewerVisualParamInfo();
 	
 	/*virtual*/ BOOL parseXml(LLXmlTreeNode* node);
+	/*virtual*/ BOOL pack(LLDataPacker& dp) const;
+	/*virtual*/ BOOL unpack(LLDataPacker& dp);
 
 	/*virtual*/ void toStream(std::ostream &out);
 
@@ -0,0 +1,127 @@
+/**
+ * @file lltexlayercompositor_test.cpp
+ * @brief Checks that the CPU bake compositor gives the same pixels for any
+ *        number of workers, and the pixels the GL blending would.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "lltexlayercompositor.h"
+#include "llimage.h"
+#include "lljobsystem.h"
+
+namespace
+{
+	const S32 SIZE = 64;
+
+	// A layer set like the ones of a bake: a base color, a tattoo like layer
+	// blended over it, a multiplied texture and an alpha mask.  The images are
+	// the size of the target, so that no resampling gets in the way:
+	//   tattoo: red, transparent on rows 0-15, alpha 0.2 on rows 16-47 and opaque above
+	//   tint:   red 1 on columns 0-31 and 0.4 right of them, green and blue 1
+	//   mask:   1 on columns 0-15, 0 right of them
+	LLPointer<LLImageRaw> composite()
+	{
+		LLPointer<LLImageRaw> tattoo = new LLImageRaw(SIZE, SIZE, 4);
+		LLPointer<LLImageRaw> tint = new LLImageRaw(SIZE, SIZE, 3);
+		LLPointer<LLImageRaw> mask = new LLImageRaw(SIZE, SIZE, 1);
+		for (S32 y = 0; y < SIZE; ++y)
+		{
+			for (S32 x = 0; x < SIZE; ++x)
+			{
+				U8* texel = tattoo->getData() + (y * SIZE + x) * 4;
+				texel[0] = 255;
+				texel[1] = 0;
+				texel[2] = 0;
+				texel[3] = y < 16 ? 0 : y < 48 ? 51 : 255;
+
+				texel = tint->getData() + (y * SIZE + x) * 3;
+				texel[0] = x < 32 ? 255 : 102;
+				texel[1] = 255;
+				texel[2] = 255;
+
+				mask->getData()[y * SIZE + x] = x < 16 ? 255 : 0;
+			}
+		}
+
+		LLTexLayerCompositor compositor(SIZE, SIZE);
+		compositor.setSceneBlendType(LLRender::BT_REPLACE);
+		compositor.drawRect(LLColor4(0.5f, 0.25f, 1.f, 1.f));
+		compositor.setSceneBlendType(LLRender::BT_ALPHA);
+		compositor.drawImage(tattoo, LLColor4::white);
+		compositor.setSceneBlendType(LLRender::BT_MULT);
+		compositor.drawImage(tint, LLColor4::white);
+		compositor.setColorMask(false, true);
+		compositor.setSceneBlendType(LLRender::BT_REPLACE);
+		compositor.drawImage(mask, LLColor4::white, true);
+
+		LLPointer<LLImageRaw> result = new LLImageRaw(SIZE, SIZE, 4);
+		compositor.readPixels(result);
+		return result;
+	}
+
+	std::string pixel_at(const LLImageRaw* image, S32 x, S32 y)
+	{
+		const U8* pixel = image->getData() + (y * SIZE + x) * 4;
+		return llformat("%d %d %d %d", pixel[0], pixel[1], pixel[2], pixel[3]);
+	}
+}
+
+namespace tut
+{
+	struct texlayercompositor_test
+	{
+	};
+	typedef test_group<texlayercompositor_test> texlayercompositor_group_t;
+	typedef texlayercompositor_group_t::object texlayercompositor_object_t;
+	tut::texlayercompositor_group_t texlayercompositor_instance("tex_layer_compositor");
+
+	// The same layers give the same pixels on the calling thread alone and
+	// split over workers, and those are the pixels the GL blending gives.
+	template<> template<>
+	void texlayercompositor_object_t::test<1>()
+	{
+		LLTexLayerCompositor::setThreadCount(0);
+		LLPointer<LLImageRaw> alone = composite();
+
+		LLJobSystem jobs("Compositor Test", 3);
+		gJobSystem = &jobs;
+		LLTexLayerCompositor::setThreadCount(3);
+		LLPointer<LLImageRaw> helped = composite();
+		LLTexLayerCompositor::setThreadCount(0);
+		gJobSystem = NULL;
+
+		ensure("same pixels", !memcmp(alone->getData(), helped->getData(), alone->getDataSize()));
+
+		// Transparent tattoo, no tint, masked in
+		ensure_equals("rows 0-15, column 0", pixel_at(alone, 0, 0), "128 64 255 255");
+		// Tattoo at 0.2 over the base, red tinted by 0.4, masked out
+		ensure_equals("rows 16-47, column 40", pixel_at(alone, 40, 20), "61 51 204 214");
+		// Opaque tattoo, masked in
+		ensure_equals("rows 48-63, column 8", pixel_at(alone, 8, 56), "255 0 0 255");
+		// Opaque tattoo, red tinted by 0.4, masked out
+		ensure_equals("rows 48-63, column 40", pixel_at(alone, 40, 56), "102 0 0 255");
+	}
+}
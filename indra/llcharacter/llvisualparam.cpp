@@ -30,6 +30,7 @@
 #include "linden_common.h"
 
 #include "llvisualparam.h"
+#include "lldatapacker.h"
 
 //-----------------------------------------------------------------------------
 // LLVisualParamInfo()
@@ -141,6 +142,46 @@ BOOL LLVisualParamInfo::parseXml(LLXmlTreeNode *node)
 	return TRUE;
 }
 
+//virtual
+BOOL LLVisualParamInfo::pack(LLDataPacker& dp) const
+{
+	BOOL success = dp.packS32(mID, "id");
+	success &= dp.packString(mName, "name");
+	success &= dp.packString(mDisplayName, "display_name");
+	success &= dp.packString(mMinName, "min_name");
+	success &= dp.packString(mMaxName, "max_name");
+	success &= dp.packU8((U8)mGroup, "group");
+	success &= dp.packF32(mMinWeight, "min_weight");
+	success &= dp.packF32(mMaxWeight, "max_weight");
+	success &= dp.packF32(mDefaultWeight, "default_weight");
+	success &= dp.packU8((U8)mSex, "sex");
+	return success;
+}
+
+//virtual
+BOOL LLVisualParamInfo::unpack(LLDataPacker& dp)
+{
+	U8 group = 0;
+	U8 sex = 0;
+	BOOL success = dp.unpackS32(mID, "id");
+	success &= dp.unpackString(mName, "name");
+	success &= dp.unpackString(mDisplayName, "display_name");
+	success &= dp.unpackString(mMinName, "min_name");
+	success &= dp.unpackString(mMaxName, "max_name");
+	success &= dp.unpackU8(group, "group");
+	success &= dp.unpackF32(mMinWeight, "min_weight");
+	success &= dp.unpackF32(mMaxWeight, "max_weight");
+	success &= dp.unpackF32(mDefaultWeight, "default_weight");
+	success &= dp.unpackU8(sex, "sex");
+	if (group >= NUM_VISUAL_PARAM_GROUPS || sex < SEX_FEMALE || sex > SEX_BOTH)
+	{
+		return FALSE;
+	}
+	mGroup = (EVisualParamGroup)group;
+	mSex = (ESex)sex;
+	return success;
+}
+
 //virtual
 void LLVisualParamInfo::toStream(std::ostream &out)
 {
@@ -31,6 +31,7 @@
 #include "llstring.h"
 #include "llxmltree.h"
 
+class LLDataPacker;
 class LLPolyMesh;
 class LLXmlTreeNode;
 
@@ -75,6 +76,10 @@ public:
 
 	virtual BOOL parseXml(LLXmlTreeNode *node);
 
+	// Binary form of what parseXml() produced, for the avatar definition cache.
+	virtual BOOL pack(LLDataPacker& dp) const;
+	virtual BOOL unpack(LLDataPacker& dp);
+
 	S32 getID() const { return mID; }
 
 	virtual void toStream(std::ostream &out);
@@ -51,6 +51,7 @@
 #include "lltimer.h"
 
 #include "aithreadsafe.h"
+#include "llthread.h"
 
 namespace {
 #if LL_WINDOWS
@@ -361,7 +362,9 @@ namespace
 
 	typedef std::map<std::string, LLError::ELevel> LevelMap;
 	typedef std::vector<LLError::RecorderPtr> Recorders;
-	typedef std::vector<LLError::CallSite*> CallSiteVector;
+
+	// Bumped whenever the recorders change, for the log sink's copy of them
+	std::atomic<U32> gRecordersGeneration(0);
 
 	class Globals
 	{
@@ -370,15 +373,12 @@ namespace
 		std::ostringstream messageStream;
 		bool messageStreamInUse;
 
-		void addCallSite(LLError::CallSite&);
 		void invalidateCallSites();
 
 		static AIThreadSafeSimple<Globals>& get();
 			// return the one instance of the globals
 
 	private:
-		CallSiteVector callSites;
-		
 		friend class AIThreadSafeSimpleDC<Globals>;		// Calls constructor.
 		friend class AIThreadSafeSimple<Globals>;		// Calls destructor.
 		
@@ -387,26 +387,15 @@ namespace
 
 	Globals::Globals()
 		: messageStream(),
-		messageStreamInUse(false),
-		callSites()
+		messageStreamInUse(false)
 	{
 	}
 
-	void Globals::addCallSite(LLError::CallSite& site)
-	{
-		callSites.push_back(&site);
-	}
-	
 	void Globals::invalidateCallSites()
 	{
-		for (CallSiteVector::const_iterator i = callSites.begin();
-			 i != callSites.end();
-			 ++i)
-		{
-			(*i)->invalidate();
-		}
-		
-		callSites.clear();
+		// Call sites compare their cached decision's generation with this
+		// one, so there is no list of them to walk.
+		++LLError::Log::sGeneration;
 	}
 	
 	AIThreadSafeSimple<Globals>& Globals::get()
@@ -439,7 +428,7 @@ namespace LLError
 		LevelMap                            mClassLevelMap;
 		LevelMap                            mFileLevelMap;
 		LevelMap                            mTagLevelMap;
-		std::map<std::string, unsigned int> mUniqueLogMessages;
+		std::map<U64, unsigned int>         mUniqueLogMessages;	// by message hash
 		
 		LLError::FatalFunction              mCrashFunction;
 		LLError::TimeFunction               mTimeFunction;
@@ -519,6 +508,7 @@ namespace LLError
 	void Settings::reset()
 	{
 		AIAccess<Globals>(Globals::get())->invalidateCallSites();
+		++gRecordersGeneration;
 		mSettingsConfig = new SettingsConfig();
 	}
 	
@@ -532,6 +522,7 @@ namespace LLError
 	void Settings::restore(SettingsStoragePtr pSettingsStorage)
 	{
 		AIAccess<Globals>(Globals::get())->invalidateCallSites();
+		++gRecordersGeneration;
 		SettingsConfigPtr newSettingsConfig(dynamic_cast<SettingsConfig *>(pSettingsStorage.get()));
 		mSettingsConfig = newSettingsConfig;
 	}
@@ -552,11 +543,10 @@ namespace LLError
 		mLine(line),
 		mClassInfo(class_info),
 		mFunction(function),
-		mCached(false),
-		mShouldLog(false),
 		mPrintOnce(printOnce),
 		mTags(new const char*[tag_count]),
-		mTagCount(tag_count)
+		mTagCount(tag_count),
+		mCachedState(0)
 	{
 		for (size_t i = 0; i < tag_count; i++)
 		{
@@ -603,7 +593,7 @@ namespace LLError
 
 	void CallSite::invalidate()
 	{
-		mCached = false; 
+		mCachedState.store(0, std::memory_order_relaxed);
 	}
 }
 
@@ -873,6 +863,7 @@ namespace LLError
 		}
 		SettingsConfigPtr s = settings_w->getSettingsConfig();
 		s->mRecorders.push_back(recorder);
+		++gRecordersGeneration;
 	}
 	
 	void addRecorder(RecorderPtr recorder)
@@ -889,6 +880,7 @@ namespace LLError
 		SettingsConfigPtr s = settings_w->getSettingsConfig();
 		s->mRecorders.erase(std::remove(s->mRecorders.begin(), s->mRecorders.end(), recorder),
 							s->mRecorders.end());
+		++gRecordersGeneration;
 	}
 
 	void removeRecorder(RecorderPtr recorder)
@@ -950,27 +942,26 @@ namespace LLError
 
 namespace
 {
-	void writeToRecorders(AIAccess<LLError::Settings>& settings_w, const LLError::CallSite& site, const std::string& message, bool show_location = true, bool show_time = true, bool show_tags = true, bool show_level = true, bool show_function = true)
+	void writeToRecorders(const Recorders& recorders, bool print_location, const std::string& time, const LLError::CallSite& site, const std::string& message, bool show_location = true, bool show_time = true, bool show_tags = true, bool show_level = true, bool show_function = true)
 	{
 		LLError::ELevel level = site.mLevel;
-		LLError::SettingsConfigPtr s = settings_w->getSettingsConfig();
 	
-		for (Recorders::const_iterator i = s->mRecorders.begin();
-			i != s->mRecorders.end();
+		for (Recorders::const_iterator i = recorders.begin();
+			i != recorders.end();
 			++i)
 		{
 			LLError::RecorderPtr r = *i;
 			
 			std::ostringstream message_stream;
 
-			if (show_location && (r->wantsLocation() || level == LLError::LEVEL_ERROR || s->mPrintLocation))
+			if (show_location && (r->wantsLocation() || level == LLError::LEVEL_ERROR || print_location))
 			{
 				message_stream << site.mLocationString << " ";
 			}
 
-			if (show_time && r->wantsTime() && s->mTimeFunction != NULL)
+			if (show_time && r->wantsTime() && !time.empty())
 			{
-				message_stream << s->mTimeFunction() << " ";
+				message_stream << time << " ";
 			}
 
 			if (show_level && r->wantsLevel())
@@ -999,12 +990,277 @@ namespace
 			r->recordMessage(level, message_stream.str());
 		}
 	}
+
+	void writeToRecorders(AIAccess<LLError::Settings>& settings_w, const LLError::CallSite& site, const std::string& message, bool show_location = true, bool show_time = true, bool show_tags = true, bool show_level = true, bool show_function = true)
+	{
+		LLError::SettingsConfigPtr s = settings_w->getSettingsConfig();
+		std::string time;
+		if (show_time && s->mTimeFunction != NULL)
+		{
+			time = s->mTimeFunction();
+		}
+		writeToRecorders(s->mRecorders, s->mPrintLocation, time, site, message, show_location, show_time, show_tags, show_level, show_function);
+	}
+
+	// A message that passed filtering, on its way to the recorders.  The time
+	// is taken when the message is logged, not when it is written.
+	struct LogEntry
+	{
+		const LLError::CallSite*	mSite;
+		std::string					mMessage;
+		std::string					mTime;
+		bool						mShowFunction;
+
+		void swap(LogEntry& other)
+		{
+			std::swap(mSite, other.mSite);
+			mMessage.swap(other.mMessage);
+			mTime.swap(other.mTime);
+			std::swap(mShowFunction, other.mShowFunction);
+		}
+	};
+
+	// Bounded lock-free queue of LogEntry, for any number of producers and a
+	// single consumer.  Each cell carries a sequence number that tells whose
+	// turn it is: a producer claims the cell at the tail with a compare and
+	// swap and publishes it by advancing its sequence, the consumer frees it
+	// by advancing it by a lap.
+	class LogQueue
+	{
+	public:
+		enum { SIZE = 4096 };	// must be a power of two
+
+		LogQueue() : mHead(0), mTail(0)
+		{
+			for (U32 i = 0; i < SIZE; ++i)
+			{
+				mCells[i].mSequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		// Swaps entry into the queue; returns false if it is full.
+		bool push(LogEntry& entry)
+		{
+			U32 pos = mTail.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				Cell& cell = mCells[pos & (SIZE - 1)];
+				S32 diff = (S32)(cell.mSequence.load(std::memory_order_acquire) - pos);
+				if (diff == 0)
+				{
+					if (mTail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+					{
+						cell.mEntry.swap(entry);
+						cell.mSequence.store(pos + 1, std::memory_order_release);
+						return true;
+					}
+				}
+				else if (diff < 0)
+				{
+					return false;
+				}
+				else
+				{
+					pos = mTail.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		// Consumer only.
+		bool pop(LogEntry& entry)
+		{
+			U32 pos = mHead.load(std::memory_order_relaxed);
+			Cell& cell = mCells[pos & (SIZE - 1)];
+			if (cell.mSequence.load(std::memory_order_acquire) != pos + 1)
+			{
+				return false;
+			}
+			entry.swap(cell.mEntry);
+			cell.mSequence.store(pos + SIZE, std::memory_order_release);
+			mHead.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		bool empty() const
+		{
+			U32 pos = mHead.load(std::memory_order_acquire);
+			return mCells[pos & (SIZE - 1)].mSequence.load(std::memory_order_acquire) != pos + 1;
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<U32>	mSequence;
+			LogEntry			mEntry;
+		};
+		Cell				mCells[SIZE];
+		std::atomic<U32>	mHead;
+		std::atomic<U32>	mTail;
+	};
+
+	// Calls the recorders for the messages of LogQueue.  It works from its
+	// own copy of the recorders, refreshed when they change, so it only needs
+	// the settings lock for that.
+	class LogSink : public LLThread
+	{
+	public:
+		LogSink() :
+			LLThread("Log sink"),
+			mIdle(false),
+			mPushed(0),
+			mWritten(0),
+			mRecordersGeneration(gRecordersGeneration.load() - 1),
+			mPrintLocation(false)
+		{
+		}
+
+		// Called with gLogMutex locked.  Returns false if the queue is full,
+		// after waking the sink to make room; see wait_for_log_sink().
+		bool push(LogEntry& entry)
+		{
+			if (!mQueue.push(entry))
+			{
+				wake();
+				return false;
+			}
+			mPushed.store(mPushed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (mIdle.load(std::memory_order_relaxed))
+			{
+				wake();
+			}
+			return true;
+		}
+
+		// Called with gLogMutex locked, so once this returns true nothing is
+		// pushed and the sink is done with the recorders until it's released.
+		// Wakes the sink if it isn't.
+		bool isWritten()
+		{
+			if (mWritten.load(std::memory_order_acquire) == mPushed.load(std::memory_order_relaxed))
+			{
+				return true;
+			}
+			wake();
+			return false;
+		}
+
+		// Doesn't need gLogMutex.  Waits at most max_ms milliseconds for the
+		// messages pushed so far to be written; returns whether they were.
+		bool waitUntilWritten(S32 max_ms)
+		{
+			U32 pushed = mPushed.load(std::memory_order_relaxed);
+			for (S32 waited = 0; (S32)(mWritten.load(std::memory_order_acquire) - pushed) < 0; ++waited)
+			{
+				if (waited >= max_ms)
+				{
+					return false;
+				}
+				wake();
+				ms_sleep(1);
+			}
+			return true;
+		}
+
+		// Consumer side, the sink thread or, once it stopped, its owner.
+		void writeQueued()
+		{
+			LogEntry entry;
+			while (mQueue.pop(entry))
+			{
+				refreshRecorders();
+				writeToRecorders(mRecorders, mPrintLocation, entry.mTime, *entry.mSite, entry.mMessage,
+								 true, true, true, true, entry.mShowFunction);
+				mWritten.fetch_add(1, std::memory_order_release);
+			}
+		}
+
+		void releaseRecorders();
+
+		// A recorder that logs from the sink can't wait for the sink.
+		static bool onSinkThread()			{ return sOnSinkThread; }
+
+	protected:
+		/*virtual*/ bool runCondition()
+		{
+			return !mQueue.empty();
+		}
+
+		/*virtual*/ void run()
+		{
+			sOnSinkThread = true;
+			while (!isQuitting())
+			{
+				mIdle.store(true, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				checkPause();
+				mIdle.store(false, std::memory_order_relaxed);
+
+				writeQueued();
+			}
+			writeQueued();
+		}
+
+	private:
+		void refreshRecorders();
+
+	private:
+		LogQueue			mQueue;
+		std::atomic<bool>	mIdle;
+		std::atomic<U32>	mPushed;		// only changed with gLogMutex locked
+		std::atomic<U32>	mWritten;
+
+		U32					mRecordersGeneration;
+		Recorders			mRecorders;
+		bool				mPrintLocation;
+
+		static thread_local bool sOnSinkThread;
+	};
+
+	thread_local bool LogSink::sOnSinkThread = false;
+
+	void LogSink::refreshRecorders()
+	{
+		if (gRecordersGeneration.load(std::memory_order_acquire) == mRecordersGeneration)
+		{
+			return;
+		}
+		AIAccess<LLError::Settings> settings_w(LLError::Settings::get());
+		LLError::SettingsConfigPtr s = settings_w->getSettingsConfig();
+		mRecordersGeneration = gRecordersGeneration.load(std::memory_order_acquire);
+		mRecorders = s->mRecorders;
+		mPrintLocation = s->mPrintLocation;
+	}
+
+	void LogSink::releaseRecorders()
+	{
+		mRecorders.clear();
+	}
+
+	// The running sink, if any.  Only changed with gLogMutex locked.
+	LogSink* gLogSink = NULL;
+
+	// 64-bit FNV-1a, to remember the messages that are only printed once
+	// without keeping them.
+	U64 message_hash(const std::string& message)
+	{
+		U64 hash = 14695981039346656037ULL;
+		for (std::string::const_iterator i = message.begin(); i != message.end(); ++i)
+		{
+			hash = (hash ^ (U8)*i) * 1099511628211ULL;
+		}
+		return hash;
+	}
 }
 
 
 LLGlobalMutex gLogMutex;
 LLGlobalMutex gCallStacksLogMutex;
 
+// Starts at one: a call site state of zero is never current.
+std::atomic<U32> LLError::Log::sGeneration(1);
+
 namespace {
 	bool checkLevelMap(const LevelMap& map, const std::string& key,
 						LLError::ELevel& level)
@@ -1066,25 +1322,11 @@ namespace {
 			return;
 		}
 		
-		const int MAX_RETRIES = 5;
-		for (int attempts = 0; attempts < MAX_RETRIES; ++attempts)
-		{
-			if (gLogMutex.try_lock())
-			{
-				mLocked = true;
-				mOK = true;
-				return;
-			}
-
-			ms_sleep(1);
-			//apr_thread_yield();
-				// Just yielding won't necessarily work, I had problems with
-				// this on Linux - doug 12/02/04
-		}
-
-		// We're hosed, we can't get the mutex.  Blah.
-		std::cerr << "LogLock::LogLock: failed to get mutex for log"
-					<< std::endl;
+		// Nobody holds it for long: waiting for the sink is done without it,
+		// see wait_for_log_sink(), so block rather than lose the message.
+		gLogMutex.lock();
+		mLocked = true;
+		mOK = true;
 	}
 	
 	LogLock::~LogLock()
@@ -1094,6 +1336,17 @@ namespace {
 			gLogMutex.unlock();
 		}
 	}
+
+	// Called with gLogMutex locked while gLogSink has to catch up.  Lets
+	// the sink work for a bit without gLogMutex, so that the other threads
+	// can log meanwhile, and returns with it locked again; gLogSink may have
+	// changed by then.
+	void wait_for_log_sink()
+	{
+		gLogMutex.unlock();
+		ms_sleep(1);
+		gLogMutex.lock();
+	}
 }
 
 namespace LLError
@@ -1106,6 +1359,10 @@ namespace LLError
 			return false;
 		}
 		
+		// A settings change while this runs makes the result stale, and
+		// the call site will ask again.
+		U32 generation = sGeneration.load(std::memory_order_acquire);
+
 		AIAccess<Settings> settings_w(Settings::get());
 		SettingsConfigPtr s = settings_w->getSettingsConfig();
 		
@@ -1140,9 +1397,9 @@ namespace LLError
 			? checkLevelMap(s->mTagLevelMap, site.mTags, site.mTagCount, compareLevel) 
 			: false);
 
-		site.mCached = true;
-		AIAccess<Globals>(Globals::get())->addCallSite(site);
-		return site.mShouldLog = site.mLevel >= compareLevel;
+		bool should_log = site.mLevel >= compareLevel;
+		site.mCachedState.store((generation << 1) | (should_log ? 1 : 0), std::memory_order_relaxed);
+		return should_log;
 	}
 
 
@@ -1218,61 +1475,158 @@ namespace LLError
 			}
 		}
 
-		AIAccess<Settings> settings_w(Settings::get());
-		SettingsConfigPtr s = settings_w->getSettingsConfig();
-		
-		if (site.mLevel == LEVEL_ERROR)
+		if (site.mLevel == LEVEL_ERROR && !LogSink::onSinkThread())
 		{
-			writeToRecorders(settings_w, site, "error", true, true, true, false, false);
+			// Everything logged before the error goes out before it, and the
+			// sink stays off the recorders while the error is written here.
+			while (gLogSink && !gLogSink->isWritten())
+			{
+				wait_for_log_sink();
+			}
 		}
-		
-		std::ostringstream message_stream;
 
-		bool need_function = site.mFunction;
-		if (need_function && !site.mTagString.empty())
+		LogEntry entry;
 		{
-#if LL_DEBUG
-			// Suppress printing mFunction if mBroadTag is set, starts with
-			// "Plugin " and ends with "child": a debug message from a plugin.
-			size_t taglen = site.mTagString.length();
-			if (taglen >= 12 && strncmp(site.mTagString.c_str(), "Plugin ", 7) == 0 &&
-				strcmp(site.mTagString.c_str() + taglen - 5, "child") == 0)
+			AIAccess<Settings> settings_w(Settings::get());
+			SettingsConfigPtr s = settings_w->getSettingsConfig();
+			
+			if (site.mLevel == LEVEL_ERROR)
 			{
-				need_function = false;
+				writeToRecorders(settings_w, site, "error", true, true, true, false, false);
 			}
+			
+			std::ostringstream message_stream;
+
+			bool need_function = site.mFunction;
+			if (need_function && !site.mTagString.empty())
+			{
+#if LL_DEBUG
+				// Suppress printing mFunction if mBroadTag is set, starts with
+				// "Plugin " and ends with "child": a debug message from a plugin.
+				size_t taglen = site.mTagString.length();
+				if (taglen >= 12 && strncmp(site.mTagString.c_str(), "Plugin ", 7) == 0 &&
+					strcmp(site.mTagString.c_str() + taglen - 5, "child") == 0)
+				{
+					need_function = false;
+				}
 #endif
-		}
+			}
 
-		if (site.mPrintOnce)
-		{
-			std::map<std::string, unsigned int>::iterator messageIter = s->mUniqueLogMessages.find(message);
-			if (messageIter != s->mUniqueLogMessages.end())
+			if (site.mPrintOnce)
 			{
-				messageIter->second++;
-				unsigned int num_messages = messageIter->second;
-				if (num_messages == 10 || num_messages == 50 || (num_messages % 100) == 0)
+				std::map<U64, unsigned int>::iterator messageIter = s->mUniqueLogMessages.find(message_hash(message));
+				if (messageIter != s->mUniqueLogMessages.end())
 				{
-					message_stream << "ONCE (" << num_messages << "th time seen): ";
-				} 
-				else
+					messageIter->second++;
+					unsigned int num_messages = messageIter->second;
+					if (num_messages == 10 || num_messages == 50 || (num_messages % 100) == 0)
+					{
+						message_stream << "ONCE (" << num_messages << "th time seen): ";
+					} 
+					else
+					{
+						return;
+					}
+				}
+				else 
+				{
+					message_stream << "ONCE: ";
+					s->mUniqueLogMessages[message_hash(message)] = 1;
+				}
+			}
+			
+			message_stream << message;
+
+			// A recorder logging from the sink writes its message right away:
+			// waiting for room in the queue would wait for itself.
+			if (!gLogSink || site.mLevel == LEVEL_ERROR || LogSink::onSinkThread())
+			{
+				writeToRecorders(settings_w, site, message_stream.str(), true, true, true, true, need_function);
+				
+				if (site.mLevel == LEVEL_ERROR  &&  s->mCrashFunction)
 				{
-					return;
+					s->mCrashFunction(message_stream.str());
 				}
+				return;
 			}
-			else 
+
+			entry.mSite = &site;
+			entry.mMessage = message_stream.str();
+			if (s->mTimeFunction != NULL)
 			{
-				message_stream << "ONCE: ";
-				s->mUniqueLogMessages[message] = 1;
+				entry.mTime = s->mTimeFunction();
 			}
+			entry.mShowFunction = need_function;
 		}
-		
-		message_stream << message;
-		
-		writeToRecorders(settings_w, site, message_stream.str(), true, true, true, true, need_function);
-		
-		if (site.mLevel == LEVEL_ERROR  &&  s->mCrashFunction)
+
+		// The settings are released first: the sink may need them to pick up
+		// changed recorders before it makes room in the queue.  Waits for
+		// room rather than dropping the message.
+		while (gLogSink && !gLogSink->push(entry))
+		{
+			wait_for_log_sink();
+		}
+		if (!gLogSink)
+		{
+			// asynchronous logging was turned off while waiting
+			AIAccess<Settings> settings_w(Settings::get());
+			writeToRecorders(settings_w, site, entry.mMessage, true, true, true, true, entry.mShowFunction);
+		}
+	}
+}
+
+namespace LLError
+{
+	void setAsyncLogging(bool async)
+	{
+		if (async == getAsyncLogging())
+		{
+			return;
+		}
+
+		if (async)
+		{
+			LogSink* sink = new LogSink;
+			sink->start();
+			LLMutexLock lock(&gLogMutex);
+			gLogSink = sink;
+		}
+		else
+		{
+			LogSink* sink;
+			{
+				LLMutexLock lock(&gLogMutex);
+				sink = gLogSink;
+				gLogSink = NULL;
+			}
+			// Nothing is pushed any more; the thread writes what is left
+			// before it stops.
+			sink->shutdown();
+			sink->writeQueued();
+			{
+				// its copy of the recorders is released under the same
+				// lock as the original
+				AIAccess<Settings> settings_w(Settings::get());
+				sink->releaseRecorders();
+			}
+			delete sink;
+		}
+	}
+
+	bool getAsyncLogging()
+	{
+		LLMutexLock lock(&gLogMutex);
+		return gLogSink != NULL;
+	}
+
+	void flushAsyncLogging()
+	{
+		// The crashed thread may hold gLogMutex, or be the sink itself, so
+		// this takes no lock and gives up after a second.
+		LogSink* sink = gLogSink;
+		if (sink && !sink->waitUntilWritten(1000))
 		{
-			s->mCrashFunction(message_stream.str());
+			std::cerr << "LLError::flushAsyncLogging: gave up waiting for the log sink" << std::endl;
 		}
 	}
 }
@@ -28,6 +28,7 @@
 #ifndef LL_LLERROR_H
 #define LL_LLERROR_H
 
+#include <atomic>
 #include <sstream>
 #include <typeinfo>
 
@@ -194,6 +195,11 @@ namespace LLError
 		static std::ostringstream* out();
 		static void flush(std::ostringstream* out, char* message);
 		static void flush(std::ostringstream*, const CallSite&);
+
+		// Bumped by every change of the settings that decide what is
+		// logged; a call site's cached decision is only good for the
+		// generation it was made in.
+		static std::atomic<U32> sGeneration;
 	};
 	
 	struct LL_COMMON_API CallSite
@@ -217,8 +223,9 @@ namespace LLError
 #else // LL_LIBRARY_INCLUDE
 		bool shouldLog()
 		{ 
-			return mCached 
-					? mShouldLog 
+			U32 cached_state = mCachedState.load(std::memory_order_relaxed);
+			return (cached_state >> 1) == Log::sGeneration.load(std::memory_order_relaxed)
+					? (cached_state & 1)
 					: Log::shouldLog(*this); 
 		}
 			// this member function needs to be in-line for efficiency
@@ -239,8 +246,7 @@ namespace LLError
 		std::string				mLocationString,
 								mFunctionString,
 								mTagString;
-		bool					mCached,
-								mShouldLog;
+		std::atomic<U32>		mCachedState;	// generation << 1 | should log, 0 if not cached
 		
 		friend class Log;
 	};
@@ -178,6 +178,17 @@ namespace LLError
 	LL_COMMON_API std::string logFileName();
 		// returns name of current logging file, empty string if none
 
+	LL_COMMON_API void setAsyncLogging(bool async);
+		// When on, messages that pass filtering are handed to a sink thread
+		// through a bounded queue and the recorders are called from there,
+		// so that the logging thread doesn't wait for the disk.  Errors
+		// still go out synchronously, after everything queued before them.
+		// Turning it off writes whatever is still queued.
+	LL_COMMON_API bool getAsyncLogging();
+	LL_COMMON_API void flushAsyncLogging();
+		// For crash handlers: waits, for a second at most and without taking
+		// any lock, until the sink wrote what was queued so far.
+
 
 	/*
 		Utilities for use by the unit tests of LLError itself.
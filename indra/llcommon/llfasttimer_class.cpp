@@ -151,7 +151,9 @@
 #include "llsingleton.h"
 #include "lltreeiterators.h"
 #include "llsdserialize.h"
+#include "llthread.h"
 
+#include <atomic>
 #include <boost/bind/bind.hpp>
 
 
@@ -194,6 +196,15 @@ const int LLFastTimer::NamedTimer::HISTORY_NUM = 300;
 std::vector<LLFastTimer::FrameState>* LLFastTimer::sTimerInfos = NULL;
 U64				LLFastTimer::sTimerCycles = 0;
 U32				LLFastTimer::sTimerCalls = 0;
+bool			LLFastTimer::sTraceEvents = false;
+
+// NamedTimers by thread index.  NamedTimers are created during static
+// initialization, hence the function static.
+static std::vector<LLFastTimer::NamedTimer*>& get_timers_by_thread_index()
+{
+	static std::vector<LLFastTimer::NamedTimer*> sTimersByThreadIndex;
+	return sTimersByThreadIndex;
+}
 
 
 // FIXME: move these declarations to the relevant modules
@@ -400,6 +411,12 @@ std::string LLFastTimer::sClockType = "QueryPerformanceCounter";
 
 //static
 U64 LLFastTimer::countsPerSecond() // counts per second for the *32-bit* timer
+{
+	return countsPerSecond64() >> 8;
+}
+
+//static
+U64 LLFastTimer::countsPerSecond64() // counts per second for the 64-bit timer
 {
 #if USE_RDTSC
 	static U64 sCPUClockFrequency = U64(LLProcessorInfo().getCPUFrequency()*1000000.0);
@@ -412,7 +429,7 @@ U64 LLFastTimer::countsPerSecond() // counts per second for the *32-bit* timer
 		firstcall = false;
 	}
 #endif
-	return sCPUClockFrequency >> 8;
+	return sCPUClockFrequency;
 }
 
 LLFastTimer::FrameState::FrameState(LLFastTimer::NamedTimer* timerp)
@@ -439,6 +456,10 @@ LLFastTimer::NamedTimer::NamedTimer(const std::string& name)
 	mFrameStateIndex = frame_state_list.size();
 	getFrameStateList().push_back(FrameState(this));
 
+	std::vector<NamedTimer*>& timers_by_thread_index = get_timers_by_thread_index();
+	mThreadIndex = timers_by_thread_index.size();
+	timers_by_thread_index.push_back(this);
+
 	mCountHistory.resize(HISTORY_NUM);
 	mCallHistory.resize(HISTORY_NUM);
 }
@@ -947,6 +968,371 @@ LLFastTimer::LLFastTimer(LLFastTimer::FrameState* state)
 	mLastTimerData = LLFastTimer::sCurTimerData;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+//
+// Timers of other threads
+//
+
+// The timing data of one thread: its timer stack, the self time and calls of
+// every NamedTimer it ran and a ring of its most recent begin/end events.
+// The main thread only uses the ring, for its trace events.
+//
+// Only the owning thread writes to it.  getThreadSummaries() and
+// writeChromeTrace() read it without stopping the thread: the totals are
+// relaxed atomics and the ring head is published after the event it covers,
+// so a reader only has to drop the events that were overwritten, or were
+// being overwritten, while it was copying them.
+class LLFastTimer::ThreadTimers
+{
+public:
+	enum
+	{
+		MAX_TIMERS = 1024,		// NamedTimers with a higher thread index aren't totalled
+		MAX_DEPTH = 64,			// timers nested deeper aren't timed
+		TRACE_EVENTS = 8192		// must be a power of two
+	};
+
+	struct Event
+	{
+		U64			mTime;
+		NamedTimer*	mTimer;
+		bool		mBegin;
+	};
+
+	struct StackEntry
+	{
+		NamedTimer*	mTimer;
+		U64			mStartTime;
+		U64			mChildTime;
+	};
+
+	ThreadTimers() :
+		mMainThread(false),
+		mInUse(false),
+		mDepth(0),
+		mStartTime(0),
+		mEvents(NULL),
+		mHead(0)
+	{
+		for (S32 i = 0; i < MAX_TIMERS; ++i)
+		{
+			mSelfTime[i].store(0, std::memory_order_relaxed);
+			mCalls[i].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	// Called with sThreadTimersMutex locked, by the thread taking this slot
+	void acquire(const std::string& name, bool main_thread)
+	{
+		mName = name;
+		mMainThread = main_thread;
+		mInUse = true;
+		mDepth = 0;
+		for (S32 i = 0; i < MAX_TIMERS; ++i)
+		{
+			mSelfTime[i].store(0, std::memory_order_relaxed);
+			mCalls[i].store(0, std::memory_order_relaxed);
+		}
+		// the events of a previous owner are older than this
+		mStartTime.store(getCPUClockCount64(), std::memory_order_relaxed);
+	}
+
+	void push(U64 time, NamedTimer* timer, bool begin)
+	{
+		Event* events = mEvents.load(std::memory_order_relaxed);
+		if (!events)
+		{
+			// only threads that are traced pay for the ring
+			events = new Event[TRACE_EVENTS];
+			mEvents.store(events, std::memory_order_release);
+		}
+
+		U32 head = mHead.load(std::memory_order_relaxed);
+		Event& event = events[head & (TRACE_EVENTS - 1)];
+		event.mTime = time;
+		event.mTimer = timer;
+		event.mBegin = begin;
+		mHead.store(head + 1, std::memory_order_release);
+	}
+
+	// Copies the events still in the ring, oldest first
+	void copyEvents(std::vector<Event>& events) const
+	{
+		events.clear();
+		const Event* ring = mEvents.load(std::memory_order_acquire);
+		if (!ring)
+		{
+			return;
+		}
+
+		U32 head = mHead.load(std::memory_order_acquire);
+		U32 count = llmin(head, (U32)TRACE_EVENTS);
+		for (U32 i = head - count; i != head; ++i)
+		{
+			events.push_back(ring[i & (TRACE_EVENTS - 1)]);
+		}
+
+		// The owner may have written past head meanwhile, and is possibly
+		// halfway through the slot after the last one it published.  Once the
+		// ring has wrapped, each of those slots held one of the oldest events
+		// copied, so those are dropped.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		U32 overwritten = mHead.load(std::memory_order_relaxed) - head;
+		U32 reused = count + overwritten + 1;
+		if (reused > TRACE_EVENTS)
+		{
+			events.erase(events.begin(), events.begin() + llmin(reused - TRACE_EVENTS, count));
+		}
+	}
+
+	std::string				mName;			// under sThreadTimersMutex
+	bool					mMainThread;
+	bool					mInUse;			// under sThreadTimersMutex
+
+	StackEntry				mStack[MAX_DEPTH];
+	S32						mDepth;
+
+	std::atomic<U64>		mStartTime;
+	std::atomic<U64>		mSelfTime[MAX_TIMERS];
+	std::atomic<U32>		mCalls[MAX_TIMERS];
+
+	std::atomic<Event*>		mEvents;
+	std::atomic<U32>		mHead;
+};
+
+// Every ThreadTimers ever created; they are never freed, a thread that exits
+// leaves its slot to the next thread instead.
+static LLGlobalMutex sThreadTimersMutex;
+static std::vector<LLFastTimer::ThreadTimers*> sThreadTimers;
+static ll_thread_local LLFastTimer::ThreadTimers* tThreadTimers = NULL;
+
+static LLFastTimer::ThreadTimers* acquire_thread_timers(const std::string& name)
+{
+	LLMutexLock lock(&sThreadTimersMutex);
+
+	LLFastTimer::ThreadTimers* timers = NULL;
+	size_t index = 0;
+	for (; index < sThreadTimers.size(); ++index)
+	{
+		if (!sThreadTimers[index]->mInUse)
+		{
+			timers = sThreadTimers[index];
+			break;
+		}
+	}
+	if (!timers)
+	{
+		timers = new LLFastTimer::ThreadTimers;
+		sThreadTimers.push_back(timers);
+	}
+
+	bool main_thread = AIThreadID::in_main_thread();
+	if (!name.empty())
+	{
+		timers->acquire(name, main_thread);
+	}
+	else
+	{
+		timers->acquire(main_thread ? std::string("Main") : llformat("Thread %d", (S32)index + 1), main_thread);
+	}
+	tThreadTimers = timers;
+	return timers;
+}
+
+static LL_FORCE_INLINE LLFastTimer::ThreadTimers* get_thread_timers()
+{
+	LLFastTimer::ThreadTimers* timers = tThreadTimers;
+	return timers ? timers : acquire_thread_timers(LLStringUtil::null);
+}
+
+//static
+void LLFastTimer::startThreadTimer(NamedTimer* timer)
+{
+	ThreadTimers* timers = get_thread_timers();
+	U64 now = getCPUClockCount64();
+
+	S32 depth = timers->mDepth++;
+	if (depth < ThreadTimers::MAX_DEPTH)
+	{
+		ThreadTimers::StackEntry& entry = timers->mStack[depth];
+		entry.mTimer = timer;
+		entry.mStartTime = now;
+		entry.mChildTime = 0;
+
+		if (sTraceEvents)
+		{
+			timers->push(now, timer, true);
+		}
+	}
+}
+
+//static
+void LLFastTimer::stopThreadTimer()
+{
+	ThreadTimers* timers = tThreadTimers;
+	U64 now = getCPUClockCount64();
+
+	S32 depth = --timers->mDepth;
+	if (depth >= ThreadTimers::MAX_DEPTH)
+	{
+		return;
+	}
+
+	const ThreadTimers::StackEntry& entry = timers->mStack[depth];
+	U64 total_time = now - entry.mStartTime;
+	U32 index = entry.mTimer->mThreadIndex;
+	if (index < ThreadTimers::MAX_TIMERS)
+	{
+		// only this thread writes them, so there is no need for a locked add
+		timers->mSelfTime[index].store(timers->mSelfTime[index].load(std::memory_order_relaxed) + total_time - entry.mChildTime,
+									   std::memory_order_relaxed);
+		timers->mCalls[index].store(timers->mCalls[index].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+	if (depth > 0)
+	{
+		timers->mStack[depth - 1].mChildTime += total_time;
+	}
+
+	if (sTraceEvents)
+	{
+		timers->push(now, entry.mTimer, false);
+	}
+}
+
+//static
+void LLFastTimer::traceEvent(NamedTimer* timer, bool begin)
+{
+	get_thread_timers()->push(getCPUClockCount64(), timer, begin);
+}
+
+//static
+void LLFastTimer::setThreadName(const std::string& name)
+{
+	if (tThreadTimers)
+	{
+		LLMutexLock lock(&sThreadTimersMutex);
+		tThreadTimers->mName = name;
+	}
+	else
+	{
+		acquire_thread_timers(name);
+	}
+}
+
+//static
+void LLFastTimer::releaseThreadTimers()
+{
+	if (tThreadTimers)
+	{
+		LLMutexLock lock(&sThreadTimersMutex);
+		tThreadTimers->mInUse = false;
+		tThreadTimers = NULL;
+	}
+}
+
+//static
+void LLFastTimer::getThreadSummaries(std::vector<ThreadSummary>& summaries)
+{
+	summaries.clear();
+
+	LLMutexLock lock(&sThreadTimersMutex);
+	const std::vector<NamedTimer*>& timers_by_thread_index = get_timers_by_thread_index();
+	U32 num_timers = llmin((U32)timers_by_thread_index.size(), (U32)ThreadTimers::MAX_TIMERS);
+	for (std::vector<ThreadTimers*>::const_iterator iter = sThreadTimers.begin(); iter != sThreadTimers.end(); ++iter)
+	{
+		const ThreadTimers* timers = *iter;
+		if (!timers->mInUse || timers->mMainThread)
+		{
+			continue;
+		}
+
+		summaries.push_back(ThreadSummary());
+		ThreadSummary& summary = summaries.back();
+		summary.mName = timers->mName;
+		for (U32 i = 0; i < num_timers; ++i)
+		{
+			U32 calls = timers->mCalls[i].load(std::memory_order_relaxed);
+			if (calls)
+			{
+				ThreadTimerTotals totals;
+				totals.mTimer = timers_by_thread_index[i];
+				totals.mSelfTime = timers->mSelfTime[i].load(std::memory_order_relaxed);
+				totals.mCalls = calls;
+				summary.mTimers.push_back(totals);
+			}
+		}
+	}
+}
+
+static void write_json_string(std::ostream& os, const std::string& str)
+{
+	os << '"';
+	for (std::string::const_iterator iter = str.begin(); iter != str.end(); ++iter)
+	{
+		if (*iter == '"' || *iter == '\\')
+		{
+			os << '\\' << *iter;
+		}
+		else if ((U8)*iter >= 0x20)
+		{
+			os << *iter;
+		}
+	}
+	os << '"';
+}
+
+//static
+void LLFastTimer::writeChromeTrace(std::ostream& os, F64 seconds)
+{
+	const U64 now = getCPUClockCount64();
+	const U64 window = (U64)(seconds * (F64)countsPerSecond64());
+	const U64 window_start = now > window ? now - window : 0;
+	const F64 us_per_count = 1000000.0 / (F64)countsPerSecond64();
+
+	os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+
+	LLMutexLock lock(&sThreadTimersMutex);
+	std::vector<ThreadTimers::Event> events;
+	for (size_t t = 0; t < sThreadTimers.size(); ++t)
+	{
+		const ThreadTimers* timers = sThreadTimers[t];
+		timers->copyEvents(events);
+		if (events.empty())
+		{
+			continue;
+		}
+
+		const U64 start = llmax(window_start, timers->mStartTime.load(std::memory_order_relaxed));
+		const S32 tid = (S32)t + 1;
+
+		os << (first ? "" : ",") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << tid << ",\"args\":{\"name\":";
+		write_json_string(os, timers->mName);
+		os << "}}";
+		first = false;
+
+		// Ends without their begin in the window are dropped, begins
+		// without their end are left open.
+		S32 depth = 0;
+		for (std::vector<ThreadTimers::Event>::const_iterator iter = events.begin(); iter != events.end(); ++iter)
+		{
+			if (iter->mTime < start || (!iter->mBegin && !depth))
+			{
+				continue;
+			}
+			depth += iter->mBegin ? 1 : -1;
+
+			os << ",{\"name\":";
+			write_json_string(os, iter->mTimer->getName());
+			os << ",\"cat\":\"timer\",\"ph\":\"" << (iter->mBegin ? 'B' : 'E')
+			   << "\",\"ts\":" << llformat("%.3f", (F64)(iter->mTime - window_start) * us_per_count)
+			   << ",\"pid\":1,\"tid\":" << tid << "}";
+		}
+	}
+
+	os << "]}";
+}
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // Important note: These implementations must be FAST!
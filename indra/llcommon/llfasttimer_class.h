@@ -27,11 +27,11 @@
 #ifndef LL_FASTTIMER_CLASS_H
 #define LL_FASTTIMER_CLASS_H
 
+#include "aithreadid.h"
 #include "llinstancetracker.h"
 
 #define FAST_TIMER_ON 1
 #define TIME_FAST_TIMERS 0
-#define DEBUG_FAST_TIMER_THREADS 1
 
 class LLMutex;
 
@@ -93,6 +93,7 @@ public:
 		static NamedTimer& getRootNamedTimer();
 
 		S32 getFrameStateIndex() const { return mFrameStateIndex; }
+		U32 getThreadIndex() const { return mThreadIndex; }
 
 		FrameState& getFrameState() const;
 
@@ -119,6 +120,7 @@ public:
 		// members
 		//
 		S32			mFrameStateIndex;
+		U32			mThreadIndex;	// stable index into the per thread totals
 
 		std::string	mName;
 
@@ -157,6 +159,14 @@ public:
 	LL_FORCE_INLINE LLFastTimer(LLFastTimer::DeclareTimer& timer)
 	:	mFrameState(timer.mFrameState)
 	{
+		if (LL_UNLIKELY(!AIThreadID::in_main_thread_inline()))
+		{
+			// Other threads keep their own stack and never touch the
+			// FrameState tree.
+			mFrameState = NULL;
+			startThreadTimer(&timer.mTimer);
+			return;
+		}
 #if TIME_FAST_TIMERS
 		U64 timer_start = getCPUClockCount64();
 #endif
@@ -175,20 +185,25 @@ public:
 		cur_timer_data->mNamedTimer = &timer.mTimer;
 		cur_timer_data->mFrameState = frame_state;
 		cur_timer_data->mChildTime = 0;
+
+		if (LL_UNLIKELY(sTraceEvents))
+		{
+			traceEvent(&timer.mTimer, true);
+		}
 #endif
 #if TIME_FAST_TIMERS
 		U64 timer_end = getCPUClockCount64();
 		sTimerCycles += timer_end - timer_start;
-#endif
-#if DEBUG_FAST_TIMER_THREADS
-#if !LL_RELEASE
-		assert_main_thread();
-#endif
 #endif
 	}
 
 	LL_FORCE_INLINE ~LLFastTimer()
 	{
+		if (LL_UNLIKELY(!mFrameState))
+		{
+			stopThreadTimer();
+			return;
+		}
 #if TIME_FAST_TIMERS
 		U64 timer_start = getCPUClockCount64();
 #endif
@@ -207,6 +222,11 @@ public:
 		mLastTimerData.mChildTime += total_time;
 
 		LLFastTimer::sCurTimerData = mLastTimerData;
+
+		if (LL_UNLIKELY(sTraceEvents))
+		{
+			traceEvent(frame_state->mTimer, false);
+		}
 #endif
 #if TIME_FAST_TIMERS
 		U64 timer_end = getCPUClockCount64();
@@ -225,6 +245,7 @@ public:
 	static bool 			sResetHistory;
 	static U64				sTimerCycles;
 	static U32				sTimerCalls;
+	static bool				sTraceEvents;	// record begin/end events for writeChromeTrace()
 
 	typedef std::vector<FrameState> info_list_t;
 	static info_list_t& getFrameStateList();
@@ -250,6 +271,36 @@ public:
 	static void writeLog(std::ostream& os);
 	static const NamedTimer* getTimerByName(const std::string& name);
 
+	// Timers run by other threads than the main thread don't show up in the
+	// frame hierarchy; each thread accumulates the self time and calls of
+	// the timers it runs instead.  Times are in getCPUClockCount64() counts.
+	struct ThreadTimerTotals
+	{
+		NamedTimer*	mTimer;
+		U64			mSelfTime;
+		U32			mCalls;
+	};
+	struct ThreadSummary
+	{
+		std::string						mName;
+		std::vector<ThreadTimerTotals>	mTimers;	// timers that ran at least once
+	};
+	// Totals since each thread started, main thread excluded.
+	static void getThreadSummaries(std::vector<ThreadSummary>& summaries);
+	static U64 countsPerSecond64();
+
+	// Names the calling thread in summaries and traces, LLThread does this
+	// for its threads.  releaseThreadTimers() is called when a thread exits,
+	// so that its slot can be reused.
+	static void setThreadName(const std::string& name);
+	static void releaseThreadTimers();
+
+	// Writes the begin/end events of every thread from the last 'seconds'
+	// seconds as Chrome trace event JSON (chrome://tracing, Perfetto).
+	// Events are only recorded while sTraceEvents is set, and each thread
+	// keeps the most recent TRACE_EVENTS of them.
+	static void writeChromeTrace(std::ostream& os, F64 seconds);
+
 	struct CurTimerData
 	{
 		LLFastTimer*	mCurTimer;
@@ -260,10 +311,16 @@ public:
 	static CurTimerData		sCurTimerData;
 	static std::string sClockType;
 
+	class ThreadTimers;
+
 private:
 	static U32 getCPUClockCount32();
 	static U64 getCPUClockCount64();
 
+	static void startThreadTimer(NamedTimer* timer);
+	static void stopThreadTimer();
+	static void traceEvent(NamedTimer* timer, bool begin);
+
 	static S32				sCurFrameIndex;
 	static S32				sLastFrameIndex;
 	static U64				sLastFrameTime;
@@ -0,0 +1,443 @@
+/**
+ * @file lljobsystem.cpp
+ * @brief Work-stealing scheduler of jobs with dependencies, shared by the subsystems.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+
+#include "lljobsystem.h"
+#include "lltimer.h"
+
+#include <memory>
+
+LLJobSystem* gJobSystem = NULL;
+
+namespace
+{
+	// The system whose worker the calling thread is, and its index there.
+	ll_thread_local LLJobSystem* tJobSystem = NULL;
+	ll_thread_local S32 tWorkerIndex = -1;
+}
+
+//============================================================================
+// LLJobSystem::Worker
+// Runs jobs while there are any, sleeps until one is queued otherwise.
+//============================================================================
+
+class LLJobSystem::Worker : public LLThread
+{
+public:
+	Worker(const std::string& name, LLJobSystem* system, S32 index) :
+		LLThread(name),
+		mSystem(system),
+		mIndex(index),
+		mIdle(false)
+	{
+	}
+
+	// Wakes the worker if it ran out of jobs, returns false if it is busy.
+	bool wakeIfIdle()
+	{
+		if (!mIdle)
+		{
+			return false;
+		}
+		wake();
+		return true;
+	}
+
+protected:
+	/*virtual*/ bool runCondition()
+	{
+		return mSystem->mQueued > 0;
+	}
+
+	/*virtual*/ void run()
+	{
+		tJobSystem = mSystem;
+		tWorkerIndex = mIndex;
+		while (!isQuitting())
+		{
+			job_ptr_t job = mSystem->findJob(mIndex);
+			if (job)
+			{
+				mSystem->execute(job);
+				continue;
+			}
+			// A job queued from here on either is seen by runCondition(),
+			// or finds us idle and wakes us.
+			mIdle = true;
+			checkPause();
+			mIdle = false;
+		}
+	}
+
+private:
+	LLJobSystem*		mSystem;
+	S32					mIndex;
+	std::atomic<bool>	mIdle;
+};
+
+//============================================================================
+// LLJobSystem::Job
+//============================================================================
+
+LLJobSystem::Job::Job(const job_func_t& func, LLFastTimer::DeclareTimer* timer, EThread thread) :
+	mFunc(func),
+	mTimer(timer),
+	mThread(thread),
+	mWaitingFor(1),
+	mDone(false)
+{
+}
+
+//============================================================================
+// LLJobSystem
+//============================================================================
+
+LLJobSystem::LLJobSystem(const std::string& name, S32 thread_count) :
+	mName(name),
+	mQueued(0),
+	mNextWake(0),
+	mWaiters(0)
+{
+	thread_count = llmax(thread_count, 1);
+	for (S32 i = 0; i <= thread_count; ++i)
+	{
+		mQueues.push_back(new JobQueue);
+	}
+	for (S32 i = 0; i < thread_count; ++i)
+	{
+		mWorkers.push_back(new Worker(llformat("%s %d", mName.c_str(), i), this, i));
+	}
+	for (S32 i = 0; i < thread_count; ++i)
+	{
+		mWorkers[i]->start();
+	}
+}
+
+LLJobSystem::~LLJobSystem()
+{
+	// Jobs that didn't run yet are dropped
+	for (std::vector<Worker*>::iterator iter = mWorkers.begin(); iter != mWorkers.end(); ++iter)
+	{
+		(*iter)->shutdown();
+		delete *iter;
+	}
+	mWorkers.clear();
+	for (std::vector<JobQueue*>::iterator iter = mQueues.begin(); iter != mQueues.end(); ++iter)
+	{
+		delete *iter;
+	}
+	mQueues.clear();
+}
+
+S32 LLJobSystem::getWorkerIndex() const
+{
+	return tJobSystem == this ? tWorkerIndex : -1;
+}
+
+LLJobSystem::job_ptr_t LLJobSystem::submit(const job_func_t& func, LLFastTimer::DeclareTimer* timer,
+										   const job_list_t& after, EThread thread)
+{
+	job_ptr_t job = new Job(func, timer, thread);
+	for (job_list_t::const_iterator iter = after.begin(); iter != after.end(); ++iter)
+	{
+		Job* dependency = *iter;
+		if (!dependency)
+		{
+			continue;
+		}
+		LLMutexLock lock(dependency->mMutex);
+		if (!dependency->mDone)
+		{
+			dependency->mContinuations.push_back(job);
+			++job->mWaitingFor;
+		}
+	}
+	// Drop the count held while adding the dependencies
+	if (--job->mWaitingFor == 0)
+	{
+		schedule(job);
+	}
+	return job;
+}
+
+LLJobSystem::job_ptr_t LLJobSystem::then(const job_ptr_t& job, const job_func_t& func, LLFastTimer::DeclareTimer* timer,
+										 EThread thread)
+{
+	return submit(func, timer, job_list_t(1, job), thread);
+}
+
+void LLJobSystem::schedule(const job_ptr_t& job)
+{
+	if (job->mThread == MAIN_THREAD)
+	{
+		LLMutexLock lock(mMainThreadMutex);
+		mMainThreadJobs.push_back(job);
+	}
+	else
+	{
+		// Counted before it can be taken, so that mQueued never goes negative
+		++mQueued;
+		S32 index = getWorkerIndex();
+		JobQueue* queue = mQueues[index < 0 ? mWorkers.size() : index];
+		{
+			LLMutexLock lock(queue->mMutex);
+			queue->mJobs.push_back(job);
+		}
+
+		// Get an idle worker to take it, or to steal it from us
+		U32 count = mWorkers.size();
+		U32 start = mNextWake++;
+		for (U32 i = 0; i < count; ++i)
+		{
+			if (mWorkers[(start + i) % count]->wakeIfIdle())
+			{
+				break;
+			}
+		}
+	}
+	notifyWaiters();
+}
+
+LLJobSystem::job_ptr_t LLJobSystem::findJob(S32 index)
+{
+	job_ptr_t job;
+	if (mQueued <= 0)
+	{
+		return job;
+	}
+
+	// The newest of our own first, it is the most likely to be in the cache
+	if (index >= 0)
+	{
+		JobQueue* queue = mQueues[index];
+		LLMutexLock lock(queue->mMutex);
+		if (!queue->mJobs.empty())
+		{
+			job = queue->mJobs.back();
+			queue->mJobs.pop_back();
+		}
+	}
+
+	// Then the oldest submitted from outside, then the oldest of the others,
+	// starting with the next worker so that thieves spread out
+	S32 workers = mWorkers.size();
+	for (S32 i = 0; !job && i <= workers; ++i)
+	{
+		S32 victim = i == 0 ? workers : (index + i) % workers;
+		if (victim == index)
+		{
+			continue;
+		}
+		JobQueue* queue = mQueues[victim];
+		LLMutexLock lock(queue->mMutex);
+		if (!queue->mJobs.empty())
+		{
+			job = queue->mJobs.front();
+			queue->mJobs.pop_front();
+		}
+	}
+
+	if (job)
+	{
+		--mQueued;
+	}
+	return job;
+}
+
+bool LLJobSystem::popMainThreadJob(job_ptr_t& job)
+{
+	LLMutexLock lock(mMainThreadMutex);
+	if (mMainThreadJobs.empty())
+	{
+		return false;
+	}
+	job = mMainThreadJobs.front();
+	mMainThreadJobs.pop_front();
+	return true;
+}
+
+void LLJobSystem::execute(Job* job)
+{
+	if (job->mTimer)
+	{
+		LLFastTimer t(*job->mTimer);
+		job->mFunc();
+	}
+	else
+	{
+		job->mFunc();
+	}
+	// Release what the job captured
+	job->mFunc = job_func_t();
+
+	job_list_t continuations;
+	{
+		LLMutexLock lock(job->mMutex);
+		job->mDone = true;
+		continuations.swap(job->mContinuations);
+	}
+	for (job_list_t::iterator iter = continuations.begin(); iter != continuations.end(); ++iter)
+	{
+		if (--(*iter)->mWaitingFor == 0)
+		{
+			schedule(*iter);
+		}
+	}
+	notifyWaiters();
+}
+
+void LLJobSystem::notifyWaiters()
+{
+	if (mWaiters > 0)
+	{
+		mWaitCondition.lock();
+		mWaitCondition.broadcast();
+		mWaitCondition.unlock();
+	}
+}
+
+void LLJobSystem::wait(const job_ptr_t& job)
+{
+	S32 index = getWorkerIndex();
+	bool main_thread = AIThreadID::in_main_thread();
+	while (!job->isDone())
+	{
+		job_ptr_t other = findJob(index);
+		if (other || (main_thread && popMainThreadJob(other)))
+		{
+			execute(other);
+			continue;
+		}
+
+		mWaitCondition.lock();
+		++mWaiters;
+		while (!job->isDone() && mQueued <= 0)
+		{
+			if (main_thread)
+			{
+				LLMutexLock lock(mMainThreadMutex);
+				if (!mMainThreadJobs.empty())
+				{
+					break;
+				}
+			}
+			mWaitCondition.wait();
+		}
+		--mWaiters;
+		mWaitCondition.unlock();
+	}
+}
+
+namespace
+{
+	// Shared by a parallelFor() and its helper jobs, which may only start
+	// once it returned.
+	struct ParallelFor
+	{
+		ParallelFor(S32 count, const std::function<void(S32)>& func) :
+			mFunc(&func),
+			mCount(count),
+			mNext(0),
+			mRunning(0)
+		{
+		}
+
+		void work()
+		{
+			for (S32 i = mNext++; i < mCount; i = mNext++)
+			{
+				(*mFunc)(i);
+			}
+		}
+
+		const std::function<void(S32)>*	mFunc;	// Only used while mNext < mCount.
+		S32								mCount;
+		std::atomic<S32>				mNext;
+		std::atomic<S32>				mRunning;
+	};
+}
+
+void LLJobSystem::parallelFor(S32 count, const std::function<void(S32)>& func, S32 max_helpers,
+							  LLFastTimer::DeclareTimer* timer)
+{
+	S32 helpers = llmin(llmin(max_helpers, getThreadCount()), count - 1);
+	if (helpers <= 0)
+	{
+		for (S32 i = 0; i < count; ++i)
+		{
+			func(i);
+		}
+		return;
+	}
+
+	std::shared_ptr<ParallelFor> batch = std::make_shared<ParallelFor>(count, func);
+	for (S32 i = 0; i < helpers; ++i)
+	{
+		submit([batch]()
+			{
+				++batch->mRunning;
+				batch->work();
+				--batch->mRunning;
+			}, timer);
+	}
+	batch->work();
+
+	// Only the helpers in the middle of a call are waited for: the ones that
+	// start from here on find no index left.  Not running other jobs meanwhile
+	// keeps the caller's time bounded by the longest call.
+	if (batch->mRunning > 0)
+	{
+		mWaitCondition.lock();
+		++mWaiters;
+		while (batch->mRunning > 0)
+		{
+			mWaitCondition.wait();
+		}
+		--mWaiters;
+		mWaitCondition.unlock();
+	}
+}
+
+S32 LLJobSystem::runMainThreadJobs(F32 max_time)
+{
+	llassert(AIThreadID::in_main_thread());
+
+	LLTimer timer;
+	S32 count = 0;
+	job_ptr_t job;
+	while (popMainThreadJob(job))
+	{
+		execute(job);
+		++count;
+		if (timer.getElapsedTimeF32() >= max_time)
+		{
+			break;
+		}
+	}
+	return count;
+}
@@ -0,0 +1,169 @@
+/**
+ * @file lljobsystem.h
+ * @brief Work-stealing scheduler of jobs with dependencies, shared by the subsystems.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#ifndef LL_LLJOBSYSTEM_H
+#define LL_LLJOBSYSTEM_H
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "llfasttimer.h"
+#include "llpointer.h"
+#include "llthread.h"
+
+//============================================================================
+// LLJobSystem
+//
+// One worker thread per core, shared by everything that has CPU-bound work to
+// split up, instead of a dedicated thread or pool for each subsystem.
+//
+// Each worker has its own deque of jobs: it runs the newest job of its own
+// deque first, and when that is empty takes the oldest job submitted from
+// outside the workers, or steals the oldest one of another worker.  Jobs a job
+// submits thus stay on its core while there is no one idle to take them.
+//
+// A job may wait for other jobs: it only becomes runnable once all of them are
+// done.  Jobs for MAIN_THREAD, typically the completion of some work, are run
+// by runMainThreadJobs() from the main loop.  Jobs are timed by the fast timer
+// given at submission, if any.
+//
+// wait() runs other jobs while waiting, so jobs can use it without tying up a
+// worker; the main thread should rather continue with a MAIN_THREAD job than
+// wait, as it might run a long job of someone else.
+//============================================================================
+
+class LL_COMMON_API LLJobSystem
+{
+public:
+	class Job;
+	typedef LLPointer<Job> job_ptr_t;
+	typedef std::vector<job_ptr_t> job_list_t;
+	typedef std::function<void()> job_func_t;
+
+	enum EThread
+	{
+		ANY_THREAD,
+		MAIN_THREAD
+	};
+
+	class LL_COMMON_API Job : public LLThreadSafeRefCount
+	{
+	public:
+		bool isDone() const							{ return mDone; }
+
+	private:
+		friend class LLJobSystem;
+
+		Job(const job_func_t& func, LLFastTimer::DeclareTimer* timer, EThread thread);
+
+		job_func_t					mFunc;
+		LLFastTimer::DeclareTimer*	mTimer;
+		EThread						mThread;
+		std::atomic<S32>			mWaitingFor;	// Unfinished jobs this one comes after, plus one while submitting.
+		std::atomic<bool>			mDone;
+		LLMutex						mMutex;
+		job_list_t					mContinuations;	// Protected by mMutex, until mDone.
+	};
+
+	// thread_count workers, at least one.
+	LLJobSystem(const std::string& name, S32 thread_count);
+	~LLJobSystem();
+
+	S32 getThreadCount() const						{ return (S32)mWorkers.size(); }
+	// Jobs waiting for a worker.
+	S32 getQueuedJobs() const						{ return mQueued; }
+
+	// Runs func once all jobs in after are done, on a worker or, for
+	// MAIN_THREAD, in runMainThreadJobs().
+	job_ptr_t submit(const job_func_t& func, LLFastTimer::DeclareTimer* timer = NULL,
+					 const job_list_t& after = job_list_t(), EThread thread = ANY_THREAD);
+	// Runs func once job is done.
+	job_ptr_t then(const job_ptr_t& job, const job_func_t& func, LLFastTimer::DeclareTimer* timer = NULL,
+				   EThread thread = ANY_THREAD);
+
+	// Returns once job is done, running other jobs in the meantime.  On the
+	// main thread that includes the MAIN_THREAD jobs.
+	void wait(const job_ptr_t& job);
+
+	// Calls func(0) .. func(count - 1) with the help of at most max_helpers
+	// workers and returns when all calls are done.  The indices are handed
+	// out one at a time, the caller taking its share, and the caller doesn't
+	// run unrelated jobs meanwhile, so the main thread can use it.
+	void parallelFor(S32 count, const std::function<void(S32)>& func, S32 max_helpers,
+					 LLFastTimer::DeclareTimer* timer = NULL);
+
+	// Main thread only: runs the MAIN_THREAD jobs that became runnable, until
+	// there are none left or max_time seconds passed.  Returns how many ran.
+	S32 runMainThreadJobs(F32 max_time);
+
+private:
+	class Worker;
+	friend class Worker;
+
+	// A deque of runnable jobs: its worker pushes and pops at the back, the
+	// others take from the front.
+	struct JobQueue
+	{
+		LLMutex					mMutex;
+		std::deque<job_ptr_t>	mJobs;
+	};
+
+	// Queues job now that it is runnable.
+	void schedule(const job_ptr_t& job);
+	// Takes a runnable job for the worker index, or for a thread that isn't
+	// a worker when index is -1.
+	job_ptr_t findJob(S32 index);
+	bool popMainThreadJob(job_ptr_t& job);
+	void execute(Job* job);
+	void notifyWaiters();
+
+	// Index of the calling thread in this system's workers, -1 for others.
+	S32 getWorkerIndex() const;
+
+private:
+	std::string				mName;
+	std::vector<Worker*>	mWorkers;
+	// One per worker, then the one of the threads that aren't workers.
+	std::vector<JobQueue*>	mQueues;
+	std::atomic<S32>		mQueued;
+	std::atomic<U32>		mNextWake;
+
+	LLMutex					mMainThreadMutex;
+	std::deque<job_ptr_t>	mMainThreadJobs;	// Protected by mMainThreadMutex.
+
+	// Signaled, when there are threads in wait(), as jobs are queued or done.
+	LLCondition				mWaitCondition;
+	std::atomic<S32>		mWaiters;
+};
+
+// The viewer's job system, NULL until the viewer created it.
+extern LL_COMMON_API LLJobSystem* gJobSystem;
+
+#endif // LL_LLJOBSYSTEM_H
@@ -88,6 +88,8 @@ void LLQueuedThread::shutdown()
 		mStatus = STOPPED;
 	}
 
+	mRequestQueue.clear();
+
 	QueuedRequest* req;
 	S32 active_count = 0;
 	while ( (req = (QueuedRequest*)mRequestHash.pop_element()) )
@@ -165,11 +167,7 @@ void LLQueuedThread::incQueue()
 // May be called from any thread
 S32 LLQueuedThread::getPending()
 {
-	S32 res;
-	lockData();
-	res = mRequestQueue.size();
-	unlockData();
-	return res;
+	return mRequestQueue.size();
 }
 
 // MAIN thread
@@ -194,17 +192,15 @@ void LLQueuedThread::waitOnPending()
 // MAIN thread
 void LLQueuedThread::printQueueStats()
 {
-	lockData();
-	if (!mRequestQueue.empty())
+	S32 pending = mRequestQueue.size();
+	if (pending)
 	{
-		QueuedRequest *req = *mRequestQueue.begin();
-		LL_INFOS() << llformat("Pending Requests:%d Current status:%d", mRequestQueue.size(), req->getStatus()) << LL_ENDL;
+		LL_INFOS() << llformat("Pending Requests:%d", pending) << LL_ENDL;
 	}
 	else
 	{
 		LL_INFOS() << "Queued Thread Idle" << LL_ENDL;
 	}
-	unlockData();
 }
 
 // MAIN thread
@@ -230,12 +226,12 @@ bool LLQueuedThread::addRequest(QueuedRequest* req)
 	
 	lockData();
 	req->setStatus(STATUS_QUEUED);
-	mRequestQueue.insert(req);
 	mRequestHash.insert(req);
 #if _DEBUG
 // 	LL_INFOS() << llformat("LLQueuedThread::Added req [%08d]",handle) << LL_ENDL;
 #endif
 	unlockData();
+	mRequestQueue.push(req);
 
 	incQueue();
 
@@ -338,17 +334,10 @@ void LLQueuedThread::setPriority(handle_t handle, U32 priority)
 	QueuedRequest* req = (QueuedRequest*)mRequestHash.find(handle);
 	if (req)
 	{
-		if(req->getStatus() == STATUS_INPROGRESS)
-		{
-			// not in list
-			req->setPriority(priority);
-		}
-		else if(req->getStatus() == STATUS_QUEUED)
+		if (req->getStatus() == STATUS_INPROGRESS || req->getStatus() == STATUS_QUEUED)
 		{
-			// remove from list then re-insert
-			llverify(mRequestQueue.erase(req) == 1);
-			req->setPriority(priority);
-			mRequestQueue.insert(req);
+			// Moves the request to its new bucket if it is in the queue.
+			mRequestQueue.setPriority(req, priority);
 		}
 	}
 	unlockData();
@@ -413,13 +402,11 @@ S32 LLQueuedThread::processNextRequest()
 	lockData();
 	while(1)
 	{
-		req = NULL;
-		if (mRequestQueue.empty())
+		req = mRequestQueue.pop();
+		if (!req)
 		{
 			break;
 		}
-		req = *mRequestQueue.begin();
-		mRequestQueue.erase(mRequestQueue.begin());
 		if ((req->getFlags() & FLAG_ABORT) || (mStatus == QUITTING))
 		{
 			req->setStatus(STATUS_ABORTED);
@@ -509,8 +496,8 @@ S32 LLQueuedThread::processNextRequest()
 		{
 			lockData();
 			req->setStatus(STATUS_QUEUED);
-			mRequestQueue.insert(req);
 			unlockData();
+			mRequestQueue.push(req);
 			if (mThreaded && start_priority < PRIORITY_NORMAL)
 			{
 				ms_sleep(1); // sleep the thread a little
@@ -589,7 +576,10 @@ LLQueuedThread::QueuedRequest::QueuedRequest(LLQueuedThread::handle_t handle, U3
 	LLSimpleHashEntry<LLQueuedThread::handle_t>(handle),
 	mStatus(STATUS_UNKNOWN),
 	mPriority(priority),
-	mFlags(flags)
+	mFlags(flags),
+	mQueueNext(NULL),
+	mQueuePrev(NULL),
+	mQueueState(0)
 {
 }
 
@@ -610,3 +600,168 @@ void LLQueuedThread::QueuedRequest::deleteRequest()
 	setStatus(STATUS_DELETE);
 	delete this;
 }
+
+//============================================================================
+
+LLQueuedThread::RequestQueue::RequestQueue() :
+	mIncoming(NULL),
+	mSize(0),
+	mUsedWords(0)
+{
+	memset(mBuckets, 0, sizeof(mBuckets));
+	memset(mUsedBuckets, 0, sizeof(mUsedBuckets));
+}
+
+LLQueuedThread::RequestQueue::~RequestQueue()
+{
+}
+
+// Any thread
+void LLQueuedThread::RequestQueue::push(QueuedRequest* req)
+{
+	llassert(req->mQueueState == QUEUE_NONE);
+	req->mQueueState = QUEUE_INCOMING;
+	++mSize;
+	QueuedRequest* head = mIncoming.load(std::memory_order_relaxed);
+	do
+	{
+		req->mQueueNext = head;
+	}
+	while (!mIncoming.compare_exchange_weak(head, req, std::memory_order_release, std::memory_order_relaxed));
+}
+
+LLQueuedThread::QueuedRequest* LLQueuedThread::RequestQueue::pop()
+{
+	if (mSize == 0)
+	{
+		return NULL;
+	}
+	LLMutexLock lock(mMutex);
+	fileIncoming();
+	if (!mUsedWords)
+	{
+		return NULL;
+	}
+	// Find the highest non-empty bucket.
+	U32 word = BITMAP_WORDS - 1;
+	while (!(mUsedWords & (1U << word)))
+	{
+		--word;
+	}
+	U64 bits = mUsedBuckets[word];
+	U32 bit = 63;
+	while (!(bits >> bit))
+	{
+		--bit;
+	}
+	QueuedRequest* req = mBuckets[word * 64 + bit].mHead;
+	llassert(req);
+	unlink(req);
+	req->mQueueState = QUEUE_NONE;
+	--mSize;
+	return req;
+}
+
+void LLQueuedThread::RequestQueue::setPriority(QueuedRequest* req, U32 priority)
+{
+	LLMutexLock lock(mMutex);
+	// If the request is still on the incoming stack then fileIncoming() picks up the new priority.
+	if (req->mQueueState == QUEUE_FILED && getBucket(priority) != getBucket(req->mPriority))
+	{
+		unlink(req);
+		req->mPriority = priority;
+		link(req);
+	}
+	else
+	{
+		req->mPriority = priority;
+	}
+}
+
+void LLQueuedThread::RequestQueue::clear()
+{
+	LLMutexLock lock(mMutex);
+	fileIncoming();
+	for (S32 i = 0; i < BUCKET_COUNT; ++i)
+	{
+		for (QueuedRequest* req = mBuckets[i].mHead; req; req = req->mQueueNext)
+		{
+			req->mQueueState = QUEUE_NONE;
+		}
+	}
+	memset(mBuckets, 0, sizeof(mBuckets));
+	memset(mUsedBuckets, 0, sizeof(mUsedBuckets));
+	mUsedWords = 0;
+	mSize = 0;
+}
+
+void LLQueuedThread::RequestQueue::fileIncoming()
+{
+	QueuedRequest* req = mIncoming.exchange(NULL, std::memory_order_acquire);
+	// The stack holds the most recent push first; reverse it so that equal priorities stay first come, first served.
+	QueuedRequest* reversed = NULL;
+	while (req)
+	{
+		QueuedRequest* next = req->mQueueNext;
+		req->mQueueNext = reversed;
+		reversed = req;
+		req = next;
+	}
+	while (reversed)
+	{
+		QueuedRequest* next = reversed->mQueueNext;
+		link(reversed);
+		reversed->mQueueState = QUEUE_FILED;
+		reversed = next;
+	}
+}
+
+void LLQueuedThread::RequestQueue::link(QueuedRequest* req)
+{
+	U32 index = getBucket(req->mPriority);
+	Bucket& bucket = mBuckets[index];
+	req->mQueueNext = NULL;
+	req->mQueuePrev = bucket.mTail;
+	if (bucket.mTail)
+	{
+		bucket.mTail->mQueueNext = req;
+	}
+	else
+	{
+		bucket.mHead = req;
+		mUsedBuckets[index / 64] |= U64(1) << (index % 64);
+		mUsedWords |= 1U << (index / 64);
+	}
+	bucket.mTail = req;
+}
+
+void LLQueuedThread::RequestQueue::unlink(QueuedRequest* req)
+{
+	U32 index = getBucket(req->mPriority);
+	Bucket& bucket = mBuckets[index];
+	if (req->mQueuePrev)
+	{
+		req->mQueuePrev->mQueueNext = req->mQueueNext;
+	}
+	else
+	{
+		bucket.mHead = req->mQueueNext;
+	}
+	if (req->mQueueNext)
+	{
+		req->mQueueNext->mQueuePrev = req->mQueuePrev;
+	}
+	else
+	{
+		bucket.mTail = req->mQueuePrev;
+	}
+	req->mQueueNext = req->mQueuePrev = NULL;
+	if (!bucket.mHead)
+	{
+		mUsedBuckets[index / 64] &= ~(U64(1) << (index % 64));
+		if (!mUsedBuckets[index / 64])
+		{
+			mUsedWords &= ~(1U << (index / 64));
+		}
+	}
+}
@@ -27,6 +27,7 @@
 #ifndef LL_LLQUEUEDTHREAD_H
 #define LL_LLQUEUEDTHREAD_H
 
+#include <atomic>
 #include <queue>
 #include <string>
 #include <map>
@@ -73,9 +74,12 @@ public:
 	//------------------------------------------------------------------------
 public:
 
+	class RequestQueue;
+
 	class LL_COMMON_API QueuedRequest : public LLSimpleHashEntry<handle_t>
 	{
 		friend class LLQueuedThread;
+		friend class RequestQueue;
 		
 	protected:
 		virtual ~QueuedRequest(); // use deleteRequest()
@@ -128,6 +132,7 @@ public:
 		void setPriority(U32 pri)
 		{
 			// Only do this on a request that is not in a queued list!
+			// Use RequestQueue::setPriority() otherwise.
 			mPriority = pri;
 		};
 		
@@ -135,15 +140,86 @@ public:
 		LLAtomic32<status_t> mStatus;
 		U32 mPriority;
 		U32 mFlags;
+
+	private:
+		// Owned by RequestQueue.
+		QueuedRequest* mQueueNext;		// Next in the incoming stack, or in the bucket.
+		QueuedRequest* mQueuePrev;		// Previous in the bucket.
+		std::atomic<U32> mQueueState;
 	};
 
-protected:
-	struct queued_request_less
+	// Pending requests, highest priority first.
+	//
+	// Priorities are grouped into BUCKET_COUNT buckets of 2^BUCKET_SHIFT consecutive
+	// values; requests within one bucket are served in the order they were queued.
+	// push() is lock-free and may be called from any thread: it only links the request
+	// onto an incoming stack. pop() and setPriority() hold a short private lock, move the
+	// incoming requests into their bucket, and then work in O(1) using intrusive lists
+	// and a bitmap of non-empty buckets.
+	class LL_COMMON_API RequestQueue
 	{
-		bool operator()(const QueuedRequest* lhs, const QueuedRequest* rhs) const
+	public:
+		RequestQueue();
+		~RequestQueue();
+
+		// req must not be queued already.
+		void push(QueuedRequest* req);
+		// Returns the highest priority request, or NULL when empty.
+		QueuedRequest* pop();
+		// Works for queued and unqueued requests alike; a queued request is moved to its new bucket.
+		void setPriority(QueuedRequest* req, U32 priority);
+		// Forget all queued requests (does not delete them).
+		void clear();
+
+		S32 size() const { return mSize; }
+		bool empty() const { return mSize == 0; }
+
+		// Call func(QueuedRequest*) for every queued request, highest priority first.
+		template<typename FUNC>
+		void forEach(FUNC func)
 		{
-			return lhs->higherPriority(*rhs); // higher priority in front of queue (set)
+			LLMutexLock lock(mMutex);
+			fileIncoming();
+			for (S32 i = BUCKET_COUNT - 1; i >= 0; --i)
+			{
+				for (QueuedRequest* req = mBuckets[i].mHead; req; req = req->mQueueNext)
+				{
+					func(req);
+				}
+			}
 		}
+
+	private:
+		enum {
+			BUCKET_SHIFT = 21,
+			BUCKET_COUNT = 1024,		// PRIORITY_IMMEDIATE >> BUCKET_SHIFT is the last one.
+			BITMAP_WORDS = BUCKET_COUNT / 64
+		};
+		enum {
+			QUEUE_NONE = 0,
+			QUEUE_INCOMING = 1,
+			QUEUE_FILED = 2
+		};
+		static U32 getBucket(U32 priority) { return llmin(priority >> BUCKET_SHIFT, (U32)BUCKET_COUNT - 1); }
+
+		// These require mMutex to be locked.
+		void fileIncoming();
+		void link(QueuedRequest* req);
+		void unlink(QueuedRequest* req);
+
+	private:
+		std::atomic<QueuedRequest*> mIncoming;
+		std::atomic<S32> mSize;
+
+		LLMutex mMutex;
+		struct Bucket
+		{
+			QueuedRequest* mHead;
+			QueuedRequest* mTail;
+		};
+		Bucket mBuckets[BUCKET_COUNT];
+		U64 mUsedBuckets[BITMAP_WORDS];	// Bit i of word w is set when bucket 64*w+i is not empty.
+		U32 mUsedWords;					// Bit w is set when mUsedBuckets[w] is not zero.
 	};
 
 
@@ -204,7 +280,7 @@ protected:
 	BOOL mStarted;  // required when mThreaded is false to call startThread() from update()
 	LLAtomic32<bool> mIdleThread; // request queue is empty (or we are quitting) and the thread is idle
 	
-	typedef std::set<QueuedRequest*, queued_request_less> request_queue_t;
+	typedef RequestQueue request_queue_t;
 	request_queue_t mRequestQueue;
 
 	enum { REQUEST_HASH_SIZE = 512 }; // must be power of 2
@@ -0,0 +1,521 @@
+/**
+ * @file llsizeclassallocator.cpp
+ * @brief Size classed allocator with per thread caches, for the image,
+ *        volume and vertex buffer data.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llsizeclassallocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+#if LL_WINDOWS
+#include "llwin32headerslean.h"
+#include <intrin.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	// In front of every block handed out.  The raw block starts mOffset bytes
+	// before the pointer handed out, the header takes the last 16 of them.
+	struct BlockHeader
+	{
+		U32	mClass;		// size class, or LARGE_CLASS
+		U16	mSubsystem;
+		U16	mOffset;
+		U64	mSize;		// as requested
+	};
+
+	const size_t HEADER_SIZE = 16;
+	static_assert(sizeof(BlockHeader) == HEADER_SIZE, "block header must keep the blocks 16 byte aligned");
+
+	const U32 LINEAR_CLASSES = 16;			// 16 to 256 bytes, by 16
+	const U32 CLASSES_PER_DOUBLING = 4;		// then four per power of two up to MAX_SMALL_SIZE
+	const U32 NUM_CLASSES = LINEAR_CLASSES + 10 * CLASSES_PER_DOUBLING;
+	const U32 LARGE_CLASS = 0xffffffff;
+
+	const size_t CHUNK_SIZE = 1 << 20;
+	// Bytes moved between a thread's cache and the central list at once
+	const size_t BATCH_BYTES = 64 << 10;
+	const U32 MAX_BATCH = 32;
+
+	inline U32 floor_log2(size_t value)
+	{
+#if LL_WINDOWS
+		unsigned long index;
+#if defined(_WIN64)
+		_BitScanReverse64(&index, value);
+#else
+		_BitScanReverse(&index, value);
+#endif
+		return (U32)index;
+#else
+		return (U32)(sizeof(unsigned long long) * 8 - 1 - __builtin_clzll(value));
+#endif
+	}
+
+	// Size class of a raw block of 1 to MAX_SMALL_SIZE bytes
+	inline U32 size_class(size_t size)
+	{
+		if (size <= 256)
+		{
+			return (U32)((size - 1) >> 4);
+		}
+		// size is in (2^l, 2^(l+1)], split in four
+		const U32 l = floor_log2(size - 1);
+		return LINEAR_CLASSES + (l - 8) * CLASSES_PER_DOUBLING + (U32)(((size - 1) >> (l - 2)) & 3);
+	}
+
+	inline size_t class_size(U32 size_class)
+	{
+		if (size_class < LINEAR_CLASSES)
+		{
+			return (size_t)(size_class + 1) << 4;
+		}
+		const U32 l = 8 + (size_class - LINEAR_CLASSES) / CLASSES_PER_DOUBLING;
+		const U32 step = (size_class - LINEAR_CLASSES) % CLASSES_PER_DOUBLING + 1;
+		return ((size_t)1 << l) + ((size_t)step << (l - 2));
+	}
+
+	inline U32 batch_size(U32 size_class)
+	{
+		return llclamp((U32)(BATCH_BYTES / class_size(size_class)), (U32)2, MAX_BATCH);
+	}
+
+	size_t page_size()
+	{
+		static const size_t size = []()
+		{
+#if LL_WINDOWS
+			SYSTEM_INFO info;
+			GetSystemInfo(&info);
+			return (size_t)info.dwPageSize;
+#else
+			return (size_t)sysconf(_SC_PAGESIZE);
+#endif
+		}();
+		return size;
+	}
+
+	inline size_t round_to_pages(size_t size)
+	{
+		const size_t page = page_size();
+		return (size + page - 1) & ~(page - 1);
+	}
+
+	char* map_pages(size_t size)
+	{
+#if LL_WINDOWS
+		return (char*)VirtualAlloc(NULL, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+#else
+		void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+		return ptr == MAP_FAILED ? NULL : (char*)ptr;
+#endif
+	}
+
+	void unmap_pages(char* ptr, size_t size)
+	{
+#if LL_WINDOWS
+		VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+		munmap(ptr, size);
+#endif
+	}
+
+	// Only held to move a batch of blocks, so it spins.  Unlike LLMutex it
+	// needs no initialization, allocations may come from static constructors.
+	class SpinLock
+	{
+	public:
+		void lock()
+		{
+			while (mLocked.exchange(true, std::memory_order_acquire))
+			{
+				while (mLocked.load(std::memory_order_relaxed))
+				{
+				}
+			}
+		}
+
+		void unlock()
+		{
+			mLocked.store(false, std::memory_order_release);
+		}
+
+	private:
+		std::atomic<bool> mLocked;
+	};
+
+	struct FreeBlock
+	{
+		FreeBlock* mNext;
+	};
+
+	struct CentralList
+	{
+		SpinLock	mLock;
+		FreeBlock*	mHead;
+		// What is left of the last chunk taken for this class
+		char*		mCarve;
+		char*		mCarveEnd;
+	};
+
+	struct ThreadCache
+	{
+		struct List
+		{
+			FreeBlock*	mHead;
+			U32			mCount;
+		};
+
+		List	mLists[NUM_CLASSES];
+		// Not yet added to the totals
+		S64		mBytes[LLSizeClassAllocator::SUBSYSTEM_COUNT];
+		S64		mCount[LLSizeClassAllocator::SUBSYSTEM_COUNT];
+	};
+
+	// All zero initialized, before any constructor runs
+	CentralList sCentral[NUM_CLASSES];
+	std::atomic<S64> sAllocatedBytes[LLSizeClassAllocator::SUBSYSTEM_COUNT];
+	std::atomic<S64> sAllocationCount[LLSizeClassAllocator::SUBSYSTEM_COUNT];
+	std::atomic<U64> sReservedBytes;
+	std::atomic<U64> sMappedBytes;
+
+	ll_thread_local ThreadCache* tThreadCache = NULL;
+
+	inline ThreadCache* get_thread_cache()
+	{
+		if (LL_UNLIKELY(!tThreadCache))
+		{
+			// Not with new: the cache must not depend on what operator new uses
+			tThreadCache = (ThreadCache*)std::calloc(1, sizeof(ThreadCache));
+		}
+		return tThreadCache;
+	}
+
+	void flush_statistics(ThreadCache* cache)
+	{
+		for (U32 i = 0; i < LLSizeClassAllocator::SUBSYSTEM_COUNT; ++i)
+		{
+			if (cache->mCount[i] || cache->mBytes[i])
+			{
+				sAllocatedBytes[i].fetch_add(cache->mBytes[i], std::memory_order_relaxed);
+				sAllocationCount[i].fetch_add(cache->mCount[i], std::memory_order_relaxed);
+				cache->mBytes[i] = 0;
+				cache->mCount[i] = 0;
+			}
+		}
+	}
+
+	// Moves up to count blocks of a class from the central list to list,
+	// carving new ones from a chunk when the central list runs out.
+	void refill(ThreadCache::List& list, U32 size_class, U32 count)
+	{
+		const size_t size = class_size(size_class);
+		CentralList& central = sCentral[size_class];
+
+		central.mLock.lock();
+		U32 moved = 0;
+		while (moved < count && central.mHead)
+		{
+			FreeBlock* block = central.mHead;
+			central.mHead = block->mNext;
+			block->mNext = list.mHead;
+			list.mHead = block;
+			++moved;
+		}
+		while (moved < count)
+		{
+			if ((size_t)(central.mCarveEnd - central.mCarve) < size)
+			{
+				// A whole number of blocks, so that only the page rounding is lost
+				const size_t chunk_size = round_to_pages(size * llmax((size_t)1, CHUNK_SIZE / size));
+				char* chunk = map_pages(chunk_size);
+				if (!chunk)
+				{
+					break;
+				}
+				sReservedBytes.fetch_add(chunk_size, std::memory_order_relaxed);
+				central.mCarve = chunk;
+				central.mCarveEnd = chunk + chunk_size;
+			}
+			FreeBlock* block = (FreeBlock*)central.mCarve;
+			central.mCarve += size;
+			block->mNext = list.mHead;
+			list.mHead = block;
+			++moved;
+		}
+		central.mLock.unlock();
+
+		list.mCount += moved;
+	}
+
+	// Moves the first count blocks of list to the central list.
+	void flush(ThreadCache::List& list, U32 size_class, U32 count)
+	{
+		FreeBlock* first = list.mHead;
+		FreeBlock* last = first;
+		for (U32 i = 1; i < count; ++i)
+		{
+			last = last->mNext;
+		}
+		list.mHead = last->mNext;
+		list.mCount -= count;
+
+		CentralList& central = sCentral[size_class];
+		central.mLock.lock();
+		last->mNext = central.mHead;
+		central.mHead = first;
+		central.mLock.unlock();
+	}
+}
+
+//static
+void* LLSizeClassAllocator::allocate(size_t size, U32 alignment, U32 subsystem)
+{
+	llassert((alignment & (alignment - 1)) == 0 && alignment <= MAX_ALIGNMENT);
+	llassert(subsystem < SUBSYSTEM_COUNT);
+	if (alignment < HEADER_SIZE)
+	{
+		alignment = HEADER_SIZE;
+	}
+	if (subsystem >= SUBSYSTEM_COUNT)
+	{
+		subsystem = OTHER;
+	}
+	if (size > ((size_t)-1 >> 1))
+	{
+		return NULL;
+	}
+
+	// The header and the alignment both fit in alignment bytes in front of
+	// the data, as raw blocks are at least 16 byte aligned.
+	const size_t raw_size = size + alignment;
+	char* raw = NULL;
+	char* ptr = NULL;
+	U32 block_class = LARGE_CLASS;
+	if (raw_size <= MAX_SMALL_SIZE)
+	{
+		ThreadCache* cache = get_thread_cache();
+		if (!cache)
+		{
+			return NULL;
+		}
+		block_class = size_class(raw_size);
+		ThreadCache::List& list = cache->mLists[block_class];
+		if (!list.mHead)
+		{
+			refill(list, block_class, batch_size(block_class));
+			flush_statistics(cache);
+			if (!list.mHead)
+			{
+				return NULL;
+			}
+		}
+		FreeBlock* block = list.mHead;
+		list.mHead = block->mNext;
+		--list.mCount;
+
+		raw = (char*)block;
+		ptr = (char*)(((uintptr_t)raw + HEADER_SIZE + alignment - 1) & ~(uintptr_t)(alignment - 1));
+		cache->mBytes[subsystem] += size;
+		++cache->mCount[subsystem];
+	}
+	else
+	{
+		const size_t map_size = round_to_pages(raw_size);
+		raw = map_pages(map_size);
+		if (!raw)
+		{
+			return NULL;
+		}
+		// pages are aligned to at least MAX_ALIGNMENT
+		ptr = raw + alignment;
+		sMappedBytes.fetch_add(map_size, std::memory_order_relaxed);
+		sAllocatedBytes[subsystem].fetch_add(size, std::memory_order_relaxed);
+		sAllocationCount[subsystem].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	BlockHeader* header = (BlockHeader*)(ptr - HEADER_SIZE);
+	header->mClass = block_class;
+	header->mSubsystem = (U16)subsystem;
+	header->mOffset = (U16)(ptr - raw);
+	header->mSize = size;
+	return ptr;
+}
+
+//static
+void LLSizeClassAllocator::free(void* ptr)
+{
+	if (!ptr)
+	{
+		return;
+	}
+
+	const BlockHeader* header = (const BlockHeader*)((char*)ptr - HEADER_SIZE);
+	char* raw = (char*)ptr - header->mOffset;
+	const U32 block_class = header->mClass;
+	const U32 subsystem = header->mSubsystem;
+	const size_t size = (size_t)header->mSize;
+
+	if (block_class == LARGE_CLASS)
+	{
+		const size_t map_size = round_to_pages(size + header->mOffset);
+		sAllocatedBytes[subsystem].fetch_sub(size, std::memory_order_relaxed);
+		sAllocationCount[subsystem].fetch_sub(1, std::memory_order_relaxed);
+		sMappedBytes.fetch_sub(map_size, std::memory_order_relaxed);
+		unmap_pages(raw, map_size);
+		return;
+	}
+
+	FreeBlock* block = (FreeBlock*)raw;
+	ThreadCache* cache = get_thread_cache();
+	if (!cache)
+	{
+		sAllocatedBytes[subsystem].fetch_sub(size, std::memory_order_relaxed);
+		sAllocationCount[subsystem].fetch_sub(1, std::memory_order_relaxed);
+		ThreadCache::List list = { block, 1 };
+		block->mNext = NULL;
+		flush(list, block_class, 1);
+		return;
+	}
+
+	cache->mBytes[subsystem] -= size;
+	--cache->mCount[subsystem];
+	ThreadCache::List& list = cache->mLists[block_class];
+	block->mNext = list.mHead;
+	list.mHead = block;
+	const U32 batch = batch_size(block_class);
+	if (++list.mCount > 2 * batch)
+	{
+		flush(list, block_class, batch);
+		flush_statistics(cache);
+	}
+}
+
+//static
+void* LLSizeClassAllocator::reallocate(void* ptr, size_t size, U32 alignment, U32 subsystem)
+{
+	if (!ptr)
+	{
+		return allocate(size, alignment, subsystem);
+	}
+
+	BlockHeader* header = (BlockHeader*)((char*)ptr - HEADER_SIZE);
+	const size_t old_size = (size_t)header->mSize;
+	const size_t raw_size = size + llmax(alignment, (U32)HEADER_SIZE);
+	ThreadCache* cache;
+	if (header->mClass != LARGE_CLASS && header->mSubsystem == subsystem && raw_size <= MAX_SMALL_SIZE &&
+		size_class(raw_size) == header->mClass && (cache = get_thread_cache()))
+	{
+		cache->mBytes[subsystem] += (S64)size - (S64)old_size;
+		header->mSize = size;
+		return ptr;
+	}
+
+	void* new_ptr = allocate(size, alignment, subsystem);
+	if (new_ptr)
+	{
+		memcpy(new_ptr, ptr, llmin(size, old_size));
+		free(ptr);
+	}
+	return new_ptr;
+}
+
+//static
+size_t LLSizeClassAllocator::getSize(const void* ptr)
+{
+	return ptr ? (size_t)((const BlockHeader*)((const char*)ptr - HEADER_SIZE))->mSize : 0;
+}
+
+//static
+void LLSizeClassAllocator::releaseThreadCache()
+{
+	ThreadCache* cache = tThreadCache;
+	if (!cache)
+	{
+		return;
+	}
+
+	for (U32 i = 0; i < NUM_CLASSES; ++i)
+	{
+		if (cache->mLists[i].mCount)
+		{
+			flush(cache->mLists[i], i, cache->mLists[i].mCount);
+		}
+	}
+	flush_statistics(cache);
+	tThreadCache = NULL;
+	std::free(cache);
+}
+
+//static
+const char* LLSizeClassAllocator::getSubsystemName(U32 subsystem)
+{
+	static const char* names[SUBSYSTEM_COUNT] = { "Other", "Image", "Volume", "Vertex buffer" };
+	return subsystem < SUBSYSTEM_COUNT ? names[subsystem] : "";
+}
+
+//static
+S64 LLSizeClassAllocator::getAllocatedBytes(U32 subsystem)
+{
+	return subsystem < SUBSYSTEM_COUNT ? sAllocatedBytes[subsystem].load(std::memory_order_relaxed) : 0;
+}
+
+//static
+S64 LLSizeClassAllocator::getAllocationCount(U32 subsystem)
+{
+	return subsystem < SUBSYSTEM_COUNT ? sAllocationCount[subsystem].load(std::memory_order_relaxed) : 0;
+}
+
+//static
+U64 LLSizeClassAllocator::getReservedBytes()
+{
+	return sReservedBytes.load(std::memory_order_relaxed);
+}
+
+//static
+U64 LLSizeClassAllocator::getMappedBytes()
+{
+	return sMappedBytes.load(std::memory_order_relaxed);
+}
+
+//static
+void LLSizeClassAllocator::logStatistics()
+{
+	LL_INFOS() << "--- size class allocator --- " << LL_ENDL;
+	LL_INFOS() << "Small blocks reserved (KB): " << getReservedBytes() / 1024 << LL_ENDL;
+	LL_INFOS() << "Large blocks mapped (KB): " << getMappedBytes() / 1024 << LL_ENDL;
+	for (U32 i = 0; i < SUBSYSTEM_COUNT; ++i)
+	{
+		LL_INFOS() << getSubsystemName(i) << " allocated (KB): " << getAllocatedBytes(i) / 1024
+				   << " in " << getAllocationCount(i) << " blocks" << LL_ENDL;
+	}
+}
@@ -0,0 +1,104 @@
+/**
+ * @file llsizeclassallocator.h
+ * @brief Size classed allocator with per thread caches, for the image,
+ *        volume and vertex buffer data.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSIZECLASSALLOCATOR_H
+#define LL_LLSIZECLASSALLOCATOR_H
+
+#include "stdtypes.h"
+#include "llpreprocessor.h"
+
+#include <cstddef>
+
+// Allocator for the large, short lived buffers of the image decoders, the
+// texture cache and fetcher, the volume faces and the vertex buffers.
+//
+// Blocks up to MAX_SMALL_SIZE are rounded up to one of a few dozen size
+// classes: multiples of 16 bytes up to 256 bytes, then four classes per
+// power of two.  Each thread keeps a short free list per class and only
+// takes the lock of the central list of a class to move a whole batch of
+// blocks in or out, so most allocations and frees are a few loads and stores.
+// A block may be freed by another thread than the one that allocated it; it
+// then goes to the freeing thread's cache.  Small blocks are carved from
+// 1 MB chunks that are kept for the life of the process.
+//
+// Larger blocks are mapped from the system (mmap or VirtualAlloc) and
+// unmapped when freed, so that the textures that come and go don't leave
+// holes in the heap.
+//
+// Every block is tagged with the subsystem it was allocated for, and the
+// bytes in use are counted per subsystem.  The counts are gathered per thread
+// and added up when a thread's cache goes to the central lists, so they lag
+// behind by at most a few batches.
+class LL_COMMON_API LLSizeClassAllocator
+{
+public:
+	enum ESubsystem
+	{
+		OTHER,
+		IMAGE,			// decoded and raw image data, texture cache and fetch buffers
+		VOLUME,			// volume face vertex and index arrays
+		VERTEX_BUFFER,	// client side copies of vertex and index buffers
+		SUBSYSTEM_COUNT
+	};
+
+	enum
+	{
+		MAX_SMALL_SIZE = 256 << 10,	// larger blocks are mapped on their own
+		MAX_ALIGNMENT = 4096
+	};
+
+	// Returns a block of at least size bytes aligned to alignment, a power of
+	// two up to MAX_ALIGNMENT (at least 16 is always used), or NULL when out of
+	// memory.  The block must be freed with free().
+	static void* allocate(size_t size, U32 alignment, U32 subsystem);
+	static void free(void* ptr);
+	// Like allocate() followed by a copy and a free(), but keeps the block when
+	// the new size still fits in its size class.  The alignment must be the
+	// one the block was allocated with.
+	static void* reallocate(void* ptr, size_t size, U32 alignment, U32 subsystem);
+
+	// Size the block was allocated with.
+	static size_t getSize(const void* ptr);
+
+	// Gives the calling thread's cached blocks back to the central lists.
+	// LLThread calls it when a thread's run() returns, other threads that
+	// allocate should call it before they exit.
+	static void releaseThreadCache();
+
+	static const char* getSubsystemName(U32 subsystem);
+	// Bytes requested and blocks in use for a subsystem.
+	static S64 getAllocatedBytes(U32 subsystem);
+	static S64 getAllocationCount(U32 subsystem);
+	// Bytes taken from the system for small blocks (never given back), and
+	// bytes currently mapped for large blocks.
+	static U64 getReservedBytes();
+	static U64 getMappedBytes();
+
+	static void logStatistics();
+};
+
+#endif // LL_LLSIZECLASSALLOCATOR_H
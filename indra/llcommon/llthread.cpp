@@ -34,6 +34,8 @@
 #include "apr_portable.h"
 
 #include "llthread.h"
+#include "llfasttimer.h"
+#include "llsizeclassallocator.h"
 
 #include "lltimer.h"
 
@@ -89,9 +91,15 @@ void *APR_THREAD_FUNC LLThread::staticRun(apr_thread_t *apr_threadp, void *datap
 	// Create a thread local data.
 	LLThreadLocalData::create(threadp);
 
+	// Name this thread in the fast timer summaries and traces.
+	LLFastTimer::setThreadName(threadp->mName);
+
 	// Run the user supplied function
 	threadp->run();
 
+	LLFastTimer::releaseThreadTimers();
+	LLSizeClassAllocator::releaseThreadCache();
+
 	// Setting mStatus to STOPPED is done non-thread-safe, so it's
 	// possible that the thread is deleted by another thread at
 	// the moment it happens... therefore make a copy here.
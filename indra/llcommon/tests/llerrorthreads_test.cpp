@@ -0,0 +1,331 @@
+/**
+ * @file llerrorthreads_test.cpp
+ * @brief Checks and times logging from several threads, with the cached call
+ *        site filtering and the asynchronous log sink.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llerrorcontrol.h"
+#include "../llthread.h"
+#include "../lltimer.h"
+
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	const S32 THREADS = 4;
+
+	// Checks that every thread's messages arrive, in the order it logged them.
+	// Like the file recorder, it takes its time over each message.
+	class OrderRecorder : public LLError::Recorder
+	{
+	public:
+		OrderRecorder() :
+			mNext(THREADS, 0),
+			mCount(0),
+			mOutOfOrder(0)
+		{
+			mWantsLevel = false;
+			mWantsFunctionName = false;
+		}
+
+		/*virtual*/ void recordMessage(LLError::ELevel level, const std::string& message)
+		{
+			size_t pos = message.find("bench ");
+			if (pos == std::string::npos)
+			{
+				return;
+			}
+			S32 thread = 0;
+			S32 seq = 0;
+			if (sscanf(message.c_str() + pos, "bench %d %d", &thread, &seq) != 2 || thread < 0 || thread >= THREADS)
+			{
+				return;
+			}
+			if (seq != mNext[thread])
+			{
+				++mOutOfOrder;
+			}
+			mNext[thread] = seq + 1;
+			++mCount;
+
+			// a flushed write to a file is in the order of a microsecond
+			LLTimer timer;
+			while (timer.getElapsedTimeF64() < 0.000001)
+			{
+			}
+		}
+
+		std::vector<S32>	mNext;
+		S32					mCount;
+		S32					mOutOfOrder;
+	};
+
+	// Logs a message of its own for every "outer" message it records, as a
+	// recorder that reports its own trouble does.  On the sink, and slow
+	// enough that the queue fills up.
+	class LoggingRecorder : public LLError::Recorder
+	{
+	public:
+		LoggingRecorder() :
+			mOuter(0),
+			mInner(0)
+		{
+			mWantsLevel = false;
+			mWantsFunctionName = false;
+		}
+
+		/*virtual*/ void recordMessage(LLError::ELevel level, const std::string& message)
+		{
+			if (message.find("inner") != std::string::npos)
+			{
+				++mInner;
+				return;
+			}
+			if (message.find("outer") == std::string::npos)
+			{
+				return;
+			}
+			++mOuter;
+			LL_WARNS("LogBench") << "inner " << mOuter << LL_ENDL;
+
+			LLTimer timer;
+			while (timer.getElapsedTimeF64() < 0.00001)
+			{
+			}
+		}
+
+		S32 mOuter;
+		S32 mInner;
+	};
+
+	class LoggerThread : public LLThread
+	{
+	public:
+		LoggerThread(S32 index, S32 count, bool filtered) :
+			LLThread("Logger"),
+			mIndex(index),
+			mCount(count),
+			mFiltered(filtered)
+		{
+		}
+
+		/*virtual*/ void run()
+		{
+			for (S32 i = 0; i < mCount; ++i)
+			{
+				if (mFiltered)
+				{
+					// below the default level: only the filtering is timed
+					LL_INFOS("LogBench") << "bench " << mIndex << " " << i << LL_ENDL;
+				}
+				else
+				{
+					LL_WARNS("LogBench") << "bench " << mIndex << " " << i << LL_ENDL;
+				}
+			}
+		}
+
+	private:
+		S32 mIndex;
+		S32 mCount;
+		bool mFiltered;
+	};
+
+	// Runs THREADS threads that log count messages each, returns the time
+	// until the last message went out.
+	F64 run_loggers(S32 count, bool filtered)
+	{
+		std::vector<LoggerThread*> threads;
+		for (S32 i = 0; i < THREADS; ++i)
+		{
+			threads.push_back(new LoggerThread(i, count, filtered));
+		}
+
+		LLTimer timer;
+		for (LoggerThread* thread : threads)
+		{
+			thread->start();
+		}
+		for (LoggerThread* thread : threads)
+		{
+			while (!thread->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete thread;
+		}
+		if (LLError::getAsyncLogging())
+		{
+			// flushes the sink
+			LLError::setAsyncLogging(false);
+			LLError::setAsyncLogging(true);
+		}
+		return timer.getElapsedTimeF64() * 1000.0;
+	}
+}
+
+namespace tut
+{
+	struct errorthreads_test
+	{
+		// The benchmark runs without the test's own recorders, so that only
+		// the recorders below see the messages.
+		errorthreads_test() :
+			mPriorSettings(LLError::saveAndResetSettings())
+		{
+			LLError::setDefaultLevel(LLError::LEVEL_WARN);
+		}
+
+		~errorthreads_test()
+		{
+			restore();
+		}
+
+		void restore()
+		{
+			LLError::setAsyncLogging(false);
+			if (mPriorSettings)
+			{
+				LLError::restoreSettings(mPriorSettings);
+				mPriorSettings = NULL;
+			}
+		}
+
+		LLError::SettingsStoragePtr mPriorSettings;
+	};
+	typedef test_group<errorthreads_test> errorthreads_group_t;
+	typedef errorthreads_group_t::object errorthreads_object_t;
+	tut::errorthreads_group_t errorthreads_instance("error_threads");
+
+	// Filtered out messages: the cached call site decision is all there is
+	template<> template<>
+	void errorthreads_object_t::test<1>()
+	{
+		const S32 COUNT = 1000000;
+		int checks = LLError::shouldLogCallCount();
+		F64 elapsed = run_loggers(COUNT, true);
+		// each thread may get to the call site before the first decision is
+		// cached, and LLThread logs too
+		ensure("filtering is cached", LLError::shouldLogCallCount() - checks <= 4 * THREADS);
+
+		// a settings change is seen by the call sites
+		LLError::setTagLevel("LogBench", LLError::LEVEL_INFO);
+		boost::shared_ptr<OrderRecorder> recorder(new OrderRecorder);
+		LLError::addRecorder(recorder);
+		run_loggers(1, true);
+		LLError::removeRecorder(recorder);
+		ensure_equals("new level applies", recorder->mCount, THREADS);
+
+		restore();
+		LL_INFOS() << "Filtered logging: " << THREADS << " threads, " << THREADS * COUNT << " messages in "
+				   << elapsed << " ms" << LL_ENDL;
+	}
+
+	// Logged messages, written by the logging threads and by the sink
+	template<> template<>
+	void errorthreads_object_t::test<2>()
+	{
+		const S32 COUNT = 20000;
+
+		boost::shared_ptr<OrderRecorder> sync_recorder(new OrderRecorder);
+		LLError::addRecorder(sync_recorder);
+		F64 sync_time = run_loggers(COUNT, false);
+		LLError::removeRecorder(sync_recorder);
+		ensure_equals("all written", sync_recorder->mCount, THREADS * COUNT);
+		ensure_equals("in order", sync_recorder->mOutOfOrder, 0);
+
+		LLError::setAsyncLogging(true);
+		boost::shared_ptr<OrderRecorder> async_recorder(new OrderRecorder);
+		LLError::addRecorder(async_recorder);
+		F64 async_time = run_loggers(COUNT, false);
+		LLError::setAsyncLogging(false);
+		LLError::removeRecorder(async_recorder);
+		ensure_equals("all written by the sink", async_recorder->mCount, THREADS * COUNT);
+		ensure_equals("in order from the sink", async_recorder->mOutOfOrder, 0);
+
+		restore();
+		LL_INFOS() << "Logging: " << THREADS << " threads, " << THREADS * COUNT << " messages: synchronous "
+				   << sync_time << " ms, log sink " << async_time << " ms" << LL_ENDL;
+	}
+
+	// What a crash handler does: the queued messages get out while the sink keeps running
+	template<> template<>
+	void errorthreads_object_t::test<3>()
+	{
+		const S32 COUNT = 5000;
+
+		LLError::setAsyncLogging(true);
+		boost::shared_ptr<OrderRecorder> recorder(new OrderRecorder);
+		LLError::addRecorder(recorder);
+
+		std::vector<LoggerThread*> threads;
+		for (S32 i = 0; i < THREADS; ++i)
+		{
+			threads.push_back(new LoggerThread(i, COUNT, false));
+			threads.back()->start();
+		}
+		for (LoggerThread* thread : threads)
+		{
+			while (!thread->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete thread;
+		}
+
+		LLError::flushAsyncLogging();
+		ensure("sink still running", LLError::getAsyncLogging());
+		ensure_equals("all written after the flush", recorder->mCount, THREADS * COUNT);
+		ensure_equals("in order", recorder->mOutOfOrder, 0);
+
+		LLError::setAsyncLogging(false);
+		LLError::removeRecorder(recorder);
+		restore();
+	}
+
+	// A recorder that logs from the sink while the queue is full doesn't wait for itself
+	template<> template<>
+	void errorthreads_object_t::test<4>()
+	{
+		const S32 COUNT = 20000;
+
+		LLError::setAsyncLogging(true);
+		boost::shared_ptr<LoggingRecorder> recorder(new LoggingRecorder);
+		LLError::addRecorder(recorder);
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			LL_WARNS("LogBench") << "outer " << i << LL_ENDL;
+		}
+		LLError::flushAsyncLogging();
+		LLError::setAsyncLogging(false);
+		LLError::removeRecorder(recorder);
+		ensure_equals("all written", recorder->mOuter, COUNT);
+		ensure_equals("all logged by the recorder written", recorder->mInner, COUNT);
+		restore();
+	}
+}
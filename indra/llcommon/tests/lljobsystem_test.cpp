@@ -0,0 +1,233 @@
+/**
+ * @file lljobsystem_test.cpp
+ * @brief Tests and microbenchmark for LLJobSystem.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../lljobsystem.h"
+#include "../lltimer.h"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	// Appends to a log the jobs share, to check the order they ran in.
+	class OrderLog
+	{
+	public:
+		void add(S32 step)
+		{
+			LLMutexLock lock(mMutex);
+			mSteps.push_back(step);
+		}
+
+		LLMutex				mMutex;
+		std::vector<S32>	mSteps;
+	};
+
+	// Some work whose length depends on index, so that jobs are uneven.
+	F32 busy_work(S32 index)
+	{
+		F32 sum = 0.f;
+		for (S32 i = 0; i < 200 + (index % 7) * 300; ++i)
+		{
+			sum += sqrtf((F32)(i + index));
+		}
+		return sum;
+	}
+}
+
+namespace tut
+{
+	struct jobsystem_test
+	{
+	};
+	typedef test_group<jobsystem_test> jobsystem_group_t;
+	typedef jobsystem_group_t::object jobsystem_object_t;
+	tut::jobsystem_group_t jobsystem_instance("job_system");
+
+	// Every job submitted runs once
+	template<> template<>
+	void jobsystem_object_t::test<1>()
+	{
+		LLJobSystem jobs("Test Job", 3);
+		const S32 COUNT = 5000;
+		std::vector<S32> runs(COUNT, 0);
+		LLJobSystem::job_list_t submitted;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			submitted.push_back(jobs.submit([&runs, i]() { ++runs[i]; }));
+		}
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			jobs.wait(submitted[i]);
+			ensure("done", submitted[i]->isDone());
+		}
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			ensure_equals("ran once", runs[i], 1);
+		}
+		ensure_equals("nothing queued", jobs.getQueuedJobs(), 0);
+	}
+
+	// Jobs run after the jobs they depend on, main thread jobs from
+	// runMainThreadJobs() only
+	template<> template<>
+	void jobsystem_object_t::test<2>()
+	{
+		LLJobSystem jobs("Test Job", 3);
+		for (S32 pass = 0; pass < 100; ++pass)
+		{
+			OrderLog log;
+			LLJobSystem::job_ptr_t first = jobs.submit([&log]() { log.add(1); });
+			LLJobSystem::job_list_t middle;
+			for (S32 i = 0; i < 4; ++i)
+			{
+				middle.push_back(jobs.then(first, [&log]() { log.add(2); }));
+			}
+			LLJobSystem::job_ptr_t last = jobs.submit([&log]() { log.add(3); }, NULL, middle);
+			bool on_main_thread = false;
+			LLJobSystem::job_ptr_t completion = jobs.then(last, [&log, &on_main_thread]()
+				{
+					on_main_thread = AIThreadID::in_main_thread();
+					log.add(4);
+				}, NULL, LLJobSystem::MAIN_THREAD);
+
+			while (!completion->isDone())
+			{
+				jobs.runMainThreadJobs(1.f);
+			}
+			ensure("completed on the main thread", on_main_thread);
+			ensure_equals("all ran", log.mSteps.size(), (size_t)7);
+			ensure_equals("first", log.mSteps[0], 1);
+			for (S32 i = 1; i <= 4; ++i)
+			{
+				ensure_equals("after first", log.mSteps[i], 2);
+			}
+			ensure_equals("after all of the middle", log.mSteps[5], 3);
+			ensure_equals("completion", log.mSteps[6], 4);
+		}
+
+		// Depending on jobs that are done already
+		LLJobSystem::job_ptr_t done = jobs.submit([]() {});
+		jobs.wait(done);
+		S32 ran = 0;
+		jobs.wait(jobs.then(done, [&ran]() { ++ran; }));
+		ensure_equals("ran after a done job", ran, 1);
+	}
+
+	// parallelFor() visits every index once, also from inside jobs, and jobs
+	// are timed by their timer
+	template<> template<>
+	void jobsystem_object_t::test<3>()
+	{
+		static LLFastTimer::DeclareTimer FTM_TEST_JOB("Test Job");
+		LLJobSystem jobs("Test Job", 3);
+		const S32 OUTER = 16;
+		const S32 INNER = 64;
+		std::vector<std::atomic<S32> > visits(OUTER * INNER);
+		for (size_t i = 0; i < visits.size(); ++i)
+		{
+			visits[i] = 0;
+		}
+
+		LLJobSystem::job_list_t outer;
+		for (S32 i = 0; i < OUTER; ++i)
+		{
+			outer.push_back(jobs.submit([&jobs, &visits, i, INNER]()
+				{
+					jobs.parallelFor(INNER, [&visits, i, INNER](S32 k) { ++visits[i * INNER + k]; }, 3);
+				}, &FTM_TEST_JOB));
+		}
+		jobs.parallelFor(INNER, [&visits](S32 k) { ++visits[k]; }, 8);
+		for (S32 i = 0; i < OUTER; ++i)
+		{
+			jobs.wait(outer[i]);
+		}
+		for (size_t i = 0; i < visits.size(); ++i)
+		{
+			ensure_equals("visited once", (S32)visits[i], i < (size_t)INNER ? 2 : 1);
+		}
+
+		S32 calls = 0;
+		jobs.parallelFor(10, [&calls](S32) { ++calls; }, 0);
+		ensure_equals("without helpers", calls, 10);
+	}
+
+	// With LL_JOB_SYSTEM_BENCH set, compares parallelFor() with a plain loop
+	// on uneven jobs, and logs the job throughput.
+	template<> template<>
+	void jobsystem_object_t::test<4>()
+	{
+		if (!getenv("LL_JOB_SYSTEM_BENCH"))
+		{
+			return;
+		}
+		const S32 THREADS = 3;
+		const S32 COUNT = 2000;
+		const S32 LOOPS = 50;
+		std::vector<F32> results(COUNT);
+		std::function<void(S32)> func = [&results](S32 index) { results[index] = busy_work(index); };
+
+		LLTimer timer;
+		for (S32 i = 0; i < LOOPS; ++i)
+		{
+			for (S32 index = 0; index < COUNT; ++index)
+			{
+				func(index);
+			}
+		}
+		F64 loop_time = timer.getElapsedTimeF64();
+
+		LLJobSystem jobs("Bench Job", THREADS);
+		timer.reset();
+		for (S32 i = 0; i < LOOPS; ++i)
+		{
+			jobs.parallelFor(COUNT, func, THREADS);
+		}
+		F64 jobs_time = timer.getElapsedTimeF64();
+
+		timer.reset();
+		LLJobSystem::job_list_t submitted;
+		for (S32 i = 0; i < COUNT * 10; ++i)
+		{
+			submitted.push_back(jobs.submit([]() {}));
+		}
+		for (size_t i = 0; i < submitted.size(); ++i)
+		{
+			jobs.wait(submitted[i]);
+		}
+		F64 submit_time = timer.getElapsedTimeF64();
+
+		LL_INFOS() << "Loop " << loop_time * 1000.0 / LOOPS << " ms, LLJobSystem::parallelFor "
+				   << jobs_time * 1000.0 / LOOPS << " ms per batch of " << COUNT << "; "
+				   << submit_time * 1.0e9 / submitted.size() << " ns per empty job" << LL_ENDL;
+	}
+}
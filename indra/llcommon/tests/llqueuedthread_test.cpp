@@ -0,0 +1,287 @@
+/**
+ * @file llqueuedthread_test.cpp
+ * @brief Tests and microbenchmark for LLQueuedThread::RequestQueue.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llqueuedthread.h"
+#include "../lltimer.h"
+
+#include <set>
+#include <vector>
+
+namespace
+{
+	class TestRequest : public LLQueuedThread::QueuedRequest
+	{
+	public:
+		TestRequest(LLQueuedThread::handle_t handle, U32 priority, S32 steps = 1) :
+			LLQueuedThread::QueuedRequest(handle, priority),
+			mSteps(steps)
+		{
+		}
+
+		/*virtual*/ bool processRequest() { return --mSteps <= 0; }
+		void setPriorityUnqueued(U32 priority) { setPriority(priority); }
+
+		S32 mSteps;		// Only touched by the thread that popped the request.
+	};
+
+	// What LLQueuedThread used before RequestQueue: a std::set behind a mutex.
+	class SetQueue
+	{
+	public:
+		void push(LLQueuedThread::QueuedRequest* req)
+		{
+			LLMutexLock lock(mMutex);
+			mSet.insert(req);
+		}
+		LLQueuedThread::QueuedRequest* pop()
+		{
+			LLMutexLock lock(mMutex);
+			if (mSet.empty())
+			{
+				return NULL;
+			}
+			LLQueuedThread::QueuedRequest* req = *mSet.begin();
+			mSet.erase(mSet.begin());
+			return req;
+		}
+		void setPriority(LLQueuedThread::QueuedRequest* req, U32 priority)
+		{
+			LLMutexLock lock(mMutex);
+			bool queued = mSet.erase(req) == 1;
+			static_cast<TestRequest*>(req)->setPriorityUnqueued(priority);
+			if (queued)
+			{
+				mSet.insert(req);
+			}
+		}
+
+	private:
+		struct less
+		{
+			bool operator()(const LLQueuedThread::QueuedRequest* lhs, const LLQueuedThread::QueuedRequest* rhs) const
+			{
+				return lhs->higherPriority(*rhs);
+			}
+		};
+		LLMutex mMutex;
+		std::set<LLQueuedThread::QueuedRequest*, less> mSet;
+	};
+
+	// Pops requests like the texture fetch worker thread does: most requests take
+	// several passes and go back into the queue until they are complete.
+	template<class QUEUE>
+	class ConsumerThread : public LLThread
+	{
+	public:
+		ConsumerThread(QUEUE& queue, LLAtomicS32& remaining) :
+			LLThread("RequestQueue consumer"),
+			mQueue(queue),
+			mRemaining(remaining)
+		{
+		}
+
+		/*virtual*/ void run()
+		{
+			while (mRemaining > 0)
+			{
+				LLQueuedThread::QueuedRequest* req = mQueue.pop();
+				if (!req)
+				{
+					LLThread::yield();
+				}
+				else if (static_cast<TestRequest*>(req)->processRequest())
+				{
+					mRemaining -= 1;
+				}
+				else
+				{
+					mQueue.push(req);
+				}
+			}
+		}
+
+	private:
+		QUEUE& mQueue;
+		LLAtomicS32& mRemaining;
+	};
+
+	// One viewer frame worth of texture pipeline traffic per loop: new requests are
+	// added and a large part of the existing ones are reprioritized (the pixel area
+	// of every visible texture changes as the camera moves).
+	template<class QUEUE>
+	F64 run_pipeline(S32 count, S32 adds_per_frame, S32 reprioritizations_per_frame, S32 consumers)
+	{
+		std::vector<TestRequest*> requests;
+		requests.reserve(count);
+		for (S32 i = 0; i < count; ++i)
+		{
+			requests.push_back(new TestRequest(i + 1, LLQueuedThread::PRIORITY_NORMAL, 1 + i % 4));
+		}
+
+		QUEUE queue;
+		LLAtomicS32 remaining(count);
+		std::vector<ConsumerThread<QUEUE>*> threads;
+		for (S32 i = 0; i < consumers; ++i)
+		{
+			threads.push_back(new ConsumerThread<QUEUE>(queue, remaining));
+		}
+
+		LLTimer timer;
+		for (ConsumerThread<QUEUE>* thread : threads)
+		{
+			thread->start();
+		}
+		U32 seed = 1;
+		S32 added = 0;
+		while (remaining > 0)
+		{
+			for (S32 i = 0; i < adds_per_frame && added < count; ++i)
+			{
+				queue.push(requests[added++]);
+			}
+			for (S32 i = 0; i < reprioritizations_per_frame && added; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				U32 priority = LLQueuedThread::PRIORITY_NORMAL | ((seed >> 4) & LLQueuedThread::PRIORITY_LOWBITS);
+				queue.setPriority(requests[seed % added], priority);
+			}
+		}
+		F64 elapsed = timer.getElapsedTimeF64();
+
+		for (ConsumerThread<QUEUE>* thread : threads)
+		{
+			while (!thread->isStopped())
+			{
+				ms_sleep(1);
+			}
+			delete thread;
+		}
+		for (TestRequest* req : requests)
+		{
+			req->deleteRequest();
+		}
+		return elapsed;
+	}
+}
+
+namespace tut
+{
+	struct requestqueue_test
+	{
+	};
+	typedef test_group<requestqueue_test> requestqueue_group_t;
+	typedef requestqueue_group_t::object requestqueue_object_t;
+	tut::requestqueue_group_t requestqueue_instance("requestqueue");
+
+	template<> template<>
+	void requestqueue_object_t::test<1>()
+	{
+		LLQueuedThread::RequestQueue queue;
+		TestRequest* low = new TestRequest(1, LLQueuedThread::PRIORITY_LOW);
+		TestRequest* high = new TestRequest(2, LLQueuedThread::PRIORITY_HIGH);
+		TestRequest* normal1 = new TestRequest(3, LLQueuedThread::PRIORITY_NORMAL);
+		TestRequest* normal2 = new TestRequest(4, LLQueuedThread::PRIORITY_NORMAL);
+		queue.push(low);
+		queue.push(normal1);
+		queue.push(high);
+		queue.push(normal2);
+		ensure_equals("size", queue.size(), 4);
+		ensure("highest first", queue.pop() == high);
+		ensure("equal priority in queue order", queue.pop() == normal1);
+		ensure("equal priority in queue order", queue.pop() == normal2);
+		ensure("lowest last", queue.pop() == low);
+		ensure("empty", queue.pop() == NULL && queue.empty());
+		low->deleteRequest();
+		high->deleteRequest();
+		normal1->deleteRequest();
+		normal2->deleteRequest();
+	}
+
+	template<> template<>
+	void requestqueue_object_t::test<2>()
+	{
+		LLQueuedThread::RequestQueue queue;
+		TestRequest* a = new TestRequest(1, LLQueuedThread::PRIORITY_LOW);
+		TestRequest* b = new TestRequest(2, LLQueuedThread::PRIORITY_NORMAL);
+		TestRequest* c = new TestRequest(3, LLQueuedThread::PRIORITY_HIGH);
+		queue.push(a);
+		queue.push(b);
+		queue.push(c);
+		// Filed into buckets by pop(), then reprioritized in place.
+		ensure("c first", queue.pop() == c);
+		queue.setPriority(a, LLQueuedThread::PRIORITY_URGENT);
+		ensure_equals("new priority", a->getPriority(), (U32)LLQueuedThread::PRIORITY_URGENT);
+		ensure("a moved up", queue.pop() == a);
+		// Reprioritizing a request that is not queued only changes its priority.
+		queue.setPriority(c, LLQueuedThread::PRIORITY_LOW);
+		ensure("b left", queue.pop() == b);
+		ensure("empty", queue.empty());
+		a->deleteRequest();
+		b->deleteRequest();
+		c->deleteRequest();
+	}
+
+	template<> template<>
+	void requestqueue_object_t::test<3>()
+	{
+		LLQueuedThread::RequestQueue queue;
+		TestRequest* a = new TestRequest(1, LLQueuedThread::PRIORITY_LOW);
+		TestRequest* b = new TestRequest(2, LLQueuedThread::PRIORITY_HIGH);
+		queue.push(a);
+		queue.push(b);
+		// Still on the incoming stack.
+		queue.setPriority(a, LLQueuedThread::PRIORITY_IMMEDIATE);
+		S32 seen = 0;
+		queue.forEach([&seen](LLQueuedThread::QueuedRequest*) { ++seen; });
+		ensure_equals("forEach", seen, 2);
+		ensure("a first", queue.pop() == a);
+		queue.clear();
+		ensure("cleared", queue.empty() && queue.pop() == NULL);
+		// A cleared request can be queued again.
+		queue.push(b);
+		ensure("b again", queue.pop() == b);
+		a->deleteRequest();
+		b->deleteRequest();
+	}
+
+	// Microbenchmark: compares RequestQueue with the old mutex guarded std::set
+	// under a load shaped like the texture fetch pipeline.
+	template<> template<>
+	void requestqueue_object_t::test<4>()
+	{
+		const S32 COUNT = 20000;
+		const S32 ADDS_PER_FRAME = 100;
+		const S32 REPRIORITIZATIONS_PER_FRAME = 1000;
+		const S32 CONSUMERS = 2;
+		F64 old_time = run_pipeline<SetQueue>(COUNT, ADDS_PER_FRAME, REPRIORITIZATIONS_PER_FRAME, CONSUMERS);
+		F64 new_time = run_pipeline<LLQueuedThread::RequestQueue>(COUNT, ADDS_PER_FRAME, REPRIORITIZATIONS_PER_FRAME, CONSUMERS);
+		LL_INFOS() << "RequestQueue: " << COUNT << " requests, " << CONSUMERS << " consumers: std::set "
+				   << old_time * 1000.0 << " ms, buckets " << new_time * 1000.0 << " ms" << LL_ENDL;
+	}
+}
@@ -0,0 +1,257 @@
+/**
+ * @file llsizeclassallocator_test.cpp
+ * @brief Checks and times the size class allocator against the aligned heap,
+ *        with blocks freed by other threads.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llmemory.h"
+#include "../llrand.h"
+#include "../llsizeclassallocator.h"
+#include "../llthread.h"
+#include "../lltimer.h"
+
+#include <vector>
+
+namespace
+{
+	const S32 THREADS = 4;
+
+	struct Block
+	{
+		U8*		mData;
+		size_t	mSize;
+	};
+
+	// The sizes vertex buffers and volume faces come in: mostly a few KB, now
+	// and then a texture's worth.
+	size_t random_size()
+	{
+		return ll_rand(16) ? ll_rand(8192) : ll_rand(1 << 20);
+	}
+
+	void fill(const Block& block)
+	{
+		memset(block.mData, (U8)block.mSize, block.mSize);
+	}
+
+	bool check(const Block& block)
+	{
+		for (size_t i = 0; i < block.mSize; i += 61)
+		{
+			if (block.mData[i] != (U8)block.mSize)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Allocates blocks and frees them in a random order, then frees the blocks
+	// the previous thread left and leaves its own for the next one.
+	class AllocatorThread : public LLThread
+	{
+	public:
+		AllocatorThread(std::vector<Block>& inherited) :
+			LLThread("Allocator"),
+			mInherited(inherited),
+			mErrors(0)
+		{
+		}
+
+		/*virtual*/ void run()
+		{
+			std::vector<Block> live;
+			for (S32 i = 0; i < 20000; ++i)
+			{
+				if (live.size() < 256 && ll_rand(2))
+				{
+					Block block;
+					block.mSize = random_size();
+					U32 alignment = 16 << ll_rand(3);
+					block.mData = (U8*)LLSizeClassAllocator::allocate(block.mSize, alignment, LLSizeClassAllocator::VERTEX_BUFFER);
+					if (!block.mData || ((uintptr_t)block.mData & (alignment - 1)) ||
+						LLSizeClassAllocator::getSize(block.mData) != block.mSize)
+					{
+						++mErrors;
+						continue;
+					}
+					fill(block);
+					live.push_back(block);
+				}
+				else if (!live.empty())
+				{
+					size_t index = ll_rand((S32)live.size());
+					Block block = live[index];
+					live[index] = live.back();
+					live.pop_back();
+					if (!check(block))
+					{
+						++mErrors;
+					}
+					LLSizeClassAllocator::free(block.mData);
+				}
+			}
+
+			for (size_t i = 0; i < mInherited.size(); ++i)
+			{
+				if (!check(mInherited[i]))
+				{
+					++mErrors;
+				}
+				LLSizeClassAllocator::free(mInherited[i].mData);
+			}
+			mInherited.swap(live);
+		}
+
+		std::vector<Block>& mInherited;
+		S32 mErrors;
+	};
+
+	// Times count rounds of allocating and freeing 1000 blocks of sizes
+	// 64 to 8 KB.
+	F64 time_allocator(S32 count)
+	{
+		std::vector<void*> blocks(1000);
+		LLTimer timer;
+		for (S32 round = 0; round < count; ++round)
+		{
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				blocks[i] = LLSizeClassAllocator::allocate(64 + i * 8, 64, LLSizeClassAllocator::VOLUME);
+			}
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				LLSizeClassAllocator::free(blocks[i]);
+			}
+		}
+		return timer.getElapsedTimeF64() * 1000.0;
+	}
+
+	F64 time_heap(S32 count)
+	{
+		std::vector<void*> blocks(1000);
+		LLTimer timer;
+		for (S32 round = 0; round < count; ++round)
+		{
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				blocks[i] = ll_aligned_malloc<64>(64 + i * 8);
+			}
+			for (size_t i = 0; i < blocks.size(); ++i)
+			{
+				ll_aligned_free<64>(blocks[i]);
+			}
+		}
+		return timer.getElapsedTimeF64() * 1000.0;
+	}
+}
+
+namespace tut
+{
+	struct sizeclassallocator_test
+	{
+	};
+	typedef test_group<sizeclassallocator_test> sizeclassallocator_group_t;
+	typedef sizeclassallocator_group_t::object sizeclassallocator_object_t;
+	tut::sizeclassallocator_group_t sizeclassallocator_instance("size_class_allocator");
+
+	// Blocks keep their size, alignment and contents, and the accounting
+	// balances once all the threads are done.
+	template<> template<>
+	void sizeclassallocator_object_t::test<1>()
+	{
+		// this thread's counts so far go into the totals
+		LLSizeClassAllocator::releaseThreadCache();
+		S64 bytes = LLSizeClassAllocator::getAllocatedBytes(LLSizeClassAllocator::VERTEX_BUFFER);
+		S64 count = LLSizeClassAllocator::getAllocationCount(LLSizeClassAllocator::VERTEX_BUFFER);
+
+		std::vector<Block> handed_over;
+		S32 errors = 0;
+		for (S32 pass = 0; pass < 2; ++pass)
+		{
+			std::vector<AllocatorThread*> threads;
+			for (S32 i = 0; i < THREADS; ++i)
+			{
+				threads.push_back(new AllocatorThread(handed_over));
+			}
+			// One at a time, as they share the handed over blocks
+			for (AllocatorThread* thread : threads)
+			{
+				thread->start();
+				while (!thread->isStopped())
+				{
+					ms_sleep(1);
+				}
+				errors += thread->mErrors;
+				delete thread;
+			}
+		}
+		for (size_t i = 0; i < handed_over.size(); ++i)
+		{
+			LLSizeClassAllocator::free(handed_over[i].mData);
+		}
+		LLSizeClassAllocator::releaseThreadCache();
+
+		ensure_equals("blocks intact", errors, 0);
+		ensure_equals("bytes balance", LLSizeClassAllocator::getAllocatedBytes(LLSizeClassAllocator::VERTEX_BUFFER), bytes);
+		ensure_equals("blocks balance", LLSizeClassAllocator::getAllocationCount(LLSizeClassAllocator::VERTEX_BUFFER), count);
+	}
+
+	// Reallocation keeps the contents
+	template<> template<>
+	void sizeclassallocator_object_t::test<2>()
+	{
+		U8* data = (U8*)LLSizeClassAllocator::allocate(100, 16, LLSizeClassAllocator::IMAGE);
+		for (S32 i = 0; i < 100; ++i)
+		{
+			data[i] = (U8)i;
+		}
+		U8* same = (U8*)LLSizeClassAllocator::reallocate(data, 110, 16, LLSizeClassAllocator::IMAGE);
+		ensure("same size class keeps the block", same == data);
+		data = (U8*)LLSizeClassAllocator::reallocate(same, 400 << 10, 16, LLSizeClassAllocator::IMAGE);
+		ensure_equals("large block size", LLSizeClassAllocator::getSize(data), (size_t)(400 << 10));
+		for (S32 i = 0; i < 100; ++i)
+		{
+			ensure_equals("contents kept", data[i], (U8)i);
+		}
+		LLSizeClassAllocator::free(data);
+		LLSizeClassAllocator::free(NULL);
+	}
+
+	template<> template<>
+	void sizeclassallocator_object_t::test<3>()
+	{
+		const S32 ROUNDS = 2000;
+		time_allocator(10);
+		F64 allocator_time = time_allocator(ROUNDS);
+		F64 heap_time = time_heap(ROUNDS);
+		LLSizeClassAllocator::releaseThreadCache();
+
+		LL_INFOS() << "Allocation: " << ROUNDS << " rounds of 1000 blocks, aligned heap " << heap_time
+				   << " ms, size class allocator " << allocator_time << " ms" << LL_ENDL;
+	}
+}
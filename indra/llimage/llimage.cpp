@@ -47,14 +47,12 @@
 //static
 std::string LLImage::sLastErrorMessage;
 LLMutex* LLImage::sMutex = NULL;
-LLPrivateMemoryPool* LLImageBase::sPrivatePoolp = NULL ;
 
 //static
 void LLImage::initClass()
 {
 	sMutex = new LLMutex;
 	LLImageJ2C::openDSO();
-	LLImageBase::createPrivatePool() ;
 }
 
 //static
@@ -63,8 +61,6 @@ void LLImage::cleanupClass()
 	LLImageJ2C::closeDSO();
 	delete sMutex;
 	sMutex = NULL;
-
-	LLImageBase::destroyPrivatePool() ;
 }
 
 //static
@@ -102,25 +98,6 @@ LLImageBase::~LLImageBase()
 	deleteData(); // virtual
 }
 
-//static 
-void LLImageBase::createPrivatePool() 
-{
-	if(!sPrivatePoolp)
-	{
-		sPrivatePoolp = LLPrivateMemoryPoolManager::getInstance()->newPool(LLPrivateMemoryPool::STATIC_THREADED) ;
-	}
-}
-	
-//static 
-void LLImageBase::destroyPrivatePool() 
-{
-	if(sPrivatePoolp)
-	{
-		LLPrivateMemoryPoolManager::getInstance()->deletePool(sPrivatePoolp) ;
-		sPrivatePoolp = NULL ;
-	}
-}
-
 // virtual
 void LLImageBase::dump()
 {
@@ -154,7 +131,7 @@ void LLImageBase::sanityCheck()
 // virtual
 void LLImageBase::deleteData()
 {
-	FREE_MEM(sPrivatePoolp, mData) ;
+	FREE_MEM(LLSizeClassAllocator::IMAGE, mData) ;
 	mData = NULL;
 	mDataSize = 0;
 }
@@ -189,7 +166,7 @@ U8* LLImageBase::allocateData(S32 size)
 	{
 		deleteData(); // virtual
 		mBadBufferAllocation = false ;
-		mData = (U8*)ALLOCATE_MEM(sPrivatePoolp, size);
+		mData = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, size);
 		if (!mData)
 		{
 			LL_WARNS() << "Failed to allocate image data size [" << size << "]" << LL_ENDL;
@@ -222,18 +199,13 @@ U8* LLImageBase::reallocateData(S32 size)
 	if(mData && (mDataSize == size))
 		return mData;
 
-	U8 *new_datap = (U8*)ALLOCATE_MEM(sPrivatePoolp, size);
+	// keeps the block when the new size is in the same size class
+	U8 *new_datap = (U8*)LLSizeClassAllocator::reallocate(mData, size, 16, LLSizeClassAllocator::IMAGE);
 	if (!new_datap)
 	{
 		LL_WARNS() << "Out of memory in LLImageBase::reallocateData" << LL_ENDL;
 		return 0;
 	}
-	if (mData)
-	{
-		S32 bytes = llmin(mDataSize, size);
-		memcpy(new_datap, mData, bytes);	/* Flawfinder: ignore */
-		FREE_MEM(sPrivatePoolp, mData) ;
-	}
 	mData = new_datap;
 	mDataSize = size;
 	return mData;
@@ -1651,7 +1623,7 @@ void LLImageFormatted::appendData(U8 *data, S32 size)
 			S32 newsize = cursize + size;
 			reallocateData(newsize);
 			memcpy(getData() + cursize, data, size);
-			FREE_MEM(LLImageBase::getPrivatePool(), data);
+			FREE_MEM(LLSizeClassAllocator::IMAGE, data);
 		}
 	}
 }
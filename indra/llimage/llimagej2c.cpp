@@ -48,6 +48,10 @@ EngineInfoLLImageJ2CFunction j2cimpl_engineinfo_func;
 LLAPRPool j2cimpl_dso_memory_pool;
 apr_dso_handle_t *j2cimpl_dso_handle;
 
+S32 LLImageJ2C::sDecodeThreads = 0;
+size_t LLImageJ2C::sDecodeCacheLimit = 64 * 1024 * 1024;
+bool LLImageJ2C::sEncodeIndexed = false;
+
 //Declare the prototype for theses functions here, their functionality
 //will be implemented in other files which define a derived LLImageJ2CImpl
 //but only ONE static library which has the implementation for this
@@ -166,6 +170,18 @@ void LLImageJ2C::closeDSO()
 	j2cimpl_dso_memory_pool.destroy();
 }
 
+//static
+void LLImageJ2C::setDecodeThreadCount(S32 count)
+{
+	sDecodeThreads = llclamp(count, 0, 8);
+}
+
+//static
+void LLImageJ2C::setDecodeCacheLimit(U32 megabytes)
+{
+	sDecodeCacheLimit = (size_t)megabytes * 1024 * 1024;
+}
+
 //static
 std::string LLImageJ2C::getEngineInfo()
 {
@@ -180,7 +196,9 @@ LLImageJ2C::LLImageJ2C() : 	LLImageFormatted(IMG_CODEC_J2C),
 							mRawDiscardLevel(-1),
 							mRate(0.0f),
 							mReversible(FALSE),
-							mAreaUsedForDataSizeCalcs(0)
+							mAreaUsedForDataSizeCalcs(0),
+							mIndexedDataSize(0),
+							mResumableDecode(false)
 {
 	//We assume here that if we wanted to create via
 	//a dynamic library that the approriate open calls were made
@@ -251,6 +269,7 @@ BOOL LLImageJ2C::updateData()
 {
 	BOOL res = TRUE;
 	resetLastError();
+	mIndexedDataSize = 0;	// new data, index it again
 
 	// Check to make sure that this instance has been initialized with data
 	if (!getData() || (getDataSize() < 16))
@@ -383,6 +402,12 @@ S32 LLImageJ2C::calcHeaderSize()
 S32 LLImageJ2C::calcDataSize(S32 discard_level)
 {
 	static const LLCachedControl<bool> legacy_size("SianaLegacyJ2CSize", false);
+
+	S32 indexed_size = calcIndexedDataSize(discard_level);
+	if (indexed_size > 0)
+	{
+		return indexed_size;
+	}
 	
 	if (legacy_size) {
 		return calcDataSizeJ2C(getWidth(), getHeight(), getComponents(), discard_level, mRate);
@@ -425,6 +450,16 @@ S32 LLImageJ2C::calcDataSize(S32 discard_level)
 	return mDataSizes[discard_level];
 }
 
+S32 LLImageJ2C::calcIndexedDataSize(S32 discard_level)
+{
+	if (getDataSize() != mIndexedDataSize)
+	{
+		mIndexedDataSize = getDataSize();
+		mIndex.build(getData(), mIndexedDataSize);
+	}
+	return mIndex.getDataSize(discard_level);
+}
+
 S32 LLImageJ2C::calcDiscardLevelBytes(S32 bytes)
 {
 	llassert(bytes >= 0);
@@ -435,10 +470,22 @@ S32 LLImageJ2C::calcDiscardLevelBytes(S32 bytes)
 	}
 	while (1)
 	{
-		S32 bytes_needed = calcDataSize(discard_level); // virtual
-		if (bytes >= bytes_needed - (bytes_needed>>2)) // For J2c, up the res at 75% of the optimal number of bytes
+		S32 bytes_needed = calcIndexedDataSize(discard_level);
+		if (bytes_needed > 0)
 		{
-			break;
+			// We know where the level ends
+			if (bytes >= bytes_needed)
+			{
+				break;
+			}
+		}
+		else
+		{
+			bytes_needed = calcDataSize(discard_level); // virtual
+			if (bytes >= bytes_needed - (bytes_needed>>2)) // For J2c, up the res at 75% of the optimal number of bytes
+			{
+				break;
+			}
 		}
 		discard_level++;
 		if (discard_level >= MAX_DISCARD_LEVEL)
@@ -486,14 +533,14 @@ BOOL LLImageJ2C::loadAndValidate(const std::string &filename)
 	}
 	else
 	{
-		U8 *data = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), file_size);
+		U8 *data = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, file_size);
 		apr_size_t bytes_read = file_size;
 		apr_status_t s = apr_file_read(apr_file, data, &bytes_read); // modifies bytes_read	
 		infile.close() ;
 
 		if (s != APR_SUCCESS || (S32)bytes_read != file_size)
 		{
-			FREE_MEM(LLImageBase::getPrivatePool(), data);
+			FREE_MEM(LLSizeClassAllocator::IMAGE, data);
 			setLastError("Unable to read entire file");
 			res = FALSE;
 		}
@@ -28,6 +28,7 @@
 #define LL_LLIMAGEJ2C_H
 
 #include "llimage.h"
+#include "llimagej2cindex.h"
 #include "llassettype.h"
 
 class LLImageJ2CImpl;
@@ -66,9 +67,33 @@ public:
 	void setMaxBytes(S32 max_bytes);
 	S32 getMaxBytes() const { return mMaxBytes; }
 
+	// Bytes needed for discard_level as read from the codestream we have so
+	// far, 0 when it doesn't tell (see LLImageJ2CIndex).
+	S32 calcIndexedDataSize(S32 discard_level);
+
+	// Keep what decoding below full resolution works out, so that the next
+	// decode of this image with more data only decodes what is new.  It is
+	// dropped after a decode at full resolution or one that isn't resumable,
+	// and whenever keeping it would exceed the decode cache limit.  Ignored by
+	// decoders that can't resume.
+	void setResumableDecode(bool resumable) { mResumableDecode = resumable; }
+	bool getResumableDecode() const { return mResumableDecode; }
+
 	static S32 calcHeaderSizeJ2C();
 	static S32 calcDataSizeJ2C(S32 w, S32 h, S32 comp, S32 discard_level, F32 rate = 0.f);
 
+	// Job system workers that help decoding the code-blocks of a large
+	// texture, 0 to decode them on the image decode thread alone.
+	static void setDecodeThreadCount(S32 count);
+	static S32 getDecodeThreadCount()						{ return sDecodeThreads; }
+	// Most memory the resumable decodes of all images together keep.
+	static void setDecodeCacheLimit(U32 megabytes);
+	static size_t getDecodeCacheLimit()						{ return sDecodeCacheLimit; }
+	// Encode resolution first with a tile-part per resolution and a TLM
+	// marker, which LLImageJ2CIndex can size the discard levels of from the
+	// header alone.  Off by default: it changes the layout of uploads.
+	static void setEncodeIndexed(bool indexed)				{ sEncodeIndexed = indexed; }
+	static bool getEncodeIndexed()							{ return sEncodeIndexed; }
 	static void openDSO();
 	static void closeDSO();
 	static std::string getEngineInfo();
@@ -83,11 +108,18 @@ protected:
 	S32 mMaxBytes; // Maximum number of bytes of data to use...
 	S32 mDataSizes[MAX_DISCARD_LEVEL+1];		// Size of data required to reach a given level
 	U32 mAreaUsedForDataSizeCalcs;				// Height * width used to calculate mDataSizes
+	LLImageJ2CIndex mIndex;
+	S32 mIndexedDataSize;						// Data size mIndex was built from
+	bool mResumableDecode;
 	S8  mRawDiscardLevel;
 	F32 mRate;
 	BOOL mReversible;
 	LLImageJ2CImpl *mImpl;
 	std::string mLastError;
+
+	static S32 sDecodeThreads;
+	static size_t sDecodeCacheLimit;
+	static bool sEncodeIndexed;
 };
 
 // Derive from this class to implement JPEG2000 decoding
@@ -0,0 +1,513 @@
+/**
+ * @file llimagej2cindex.cpp
+ * @brief Index of where each discard level ends in a jpeg2000 codestream.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llimagej2cindex.h"
+
+#include <vector>
+
+namespace
+{
+	// Codestream markers, ISO/IEC 15444-1 annex A
+	const U16 J2C_SOC = 0xff4f;
+	const U16 J2C_SIZ = 0xff51;
+	const U16 J2C_COD = 0xff52;
+	const U16 J2C_COC = 0xff53;
+	const U16 J2C_TLM = 0xff55;
+	const U16 J2C_PLT = 0xff58;
+	const U16 J2C_POC = 0xff5f;
+	const U16 J2C_PPM = 0xff60;
+	const U16 J2C_PPT = 0xff61;
+	const U16 J2C_SOT = 0xff90;
+	const U16 J2C_SOD = 0xff93;
+
+	// SOT marker segment, marker included
+	const S32 J2C_SOT_SIZE = 12;
+
+	// Progression orders
+	enum
+	{
+		LRCP,
+		RLCP,
+		RPCL,
+		PCRL,
+		CPRL
+	};
+
+	// Default precinct size (2^15 x 2^15), when the coding style doesn't give them
+	const U8 MAX_PRECINCT = 0xff;
+
+	U16 read16(const U8* p)
+	{
+		return (p[0] << 8) | p[1];
+	}
+
+	U32 read32(const U8* p)
+	{
+		return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | p[3];
+	}
+
+	U64 ceil_shift(U64 value, S32 shift)
+	{
+		return (value + ((1ULL << shift) - 1)) >> shift;
+	}
+
+	// Decomposition levels and precinct sizes from the SPcod or SPcoc
+	// parameters of a COD or COC marker segment, style being Scod or Scoc.
+	bool read_coding_style(U8 style, const U8* parameters, S32 size, S32& levels, std::vector<U8>& precincts)
+	{
+		if (size < 5)
+		{
+			return false;
+		}
+		levels = parameters[0];
+		precincts.assign(levels + 1, MAX_PRECINCT);
+		if (style & 1)
+		{
+			if (size < 5 + levels + 1)
+			{
+				return false;
+			}
+			precincts.assign(parameters + 5, parameters + 5 + levels + 1);
+		}
+		return true;
+	}
+
+	// Component and coding style of a COC marker segment
+	bool read_component_style(const U8* segment, S32 size, size_t components, U32& index, S32& levels, std::vector<U8>& precincts)
+	{
+		S32 index_size = components < 257 ? 1 : 2;
+		if (size < index_size + 1)
+		{
+			return false;
+		}
+		index = index_size == 1 ? segment[0] : read16(segment);
+		return index < components &&
+			   read_coding_style(segment[index_size], segment + index_size + 1, size - index_size - 1, levels, precincts);
+	}
+
+	struct Component
+	{
+		Component() : mSubX(1), mSubY(1), mLevels(-1) {}
+
+		U8 mSubX;
+		U8 mSubY;
+		S32 mLevels;					// -1 when the COD applies
+		std::vector<U8> mPrecincts;		// empty when the COD applies
+	};
+}
+
+LLImageJ2CIndex::LLImageJ2CIndex()
+{
+	reset();
+}
+
+void LLImageJ2CIndex::reset()
+{
+	memset(mDataSizes, 0, sizeof(mDataSizes));
+	mLevels = 0;
+}
+
+S32 LLImageJ2CIndex::getDataSize(S32 discard_level) const
+{
+	return mDataSizes[llclamp(discard_level, 0, MAX_DISCARD_LEVEL)];
+}
+
+bool LLImageJ2CIndex::build(const U8* data, S32 data_size)
+{
+	reset();
+	if (!data || data_size < 2 || read16(data) != J2C_SOC)
+	{
+		return false;
+	}
+
+	// Main header, up to the first SOT
+	U32 width = 0, height = 0, x0 = 0, y0 = 0;
+	U32 tile_width = 0, tile_height = 0, tile_x0 = 0, tile_y0 = 0;
+	std::vector<Component> components;
+	S32 levels = -1;
+	S32 layers = 0;
+	S32 order = LRCP;
+	std::vector<U8> precincts;
+	std::vector<U32> tile_part_lengths;		// from TLM
+	S32 pos = 2;
+	while (true)
+	{
+		if (pos + 4 > data_size)
+		{
+			return false;
+		}
+		U16 marker = read16(data + pos);
+		if (marker == J2C_SOT)
+		{
+			break;
+		}
+		S32 length = read16(data + pos + 2);
+		if ((marker & 0xff00) != 0xff00 || length < 2 || pos + 2 + length > data_size)
+		{
+			return false;
+		}
+		const U8* segment = data + pos + 4;
+		S32 segment_size = length - 2;
+		switch (marker)
+		{
+		case J2C_SIZ:
+		{
+			if (segment_size < 36)
+			{
+				return false;
+			}
+			width = read32(segment + 2);
+			height = read32(segment + 6);
+			x0 = read32(segment + 10);
+			y0 = read32(segment + 14);
+			tile_width = read32(segment + 18);
+			tile_height = read32(segment + 22);
+			tile_x0 = read32(segment + 26);
+			tile_y0 = read32(segment + 30);
+			S32 count = read16(segment + 34);
+			if (!count || segment_size < 36 + 3 * count || !tile_width || !tile_height || width <= x0 || height <= y0)
+			{
+				return false;
+			}
+			components.resize(count);
+			for (S32 i = 0; i < count; ++i)
+			{
+				components[i].mSubX = segment[37 + 3 * i];
+				components[i].mSubY = segment[38 + 3 * i];
+				if (!components[i].mSubX || !components[i].mSubY)
+				{
+					return false;
+				}
+			}
+			break;
+		}
+		case J2C_COD:
+			if (segment_size < 5)
+			{
+				return false;
+			}
+			order = segment[1];
+			layers = read16(segment + 2);
+			if (!read_coding_style(segment[0], segment + 5, segment_size - 5, levels, precincts))
+			{
+				return false;
+			}
+			break;
+		case J2C_COC:
+		{
+			U32 index;
+			S32 component_levels;
+			std::vector<U8> component_precincts;
+			if (!read_component_style(segment, segment_size, components.size(), index, component_levels, component_precincts))
+			{
+				return false;
+			}
+			components[index].mLevels = component_levels;
+			components[index].mPrecincts.swap(component_precincts);
+			break;
+		}
+		case J2C_TLM:
+		{
+			if (segment_size < 2)
+			{
+				return false;
+			}
+			S32 index_size = (segment[1] >> 4) & 3;
+			S32 length_size = (segment[1] & 0x40) ? 4 : 2;
+			if (index_size == 3)
+			{
+				return false;
+			}
+			for (S32 i = 2 + index_size; i + length_size <= segment_size; i += index_size + length_size)
+			{
+				tile_part_lengths.push_back(length_size == 4 ? read32(segment + i) : read16(segment + i));
+			}
+			break;
+		}
+		case J2C_POC:
+		case J2C_PPM:
+			// The packet order or the packet headers are elsewhere
+			return false;
+		default:
+			break;
+		}
+		pos += 2 + length;
+	}
+
+	if (components.empty() || levels < 0 || layers <= 0 || order > CPRL)
+	{
+		return false;
+	}
+	// One tile covering the whole image
+	if (tile_x0 > x0 || tile_y0 > y0 || (U64)tile_x0 + tile_width < width || (U64)tile_y0 + tile_height < height)
+	{
+		return false;
+	}
+
+	// Packets per layer of each resolution
+	std::vector<U64> packets(levels + 1, 0);
+	for (size_t c = 0; c < components.size(); ++c)
+	{
+		const Component& component = components[c];
+		if (component.mLevels >= 0 && component.mLevels != levels)
+		{
+			// Resolutions that don't line up between components
+			return false;
+		}
+		const std::vector<U8>& sizes = component.mLevels >= 0 ? component.mPrecincts : precincts;
+		U64 cx0 = ((U64)x0 + component.mSubX - 1) / component.mSubX;
+		U64 cx1 = ((U64)width + component.mSubX - 1) / component.mSubX;
+		U64 cy0 = ((U64)y0 + component.mSubY - 1) / component.mSubY;
+		U64 cy1 = ((U64)height + component.mSubY - 1) / component.mSubY;
+		for (S32 r = 0; r <= levels; ++r)
+		{
+			S32 shift = levels - r;
+			U64 rx0 = ceil_shift(cx0, shift);
+			U64 rx1 = ceil_shift(cx1, shift);
+			U64 ry0 = ceil_shift(cy0, shift);
+			U64 ry1 = ceil_shift(cy1, shift);
+			S32 precinct_x = sizes[r] & 0xf;
+			S32 precinct_y = sizes[r] >> 4;
+			U64 wide = rx1 > rx0 ? ceil_shift(rx1, precinct_x) - (rx0 >> precinct_x) : 0;
+			U64 high = ry1 > ry0 ? ceil_shift(ry1, precinct_y) - (ry0 >> precinct_y) : 0;
+			packets[r] += wide * high;
+		}
+	}
+	U64 total_packets = 0;
+	for (S32 r = 0; r <= levels; ++r)
+	{
+		total_packets += packets[r];
+	}
+
+	// Tile-parts, as far as the data goes
+	S32 first_tile_part = pos;
+	S32 tile_parts = 0;						// from TNsot, 0 when unknown
+	std::vector<S32> tile_part_ends;
+	std::vector<S32> packet_ends;
+	bool packet_lengths = true;				// all tile-parts so far had PLT markers
+	while (pos + J2C_SOT_SIZE <= data_size && read16(data + pos) == J2C_SOT)
+	{
+		U32 tile_part_length = read32(data + pos + 6);
+		if (data[pos + 11])
+		{
+			tile_parts = data[pos + 11];
+		}
+		S32 end = tile_part_length ? pos + (S32)tile_part_length : 0;
+		if (tile_part_length && (tile_part_length < J2C_SOT_SIZE + 2 || end < pos))
+		{
+			break;
+		}
+
+		// Tile-part header, up to the SOD
+		std::vector<S32> lengths;
+		bool complete = true;			// the PLT lengths don't stop half way
+		S32 header = pos + J2C_SOT_SIZE;
+		S32 start = 0;
+		while (header + 2 <= data_size)
+		{
+			U16 marker = read16(data + header);
+			if (marker == J2C_SOD)
+			{
+				start = header + 2;
+				break;
+			}
+			if (header + 4 > data_size)
+			{
+				break;
+			}
+			S32 length = read16(data + header + 2);
+			if ((marker & 0xff00) != 0xff00 || length < 2 || header + 2 + length > data_size)
+			{
+				break;
+			}
+			switch (marker)
+			{
+			case J2C_PLT:
+			{
+				// Zplt, then lengths of 7 bits per byte, the high bit set on
+				// all bytes but the last
+				U32 value = 0;
+				for (S32 i = header + 5; i < header + 2 + length; ++i)
+				{
+					value = (value << 7) | (data[i] & 0x7f);
+					if (!(data[i] & 0x80))
+					{
+						lengths.push_back(value);
+						value = 0;
+					}
+				}
+				complete = complete && !value;
+				break;
+			}
+			case J2C_COD:
+			{
+				// Encoders may repeat the coding style in the tile-part
+				// header, it may not change it
+				const U8* segment = data + header + 4;
+				S32 tile_levels;
+				std::vector<U8> tile_precincts;
+				if (length < 7 || segment[1] != order || read16(segment + 2) != layers ||
+					!read_coding_style(segment[0], segment + 5, length - 7, tile_levels, tile_precincts) ||
+					tile_levels != levels || tile_precincts != precincts)
+				{
+					return false;
+				}
+				for (size_t c = 0; c < components.size(); ++c)
+				{
+					if (components[c].mLevels >= 0 && components[c].mPrecincts != precincts)
+					{
+						return false;
+					}
+				}
+				break;
+			}
+			case J2C_COC:
+			{
+				U32 index;
+				S32 tile_levels;
+				std::vector<U8> tile_precincts;
+				if (!read_component_style(data + header + 4, length - 2, components.size(), index, tile_levels, tile_precincts))
+				{
+					return false;
+				}
+				const Component& component = components[index];
+				if (tile_levels != levels || tile_precincts != (component.mLevels >= 0 ? component.mPrecincts : precincts))
+				{
+					return false;
+				}
+				break;
+			}
+			case J2C_POC:
+			case J2C_PPT:
+				// The packet order or the packet headers are elsewhere
+				return false;
+			default:
+				break;
+			}
+			header += 2 + length;
+		}
+		if (!start)
+		{
+			// The tile-part header isn't all there yet
+			break;
+		}
+
+		if (packet_lengths && !lengths.empty() && complete)
+		{
+			std::vector<S32> tile_part_packets;
+			S32 offset = start;
+			for (size_t i = 0; i < lengths.size(); ++i)
+			{
+				offset += lengths[i];
+				tile_part_packets.push_back(offset);
+			}
+			// The lengths must account for the whole tile-part
+			if (!end || offset == end)
+			{
+				packet_ends.insert(packet_ends.end(), tile_part_packets.begin(), tile_part_packets.end());
+			}
+			else
+			{
+				packet_lengths = false;
+			}
+		}
+		else
+		{
+			// Packets past here can't be placed
+			packet_lengths = false;
+		}
+
+		if (!end)
+		{
+			// Last tile-part, up to the EOC
+			break;
+		}
+		tile_part_ends.push_back(end);
+		pos = end;
+	}
+	// With one tile-part per resolution, in an order where a resolution's
+	// packets all come before the next resolution's
+	bool resolution_first = order == RLCP || order == RPCL;
+	bool tile_part_per_resolution = resolution_first &&
+		(tile_parts ? tile_parts == levels + 1 : tile_part_lengths.size() == (size_t)(levels + 1));
+	if (tile_part_per_resolution && tile_part_ends.size() < (size_t)(levels + 1) &&
+		tile_part_lengths.size() == (size_t)(levels + 1))
+	{
+		S32 end = first_tile_part;
+		tile_part_ends.clear();
+		for (S32 r = 0; r <= levels; ++r)
+		{
+			end += tile_part_lengths[r];
+			tile_part_ends.push_back(end);
+		}
+	}
+
+	U64 lower_packets = 0;						// packets per layer of the resolutions below r
+	std::vector<S32> ends(levels + 1, 0);
+	for (S32 r = 0; r <= levels; ++r)
+	{
+		lower_packets += packets[r];
+		U64 needed;
+		switch (order)
+		{
+		case RLCP:
+		case RPCL:
+			needed = lower_packets * layers;
+			break;
+		case LRCP:
+			needed = total_packets * (layers - 1) + lower_packets;
+			break;
+		default:
+			// Every component or position brings all resolutions in turn
+			needed = total_packets * layers;
+			break;
+		}
+		if (needed && needed <= packet_ends.size())
+		{
+			ends[r] = packet_ends[needed - 1];
+		}
+		else if (tile_part_per_resolution && (size_t)r < tile_part_ends.size())
+		{
+			ends[r] = tile_part_ends[r];
+		}
+	}
+
+	if (ends[levels])
+	{
+		// The last packet is followed by the EOC, which the decoder wants to
+		// see when decoding the full resolution
+		ends[levels] += 2;
+	}
+
+	mLevels = levels + 1;
+	for (S32 discard = 0; discard <= MAX_DISCARD_LEVEL; ++discard)
+	{
+		mDataSizes[discard] = ends[llmax(levels - discard, 0)];
+	}
+	return true;
+}
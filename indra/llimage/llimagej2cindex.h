@@ -0,0 +1,68 @@
+/**
+ * @file llimagej2cindex.h
+ * @brief Index of where each discard level ends in a jpeg2000 codestream.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLIMAGEJ2CINDEX_H
+#define LL_LLIMAGEJ2CINDEX_H
+
+#include "llimage.h"
+
+// Walks the markers of a (possibly truncated) jpeg2000 codestream and works
+// out how many bytes from its start are needed to decode each discard level,
+// instead of estimating it from the image size.
+//
+// Only single tile codestreams are indexed, which is what textures are.  The
+// packet lengths come from the PLT markers in the tile-part headers; when
+// there are none, a stream in a resolution first progression order with one
+// tile-part per resolution is indexed by its tile-part lengths, from the SOT
+// markers or the TLM marker of the main header.  A level whose end lies past
+// the data seen so far, or in a stream that can't be indexed (other
+// progression orders without packet lengths, POC or PPM markers, several
+// tiles), stays unknown.
+class LLImageJ2CIndex
+{
+public:
+	LLImageJ2CIndex();
+
+	void reset();
+
+	// Indexes the codestream in data, which may end anywhere.  Returns true
+	// when the main header was understood, even if the data doesn't go far
+	// enough yet to know where every level ends.
+	bool build(const U8* data, S32 data_size);
+
+	// Bytes needed to decode discard_level completely (higher discard levels
+	// and header included), or 0 when it isn't known.
+	S32 getDataSize(S32 discard_level) const;
+
+	// Number of resolution levels in the codestream, 0 when not indexed.
+	S32 getLevels() const { return mLevels; }
+
+private:
+	S32 mDataSizes[MAX_DISCARD_LEVEL + 1];
+	S32 mLevels;
+};
+
+#endif // LL_LLIMAGEJ2CINDEX_H
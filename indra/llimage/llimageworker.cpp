@@ -28,12 +28,14 @@
 
 #include "llimageworker.h"
 #include "llimagedxt.h"
+#include "llimagej2c.h"
 
 //----------------------------------------------------------------------------
 
 // MAIN THREAD
 LLImageDecodeThread::LLImageDecodeThread(bool threaded)
-	: LLQueuedThread("imagedecode", threaded)
+	: LLQueuedThread("imagedecode", threaded),
+	  mResumable(false)
 {
 	mCreationMutex = new LLMutex();
 }
@@ -55,7 +57,7 @@ S32 LLImageDecodeThread::update(F32 max_time_ms)
 		creation_info& info = *iter;
 		ImageRequest* req = new ImageRequest(info.handle, info.image,
 						     info.priority, info.discard, info.needs_aux,
-						     info.responder);
+						     info.responder, mResumable, info.desired_discard);
 
 		bool res = addRequest(req);
 		if (!res)
@@ -69,11 +71,11 @@ S32 LLImageDecodeThread::update(F32 max_time_ms)
 }
 
 LLImageDecodeThread::handle_t LLImageDecodeThread::decodeImage(LLImageFormatted* image, 
-	U32 priority, S32 discard, BOOL needs_aux, Responder* responder)
+	U32 priority, S32 discard, BOOL needs_aux, Responder* responder, S32 desired_discard)
 {
 	LLMutexLock lock(mCreationMutex);
 	handle_t handle = generateHandle();
-	mCreationList.push_back(creation_info(handle, image, priority, discard, needs_aux, responder));
+	mCreationList.push_back(creation_info(handle, image, priority, discard, needs_aux, responder, desired_discard));
 	return handle;
 }
 
@@ -94,11 +96,13 @@ LLImageDecodeThread::Responder::~Responder()
 
 LLImageDecodeThread::ImageRequest::ImageRequest(handle_t handle, LLImageFormatted* image, 
 												U32 priority, S32 discard, BOOL needs_aux,
-												LLImageDecodeThread::Responder* responder)
+												LLImageDecodeThread::Responder* responder, bool resumable, S32 desired_discard)
 	: LLQueuedThread::QueuedRequest(handle, priority, FLAG_AUTO_COMPLETE),
 	  mFormattedImage(image),
 	  mDiscardLevel(discard),
 	  mNeedsAux(needs_aux),
+	  mResumable(resumable),
+	  mDesiredDiscard(desired_discard),
 	  mDecodedRaw(FALSE),
 	  mDecodedAux(FALSE),
 	  mResponder(responder)
@@ -138,6 +142,11 @@ bool LLImageDecodeThread::ImageRequest::processRequest()
 			{
 				mFormattedImage->setDiscardLevel(mDiscardLevel);
 			}
+			if (mFormattedImage->getCodec() == IMG_CODEC_J2C)
+			{
+				// nothing to resume once the caller has what it wants
+				((LLImageJ2C*)mFormattedImage.get())->setResumableDecode(mResumable && mDiscardLevel > mDesiredDiscard);
+			}
 			mDecodedImageRaw = new LLImageRaw(mFormattedImage->getWidth(),
 											  mFormattedImage->getHeight(),
 											  mFormattedImage->getComponents());
@@ -50,7 +50,7 @@ public:
 	public:
 		ImageRequest(handle_t handle, LLImageFormatted* image,
 					 U32 priority, S32 discard, BOOL needs_aux,
-					 LLImageDecodeThread::Responder* responder);
+					 LLImageDecodeThread::Responder* responder, bool resumable = false, S32 desired_discard = -1);
 
 		/*virtual*/ bool processRequest();
 		/*virtual*/ void finishRequest(bool completed);
@@ -63,6 +63,8 @@ public:
 		LLPointer<LLImageFormatted> mFormattedImage;
 		S32 mDiscardLevel;
 		BOOL mNeedsAux;
+		bool mResumable;
+		S32 mDesiredDiscard;
 		// output
 		LLPointer<LLImageRaw> mDecodedImageRaw;
 		LLPointer<LLImageRaw> mDecodedImageAux;
@@ -75,11 +77,19 @@ public:
 	LLImageDecodeThread(bool threaded = true);
 	virtual ~LLImageDecodeThread();
 
+	// desired_discard is the discard level the caller is going to stop at,
+	// -1 if it doesn't know: the decode that reaches it isn't resumed.
 	handle_t decodeImage(LLImageFormatted* image,
 						 U32 priority, S32 discard, BOOL needs_aux,
-						 Responder* responder);
+						 Responder* responder, S32 desired_discard = -1);
 	S32 update(F32 max_time_ms);
 
+	// When set, the decoder of each J2C image keeps what it decoded below
+	// full resolution, so that decoding that image again with more data at a
+	// lower discard level only decodes the packets that arrived since.
+	void setResumable(bool resumable) { mResumable = resumable; }
+	bool getResumable() const { return mResumable; }
+
 	// Used by unit tests to check the consistency of the thread instance
 	S32 tut_size();
 	
@@ -92,13 +102,15 @@ private:
 		S32 discard;
 		BOOL needs_aux;
 		LLPointer<Responder> responder;
-		creation_info(handle_t h, LLImageFormatted* i, U32 p, S32 d, BOOL aux, Responder* r)
-			: handle(h), image(i), priority(p), discard(d), needs_aux(aux), responder(r)
+		S32 desired_discard;
+		creation_info(handle_t h, LLImageFormatted* i, U32 p, S32 d, BOOL aux, Responder* r, S32 dd)
+			: handle(h), image(i), priority(p), discard(d), needs_aux(aux), responder(r), desired_discard(dd)
 		{}
 	};
 	typedef std::list<creation_info> creation_list_t;
 	creation_list_t mCreationList;
 	LLMutex* mCreationMutex;
+	bool mResumable;
 };
 
 #endif
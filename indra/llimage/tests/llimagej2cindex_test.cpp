@@ -0,0 +1,334 @@
+/**
+ * @file llimagej2cindex_test.cpp
+ * @brief Checks where the jpeg2000 codestream index puts the end of each
+ *        discard level, for the layouts it knows and for truncated data.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../llimagej2cindex.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	// Progression orders, as in the COD marker
+	enum { LRCP, RLCP, RPCL, PCRL, CPRL };
+
+	// Codestream of a 64x64 image with one precinct per resolution, so that
+	// each layer has one packet per resolution and component.  The packet
+	// bodies are filler: only the markers and the lengths matter.
+	class Codestream
+	{
+	public:
+		Codestream(S32 components, S32 order, S32 layers, S32 levels) :
+			mComponents(components),
+			mLayers(layers),
+			mLevels(levels)
+		{
+			put16(0xff4f);							// SOC
+			put16(0xff51);							// SIZ
+			put16(38 + 3 * components);
+			put16(0);
+			put32(64); put32(64); put32(0); put32(0);
+			put32(64); put32(64); put32(0); put32(0);
+			put16(components);
+			for (S32 c = 0; c < components; ++c)
+			{
+				mData.push_back(7);
+				mData.push_back(1);
+				mData.push_back(1);
+			}
+			put16(0xff52);							// COD
+			put16(12);
+			mData.push_back(0);
+			mData.push_back(order);
+			put16(layers);
+			mData.push_back(0);
+			mData.push_back(levels);
+			mData.push_back(4);
+			mData.push_back(4);
+			mData.push_back(0);
+			mData.push_back(1);
+			put16(0xff5c);							// QCD, not looked at
+			put16(5);
+			mData.push_back(0x40);
+			put16(0x4848);
+		}
+
+		S32 packetCount() const { return mComponents * mLayers * (mLevels + 1); }
+
+		// One tile-part per entry of lengths, holding packets of those sizes,
+		// with PLT markers if plt.
+		void addTileParts(const std::vector<std::vector<S32> >& lengths, bool plt)
+		{
+			for (size_t part = 0; part < lengths.size(); ++part)
+			{
+				std::vector<U8> header;
+				if (plt)
+				{
+					std::vector<U8> values;
+					for (size_t i = 0; i < lengths[part].size(); ++i)
+					{
+						S32 length = lengths[part][i];
+						if (length >= 128)
+						{
+							values.push_back(0x80 | (length >> 7));
+						}
+						values.push_back(length & 0x7f);
+					}
+					header.push_back(0xff);
+					header.push_back(0x58);
+					header.push_back((values.size() + 3) >> 8);
+					header.push_back((values.size() + 3) & 0xff);
+					header.push_back(0);
+					header.insert(header.end(), values.begin(), values.end());
+				}
+				S32 body = 0;
+				for (size_t i = 0; i < lengths[part].size(); ++i)
+				{
+					body += lengths[part][i];
+				}
+				mTilePartStarts.push_back(mData.size());
+				put16(0xff90);						// SOT
+				put16(10);
+				put16(0);
+				put32(12 + header.size() + 2 + body);
+				mData.push_back(part);
+				mData.push_back(lengths.size());
+				mData.insert(mData.end(), header.begin(), header.end());
+				put16(0xff93);						// SOD
+				mPacketStarts.push_back(mData.size());
+				mData.insert(mData.end(), body, 0x55);
+			}
+			put16(0xffd9);							// EOC
+		}
+
+		// TLM marker for the tile-parts of the given sizes, to go in the main
+		// header before the tile-parts are added.
+		void addTLM(const std::vector<S32>& tile_part_sizes)
+		{
+			put16(0xff55);
+			put16(4 + 4 * tile_part_sizes.size());
+			mData.push_back(0);
+			mData.push_back(0x40);
+			for (size_t i = 0; i < tile_part_sizes.size(); ++i)
+			{
+				put32(tile_part_sizes[i]);
+			}
+		}
+
+		void put16(U32 value)
+		{
+			mData.push_back(value >> 8);
+			mData.push_back(value & 0xff);
+		}
+
+		void put32(U32 value)
+		{
+			put16(value >> 16);
+			put16(value & 0xffff);
+		}
+
+		std::vector<U8> mData;
+		std::vector<S32> mTilePartStarts;
+		std::vector<S32> mPacketStarts;
+		S32 mComponents;
+		S32 mLayers;
+		S32 mLevels;
+	};
+
+	S32 packet_length(S32 index)
+	{
+		return 20 + (index * 37) % 150;
+	}
+
+	// End of the count first packets of a single tile-part stream
+	S32 packets_end(const Codestream& stream, S32 count)
+	{
+		S32 end = stream.mPacketStarts[0];
+		for (S32 i = 0; i < count; ++i)
+		{
+			end += packet_length(i);
+		}
+		return end;
+	}
+}
+
+namespace tut
+{
+	struct j2cindex_test
+	{
+	};
+	typedef test_group<j2cindex_test> j2cindex_group_t;
+	typedef j2cindex_group_t::object j2cindex_object_t;
+	tut::j2cindex_group_t j2cindex_instance("j2c_index");
+
+	// Resolution first order, one tile-part with packet lengths: the header
+	// alone tells where every level ends.
+	template<> template<>
+	void j2cindex_object_t::test<1>()
+	{
+		Codestream stream(3, RPCL, 2, 4);
+		std::vector<std::vector<S32> > lengths(1);
+		for (S32 i = 0; i < stream.packetCount(); ++i)
+		{
+			lengths[0].push_back(packet_length(i));
+		}
+		stream.addTileParts(lengths, true);
+
+		LLImageJ2CIndex index;
+		// just past the SOD
+		ensure("indexed", index.build(&stream.mData[0], stream.mPacketStarts[0] + 10));
+		ensure_equals("levels", index.getLevels(), 5);
+		for (S32 discard = 0; discard <= 4; ++discard)
+		{
+			// the resolutions up to this one, all layers and components
+			S32 packets = (5 - discard) * 2 * 3;
+			// and the EOC for the full resolution
+			S32 end = packets_end(stream, packets) + (discard ? 0 : 2);
+			ensure_equals("level end", index.getDataSize(discard), end);
+		}
+		ensure_equals("past the lowest resolution", index.getDataSize(5), index.getDataSize(4));
+
+		// cut in the main header
+		ensure("header cut", !index.build(&stream.mData[0], 40));
+		ensure_equals("nothing known", index.getDataSize(2), 0);
+	}
+
+	// Layer first order: a resolution is complete with the last layer
+	template<> template<>
+	void j2cindex_object_t::test<2>()
+	{
+		Codestream stream(1, LRCP, 3, 5);
+		std::vector<std::vector<S32> > lengths(1);
+		for (S32 i = 0; i < stream.packetCount(); ++i)
+		{
+			lengths[0].push_back(packet_length(i));
+		}
+		stream.addTileParts(lengths, true);
+
+		LLImageJ2CIndex index;
+		ensure("indexed", index.build(&stream.mData[0], stream.mData.size()));
+		for (S32 discard = 0; discard <= 5; ++discard)
+		{
+			S32 packets = 2 * 6 + (6 - discard);
+			S32 end = packets_end(stream, packets) + (discard ? 0 : 2);
+			ensure_equals("level end", index.getDataSize(discard), end);
+		}
+	}
+
+	// One tile-part per resolution without packet lengths: known as far as
+	// the tile-parts seen so far, or from the TLM marker.
+	template<> template<>
+	void j2cindex_object_t::test<3>()
+	{
+		std::vector<std::vector<S32> > lengths(5);
+		for (S32 r = 0; r < 5; ++r)
+		{
+			lengths[r].push_back(50 << r);
+		}
+		Codestream stream(1, RLCP, 1, 4);
+		stream.addTileParts(lengths, false);
+
+		LLImageJ2CIndex index;
+		S32 end_of_third = stream.mTilePartStarts[3];
+		ensure("indexed", index.build(&stream.mData[0], end_of_third));
+		ensure_equals("lowest resolution", index.getDataSize(4), stream.mTilePartStarts[1]);
+		ensure_equals("third resolution", index.getDataSize(2), end_of_third);
+		ensure_equals("next tile-part not seen", index.getDataSize(1), 0);
+		ensure("whole", index.build(&stream.mData[0], stream.mData.size()));
+		ensure_equals("full resolution", index.getDataSize(0), (S32)stream.mData.size());
+
+		Codestream with_tlm(1, RLCP, 1, 4);
+		std::vector<S32> sizes;
+		for (S32 r = 0; r < 5; ++r)
+		{
+			sizes.push_back(12 + 2 + lengths[r][0]);
+		}
+		with_tlm.addTLM(sizes);
+		with_tlm.addTileParts(lengths, false);
+		ensure("indexed from the header", index.build(&with_tlm.mData[0], with_tlm.mTilePartStarts[0] + 20));
+		for (S32 discard = 0; discard <= 4; ++discard)
+		{
+			S32 r = 4 - discard;
+			S32 end = r < 4 ? with_tlm.mTilePartStarts[r + 1] : (S32)with_tlm.mData.size();
+			ensure_equals("level end from TLM", index.getDataSize(discard), end);
+		}
+	}
+
+	// Layouts that can't be indexed stay unknown
+	template<> template<>
+	void j2cindex_object_t::test<4>()
+	{
+		std::vector<std::vector<S32> > lengths(5);
+		for (S32 r = 0; r < 5; ++r)
+		{
+			lengths[r].push_back(100);
+		}
+		Codestream position_first(1, PCRL, 1, 4);
+		position_first.addTileParts(lengths, false);
+		LLImageJ2CIndex index;
+		ensure("header understood", index.build(&position_first.mData[0], position_first.mData.size()));
+		ensure_equals("no level end", index.getDataSize(2), 0);
+
+		// Packet lengths that don't add up to the tile-part
+		Codestream wrong(1, RPCL, 1, 4);
+		std::vector<std::vector<S32> > one(1, std::vector<S32>(5, 30));
+		wrong.addTileParts(one, true);
+		wrong.mData[wrong.mTilePartStarts[0] + 9] += 1;
+		index.build(&wrong.mData[0], wrong.mData.size());
+		ensure_equals("lengths rejected", index.getDataSize(0), 0);
+
+		U8 not_j2c[] = { 0xff, 0xd8, 0xff, 0xe0 };
+		ensure("not a codestream", !index.build(not_j2c, sizeof(not_j2c)));
+	}
+
+	// With LL_J2C_FILE set, logs where the levels of that texture end.
+	template<> template<>
+	void j2cindex_object_t::test<5>()
+	{
+		const char* filename = getenv("LL_J2C_FILE");
+		if (!filename)
+		{
+			return;
+		}
+		std::ifstream file(filename, std::ios::binary);
+		std::vector<U8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		ensure("read", !data.empty());
+
+		LLImageJ2CIndex index;
+		bool indexed = index.build(&data[0], data.size());
+		LL_INFOS() << filename << ": " << data.size() << " bytes, " << (indexed ? "indexed" : "not indexed")
+				   << ", " << index.getLevels() << " levels" << LL_ENDL;
+		for (S32 discard = 0; discard <= MAX_DISCARD_LEVEL; ++discard)
+		{
+			LL_INFOS() << "  discard " << discard << ": " << index.getDataSize(discard) << " bytes" << LL_ENDL;
+		}
+	}
+}
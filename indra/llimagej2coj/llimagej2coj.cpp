@@ -31,8 +31,15 @@
 #include "openjpeg.h"
 
 #include "lltimer.h"
+#include "lljobsystem.h"
 //#include "llmemory.h"
 
+#include <atomic>
+
+// Bytes held by the decode caches of all images, kept under
+// LLImageJ2C::getDecodeCacheLimit()
+static std::atomic<size_t> sDecodeCacheBytes(0);
+
 // Factory function: see declaration in llimagej2c.cpp
 LLImageJ2CImpl* fallbackCreateLLImageJ2CImpl()
 {
@@ -52,6 +59,13 @@ const char* fallbackEngineInfoLLImageJ2CImpl()
 	return version_string.c_str();
 }
 
+// Runs a batch of tier-1 jobs of the decoder with the help of the job system
+static void run_jobs(void* runner, int count, opj_job_fn job, void* data)
+{
+	static_cast<LLJobSystem*>(runner)->parallelFor(count, [job, data](S32 index) { job(data, index); },
+												   LLImageJ2C::getDecodeThreadCount());
+}
+
 // Return string from message, eliminating final \n if present
 static std::string chomp(const char* msg)
 {
@@ -98,13 +112,28 @@ int ceildivpow2(int a, int b)
 
 
 LLImageJ2COJ::LLImageJ2COJ()
-	: LLImageJ2CImpl()
+	: LLImageJ2CImpl(),
+	  mDecodeCache(NULL),
+	  mDecodeCacheBytes(0)
 {
 }
 
 
 LLImageJ2COJ::~LLImageJ2COJ()
 {
+	destroyDecodeCache();
+}
+
+
+void LLImageJ2COJ::destroyDecodeCache()
+{
+	if (mDecodeCache)
+	{
+		opj_destroy_decode_cache(mDecodeCache);
+		mDecodeCache = NULL;
+		sDecodeCacheBytes -= mDecodeCacheBytes;
+		mDecodeCacheBytes = 0;
+	}
 }
 
 
@@ -170,6 +199,16 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 
 	parameters.cp_reduce = base.getRawDiscardLevel();
 
+	// The code-blocks decoded below full resolution are kept, so that the
+	// next decode, with more of the codestream, only runs tier-1 on the
+	// code-blocks it added to.  A decode that isn't resumable still uses
+	// what an earlier one kept, and drops it afterwards.
+	if (base.getResumableDecode() && !mDecodeCache)
+	{
+		mDecodeCache = opj_create_decode_cache();
+	}
+	parameters.cp_cache = mDecodeCache;
+
 	if(parameters.cp_reduce == 0 && *(U16*)(base.getData() + base.getDataSize() - 2) != 0xD9FF)
 	{
 		bool failed = true;
@@ -201,6 +240,13 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 	/* catch events using our callbacks and give a local context */
 	opj_set_event_mgr((opj_common_ptr)dinfo, &event_mgr, stderr);			
 
+	// Large textures get their code-blocks decoded by job system workers too
+	if (gJobSystem && LLImageJ2C::getDecodeThreadCount() > 0)
+	{
+		parameters.cp_run_jobs = run_jobs;
+		parameters.cp_runner = gJobSystem;
+	}
+
 	/* setup the decoder decoding parameters using user parameters */
 	opj_setup_decoder(dinfo, &parameters);
 
@@ -219,6 +265,31 @@ BOOL LLImageJ2COJ::decodeImpl(LLImageJ2C &base, LLImageRaw &raw_image, F32 decod
 		opj_destroy_decompress(dinfo);
 	}
 
+	if (mDecodeCache)
+	{
+		int reused, decoded;
+		opj_get_decode_cache_stats(mDecodeCache, &reused, &decoded);
+		LL_DEBUGS("Texture") << "decodeImpl: discard " << parameters.cp_reduce << ", " << reused << " code-blocks reused, "
+							 << decoded << " decoded so far" << LL_ENDL;
+		if (parameters.cp_reduce == 0 || !base.getResumableDecode())
+		{
+			// Nothing left to refine, or no decode to come that would
+			destroyDecodeCache();
+		}
+		else
+		{
+			size_t bytes = opj_get_decode_cache_size(mDecodeCache);
+			size_t total = (sDecodeCacheBytes += bytes - mDecodeCacheBytes);
+			mDecodeCacheBytes = bytes;
+			if (total > LLImageJ2C::getDecodeCacheLimit())
+			{
+				// The next decode of this image starts from scratch
+				LL_DEBUGS("Texture") << "decodeImpl: decode caches over the limit, dropping " << bytes << " bytes" << LL_ENDL;
+				destroyDecodeCache();
+			}
+		}
+	}
+
 	// The image decode failed if the return was NULL or the component
 	// count was zero.  The latter is just a sanity check before we
 	// dereference the array.
@@ -341,6 +412,15 @@ BOOL LLImageJ2COJ::encodeImpl(LLImageJ2C &base, const LLImageRaw &raw_image, con
 	opj_set_default_encoder_parameters(&parameters);
 	parameters.cod_format = 0;
 	parameters.cp_disto_alloc = 1;
+	if (LLImageJ2C::getEncodeIndexed())
+	{
+		// Resolution first, one tile-part per resolution and a TLM marker, so
+		// that the texture fetcher can tell from the header how many bytes
+		// each discard level takes (see LLImageJ2CIndex)
+		parameters.prog_order = RPCL;
+		parameters.tp_on = 1;
+		parameters.tp_flag = 'R';
+	}
 
 	if (reversible)
 	{
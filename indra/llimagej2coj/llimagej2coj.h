@@ -35,6 +35,8 @@
 
 #include "llimagej2c.h"
 
+struct opj_decode_cache;
+
 class LLImageJ2COJ : public LLImageJ2CImpl
 {	
 public:
@@ -52,6 +54,12 @@ protected:
 		return (a + (1 << b) - 1) >> b;
 	}
 
+private:
+	// Code-blocks kept between decodes when the image is decoded resumably
+	struct opj_decode_cache* mDecodeCache;
+	size_t mDecodeCacheBytes;				// What mDecodeCache counts for in sDecodeCacheBytes
+
+	void destroyDecodeCache();
 };
 
 #endif
@@ -0,0 +1,182 @@
+/**
+ * @file llimagej2cdecode_test.cpp
+ * @brief Checks that resumable jpeg2000 decoding gives the same images as
+ *        decoding from scratch, and times a texture's refinement with both.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "llimagej2c.h"
+#include "llmemory.h"
+#include "lltimer.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+// The benchmark runs when LL_J2C_DECODE_BENCH is set, on the texture in
+// LL_J2C_FILE if there is one and on a generated 1024x1024 one otherwise.
+namespace
+{
+	LLPointer<LLImageJ2C> make_texture(S32 size)
+	{
+		LLPointer<LLImageRaw> raw = new LLImageRaw(size, size, 3);
+		U8* data = raw->getData();
+		for (S32 y = 0; y < size; ++y)
+		{
+			for (S32 x = 0; x < size; ++x)
+			{
+				for (S32 c = 0; c < 3; ++c)
+				{
+					*data++ = (U8)((S32)(127.f + 60.f * sinf(x * 0.05f * (c + 1)) + 60.f * cosf(y * 0.07f + c)) ^ ((x * y) & 15));
+				}
+			}
+		}
+		LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+		j2c->encode(raw, 0.f);
+		return j2c;
+	}
+
+	// The first size bytes of the codestream in image, as the fetcher sets
+	// them when more of the texture arrives.
+	void set_data(LLImageJ2C* image, LLImageJ2C* from, S32 size)
+	{
+		U8* buffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, size);
+		memcpy(buffer, from->getData(), size);
+		image->setData(buffer, size);
+		image->updateData();
+	}
+
+	LLPointer<LLImageRaw> decode(LLImageJ2C* image, S32 discard)
+	{
+		image->setDiscardLevel(discard);
+		LLPointer<LLImageRaw> raw = new LLImageRaw(image->getWidth(), image->getHeight(), image->getComponents());
+		image->decode(raw, 0.f);
+		return raw;
+	}
+
+	bool same(const LLImageRaw* a, const LLImageRaw* b)
+	{
+		return a->getDataSize() && a->getDataSize() == b->getDataSize() && a->getWidth() == b->getWidth()
+			&& !memcmp(a->getData(), b->getData(), a->getDataSize());
+	}
+
+	// Decodes texture from discard level 4 to 0, with the data for each level
+	// as it is fetched, and returns the seconds spent decoding.  Each decode
+	// is compared with one of the same data from scratch when compare.
+	F64 refine(LLImageJ2C* texture, bool resumable, bool compare, S32& different)
+	{
+		LLPointer<LLImageJ2C> image = new LLImageJ2C;
+		image->setResumableDecode(resumable);
+		F64 elapsed = 0.0;
+		for (S32 discard = 4; discard >= 0; --discard)
+		{
+			S32 size = llmin(texture->calcDataSize(discard), texture->getDataSize());
+			set_data(image, texture, size);
+			LLTimer timer;
+			LLPointer<LLImageRaw> raw = decode(image, discard);
+			elapsed += timer.getElapsedTimeF64();
+			if (compare)
+			{
+				LLPointer<LLImageJ2C> scratch = new LLImageJ2C;
+				set_data(scratch, texture, size);
+				if (!same(raw, decode(scratch, discard)))
+				{
+					++different;
+				}
+			}
+		}
+		return elapsed;
+	}
+}
+
+namespace tut
+{
+	struct j2cdecode_test
+	{
+	};
+	typedef test_group<j2cdecode_test> j2cdecode_group_t;
+	typedef j2cdecode_group_t::object j2cdecode_object_t;
+	tut::j2cdecode_group_t j2cdecode_instance("j2c_decode");
+
+	// Refining a texture resumably gives the images decoding from scratch does
+	template<> template<>
+	void j2cdecode_object_t::test<1>()
+	{
+		LLPointer<LLImageJ2C> texture = make_texture(256);
+		ensure("encoded", texture->getDataSize() > 0);
+
+		S32 different = 0;
+		refine(texture, true, true, different);
+		ensure_equals("same images", different, 0);
+
+		// Decoding the same data again, as for the aux channel
+		LLPointer<LLImageJ2C> image = new LLImageJ2C;
+		image->setResumableDecode(true);
+		set_data(image, texture, llmin(texture->calcDataSize(2), texture->getDataSize()));
+		LLPointer<LLImageRaw> first = decode(image, 2);
+		ensure("same image twice", same(first, decode(image, 2)));
+	}
+
+	template<> template<>
+	void j2cdecode_object_t::test<2>()
+	{
+		if (!getenv("LL_J2C_DECODE_BENCH"))
+		{
+			return;
+		}
+		LLPointer<LLImageJ2C> texture;
+		const char* filename = getenv("LL_J2C_FILE");
+		if (filename)
+		{
+			std::ifstream file(filename, std::ios::binary);
+			std::vector<U8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+			ensure("read", !data.empty());
+			texture = new LLImageJ2C;
+			U8* buffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, data.size());
+			memcpy(buffer, &data[0], data.size());
+			texture->setData(buffer, data.size());
+			texture->updateData();
+		}
+		else
+		{
+			texture = make_texture(1024);
+		}
+
+		const S32 COUNT = 10;
+		S32 different = 0;
+		F64 scratch = 0.0;
+		F64 resumed = 0.0;
+		for (S32 i = 0; i < COUNT; ++i)
+		{
+			scratch += refine(texture, false, false, different);
+			resumed += refine(texture, true, false, different);
+		}
+		LL_INFOS() << "Decoding a " << texture->getWidth() << "x" << texture->getHeight() << " texture from discard 4 to 0: "
+				   << scratch * 1000.0 / COUNT << " ms from scratch, " << resumed * 1000.0 / COUNT << " ms resumed" << LL_ENDL;
+	}
+}
@@ -0,0 +1,226 @@
+/**
+ * @file llimagej2csimd_test.cpp
+ * @brief Checks that the vectorized and threaded jpeg2000 decoding gives
+ *        the images of the scalar decoder.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "llimagej2c.h"
+#include "lljobsystem.h"
+#include "llmemory.h"
+
+#include "openjpeg.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace
+{
+	LLPointer<LLImageJ2C> make_texture(S32 width, S32 height, S32 components, bool reversible)
+	{
+		LLPointer<LLImageRaw> raw = new LLImageRaw(width, height, components);
+		U8* data = raw->getData();
+		for (S32 y = 0; y < height; ++y)
+		{
+			for (S32 x = 0; x < width; ++x)
+			{
+				for (S32 c = 0; c < components; ++c)
+				{
+					*data++ = (U8)((S32)(127.f + 60.f * sinf(x * 0.11f * (c + 1)) + 60.f * cosf(y * 0.05f + c)) ^ ((x * y) & 7));
+				}
+			}
+		}
+		LLPointer<LLImageJ2C> j2c = new LLImageJ2C;
+		j2c->setReversible(reversible);
+		j2c->encode(raw, 0.f);
+		return j2c;
+	}
+
+// The vectorized wavelet and colour transforms, and the code-blocks decoded on
+// other threads, must give the images of the scalar decoder bit for bit.
+// Only the in-tree openjpeg has the switches to check that.
+#ifdef OPJ_DPARAMETERS_NO_SIMD_FLAG
+	void run_jobs(void* runner, int count, opj_job_fn job, void* data)
+	{
+		static_cast<LLJobSystem*>(runner)->parallelFor(count, [job, data](S32 index) { job(data, index); }, 3);
+	}
+
+	// The samples of all components of the codestream decoded at reduce,
+	// empty if it didn't decode.
+	std::vector<S32> decode(const U8* codestream, S32 size, S32 reduce, unsigned int flags, LLJobSystem* pool)
+	{
+		opj_dparameters_t parameters;
+		opj_set_default_decoder_parameters(&parameters);
+		parameters.cp_reduce = reduce;
+		parameters.flags = flags;
+		if (pool)
+		{
+			parameters.cp_run_jobs = run_jobs;
+			parameters.cp_runner = pool;
+		}
+		opj_dinfo_t* dinfo = opj_create_decompress(CODEC_J2K);
+		opj_setup_decoder(dinfo, &parameters);
+		opj_cio_t* cio = opj_cio_open((opj_common_ptr)dinfo, const_cast<U8*>(codestream), size);
+		opj_image_t* image = opj_decode(dinfo, cio);
+		opj_cio_close(cio);
+		opj_destroy_decompress(dinfo);
+
+		std::vector<S32> samples;
+		if (image)
+		{
+			for (int c = 0; c < image->numcomps; ++c)
+			{
+				const opj_image_comp_t& comp = image->comps[c];
+				if (comp.data)
+				{
+					samples.insert(samples.end(), comp.data, comp.data + comp.w * comp.h);
+				}
+			}
+			opj_image_destroy(image);
+		}
+		return samples;
+	}
+
+	// Decodes the codestream at each of its discard levels with every
+	// combination of instruction sets and threads, and returns how many of
+	// them differ from the scalar decode.
+	S32 count_differences(const U8* codestream, S32 size, S32 levels, LLJobSystem* pool, S32& decoded)
+	{
+		static const unsigned int flags[] = { OPJ_DPARAMETERS_NO_AVX2_FLAG, 0 };
+		S32 different = 0;
+		for (S32 reduce = 0; reduce <= levels; ++reduce)
+		{
+			std::vector<S32> scalar = decode(codestream, size, reduce, OPJ_DPARAMETERS_NO_SIMD_FLAG, NULL);
+			if (scalar.empty())
+			{
+				continue;
+			}
+			++decoded;
+			if (decode(codestream, size, reduce, OPJ_DPARAMETERS_NO_SIMD_FLAG, pool) != scalar)
+			{
+				++different;
+			}
+			for (size_t i = 0; i < LL_ARRAY_SIZE(flags); ++i)
+			{
+				if (decode(codestream, size, reduce, flags[i], NULL) != scalar ||
+					decode(codestream, size, reduce, flags[i], pool) != scalar)
+				{
+					++different;
+				}
+			}
+		}
+		return different;
+	}
+#endif
+}
+
+namespace tut
+{
+	struct j2csimd_test
+	{
+	};
+	typedef test_group<j2csimd_test> j2csimd_group_t;
+	typedef j2csimd_group_t::object j2csimd_object_t;
+	tut::j2csimd_group_t j2csimd_instance("j2c_simd");
+
+	// Generated textures of odd sizes and all component counts, lossless and
+	// lossy, decode the same way whatever the decoder may use.
+	template<> template<>
+	void j2csimd_object_t::test<1>()
+	{
+#ifdef OPJ_DPARAMETERS_NO_SIMD_FLAG
+		static const S32 sizes[][2] = { { 8, 8 }, { 37, 13 }, { 64, 64 }, { 128, 32 }, { 203, 150 }, { 512, 256 } };
+		LLJobSystem pool("J2C Test", 3);
+		S32 different = 0;
+		S32 decoded = 0;
+		for (size_t s = 0; s < LL_ARRAY_SIZE(sizes); ++s)
+		{
+			for (S32 components = 1; components <= 4; ++components)
+			{
+				for (S32 reversible = 0; reversible < 2; ++reversible)
+				{
+					LLPointer<LLImageJ2C> texture = make_texture(sizes[s][0], sizes[s][1], components, reversible);
+					ensure("encoded", texture->getDataSize() > 0);
+					different += count_differences(texture->getData(), texture->getDataSize(), MAX_DISCARD_LEVEL, &pool, decoded);
+				}
+			}
+		}
+		ensure("decoded", decoded > 0);
+		ensure_equals("same images", different, 0);
+#endif
+	}
+
+	// Decoding with the help of the job system gives the images decoding
+	// without it does.
+	template<> template<>
+	void j2csimd_object_t::test<2>()
+	{
+		LLPointer<LLImageJ2C> texture = make_texture(512, 512, 3, false);
+		LLPointer<LLImageRaw> alone = new LLImageRaw(512, 512, 3);
+		ensure("decoded alone", texture->decode(alone, 0.f));
+
+		LLJobSystem jobs("Decode Test", 3);
+		gJobSystem = &jobs;
+		LLImageJ2C::setDecodeThreadCount(3);
+		LLPointer<LLImageJ2C> again = new LLImageJ2C;
+		U8* buffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, texture->getDataSize());
+		memcpy(buffer, texture->getData(), texture->getDataSize());
+		again->setData(buffer, texture->getDataSize());
+		again->updateData();
+		LLPointer<LLImageRaw> helped = new LLImageRaw(512, 512, 3);
+		bool decoded = again->decode(helped, 0.f);
+		LLImageJ2C::setDecodeThreadCount(0);
+		gJobSystem = NULL;
+
+		ensure("decoded with helpers", decoded);
+		ensure("same image", !memcmp(alone->getData(), helped->getData(), alone->getDataSize()));
+	}
+
+	// With LL_J2C_FILE set, checks that texture the same way.
+	template<> template<>
+	void j2csimd_object_t::test<3>()
+	{
+#ifdef OPJ_DPARAMETERS_NO_SIMD_FLAG
+		const char* filename = getenv("LL_J2C_FILE");
+		if (!filename)
+		{
+			return;
+		}
+		std::ifstream file(filename, std::ios::binary);
+		std::vector<U8> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+		ensure("read", !data.empty());
+
+		LLJobSystem pool("J2C Test", 3);
+		S32 decoded = 0;
+		S32 different = count_differences(&data[0], data.size(), MAX_DISCARD_LEVEL, &pool, decoded);
+		ensure("decoded", decoded > 0);
+		ensure_equals("same images", different, 0);
+#endif
+	}
+}
@@ -46,10 +46,13 @@
 #include "lloctree.h"
 #include "llvolume.h"
 #include "llvolumeoctree.h"
+#include "llvolumebvh.h"
 #include "llstl.h"
 #include "llsdserialize.h"
 #include "llvector4a.h"
 #include "lltimer.h"
+#include "lljobsystem.h"
+#include "aithreadid.h"
 
 #define DEBUG_SILHOUETTE_BINORMALS 0
 #define DEBUG_SILHOUETTE_NORMALS 0 // TomY: Use this to display normals using the silhouette
@@ -817,7 +820,7 @@ S32 LLProfile::getNumPoints(const LLProfileParams& params, BOOL path_open,F32 de
 }
 
 
-BOOL LLProfile::generate(const LLProfileParams& params, BOOL path_open,F32 detail, S32 split,
+BOOL LLProfile::generateUncached(const LLProfileParams& params, BOOL path_open,F32 detail, S32 split,
 						 BOOL is_sculpted, S32 sculpt_size)
 {
 	if ((!mDirty) && (!is_sculpted))
@@ -1531,7 +1534,7 @@ S32 LLPath::getNumPoints(const LLPathParams& params, F32 detail)
 	return np;
 }
 
-BOOL LLPath::generate(const LLPathParams& params, F32 detail, S32 split,
+BOOL LLPath::generateUncached(const LLPathParams& params, F32 detail, S32 split,
 					  BOOL is_sculpted, S32 sculpt_size)
 {
 	if ((!mDirty) && (!is_sculpted))
@@ -2039,9 +2042,211 @@ LLProfile::~LLProfile()
 	}
 }
 
+//----------------------------------------------------------------------------
+// Profile and path memoization
+//
+// Prim heavy regions are full of volumes that differ only in path or only in
+// profile (a box and a tapered box share their profile, a torus and a hollow
+// torus share their path), so the two are cached separately, each keyed on
+// exactly the arguments its generate() depends on.
+
+U32 LLProfile::sCacheHits = 0;
+U32 LLProfile::sCacheMisses = 0;
+U32 LLPath::sCacheHits = 0;
+U32 LLPath::sCacheMisses = 0;
+
+namespace
+{
+	// Entries are dropped all at once past this; the cache refills from the
+	// volumes currently being built.
+	const U32 MAX_CACHED_SHAPES = 512;
+
+	struct LLProfileKey
+	{
+		LLProfileParams mParams;
+		BOOL mPathOpen;
+		F32 mDetail;
+		S32 mSplit;
+		BOOL mSculpted;
+		S32 mSculptSize;
+
+		bool operator<(const LLProfileKey& rhs) const
+		{
+			if (mParams != rhs.mParams) return mParams < rhs.mParams;
+			if (mPathOpen != rhs.mPathOpen) return mPathOpen < rhs.mPathOpen;
+			if (mDetail != rhs.mDetail) return mDetail < rhs.mDetail;
+			if (mSplit != rhs.mSplit) return mSplit < rhs.mSplit;
+			if (mSculpted != rhs.mSculpted) return mSculpted < rhs.mSculpted;
+			return mSculptSize < rhs.mSculptSize;
+		}
+	};
+
+	struct LLPathKey
+	{
+		LLPathParams mParams;
+		F32 mDetail;
+		S32 mSplit;
+		BOOL mSculpted;
+		S32 mSculptSize;
+
+		bool operator<(const LLPathKey& rhs) const
+		{
+			if (mParams != rhs.mParams) return mParams < rhs.mParams;
+			if (mDetail != rhs.mDetail) return mDetail < rhs.mDetail;
+			if (mSplit != rhs.mSplit) return mSplit < rhs.mSplit;
+			if (mSculpted != rhs.mSculpted) return mSculpted < rhs.mSculpted;
+			return mSculptSize < rhs.mSculptSize;
+		}
+	};
+
+	typedef std::map<LLProfileKey, LLProfile*> profile_cache_t;
+	typedef std::map<LLPathKey, LLPath*> path_cache_t;
+	profile_cache_t sProfileCache;
+	path_cache_t sPathCache;
+
+	template<class T, U32 alignment>
+	void copy_aligned_array(LLAlignedArray<T, alignment>& dst, const LLAlignedArray<T, alignment>& src)
+	{
+		dst.resize(src.size());
+		if (src.size())
+		{
+			ll_memcpy_nonaliased_aligned_16((char*) dst.mArray, (char*) src.mArray, sizeof(T) * src.size());
+		}
+	}
+}
+
+void LLProfile::copyGenerated(const LLProfile& src)
+{
+	copy_aligned_array(mProfile, src.mProfile);
+	mFaces = src.mFaces;
+	mOpen = src.mOpen;
+	mConcave = src.mConcave;
+	mTotalOut = src.mTotalOut;
+	mTotal = src.mTotal;
+}
+
+BOOL LLProfile::generate(const LLProfileParams& params, BOOL path_open, F32 detail, S32 split,
+						 BOOL is_sculpted, S32 sculpt_size)
+{
+	if ((!mDirty) && (!is_sculpted))
+	{
+		return FALSE;
+	}
+
+	if (!AIThreadID::in_main_thread())
+	{
+		return generateUncached(params, path_open, detail, split, is_sculpted, sculpt_size);
+	}
+
+	LLProfileKey key = { params, path_open, detail, split, is_sculpted, sculpt_size };
+	profile_cache_t::iterator iter = sProfileCache.find(key);
+	if (iter != sProfileCache.end())
+	{
+		mDirty = FALSE;
+		copyGenerated(*iter->second);
+		++sCacheHits;
+		return TRUE;
+	}
+
+	++sCacheMisses;
+	BOOL ret = generateUncached(params, path_open, detail, split, is_sculpted, sculpt_size);
+	if (ret)
+	{
+		if (sProfileCache.size() >= MAX_CACHED_SHAPES)
+		{
+			clearCache();
+		}
+
+		LLProfile* cached = new LLProfile();
+		cached->copyGenerated(*this);
+		cached->mDirty = FALSE;
+		sProfileCache[key] = cached;
+	}
+	return ret;
+}
+
+//static
+void LLProfile::clearCache()
+{
+	profile_delete_lock = 0;
+	for (profile_cache_t::iterator iter = sProfileCache.begin(); iter != sProfileCache.end(); ++iter)
+	{
+		delete iter->second;
+	}
+	profile_delete_lock = 1;
+	sProfileCache.clear();
+}
+
+void LLPath::copyGenerated(const LLPath& src)
+{
+	copy_aligned_array(mPath, src.mPath);
+	mOpen = src.mOpen;
+	mTotal = src.mTotal;
+	mStep = src.mStep;
+}
+
+BOOL LLPath::generate(const LLPathParams& params, F32 detail, S32 split,
+					  BOOL is_sculpted, S32 sculpt_size)
+{
+	if ((!mDirty) && (!is_sculpted))
+	{
+		return FALSE;
+	}
+
+	if (!AIThreadID::in_main_thread())
+	{
+		return generateUncached(params, detail, split, is_sculpted, sculpt_size);
+	}
+
+	LLPathKey key = { params, detail, split, is_sculpted, sculpt_size };
+	path_cache_t::iterator iter = sPathCache.find(key);
+	if (iter != sPathCache.end())
+	{
+		mDirty = FALSE;
+		copyGenerated(*iter->second);
+		++sCacheHits;
+		return TRUE;
+	}
+
+	++sCacheMisses;
+	BOOL ret = generateUncached(params, detail, split, is_sculpted, sculpt_size);
+	if (ret)
+	{
+		if (sPathCache.size() >= MAX_CACHED_SHAPES)
+		{
+			clearCache();
+		}
+
+		LLPath* cached = new LLPath();
+		cached->copyGenerated(*this);
+		cached->mDirty = FALSE;
+		sPathCache[key] = cached;
+	}
+	return ret;
+}
+
+//static
+void LLPath::clearCache()
+{
+	for (path_cache_t::iterator iter = sPathCache.begin(); iter != sPathCache.end(); ++iter)
+	{
+		delete iter->second;
+	}
+	sPathCache.clear();
+}
+
 
 S32 LLVolume::sNumMeshPoints = 0;
 
+namespace
+{
+	// Workers of the job system helping to build the faces of one volume
+	S32 sFaceThreads = 0;
+
+	// Below this many vertices waking the workers costs more than it saves
+	const S32 MIN_THREADED_FACE_VERTICES = 2048;
+}
+
 LLVolume::LLVolume(const LLVolumeParams &params, const F32 detail, const BOOL generate_single_face, const BOOL is_unique)
 	: mParams(params)
 {
@@ -2733,6 +2938,25 @@ S32	LLVolume::getNumFaces() const
 }
 
 
+//static
+void LLVolume::setFaceThreadCount(S32 count)
+{
+	llassert(AIThreadID::in_main_thread());
+
+	sFaceThreads = llclamp(count, 0, 8);
+}
+
+//static
+void LLVolume::cleanupClass()
+{
+	setFaceThreadCount(0);
+
+	LL_INFOS() << "Profile cache " << LLProfile::sCacheHits << " hits, " << LLProfile::sCacheMisses << " misses; path cache "
+			   << LLPath::sCacheHits << " hits, " << LLPath::sCacheMisses << " misses" << LL_ENDL;
+	LLProfile::clearCache();
+	LLPath::clearCache();
+}
+
 void LLVolume::createVolumeFaces()
 {
 	if (mGenerateSingleFace)
@@ -2816,10 +3040,29 @@ void LLVolume::createVolumeFaces()
 			}
 		}
 
+		S32 vertices = 0;
 		for (face_list_t::iterator iter = mVolumeFaces.begin();
 			 iter != mVolumeFaces.end(); ++iter)
 		{
-			(*iter).create(this, partial_build);
+			vertices += iter->mNumS * iter->mNumT;
+		}
+
+		//faces only read the shared mesh, profile and path, so they can be
+		//built side by side
+		if (gJobSystem && sFaceThreads > 0 && mVolumeFaces.size() > 1 && vertices >= MIN_THREADED_FACE_VERTICES)
+		{
+			gJobSystem->parallelFor((S32) mVolumeFaces.size(), [this, partial_build](S32 index)
+				{
+					mVolumeFaces[index].create(this, partial_build);
+				}, sFaceThreads);
+		}
+		else
+		{
+			for (face_list_t::iterator iter = mVolumeFaces.begin();
+				 iter != mVolumeFaces.end(); ++iter)
+			{
+				(*iter).create(this, partial_build);
+			}
 		}
 	}
 }
@@ -4125,16 +4368,77 @@ S32 LLVolume::lineSegmentIntersect(const LLVector4a& start, const LLVector4a& en
 			}
 			else
 			{
-				if (!face.mOctree)
+				if (!face.mBVH)
 				{
-					face.createOctree();
+					face.createBVH();
 				}
-			
-				LLOctreeTriangleRayIntersect intersect(start, dir, &face, &closest_t, intersection, tex_coord, normal, tangent_out);
-				intersect.traverse(face.mOctree);
-				if (intersect.mHitFace)
+
+				F32 a, b;
+				U32 index;
+
+				if (face.mBVH->intersect(start, dir, closest_t, a, b, index))
 				{
 					hit_face = i;
+
+					U16 idx0 = face.mIndices[index+0];
+					U16 idx1 = face.mIndices[index+1];
+					U16 idx2 = face.mIndices[index+2];
+
+					if (intersection != NULL)
+					{
+						LLVector4a intersect = dir;
+						intersect.mul(closest_t);
+						intersect.add(start);
+						*intersection = intersect;
+					}
+
+					if (tex_coord != NULL)
+					{
+						LLVector2* tc = (LLVector2*) face.mTexCoords;
+						*tex_coord = ((1.f - a - b)  * tc[idx0] +
+							a              * tc[idx1] +
+							b              * tc[idx2]);
+					}
+
+					if (normal != NULL)
+					{
+						LLVector4a* norm = face.mNormals;
+
+						LLVector4a n1,n2,n3;
+						n1 = norm[idx0];
+						n1.mul(1.f-a-b);
+
+						n2 = norm[idx1];
+						n2.mul(a);
+
+						n3 = norm[idx2];
+						n3.mul(b);
+
+						n1.add(n2);
+						n1.add(n3);
+
+						*normal		= n1;
+					}
+
+					if (tangent_out != NULL)
+					{
+						LLVector4a* tangents = face.mTangents;
+
+						LLVector4a t1,t2,t3;
+						t1 = tangents[idx0];
+						t1.mul(1.f-a-b);
+
+						t2 = tangents[idx1];
+						t2.mul(a);
+
+						t3 = tangents[idx2];
+						t3.mul(b);
+
+						t1.add(t2);
+						t1.add(t3);
+
+						*tangent_out = t1;
+					}
 				}
 			}
 		}		
@@ -4683,6 +4987,7 @@ LLVolumeFace::LLVolumeFace() :
 	mWeights(NULL),
 	mWeightsScrubbed(FALSE),
 	mOctree(NULL),
+	mBVH(NULL),
 	mOptimized(FALSE)
 {
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4709,6 +5014,7 @@ LLVolumeFace::LLVolumeFace(const LLVolumeFace& src)
 	mWeights(NULL),
 	mWeightsScrubbed(FALSE),
 	mOctree(NULL),
+	mBVH(NULL),
 	mOptimized(FALSE)
 { 
 	mExtents = (LLVector4a*) ll_aligned_malloc_16(sizeof(LLVector4a)*3);
@@ -4802,15 +5108,13 @@ void LLVolumeFace::freeData()
 	allocateWeights(0);
 	allocateIndices(0);
 
-	delete mOctree;
-	mOctree = NULL;
+	destroyOctree();
 }
 
 BOOL LLVolumeFace::create(LLVolume* volume, BOOL partial_build)
 {
 	//tree for this face is no longer valid
-	delete mOctree;
-	mOctree = NULL;
+	destroyOctree();
 
 	BOOL ret = FALSE ;
 	if (mTypeMask & CAP_MASK)
@@ -5419,9 +5723,9 @@ void LLVolumeFace::cacheOptimize()
 		mIndices[i] = new_idx[mIndices[i]];
 	}
 	
-	ll_aligned_free<64>(old_pos);
-	ll_aligned_free_16(old_binorm);
-	ll_aligned_free_16(old_wght);
+	LLSizeClassAllocator::free(old_pos);
+	LLSizeClassAllocator::free(old_binorm);
+	LLSizeClassAllocator::free(old_wght);
 
 	// DO NOT free mNormals and mTexCoords as they are part of mPositions buffer
 
@@ -5499,9 +5803,29 @@ void LLVolumeFace::createOctree(F32 scaler, const LLVector4a& center, const LLVe
 	}
 }
 
+void LLVolumeFace::createBVH()
+{
+	if (!mBVH)
+	{
+		mBVH = new LLVolumeBVH(*this);
+	}
+}
+
+void LLVolumeFace::destroyOctree()
+{
+	delete mOctree;
+	mOctree = NULL;
+
+	delete mBVH;
+	mBVH = NULL;
+}
 
 void LLVolumeFace::swapData(LLVolumeFace& rhs)
 {
+	//both copy or point into the geometry being swapped
+	destroyOctree();
+	rhs.destroyOctree();
+
 	llswap(rhs.mPositions, mPositions);
 	llswap(rhs.mNormals, mNormals);
 	llswap(rhs.mTangents, mTangents);
@@ -6261,21 +6585,21 @@ void LLVolumeFace::pushVertex(const LLVector4a& pos, const LLVector4a& norm, con
 
 void LLVolumeFace::allocateTangents(S32 num_verts)
 {
-	ll_aligned_free_16(mTangents);
+	LLSizeClassAllocator::free(mTangents);
 	mTangents = NULL;
 	if (num_verts)
 	{
-		mTangents = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
+		mTangents = (LLVector4a*)LLSizeClassAllocator::allocate(sizeof(LLVector4a)*num_verts, 16, LLSizeClassAllocator::VOLUME);
 	}
 }
 
 void LLVolumeFace::allocateWeights(S32 num_verts)
 {
-	ll_aligned_free_16(mWeights);
+	LLSizeClassAllocator::free(mWeights);
 	mWeights = NULL;
 	if (num_verts)
 	{
-		mWeights = (LLVector4a*)ll_aligned_malloc_16(sizeof(LLVector4a)*num_verts);
+		mWeights = (LLVector4a*)LLSizeClassAllocator::allocate(sizeof(LLVector4a)*num_verts, 16, LLSizeClassAllocator::VOLUME);
 	}
 }
 
@@ -6283,7 +6607,7 @@ void LLVolumeFace::allocateVertices(S32 num_verts, bool copy)
 {
 	if (!copy || !num_verts)
 	{
-		ll_aligned_free<64>(mPositions);
+		LLSizeClassAllocator::free(mPositions);
 		mPositions = NULL;
 		mNormals = NULL;
 		mTexCoords = NULL;
@@ -6298,7 +6622,7 @@ void LLVolumeFace::allocateVertices(S32 num_verts, bool copy)
 
 		//allocate new buffer space
 		LLVector4a* old_buf = mPositions;
-		mPositions = (LLVector4a*)ll_aligned_malloc<64>(new_size);
+		mPositions = (LLVector4a*)LLSizeClassAllocator::allocate(new_size, 64, LLSizeClassAllocator::VOLUME);
 		mNormals = mPositions + num_verts;
 		mTexCoords = (LLVector2*)(mNormals + num_verts);
 
@@ -6315,7 +6639,7 @@ void LLVolumeFace::allocateVertices(S32 num_verts, bool copy)
 				LLVector4a::memcpyNonAliased16((F32*)mNormals, (F32*)(old_buf + mNumVertices), old_nsize);
 				LLVector4a::memcpyNonAliased16((F32*)mTexCoords, (F32*)(old_buf + mNumVertices * 2), old_tcsize);
 			}
-			ll_aligned_free<64>(old_buf);
+			LLSizeClassAllocator::free(old_buf);
 		}
 	}
 	mNumAllocatedVertices = num_verts;
@@ -6331,20 +6655,16 @@ void LLVolumeFace::allocateIndices(S32 num_indices, bool copy)
 	S32 new_size = ((num_indices * sizeof(U16)) + 0xF) & ~0xF;
 	if (copy && num_indices && mIndices && mNumIndices)
 	{
-#if !LL_USE_TCMALLOC
-		S32 old_size = ((mNumIndices * sizeof(U16)) + 0xF) & ~0xF;
-#endif
-
-		mIndices = (U16*)ll_aligned_realloc_16(mIndices, new_size, old_size);
+		mIndices = (U16*)LLSizeClassAllocator::reallocate(mIndices, new_size, 16, LLSizeClassAllocator::VOLUME);
 
 		mNumIndices = num_indices;
 		return;
 	}
-	ll_aligned_free_16(mIndices);
+	LLSizeClassAllocator::free(mIndices);
 	mIndices = NULL;
 	if (num_indices)
 	{
-		mIndices = (U16*)ll_aligned_malloc_16(new_size);
+		mIndices = (U16*)LLSizeClassAllocator::allocate(new_size, 16, LLSizeClassAllocator::VOLUME);
 	}
 
 	mNumIndices = num_indices;
@@ -6634,7 +6954,7 @@ BOOL LLVolumeFace::createSide(LLVolume* volume, BOOL partial_build)
 
 	LLVector4a* norm = mNormals;
 
-	static LLAlignedArray<LLVector4a, 64> triangle_normals;
+	static thread_local LLAlignedArray<LLVector4a, 64> triangle_normals;
 	triangle_normals.resize(count);
 	LLVector4a* output = triangle_normals.mArray;
 	LLVector4a* end_output = output+count;
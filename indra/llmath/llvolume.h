@@ -43,6 +43,7 @@ template <class T> class LLOctreeRoot;
 class LLVolumeFace;
 class LLVolume;
 class LLVolumeTriangle;
+class LLVolumeBVH;
 
 #include "lluuid.h"
 #include "v4color.h"
@@ -707,6 +708,13 @@ public:
 	BOOL generate(const LLProfileParams& params, BOOL path_open, F32 detail = 1.0f, S32 split = 0,
 				  BOOL is_sculpted = FALSE, S32 sculpt_size = 0);
 	BOOL isConcave() const								{ return mConcave; }
+
+	// Generated profiles are kept per set of generate() arguments so volumes
+	// with the same profile copy the points instead of rebuilding them.  The
+	// cache is only used on the main thread.
+	static void clearCache();
+	static U32 sCacheHits;
+	static U32 sCacheMisses;
 public:
 	struct Face
 	{
@@ -735,6 +743,10 @@ protected:
 	Face* addCap (S16 faceID);
 	Face* addFace(S32 index, S32 count, F32 scaleU, S16 faceID, BOOL flat);
 
+	BOOL generateUncached(const LLProfileParams& params, BOOL path_open, F32 detail, S32 split,
+						  BOOL is_sculpted, S32 sculpt_size);
+	void copyGenerated(const LLProfile& src);
+
 protected:
 	BOOL		  mOpen;
 	BOOL		  mConcave;
@@ -802,11 +814,21 @@ public:
 
 	void resizePath(S32 length) { mPath.resize(length); }
 
+	// See LLProfile::clearCache()
+	static void clearCache();
+	static U32 sCacheHits;
+	static U32 sCacheMisses;
+
 	friend std::ostream& operator<<(std::ostream &s, const LLPath &path);
 
 public:
 	LLAlignedArray<PathPt, 64> mPath;
 
+protected:
+	BOOL generateUncached(const LLPathParams& params, F32 detail, S32 split,
+						  BOOL is_sculpted, S32 sculpt_size);
+	void copyGenerated(const LLPath& src);
+
 protected:
 	BOOL		  mOpen;
 	S32			  mTotal;
@@ -907,6 +929,10 @@ public:
 	void cacheOptimize();
 
 	void createOctree(F32 scaler = 0.25f, const LLVector4a& center = LLVector4a(0,0,0), const LLVector4a& size = LLVector4a(0.5f,0.5f,0.5f));
+	void createBVH();
+
+	//free the octree and picking hierarchy, both are rebuilt on demand
+	void destroyOctree();
 
 	enum
 	{
@@ -966,6 +992,9 @@ public:
     
 	LLOctreeRoot<LLVolumeTriangle>* mOctree;
 
+	//flat hierarchy used by LLVolume::lineSegmentIntersect
+	LLVolumeBVH* mBVH;
+
 	//whether or not face has been cache optimized
 	BOOL mOptimized;
 
@@ -1051,6 +1080,11 @@ public:
 	BOOL isFaceMaskValid(LLFaceID face_mask);
 	static S32 sNumMeshPoints;
 
+	// Number of job system workers createVolumeFaces() may spread the faces
+	// of a large prim over; 0 disables.
+	static void setFaceThreadCount(S32 count);
+	static void cleanupClass();
+
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume &volume);
 	friend std::ostream& operator<<(std::ostream &s, const LLVolume *volumep);		// HACK to bypass Windoze confusion over 
 																				// conversion if *(LLVolume*) to LLVolume&
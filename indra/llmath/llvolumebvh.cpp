@@ -0,0 +1,530 @@
+/**
+ * @file llvolumebvh.cpp
+ * @brief Flat bounding volume hierarchy for ray picking against volume faces.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llvolumebvh.h"
+
+#include "llmemory.h"
+#include "llvolume.h"
+
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+	const U32 INNER_NODE = 0x80000000;	// set in Node::mCount of inner nodes, low bits hold the split axis
+	const U32 PACKET_SIZE = 4;			// triangles per SSE packet
+	const U32 MIN_LEAF_SIZE = 4;		// never split a node holding this many triangles or fewer
+	const U32 MAX_LEAF_SIZE = 16;		// always split a node holding more triangles than this
+	const U32 MAX_DEPTH = 40;			// past this depth split at the median, keeps the traversal stack bounded
+	const U32 STACK_SIZE = 64;
+	const S32 BIN_COUNT = 12;
+	const F32 TRAVERSAL_COST = 0.5f;	// cost of a box test relative to a packet test
+
+	inline U32 packets_for(U32 count)
+	{
+		return (count + PACKET_SIZE - 1) / PACKET_SIZE;
+	}
+
+	inline F32 half_area(const LLVector4a& min, const LLVector4a& max)
+	{
+		LLVector4a size;
+		size.setSub(max, min);
+		const F32* s = size.getF32ptr();
+		return s[0]*s[1] + s[1]*s[2] + s[2]*s[0];
+	}
+
+	// horizontal maximum and minimum of all four lanes, result in every lane
+	inline __m128 hmax(__m128 v)
+	{
+		v = _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_max_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+
+	inline __m128 hmin(__m128 v)
+	{
+		v = _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+		return _mm_min_ps(v, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+	}
+}
+
+//------------------------------------------------------------------------------
+// Layout
+//------------------------------------------------------------------------------
+
+LL_ALIGN_PREFIX(16)
+struct LLVolumeBVH::Node
+{
+	F32 mMin[3];
+	U32 mOffset;	// right child of an inner node, first packet of a leaf
+	F32 mMax[3];
+	U32 mCount;		// packets in a leaf, or INNER_NODE | split axis
+} LL_ALIGN_POSTFIX(16);
+
+// Four triangles, one per lane.  Storing the first vertex and both edges
+// is what the Moller-Trumbore test consumes; padding lanes have zero edges
+// so their determinant never passes the epsilon test.
+LL_ALIGN_PREFIX(16)
+struct LLVolumeBVH::Packet
+{
+	LLVector4a mV0[3];
+	LLVector4a mEdge1[3];
+	LLVector4a mEdge2[3];
+	U32 mIndex[4];	// offset of the triangle in LLVolumeFace::mIndices
+} LL_ALIGN_POSTFIX(16);
+
+LL_ALIGN_PREFIX(16)
+struct LLVolumeBVH::BuildTriangle
+{
+	LLVector4a mMin;
+	LLVector4a mMax;
+	LLVector4a mCenter;
+	U32 mIndex;
+} LL_ALIGN_POSTFIX(16);
+
+//------------------------------------------------------------------------------
+// Construction
+//------------------------------------------------------------------------------
+
+class LLVolumeBVH::Builder
+{
+public:
+	Builder(LLVolumeBVH& bvh, const LLVolumeFace& face, BuildTriangle* tris)
+	:	mBVH(bvh), mFace(face), mTriangles(tris)
+	{
+	}
+
+	void build(U32 begin, U32 end, U32 depth);
+
+private:
+	void makeLeaf(Node& node, U32 begin, U32 end);
+
+	LLVolumeBVH& mBVH;
+	const LLVolumeFace& mFace;
+	BuildTriangle* mTriangles;
+};
+
+void LLVolumeBVH::Builder::makeLeaf(Node& node, U32 begin, U32 end)
+{
+	node.mOffset = mBVH.mPacketCount;
+	node.mCount = packets_for(end - begin);
+
+	for (U32 i = begin; i < end; i += PACKET_SIZE)
+	{
+		Packet& packet = mBVH.mPackets[mBVH.mPacketCount++];
+		F32* v0[3] = { packet.mV0[0].getF32ptr(), packet.mV0[1].getF32ptr(), packet.mV0[2].getF32ptr() };
+		F32* e1[3] = { packet.mEdge1[0].getF32ptr(), packet.mEdge1[1].getF32ptr(), packet.mEdge1[2].getF32ptr() };
+		F32* e2[3] = { packet.mEdge2[0].getF32ptr(), packet.mEdge2[1].getF32ptr(), packet.mEdge2[2].getF32ptr() };
+
+		for (U32 lane = 0; lane < PACKET_SIZE; ++lane)
+		{
+			if (i + lane >= end)
+			{ //degenerate padding
+				for (U32 k = 0; k < 3; ++k)
+				{
+					v0[k][lane] = e1[k][lane] = e2[k][lane] = 0.f;
+				}
+				packet.mIndex[lane] = U32_MAX;
+				continue;
+			}
+
+			U32 index = mTriangles[i + lane].mIndex;
+			const F32* p0 = mFace.mPositions[mFace.mIndices[index]].getF32ptr();
+			const F32* p1 = mFace.mPositions[mFace.mIndices[index+1]].getF32ptr();
+			const F32* p2 = mFace.mPositions[mFace.mIndices[index+2]].getF32ptr();
+
+			for (U32 k = 0; k < 3; ++k)
+			{
+				v0[k][lane] = p0[k];
+				e1[k][lane] = p1[k] - p0[k];
+				e2[k][lane] = p2[k] - p0[k];
+			}
+			packet.mIndex[lane] = index;
+		}
+	}
+}
+
+void LLVolumeBVH::Builder::build(U32 begin, U32 end, U32 depth)
+{
+	Node& node = mBVH.mNodes[mBVH.mNodeCount++];
+	U32 count = end - begin;
+
+	LLVector4a min = mTriangles[begin].mMin;
+	LLVector4a max = mTriangles[begin].mMax;
+	LLVector4a cmin = mTriangles[begin].mCenter;
+	LLVector4a cmax = cmin;
+	for (U32 i = begin + 1; i < end; ++i)
+	{
+		min.setMin(min, mTriangles[i].mMin);
+		max.setMax(max, mTriangles[i].mMax);
+		cmin.setMin(cmin, mTriangles[i].mCenter);
+		cmax.setMax(cmax, mTriangles[i].mCenter);
+	}
+
+	for (U32 k = 0; k < 3; ++k)
+	{
+		node.mMin[k] = min[k];
+		node.mMax[k] = max[k];
+	}
+
+	if (count <= MIN_LEAF_SIZE)
+	{
+		makeLeaf(node, begin, end);
+		return;
+	}
+
+	//binned surface area heuristic over the triangle centers
+	S32 best_axis = -1;
+	S32 best_bin = 0;
+	F32 best_cost = FLT_MAX;
+
+	if (depth < MAX_DEPTH)
+	{
+		for (S32 axis = 0; axis < 3; ++axis)
+		{
+			F32 extent = cmax[axis] - cmin[axis];
+			if (extent <= 0.f)
+			{
+				continue;
+			}
+
+			F32 scale = BIN_COUNT * (1.f - 1e-5f) / extent;
+
+			U32 bin_count[BIN_COUNT] = { 0 };
+			LLVector4a bin_min[BIN_COUNT];
+			LLVector4a bin_max[BIN_COUNT];
+			for (S32 b = 0; b < BIN_COUNT; ++b)
+			{
+				bin_min[b].splat(FLT_MAX);
+				bin_max[b].splat(-FLT_MAX);
+			}
+
+			for (U32 i = begin; i < end; ++i)
+			{
+				S32 b = llmin((S32) ((mTriangles[i].mCenter[axis] - cmin[axis]) * scale), BIN_COUNT - 1);
+				bin_count[b]++;
+				bin_min[b].setMin(bin_min[b], mTriangles[i].mMin);
+				bin_max[b].setMax(bin_max[b], mTriangles[i].mMax);
+			}
+
+			//sweep from the right to get the cost of everything past each split
+			F32 right_cost[BIN_COUNT];
+			LLVector4a rmin, rmax;
+			rmin.splat(FLT_MAX);
+			rmax.splat(-FLT_MAX);
+			U32 rcount = 0;
+			for (S32 b = BIN_COUNT - 1; b > 0; --b)
+			{
+				rcount += bin_count[b];
+				rmin.setMin(rmin, bin_min[b]);
+				rmax.setMax(rmax, bin_max[b]);
+				right_cost[b] = rcount ? half_area(rmin, rmax) * packets_for(rcount) : 0.f;
+			}
+
+			LLVector4a lmin, lmax;
+			lmin.splat(FLT_MAX);
+			lmax.splat(-FLT_MAX);
+			U32 lcount = 0;
+			for (S32 b = 0; b < BIN_COUNT - 1; ++b)
+			{
+				lcount += bin_count[b];
+				lmin.setMin(lmin, bin_min[b]);
+				lmax.setMax(lmax, bin_max[b]);
+				if (!lcount || lcount == count)
+				{
+					continue;
+				}
+
+				F32 cost = half_area(lmin, lmax) * packets_for(lcount) + right_cost[b + 1];
+				if (cost < best_cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_bin = b;
+				}
+			}
+		}
+	}
+
+	U32 mid = begin;
+	S32 split_axis = best_axis;
+
+	F32 area = half_area(min, max);
+	bool split = best_axis >= 0 && area * TRAVERSAL_COST + best_cost < area * packets_for(count);
+
+	if (split)
+	{
+		F32 base = cmin[best_axis];
+		F32 scale = BIN_COUNT * (1.f - 1e-5f) / (cmax[best_axis] - base);
+		BuildTriangle* pivot = std::partition(mTriangles + begin, mTriangles + end,
+			[=](const BuildTriangle& tri)
+			{
+				return llmin((S32) ((tri.mCenter[best_axis] - base) * scale), BIN_COUNT - 1) <= best_bin;
+			});
+		mid = (U32) (pivot - mTriangles);
+	}
+	else if (count <= MAX_LEAF_SIZE)
+	{
+		makeLeaf(node, begin, end);
+		return;
+	}
+	else
+	{ //too big for a leaf and no useful split, halve along the widest axis
+		LLVector4a extent;
+		extent.setSub(cmax, cmin);
+		split_axis = extent[0] > extent[1] ? 0 : 1;
+		split_axis = extent[2] > extent[split_axis] ? 2 : split_axis;
+
+		mid = begin + count / 2;
+		std::nth_element(mTriangles + begin, mTriangles + mid, mTriangles + end,
+			[=](const BuildTriangle& lhs, const BuildTriangle& rhs)
+			{
+				return lhs.mCenter[split_axis] < rhs.mCenter[split_axis];
+			});
+	}
+
+	build(begin, mid, depth + 1);
+	node.mOffset = mBVH.mNodeCount;
+	node.mCount = INNER_NODE | split_axis;
+	build(mid, end, depth + 1);
+}
+
+LLVolumeBVH::LLVolumeBVH(const LLVolumeFace& face)
+:	mNodes(NULL),
+	mPackets(NULL),
+	mNodeCount(0),
+	mPacketCount(0),
+	mTriangleCount(face.mNumIndices / 3)
+{
+	if (!mTriangleCount)
+	{
+		return;
+	}
+
+	BuildTriangle* tris = (BuildTriangle*) ll_aligned_malloc_16(sizeof(BuildTriangle) * mTriangleCount);
+	for (U32 i = 0; i < mTriangleCount; ++i)
+	{
+		const LLVector4a& v0 = face.mPositions[face.mIndices[i*3+0]];
+		const LLVector4a& v1 = face.mPositions[face.mIndices[i*3+1]];
+		const LLVector4a& v2 = face.mPositions[face.mIndices[i*3+2]];
+
+		BuildTriangle& tri = tris[i];
+		tri.mMin.setMin(v0, v1);
+		tri.mMin.setMin(tri.mMin, v2);
+		tri.mMax.setMax(v0, v1);
+		tri.mMax.setMax(tri.mMax, v2);
+		tri.mCenter.setAdd(tri.mMin, tri.mMax);
+		tri.mCenter.mul(0.5f);
+		tri.mIndex = i*3;
+	}
+
+	//a binary tree with at least one triangle per leaf bounds both arrays
+	Node* nodes = (Node*) ll_aligned_malloc_16(sizeof(Node) * (mTriangleCount * 2 - 1));
+	Packet* packets = (Packet*) ll_aligned_malloc_16(sizeof(Packet) * mTriangleCount);
+	mNodes = nodes;
+	mPackets = packets;
+
+	Builder builder(*this, face, tris);
+	builder.build(0, mTriangleCount, 0);
+
+	ll_aligned_free_16(tris);
+
+	//trim to the space actually used
+	mNodes = (Node*) ll_aligned_malloc_16(sizeof(Node) * mNodeCount);
+	memcpy(mNodes, nodes, sizeof(Node) * mNodeCount);
+	ll_aligned_free_16(nodes);
+
+	mPackets = (Packet*) ll_aligned_malloc_16(sizeof(Packet) * mPacketCount);
+	memcpy(mPackets, packets, sizeof(Packet) * mPacketCount);
+	ll_aligned_free_16(packets);
+}
+
+LLVolumeBVH::~LLVolumeBVH()
+{
+	ll_aligned_free_16(mNodes);
+	ll_aligned_free_16(mPackets);
+}
+
+U32 LLVolumeBVH::getMemoryUsage() const
+{
+	return sizeof(LLVolumeBVH) + mNodeCount * sizeof(Node) + mPacketCount * sizeof(Packet);
+}
+
+//------------------------------------------------------------------------------
+// Traversal
+//------------------------------------------------------------------------------
+
+bool LLVolumeBVH::intersect(const LLVector4a& start, const LLVector4a& dir,
+							F32& closest_t, F32& a, F32& b, U32& index) const
+{
+	if (!mNodeCount)
+	{
+		return false;
+	}
+
+	const __m128 xyz_mask = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+
+	//slab test setup, axis parallel segments get a huge but finite reciprocal
+	//so a zero offset never turns into 0 * inf
+	LL_ALIGN_16(F32 inv[4]);
+	U32 negative[3];
+	for (U32 k = 0; k < 3; ++k)
+	{
+		F32 d = dir[k];
+		inv[k] = fabsf(d) > 1e-30f ? 1.f / d : (d < 0.f ? -1e30f : 1e30f);
+		negative[k] = d < 0.f;
+	}
+	inv[3] = 0.f;
+
+	const __m128 origin = _mm_and_ps(start, xyz_mask);
+	const __m128 inv_dir = _mm_load_ps(inv);
+
+	const __m128 dx = _mm_set1_ps(dir[0]);
+	const __m128 dy = _mm_set1_ps(dir[1]);
+	const __m128 dz = _mm_set1_ps(dir[2]);
+	const __m128 ox = _mm_set1_ps(start[0]);
+	const __m128 oy = _mm_set1_ps(start[1]);
+	const __m128 oz = _mm_set1_ps(start[2]);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 epsilon = LLVector4a::getEpsilon();
+
+	bool hit = false;
+
+	U32 stack[STACK_SIZE];
+	U32 depth = 0;
+	U32 cur = 0;
+
+	while (true)
+	{
+		const Node& node = mNodes[cur];
+
+		//segment against the node's box, clipped to [0, min(closest_t, 1)]
+		__m128 limit = _mm_set1_ps(llmin(closest_t, 1.f));
+		__m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_and_ps(_mm_load_ps(node.mMin), xyz_mask), origin), inv_dir);
+		__m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_and_ps(_mm_load_ps(node.mMax), xyz_mask), origin), inv_dir);
+		__m128 t_near = hmax(_mm_min_ps(t0, t1));	//w lane is 0, which also clamps to the segment start
+		__m128 t_far = _mm_max_ps(t0, t1);
+		t_far = hmin(_mm_or_ps(_mm_and_ps(t_far, xyz_mask), _mm_andnot_ps(xyz_mask, limit)));
+
+		if (_mm_comile_ss(t_near, t_far))
+		{
+			if (node.mCount & INNER_NODE)
+			{ //visit the near child first so closest_t tightens sooner
+				U32 left = cur + 1;
+				U32 right = node.mOffset;
+				if (negative[node.mCount & 3])
+				{
+					std::swap(left, right);
+				}
+				llassert(depth < STACK_SIZE);
+				stack[depth++] = right;
+				cur = left;
+				continue;
+			}
+
+			const Packet* packet = mPackets + node.mOffset;
+			const Packet* packet_end = packet + node.mCount;
+			for (; packet < packet_end; ++packet)
+			{
+				const __m128 e1x = packet->mEdge1[0], e1y = packet->mEdge1[1], e1z = packet->mEdge1[2];
+				const __m128 e2x = packet->mEdge2[0], e2y = packet->mEdge2[1], e2z = packet->mEdge2[2];
+
+				//p = dir x edge2
+				__m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+				__m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+				__m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+
+				__m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+
+				__m128 tx = _mm_sub_ps(ox, packet->mV0[0]);
+				__m128 ty = _mm_sub_ps(oy, packet->mV0[1]);
+				__m128 tz = _mm_sub_ps(oz, packet->mV0[2]);
+
+				__m128 u = _mm_add_ps(_mm_add_ps(_mm_mul_ps(tx, px), _mm_mul_ps(ty, py)), _mm_mul_ps(tz, pz));
+
+				//q = t x edge1
+				__m128 qx = _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y));
+				__m128 qy = _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z));
+				__m128 qz = _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x));
+
+				__m128 v = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz));
+
+				__m128 mask = _mm_cmpge_ps(det, epsilon);
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(u, zero));
+				mask = _mm_and_ps(mask, _mm_cmple_ps(u, det));
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(v, zero));
+				mask = _mm_and_ps(mask, _mm_cmple_ps(_mm_add_ps(u, v), det));
+
+				if (!_mm_movemask_ps(mask))
+				{
+					continue;
+				}
+
+				__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz));
+				t = _mm_div_ps(t, det);
+
+				mask = _mm_and_ps(mask, _mm_cmpge_ps(t, zero));
+				mask = _mm_and_ps(mask, _mm_cmple_ps(t, one));
+				mask = _mm_and_ps(mask, _mm_cmplt_ps(t, _mm_set1_ps(closest_t)));
+
+				S32 lanes = _mm_movemask_ps(mask);
+				if (!lanes)
+				{
+					continue;
+				}
+
+				LL_ALIGN_16(F32 lane_t[4]);
+				LL_ALIGN_16(F32 lane_u[4]);
+				LL_ALIGN_16(F32 lane_v[4]);
+				_mm_store_ps(lane_t, t);
+				_mm_store_ps(lane_u, _mm_div_ps(u, det));
+				_mm_store_ps(lane_v, _mm_div_ps(v, det));
+
+				for (U32 lane = 0; lane < PACKET_SIZE; ++lane)
+				{
+					if ((lanes & (1 << lane)) && lane_t[lane] < closest_t)
+					{
+						closest_t = lane_t[lane];
+						a = lane_u[lane];
+						b = lane_v[lane];
+						index = packet->mIndex[lane];
+						hit = true;
+					}
+				}
+			}
+		}
+
+		if (!depth)
+		{
+			break;
+		}
+		cur = stack[--depth];
+	}
+
+	return hit;
+}
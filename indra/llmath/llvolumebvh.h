@@ -0,0 +1,77 @@
+/**
+ * @file llvolumebvh.h
+ * @brief Flat bounding volume hierarchy for ray picking against volume faces.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLVOLUMEBVH_H
+#define LL_LLVOLUMEBVH_H
+
+#include "llmath.h"
+
+class LLVolumeFace;
+
+// Bounding volume hierarchy over the triangles of one LLVolumeFace, used by
+// LLVolume::lineSegmentIntersect in place of the per face octree.
+//
+// The tree is built top down with a binned surface area heuristic and stored
+// depth first in a single node array (the left child of a node is the node
+// that follows it).  Leaves reference packets of four triangles laid out
+// structure-of-arrays so a whole packet is tested with one SSE pass.
+//
+// Vertex positions are copied into the packets, so the hierarchy has to be
+// thrown away whenever the face's positions or indices change.
+class LLVolumeBVH
+{
+public:
+	LLVolumeBVH(const LLVolumeFace& face);
+	~LLVolumeBVH();
+
+	// Intersect the segment start + t*dir, 0 <= t <= 1, with the face.
+	// Triangles are one sided, exactly as in LLTriangleRayIntersect.
+	// Returns true if a hit closer than closest_t was found, in which case
+	// closest_t, the barycentric weights a and b of the second and third
+	// vertex and the offset of the triangle's first index in
+	// LLVolumeFace::mIndices are updated.
+	bool intersect(const LLVector4a& start, const LLVector4a& dir,
+				   F32& closest_t, F32& a, F32& b, U32& index) const;
+
+	U32 getTriangleCount() const	{ return mTriangleCount; }
+	U32 getNodeCount() const		{ return mNodeCount; }
+	U32 getPacketCount() const		{ return mPacketCount; }
+	U32 getMemoryUsage() const;
+
+private:
+	struct Node;
+	struct Packet;
+	struct BuildTriangle;
+	class Builder;
+
+	Node* mNodes;
+	Packet* mPackets;
+	U32 mNodeCount;
+	U32 mPacketCount;
+	U32 mTriangleCount;
+};
+
+#endif //LL_LLVOLUMEBVH_H
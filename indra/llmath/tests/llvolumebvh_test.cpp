@@ -0,0 +1,170 @@
+/**
+ * @file llvolumebvh_test.cpp
+ * @brief Checks the volume face BVH against the octree it replaces for picking.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "llrand.h"
+#include "lltimer.h"
+#include "../llvolume.h"
+#include "../llvolumebvh.h"
+#include "../llvolumeoctree.h"
+
+BOOL gDebugGL = FALSE;
+
+namespace
+{
+	// A bumpy sphere of the size of a sculpt or mesh face, fitting the unit
+	// cube createOctree() assumes by default.
+	void make_face(LLVolumeFace& face, S32 rings, S32 segments)
+	{
+		face.resizeVertices(rings * segments);
+		face.resizeIndices((rings - 1) * (segments - 1) * 6);
+
+		for (S32 i = 0; i < rings; ++i)
+		{
+			F32 phi = F_PI * i / (rings - 1);
+			for (S32 j = 0; j < segments; ++j)
+			{
+				F32 theta = F_TWO_PI * j / (segments - 1);
+				F32 r = 0.45f + 0.03f * sinf(theta * 7.f) * sinf(phi * 5.f);
+				S32 v = i * segments + j;
+				face.mPositions[v].set(r * cosf(theta) * sinf(phi), r * sinf(theta) * sinf(phi), r * cosf(phi));
+				face.mNormals[v] = face.mPositions[v];
+				face.mNormals[v].normalize3fast();
+				face.mTexCoords[v].set((F32) j / (segments - 1), (F32) i / (rings - 1));
+			}
+		}
+
+		U16* idx = face.mIndices;
+		for (S32 i = 0; i < rings - 1; ++i)
+		{
+			for (S32 j = 0; j < segments - 1; ++j)
+			{
+				U16 v = i * segments + j;
+				*idx++ = v;
+				*idx++ = v + segments;
+				*idx++ = v + 1;
+				*idx++ = v + 1;
+				*idx++ = v + segments;
+				*idx++ = v + segments + 1;
+			}
+		}
+
+		face.mExtents[0] = face.mPositions[0];
+		face.mExtents[1] = face.mPositions[0];
+		for (S32 v = 1; v < face.mNumVertices; ++v)
+		{
+			face.mExtents[0].setMin(face.mExtents[0], face.mPositions[v]);
+			face.mExtents[1].setMax(face.mExtents[1], face.mPositions[v]);
+		}
+	}
+
+	LLVector4a random_point(F32 scale)
+	{
+		LLVector4a p;
+		p.set((ll_frand() - 0.5f) * scale, (ll_frand() - 0.5f) * scale, (ll_frand() - 0.5f) * scale);
+		return p;
+	}
+}
+
+namespace tut
+{
+	struct volumebvh_test
+	{
+	};
+	typedef test_group<volumebvh_test> volumebvh_group_t;
+	typedef volumebvh_group_t::object volumebvh_object_t;
+	tut::volumebvh_group_t volumebvh_instance("volume_bvh");
+
+	template<> template<>
+	void volumebvh_object_t::test<1>()
+	{
+		LLVolumeFace face;
+		make_face(face, 96, 128);
+
+		LLTimer timer;
+		face.createOctree();
+		F64 octree_build = timer.getElapsedTimeF64() * 1000.0;
+
+		timer.reset();
+		face.createBVH();
+		F64 bvh_build = timer.getElapsedTimeF64() * 1000.0;
+
+		//rays from outside the face toward points near its center, plus
+		//some axis aligned ones to exercise the zero direction components
+		const S32 RAYS = 20000;
+		std::vector<LLVector4a> starts(RAYS);
+		std::vector<LLVector4a> dirs(RAYS);
+		for (S32 i = 0; i < RAYS; ++i)
+		{
+			starts[i] = random_point(3.f);
+			LLVector4a end = random_point(0.8f);
+			if (i % 5 == 0)
+			{
+				end = starts[i];
+				end.getF32ptr()[i % 3] -= 3.f;
+			}
+			dirs[i].setSub(end, starts[i]);
+		}
+
+		std::vector<F32> octree_t(RAYS, 2.f);
+		std::vector<LLVector4a> octree_hit(RAYS);
+		timer.reset();
+		for (S32 i = 0; i < RAYS; ++i)
+		{
+			LLOctreeTriangleRayIntersect intersect(starts[i], dirs[i], &face, &octree_t[i], &octree_hit[i], NULL, NULL, NULL);
+			intersect.traverse(face.mOctree);
+		}
+		F64 octree_cast = timer.getElapsedTimeF64() * 1000.0;
+
+		std::vector<F32> bvh_t(RAYS, 2.f);
+		std::vector<U32> bvh_index(RAYS);
+		timer.reset();
+		for (S32 i = 0; i < RAYS; ++i)
+		{
+			F32 a, b;
+			face.mBVH->intersect(starts[i], dirs[i], bvh_t[i], a, b, bvh_index[i]);
+		}
+		F64 bvh_cast = timer.getElapsedTimeF64() * 1000.0;
+
+		S32 hits = 0;
+		for (S32 i = 0; i < RAYS; ++i)
+		{
+			ensure("same hit", (octree_t[i] <= 1.f) == (bvh_t[i] <= 1.f));
+			if (bvh_t[i] <= 1.f)
+			{
+				ensure_approximately_equals("same distance", octree_t[i], bvh_t[i], 16);
+				++hits;
+			}
+		}
+
+		LL_INFOS() << "Volume BVH: " << face.mBVH->getTriangleCount() << " triangles, " << face.mBVH->getNodeCount() << " nodes, "
+				   << face.mBVH->getMemoryUsage() << " bytes, " << hits << " of " << RAYS << " rays hit" << LL_ENDL;
+		LL_INFOS() << "Volume BVH: build " << bvh_build << " ms, cast " << bvh_cast << " ms; octree build "
+				   << octree_build << " ms, cast " << octree_cast << " ms" << LL_ENDL;
+	}
+}
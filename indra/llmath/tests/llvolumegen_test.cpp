@@ -0,0 +1,191 @@
+/**
+ * @file llvolumegen_test.cpp
+ * @brief Checks and times prim generation with the profile/path caches and
+ *        threaded face creation.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "llrand.h"
+#include "llsdserialize.h"
+#include "lljobsystem.h"
+#include "lltimer.h"
+#include "../llvolume.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+// The shapes are either read from LL_PRIM_SHAPES, an LLSD array of
+// LLVolumeParams::asLLSD() maps taken from a region, or generated: the
+// handful of profile/path combinations builders use, with the cut, hollow,
+// twist and taper values that prims in a region tend to share.
+namespace
+{
+	typedef std::vector<LLVolumeParams> shape_list_t;
+
+	void load_shapes(shape_list_t& shapes)
+	{
+		const char* file = getenv("LL_PRIM_SHAPES");
+		if (file)
+		{
+			std::ifstream input(file);
+			LLSD sd;
+			if (input.is_open() && LLSDSerialize::fromXML(sd, input) > 0)
+			{
+				for (LLSD::array_iterator iter = sd.beginArray(); iter != sd.endArray(); ++iter)
+				{
+					LLVolumeParams params;
+					if (params.fromLLSD(*iter))
+					{
+						shapes.push_back(params);
+					}
+				}
+				return;
+			}
+		}
+
+		const U8 types[][2] =
+		{
+			{ LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_LINE },		// box
+			{ LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_LINE },		// cylinder
+			{ LL_PCODE_PROFILE_EQUALTRI, LL_PCODE_PATH_LINE },		// prism
+			{ LL_PCODE_PROFILE_CIRCLE_HALF, LL_PCODE_PATH_CIRCLE },	// sphere
+			{ LL_PCODE_PROFILE_CIRCLE, LL_PCODE_PATH_CIRCLE },		// torus
+			{ LL_PCODE_PROFILE_SQUARE, LL_PCODE_PATH_CIRCLE },		// tube
+			{ LL_PCODE_PROFILE_EQUALTRI, LL_PCODE_PATH_CIRCLE },	// ring
+		};
+		const F32 hollows[] = { 0.f, 0.f, 0.5f, 0.95f };
+		const F32 cuts[] = { 0.f, 0.f, 0.25f, 0.5f };
+		const F32 twists[] = { 0.f, 0.f, 0.f, 0.5f };
+		const F32 tapers[] = { 0.f, 0.f, 0.5f, -0.25f };
+
+		for (U32 t = 0; t < LL_ARRAY_SIZE(types); ++t)
+		{
+			for (S32 i = 0; i < 96; ++i)
+			{
+				LLVolumeParams params;
+				params.setType(types[t][0], types[t][1]);
+				params.setHollow(hollows[ll_rand(4)]);
+				F32 cut = cuts[ll_rand(4)];
+				params.setBeginAndEndS(cut, 1.f - cut * ll_rand(2));
+				params.setTwistEnd(twists[ll_rand(4)]);
+				params.setTaper(tapers[ll_rand(4)], tapers[ll_rand(4)]);
+				shapes.push_back(params);
+			}
+		}
+	}
+
+	// Builds every shape at every detail level, keeping the volumes
+	F64 build_all(const shape_list_t& shapes, std::vector<LLPointer<LLVolume> >& volumes)
+	{
+		const F32 details[] = { 1.f, 1.5f, 2.5f, 4.f };
+
+		volumes.clear();
+		LLTimer timer;
+		for (shape_list_t::const_iterator iter = shapes.begin(); iter != shapes.end(); ++iter)
+		{
+			for (U32 d = 0; d < LL_ARRAY_SIZE(details); ++d)
+			{
+				volumes.push_back(new LLVolume(*iter, details[d]));
+			}
+		}
+		return timer.getElapsedTimeF64() * 1000.0;
+	}
+
+	bool same_geometry(const LLVolume& a, const LLVolume& b)
+	{
+		if (a.getNumVolumeFaces() != b.getNumVolumeFaces())
+		{
+			return false;
+		}
+
+		for (S32 i = 0; i < a.getNumVolumeFaces(); ++i)
+		{
+			const LLVolumeFace& fa = a.getVolumeFace(i);
+			const LLVolumeFace& fb = b.getVolumeFace(i);
+			if (fa.mNumVertices != fb.mNumVertices || fa.mNumIndices != fb.mNumIndices ||
+				memcmp(fa.mPositions, fb.mPositions, fa.mNumVertices * sizeof(LLVector4a)) ||
+				memcmp(fa.mNormals, fb.mNormals, fa.mNumVertices * sizeof(LLVector4a)) ||
+				memcmp(fa.mTexCoords, fb.mTexCoords, fa.mNumVertices * sizeof(LLVector2)) ||
+				memcmp(fa.mIndices, fb.mIndices, fa.mNumIndices * sizeof(U16)))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+namespace tut
+{
+	struct volumegen_test
+	{
+	};
+	typedef test_group<volumegen_test> volumegen_group_t;
+	typedef volumegen_group_t::object volumegen_object_t;
+	tut::volumegen_group_t volumegen_instance("volume_generation");
+
+	template<> template<>
+	void volumegen_object_t::test<1>()
+	{
+		shape_list_t shapes;
+		load_shapes(shapes);
+		ensure("have shapes", !shapes.empty());
+
+		LLVolume::cleanupClass();
+		U32 profile_misses = LLProfile::sCacheMisses;
+		U32 path_misses = LLPath::sCacheMisses;
+
+		std::vector<LLPointer<LLVolume> > cold;
+		F64 cold_time = build_all(shapes, cold);
+		profile_misses = LLProfile::sCacheMisses - profile_misses;
+		path_misses = LLPath::sCacheMisses - path_misses;
+
+		std::vector<LLPointer<LLVolume> > warm;
+		F64 warm_time = build_all(shapes, warm);
+
+		LLJobSystem jobs("Volume Test", 2);
+		gJobSystem = &jobs;
+		LLVolume::setFaceThreadCount(2);
+		std::vector<LLPointer<LLVolume> > threaded;
+		F64 threaded_time = build_all(shapes, threaded);
+		LLVolume::setFaceThreadCount(0);
+		gJobSystem = NULL;
+
+		for (size_t i = 0; i < cold.size(); ++i)
+		{
+			ensure("cached profile and path give the same geometry", same_geometry(*cold[i], *warm[i]));
+			ensure("threaded faces give the same geometry", same_geometry(*cold[i], *threaded[i]));
+		}
+
+		LL_INFOS() << "Volume generation: " << shapes.size() << " shapes, " << cold.size() << " volumes, "
+				   << profile_misses << " distinct profiles, " << path_misses << " distinct paths" << LL_ENDL;
+		LL_INFOS() << "Volume generation: cold " << cold_time << " ms, cached " << warm_time
+				   << " ms, cached with 2 face threads " << threaded_time << " ms" << LL_ENDL;
+
+		LLVolume::cleanupClass();
+	}
+}
@@ -350,6 +350,10 @@ void initCurl(void)
 	{
 	  LL_ERRS() << "This libcurl has no SSL support!" << LL_ENDL;
 	}
+	if (!(version_info->features & CURL_VERSION_HTTP2))				// HTTP/2 support (added in libcurl 7.33.0).
+	{
+	  LL_INFOS() << "libcurl was not compiled with HTTP/2 support; every request will use a connection of its own." << LL_ENDL;
+	}
 
 	LL_INFOS() << "Successful initialization of libcurl " <<
 		version_info->version << " (0x" << std::hex << version_info->version_num << std::dec << "), (" <<
@@ -1125,6 +1129,11 @@ void CurlEasyRequest::applyDefaultOptions(void)
   setopt(CURLOPT_SSL_SESSIONID_CACHE, 0);
   // Call the progress callback funtion.
   setopt(CURLOPT_NOPROGRESS, 0);
+#if AICURL_HTTP2
+  // Offer HTTP/2 to https services, so that the requests to one service can share a connection.
+  // Otherwise stick to HTTP/1.1 (the default of libcurl 7.62.0 and up is to offer HTTP/2 too).
+  setopt(CURLOPT_HTTP_VERSION, (long)(CurlHTTP2Multiplexing ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_1_1));
+#endif
   // Set the CURL options for either SOCKS or HTTP proxy.
   applyProxySettings();
   // Cause libcurl to print all it's I/O traffic on the debug channel.
@@ -1198,6 +1207,28 @@ void CurlEasyRequest::set_timeout_opts(void)
   setopt(CURLOPT_TIMEOUT, mTimeoutPolicy->getCurlTransaction());
 }
 
+void CurlEasyRequest::set_multiplexed(bool multiplexed)
+{
+  mMultiplexed = multiplexed;
+#if AICURL_HTTP2
+  if (CurlHTTP2Multiplexing)
+  {
+	// Wait for the connection of a multiplexed service to become available rather than opening a new one.
+	setopt(CURLOPT_PIPEWAIT, multiplexed ? 1 : 0);
+  }
+#endif
+}
+
+bool CurlEasyRequest::used_http2(void) const
+{
+#if AICURL_HTTP2
+  long http_version;
+  return getinfo(CURLINFO_HTTP_VERSION, &http_version) == CURLE_OK && http_version == CURL_HTTP_VERSION_2_0;
+#else
+  return false;
+#endif
+}
+
 void CurlEasyRequest::create_timeout_object(void)
 {
   ThreadSafeBufferedCurlEasyRequest* lockobj = NULL;
@@ -49,6 +49,9 @@
 #undef CURLOPT_DNS_USE_GLOBAL_CACHE
 #define CURLOPT_DNS_USE_GLOBAL_CACHE do_not_use_CURLOPT_DNS_USE_GLOBAL_CACHE
 
+// HTTP/2 multiplexing needs CURL_HTTP_VERSION_2TLS, CURLOPT_PIPEWAIT and CURLINFO_HTTP_VERSION (libcurl 7.50.0).
+#define AICURL_HTTP2 (LIBCURL_VERSION_NUM >= 0x073200)
+
 #include "stdtypes.h"		// U16, S32, U32, F64
 #include "llatomic.h"		// LLAtomicU32
 #include "aithreadsafe.h"
@@ -157,6 +160,7 @@ struct Stats {
 // Called to handle changes in Debug Settings.
 bool handleCurlMaxTotalConcurrentConnections(LLSD const& newvalue);
 bool handleCurlConcurrentConnectionsPerService(LLSD const& newvalue);
+bool handleCurlConcurrentStreamsPerService(LLSD const& newvalue);
 bool handleNoVerifySSLCert(LLSD const& newvalue);
 
 // Called once at start of application (from newview/llappviewer.cpp by main thread (before threads are created)),
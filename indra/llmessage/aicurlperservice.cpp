@@ -34,6 +34,10 @@
  *   09/04/2013
  *   Renamed everything "host" to "service" and use "hostname:port" as key
  *   instead of just "hostname".
+ *
+ *   18/10/2026
+ *   Services that answer over HTTP/2 get their requests multiplexed on one
+ *   connection, limited by the number of concurrent streams.
  */
 
 #include "sys.h"
@@ -50,6 +54,10 @@ namespace AICurlPrivate {
 
 // Cached value of CurlConcurrentConnectionsPerService.
 U16 CurlConcurrentConnectionsPerService;
+// Cached value of CurlConcurrentStreamsPerService.
+U16 CurlConcurrentStreamsPerService;
+// Cached value of CurlHTTP2Multiplexing, false if libcurl has no HTTP/2 support.
+bool CurlHTTP2Multiplexing;
 
 // Friend functions of RefCountedThreadSafePerService
 
@@ -77,6 +85,7 @@ AIPerService::AIPerService(void) :
 		mTotalAdded(0),
 		mEventPolls(0),
 		mEstablishedConnections(0),
+		mMultiplexed(false),
 		mUsedCT(0),
 		mCTInUse(0)
 {
@@ -330,6 +339,37 @@ void AIPerService::redivide_connections(void)
   }
 }
 
+// Switch between the connection and stream limits. A request that is added
+// while the service isn't known to be multiplexed yet opens a connection of
+// its own; once one finished over HTTP/2 the following requests wait for and
+// share that connection (see CURLOPT_PIPEWAIT), so that a CDN no longer needs a
+// dozen TLS handshakes to be used at full speed.
+bool AIPerService::set_multiplexed(bool multiplexed)
+{
+  if (multiplexed == mMultiplexed)
+  {
+	return false;
+  }
+  mMultiplexed = multiplexed;
+  set_concurrent_connections(multiplexed ? CurlConcurrentStreamsPerService : CurlConcurrentConnectionsPerService);
+  return true;
+}
+
+// Set the maximum number of connections (or streams) and scale that of every capability type along.
+void AIPerService::set_concurrent_connections(int new_concurrent_connections)
+{
+  int old_concurrent_connections = mConcurrentConnections;
+  int increment = new_concurrent_connections - old_concurrent_connections;
+  mConcurrentConnections = new_concurrent_connections;
+  for (int i = 0; i < number_of_capability_types; ++i)
+  {
+	mCapabilityType[i].mMaxPipelinedRequests = llmax(mCapabilityType[i].mMaxPipelinedRequests + increment, 0);
+	int new_concurrent_connections_per_capability_type =
+		llclamp((new_concurrent_connections * mCapabilityType[i].mConcurrentConnections + old_concurrent_connections / 2) / old_concurrent_connections, 1, new_concurrent_connections);
+	mCapabilityType[i].mConcurrentConnections = (U16)new_concurrent_connections_per_capability_type;
+  }
+}
+
 bool AIPerService::throttled(AICapabilityType capability_type) const
 {
   return mTotalAdded >= mConcurrentConnections ||
@@ -479,9 +519,10 @@ void AIPerService::add_queued_to(curlthread::MultiHandle* multi_handle, bool onl
 	{
 	  continue;
 	}
-	if (multi_handle->added_maximum())
+	if (!mMultiplexed && multi_handle->added_maximum())
 	{
 	  // We hit the maximum number of global connections. Abort every attempt to add anything.
+	  // Streams on the connection of a multiplexed service don't count towards that maximum.
 	  only_this_service = true;
 	  break;
 	}
@@ -624,16 +665,23 @@ void AIPerService::adjust_concurrent_connections(int increment)
   for (AIPerService::iterator iter = instance_map_w->begin(); iter != instance_map_w->end(); ++iter)
   {
 	PerService_wat per_service_w(*iter->second);
-	U16 old_concurrent_connections = per_service_w->mConcurrentConnections;
-	int new_concurrent_connections = llclamp(old_concurrent_connections + increment, 1, (int)CurlConcurrentConnectionsPerService);
-	per_service_w->mConcurrentConnections = (U16)new_concurrent_connections;
-	increment = per_service_w->mConcurrentConnections - old_concurrent_connections;
-	for (int i = 0; i < number_of_capability_types; ++i)
+	if (!per_service_w->mMultiplexed)
+	{
+	  per_service_w->set_concurrent_connections(llclamp(per_service_w->mConcurrentConnections + increment, 1, (int)CurlConcurrentConnectionsPerService));
+	}
+  }
+}
+
+//static
+void AIPerService::adjust_concurrent_streams(int increment)
+{
+  instance_map_wat instance_map_w(sInstanceMap);
+  for (AIPerService::iterator iter = instance_map_w->begin(); iter != instance_map_w->end(); ++iter)
+  {
+	PerService_wat per_service_w(*iter->second);
+	if (per_service_w->mMultiplexed)
 	{
-	  per_service_w->mCapabilityType[i].mMaxPipelinedRequests = llmax(per_service_w->mCapabilityType[i].mMaxPipelinedRequests + increment, 0);
-	  int new_concurrent_connections_per_capability_type =
-		  llclamp((new_concurrent_connections * per_service_w->mCapabilityType[i].mConcurrentConnections + old_concurrent_connections / 2) / old_concurrent_connections, 1, new_concurrent_connections);
-	  per_service_w->mCapabilityType[i].mConcurrentConnections = (U16)new_concurrent_connections_per_capability_type;
+	  per_service_w->set_concurrent_connections(llclamp(per_service_w->mConcurrentConnections + increment, 1, (int)CurlConcurrentStreamsPerService));
 	}
   }
 }
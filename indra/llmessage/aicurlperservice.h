@@ -34,6 +34,10 @@
  *   09/04/2013
  *   Renamed everything "host" to "service" and use "hostname:port" as key
  *   instead of just "hostname".
+ *
+ *   18/10/2026
+ *   Services that answer over HTTP/2 get their requests multiplexed on one
+ *   connection, limited by the number of concurrent streams.
  */
 
 #ifndef AICURLPERSERVICE_H
@@ -167,11 +171,12 @@ class AIPerService {
 	CapabilityType mCapabilityType[number_of_capability_types];
 
 	AIAverage mHTTPBandwidth;					// Keeps track on number of bytes received for this service in the past second.
-	int mConcurrentConnections;					// The maximum number of allowed concurrent connections to this service.
+	int mConcurrentConnections;					// The maximum number of allowed concurrent connections to this service, or of streams when mMultiplexed.
 	int mApprovedRequests;						// The number of approved requests for this service by approveHTTPRequestFor that were not added to the command queue yet.
 	int mTotalAdded;							// Number of active easy handles with this service.
 	int mEventPolls;							// Number of active event poll handles with this service.
 	int mEstablishedConnections;				// Number of connected sockets to this service.
+	bool mMultiplexed;							// Set when the last successful request to this service used HTTP/2, so that all requests share one connection.
 
 	U32 mUsedCT;								// Bit mask with one bit per capability type. A '1' means the capability was in use since the last resetUsedCT().
 	U32 mCTInUse;								// Bit mask with one bit per capability type. A '1' means the capability is in use right now.
@@ -180,6 +185,7 @@ class AIPerService {
 	struct ResetUsed { void operator()(instance_map_type::value_type const& service) const; };
 
 	void redivide_connections(void);
+	void set_concurrent_connections(int concurrent_connections);
 	void mark_inuse(AICapabilityType capability_type)
 	{
 	  U32 bit = CT2mask(capability_type);
@@ -274,6 +280,8 @@ class AIPerService {
 	void removed_from_multi_handle(AICapabilityType capability_type, bool event_poll,
 								   bool downloaded_something, bool success);			// Called when an easy handle for this service is removed again from the multi handle.
 	void download_started(AICapabilityType capability_type) { ++mCapabilityType[capability_type].mDownloading; }
+	bool set_multiplexed(bool multiplexed);						// Called when a request for this service finished successfully, with whether it used HTTP/2. Returns true if that changed.
+	bool is_multiplexed(void) const { return mMultiplexed; }	// Returns true if requests for this service are streams on a shared connection.
 	bool throttled(AICapabilityType capability_type) const;		// Returns true if the maximum number of allowed requests for this service/capability type have been added to the multi handle.
 	bool nothing_added(AICapabilityType capability_type) const { return mCapabilityType[capability_type].mAdded == 0; }
 
@@ -296,6 +304,8 @@ class AIPerService {
 
 	// Called when CurlConcurrentConnectionsPerService changes.
 	static void adjust_concurrent_connections(int increment);
+	// Called when CurlConcurrentStreamsPerService changes.
+	static void adjust_concurrent_streams(int increment);
 
 	// A helper class to decrement mApprovedRequests after requests approved by approveHTTPRequestFor were handled.
 	class Approvement : public LLThreadSafeRefCount {
@@ -343,6 +353,8 @@ class RefCountedThreadSafePerService : public threadsafe_PerService {
 };
 
 extern U16 CurlConcurrentConnectionsPerService;
+extern U16 CurlConcurrentStreamsPerService;
+extern bool CurlHTTP2Multiplexing;
 
 } // namespace AICurlPrivate
 
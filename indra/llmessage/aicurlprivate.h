@@ -284,6 +284,12 @@ class CurlEasyRequest : public CurlEasyHandle {
 
 	// Last second initialization. Called from MultiHandle::add_easy_request.
 	void set_timeout_opts(void);
+	// Idem. Whether the request is a stream on the shared connection of its (HTTP/2) service.
+	void set_multiplexed(bool multiplexed);
+	bool is_multiplexed(void) const { return mMultiplexed; }
+
+	// Returns true if the finished request was answered over HTTP/2.
+	bool used_http2(void) const;
 
   public:
 	// Called by MultiHandle::finish_easy_request() to store result code that is returned by getResult.
@@ -321,6 +327,7 @@ class CurlEasyRequest : public CurlEasyHandle {
 	LLPointer<curlthread::HTTPTimeout> mTimeout;// Timeout administration object associated with last created CurlSocketInfo.
 	bool mTimeoutIsOrphan;						// Set to true when mTimeout is not (yet) associated with a CurlSocketInfo.
 	bool mIsHttps;								// Set if the url starts with "https:".
+	bool mMultiplexed;							// Set if the request was added as a stream of a multiplexed service.
 #ifdef CWDEBUG
   public:
 	bool mDebugIsHeadOrGetMethod;
@@ -342,7 +349,7 @@ class CurlEasyRequest : public CurlEasyHandle {
   protected:
 	// This class may only be created as base class of BufferedCurlEasyRequest.
 	// Throws AICurlNoEasyHandle.
-	CurlEasyRequest(void) : mHeaders(NULL), mHandleEventsTarget(NULL), mContentLength(0), mResult(CURLE_FAILED_INIT), mTimeoutPolicy(NULL), mTimeoutIsOrphan(false)
+	CurlEasyRequest(void) : mHeaders(NULL), mHandleEventsTarget(NULL), mContentLength(0), mResult(CURLE_FAILED_INIT), mTimeoutPolicy(NULL), mTimeoutIsOrphan(false), mMultiplexed(false)
 #ifdef CWDEBUG
 		, mDebugIsHeadOrGetMethod(false)
 #endif
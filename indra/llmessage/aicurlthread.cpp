@@ -1631,6 +1631,7 @@ void AICurlThread::run(void)
 // MultiHandle
 
 LLAtomicU32 MultiHandle::sTotalAdded;
+LLAtomicU32 MultiHandle::sTotalMultiplexed;
 
 MultiHandle::MultiHandle(void) : mTimeout(-1), mReadPollSet(NULL), mWritePollSet(NULL)
 {
@@ -1640,6 +1641,13 @@ MultiHandle::MultiHandle(void) : mTimeout(-1), mReadPollSet(NULL), mWritePollSet
   check_multi_code(curl_multi_setopt(mMultiHandle, CURLMOPT_SOCKETDATA, this));
   check_multi_code(curl_multi_setopt(mMultiHandle, CURLMOPT_TIMERFUNCTION, &MultiHandle::timer_callback));
   check_multi_code(curl_multi_setopt(mMultiHandle, CURLMOPT_TIMERDATA, this));
+#if AICURL_HTTP2
+  if (CurlHTTP2Multiplexing)
+  {
+	// Run the requests to a service that speaks HTTP/2 as streams on one connection.
+	check_multi_code(curl_multi_setopt(mMultiHandle, CURLMOPT_PIPELINING, (long)CURLPIPE_MULTIPLEX));
+  }
+#endif
 }
 
 MultiHandle::~MultiHandle()
@@ -1749,6 +1757,7 @@ U32 curl_max_total_concurrent_connections = 32;						// Initialized on start up
 bool MultiHandle::add_easy_request(AICurlEasyRequest const& easy_request, bool from_queue)
 {
   bool throttled = true;		// Default.
+  bool multiplexed = false;
   AICapabilityType capability_type;
   bool event_poll;
   AIPerServicePtr per_service;
@@ -1782,9 +1791,12 @@ bool MultiHandle::add_easy_request(AICurlEasyRequest const& easy_request, bool f
 	}
 	bool too_much_bandwidth = !curl_easy_request_w->approved() && AIPerService::checkBandwidthUsage(per_service, get_clock_count() * HTTPTimeout::sClockWidth_40ms);
 	PerService_wat per_service_w(*per_service);
-	if (!too_much_bandwidth && sTotalAdded < curl_max_total_concurrent_connections && !per_service_w->throttled(capability_type))
+	// Streams of a multiplexed service are only limited by the number of streams for that service.
+	multiplexed = per_service_w->is_multiplexed();
+	if (!too_much_bandwidth && (multiplexed || !added_maximum()) && !per_service_w->throttled(capability_type))
 	{
 	  curl_easy_request_w->set_timeout_opts();
+	  curl_easy_request_w->set_multiplexed(multiplexed);
 	  if (curl_easy_request_w->add_handle_to_multi(curl_easy_request_w, mMultiHandle) == CURLM_OK)
 	  {
 		per_service_w->added_to_multi_handle(capability_type, event_poll);	// (About to be) added to mAddedEasyRequests.
@@ -1800,6 +1812,10 @@ bool MultiHandle::add_easy_request(AICurlEasyRequest const& easy_request, bool f
 		mAddedEasyRequests.insert(easy_request);
 	llassert(res.second);						// May not have been added before.
 	sTotalAdded++;
+	if (multiplexed)
+	{
+	  sTotalMultiplexed++;
+	}
 	llassert(sTotalAdded == mAddedEasyRequests.size());
 	Dout(dc::curl, "MultiHandle::add_easy_request: Added AICurlEasyRequest " << (void*)easy_request.get_ptr().get() <<
 		"; now processing " << mAddedEasyRequests.size() << " easy handles [running_handles = " << AICurlInterface::Stats::running_handles << "].");
@@ -1847,16 +1863,26 @@ CURLMcode MultiHandle::remove_easy_request(addedEasyRequests_type::iterator cons
   CURLMcode res;
   AICapabilityType capability_type;
   bool event_poll;
+  bool multiplexed;
   AIPerServicePtr per_service;
   {
 	AICurlEasyRequest_wat curl_easy_request_w(**iter);
 	bool downloaded_something = curl_easy_request_w->received_data();
 	bool success = curl_easy_request_w->success();
+	bool http2 = success && CurlHTTP2Multiplexing && curl_easy_request_w->used_http2();
 	res = curl_easy_request_w->remove_handle_from_multi(curl_easy_request_w, mMultiHandle);
 	capability_type = curl_easy_request_w->capability_type();
 	event_poll = curl_easy_request_w->is_event_poll();
+	multiplexed = curl_easy_request_w->is_multiplexed();
 	per_service = curl_easy_request_w->getPerServicePtr();
-	PerService_wat(*per_service)->removed_from_multi_handle(capability_type, event_poll, downloaded_something, success);		// (About to be) removed from mAddedEasyRequests.
+	PerService_wat per_service_w(*per_service);
+	per_service_w->removed_from_multi_handle(capability_type, event_poll, downloaded_something, success);		// (About to be) removed from mAddedEasyRequests.
+	// Switch the service to or from multiplexing when it turns out to (no longer) speak HTTP/2.
+	if (success && CurlHTTP2Multiplexing && per_service_w->set_multiplexed(http2))
+	{
+	  LL_INFOS() << "Service \"" << curl_easy_request_w->getLowercaseServicename() << "\" " <<
+		  (http2 ? "uses HTTP/2, multiplexing its requests." : "no longer uses HTTP/2.") << LL_ENDL;
+	}
 #ifdef SHOW_ASSERT
 	curl_easy_request_w->mRemovedPerCommand = as_per_command;
 #endif
@@ -1865,6 +1891,11 @@ CURLMcode MultiHandle::remove_easy_request(addedEasyRequests_type::iterator cons
   ThreadSafeBufferedCurlEasyRequest* lockobj = iter->get_ptr().get();
 #endif
   mAddedEasyRequests.erase(iter);
+  // Decrement sTotalMultiplexed first so that it never exceeds sTotalAdded.
+  if (multiplexed)
+  {
+	--sTotalMultiplexed;
+  }
   --sTotalAdded;
   llassert(sTotalAdded == mAddedEasyRequests.size());
 #if CWDEBUG
@@ -2672,6 +2703,10 @@ void startCurlThread(LLControlGroup* control_group)
   sConfigGroup = control_group;
   curl_max_total_concurrent_connections = sConfigGroup->getU32("CurlMaxTotalConcurrentConnections");
   CurlConcurrentConnectionsPerService = (U16)sConfigGroup->getU32("CurlConcurrentConnectionsPerService");
+  CurlConcurrentStreamsPerService = (U16)llclamp(sConfigGroup->getU32("CurlConcurrentStreamsPerService"), 1U, 100U);
+#if AICURL_HTTP2
+  CurlHTTP2Multiplexing = sConfigGroup->getBOOL("CurlHTTP2Multiplexing") && (curl_version_info(CURLVERSION_NOW)->features & CURL_VERSION_HTTP2);
+#endif
   gNoVerifySSLCert = sConfigGroup->getBOOL("NoVerifySSLCert");
   AIPerService::setMaxPipelinedRequests(curl_max_total_concurrent_connections);
   AIPerService::setHTTPThrottleBandwidth(sConfigGroup->getF32("HTTPThrottleBandwidth"));
@@ -2712,6 +2747,27 @@ bool handleCurlConcurrentConnectionsPerService(LLSD const& newvalue)
   return true;
 }
 
+bool handleCurlConcurrentStreamsPerService(LLSD const& newvalue)
+{
+  using namespace AICurlPrivate;
+
+  U16 new_concurrent_streams = (U16)newvalue.asInteger();
+  // libcurl doesn't open more than 100 streams per connection by default.
+  U16 const maxCurlConcurrentStreamsPerService = 100;
+  if (new_concurrent_streams < 1 || new_concurrent_streams > maxCurlConcurrentStreamsPerService)
+  {
+	sConfigGroup->setU32("CurlConcurrentStreamsPerService", static_cast<U32>((new_concurrent_streams < 1) ? 1 : maxCurlConcurrentStreamsPerService));
+  }
+  else
+  {
+	int increment = new_concurrent_streams - CurlConcurrentStreamsPerService;
+	CurlConcurrentStreamsPerService = new_concurrent_streams;
+	AIPerService::adjust_concurrent_streams(increment);
+	LL_INFOS() << "CurlConcurrentStreamsPerService set to " << CurlConcurrentStreamsPerService << LL_ENDL;
+  }
+  return true;
+}
+
 bool handleNoVerifySSLCert(LLSD const& newvalue)
 {
   gNoVerifySSLCert = newvalue.asBoolean();
@@ -2831,8 +2887,10 @@ AIPerService::Approvement* AIPerService::approveHTTPRequestFor(AIPerServicePtr c
   U64 const sTime_40ms = get_clock_count() * HTTPTimeout::sClockWidth_40ms;							// Time in 40ms units.
 
   // Cache all sTotalQueued info.
+  // Streams on the connection of a multiplexed service are limited per service and not counted here,
+  // just like they don't count towards the global maximum number of connections.
   bool starvation, decrement_threshold;
-  S32 total_approved_queuedapproved_or_added = MultiHandle::total_added_size();
+  S32 total_approved_queuedapproved_or_added = MultiHandle::total_added_size() - MultiHandle::total_multiplexed_size();
   {
 	TotalQueued_wat total_queued_w(sTotalQueued);
 	total_approved_queuedapproved_or_added += total_queued_w->approved;
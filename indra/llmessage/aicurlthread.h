@@ -78,6 +78,7 @@ class MultiHandle : public CurlMultiHandle
 	addedEasyRequests_type mAddedEasyRequests;	// All easy requests currently added to the multi handle.
 	long mTimeout;								// The last timeout in ms as set by the callback CURLMOPT_TIMERFUNCTION.
 	static LLAtomicU32 sTotalAdded;				// The (sum of the) size of mAddedEasyRequests (of every MultiHandle, but there is only one).
+	static LLAtomicU32 sTotalMultiplexed;		// The number of those that are streams on the shared connection of a multiplexed service.
 
   private:
 	// Store result and trigger events for easy request.
@@ -105,8 +106,11 @@ class MultiHandle : public CurlMultiHandle
 	// Return the total number of added curl requests.
 	static U32 total_added_size(void) { return sTotalAdded; }
 
+	// Return the number of added curl requests that are streams of a multiplexed service.
+	static U32 total_multiplexed_size(void) { return sTotalMultiplexed; }
+
 	// Return true if we reached the global maximum number of connections.
-	static bool added_maximum(void) { return sTotalAdded >= curl_max_total_concurrent_connections; }
+	static bool added_maximum(void) { return sTotalAdded - sTotalMultiplexed >= curl_max_total_concurrent_connections; }
 
   public:
 	//-----------------------------------------------------------------------------
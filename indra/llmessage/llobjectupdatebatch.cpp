@@ -0,0 +1,230 @@
+/**
+ * @file llobjectupdatebatch.cpp
+ * @brief Column oriented decoding of ImprovedTerseObjectUpdate messages.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+
+#include "llobjectupdatebatch.h"
+
+#include "llquantize.h"
+#include "llsd.h"
+#include "message.h"
+
+LLObjectUpdateBatch::LLObjectUpdateBatch() :
+	mRegionHandle(0),
+	mTimeDilation(1.f)
+{
+}
+
+void LLObjectUpdateBatch::clear()
+{
+	mRegionHandle = 0;
+	mTimeDilation = 1.f;
+
+	// clear() keeps the capacity, so a steady stream of messages doesn't
+	// allocate
+	mValid.clear();
+	mLocalIDs.clear();
+	mStates.clear();
+	mPositions.clear();
+	mVelocities.clear();
+	mAccelerations.clear();
+	mRotations.clear();
+	mAngularVelocities.clear();
+	mRaw.clear();
+	mRawSizes.clear();
+	for (S32 q = 0; q < Q_COUNT; ++q)
+	{
+		mQuantized[q].clear();
+	}
+	mFootPlaneIndex.clear();
+	mFootPlanes.clear();
+}
+
+void LLObjectUpdateBatch::addBlock(const U8* data, S32 size)
+{
+	size_t offset = mRaw.size();
+	mRaw.resize(offset + TERSE_AVATAR_SIZE);
+	if (size > 0 && size <= TERSE_AVATAR_SIZE)
+	{
+		memcpy(&mRaw[offset], data, size);
+	}
+	else
+	{
+		size = 0;
+	}
+	mRawSizes.push_back((U8)size);
+}
+
+void LLObjectUpdateBatch::decodeMessage(LLMessageSystem* msg)
+{
+	clear();
+
+	U16 time_dilation16;
+	msg->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, mRegionHandle);
+	msg->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
+	mTimeDilation = ((F32) time_dilation16) / 65535.f;
+
+	S32 count = msg->getNumberOfBlocksFast(_PREHASH_ObjectData);
+	mRaw.resize(count * TERSE_AVATAR_SIZE);
+	mRawSizes.resize(count);
+	for (S32 i = 0; i < count; ++i)
+	{
+		S32 size = msg->getSizeFast(_PREHASH_ObjectData, i, _PREHASH_Data);
+		if (size > 0 && size <= TERSE_AVATAR_SIZE)
+		{
+			msg->getBinaryDataFast(_PREHASH_ObjectData, _PREHASH_Data, &mRaw[i * TERSE_AVATAR_SIZE], 0, i, TERSE_AVATAR_SIZE);
+		}
+		else
+		{
+			size = 0;
+		}
+		mRawSizes[i] = (U8)size;
+	}
+
+	decode();
+}
+
+void LLObjectUpdateBatch::decode()
+{
+	const S32 count = (S32)mRawSizes.size();
+
+	mValid.resize(count);
+	mLocalIDs.resize(count);
+	mStates.resize(count);
+	mPositions.resize(count);
+	mVelocities.resize(count);
+	mAccelerations.resize(count);
+	mRotations.resize(count);
+	mAngularVelocities.resize(count);
+	mFootPlaneIndex.resize(count);
+	for (S32 q = 0; q < Q_COUNT; ++q)
+	{
+		mQuantized[q].resize(count);
+	}
+	mFootPlanes.clear();
+
+	if (!count)
+	{
+		return;
+	}
+
+	// Split the rows into columns.  Everything after the optional foot plane
+	// is at a fixed offset from it.
+	for (S32 i = 0; i < count; ++i)
+	{
+		const U8* data = &mRaw[i * TERSE_AVATAR_SIZE];
+		const U8 is_avatar = data[5];
+		const S32 expected = is_avatar ? TERSE_AVATAR_SIZE : TERSE_SIZE;
+
+		mFootPlaneIndex[i] = -1;
+		mValid[i] = mRawSizes[i] == expected;
+		if (!mValid[i])
+		{
+			mLocalIDs[i] = 0;
+			continue;
+		}
+
+		htonmemcpy(&mLocalIDs[i], data, MVT_U32, 4);
+		mStates[i] = data[4];
+		data += 6;
+
+		if (is_avatar)
+		{
+			mFootPlaneIndex[i] = (S32)mFootPlanes.size();
+			mFootPlanes.push_back(LLVector4());
+			htonmemcpy(mFootPlanes.back().mV, data, MVT_LLVector4, 16);
+			data += 16;
+		}
+
+		htonmemcpy(mPositions[i].mV, data, MVT_LLVector3, 12);
+		data += 12;
+
+		U16 val[Q_COUNT];
+		htonmemcpy(val, data, MVT_U16Vec3, 6);
+		htonmemcpy(val + Q_ACC, data + 6, MVT_U16Vec3, 6);
+		htonmemcpy(val + Q_ROT, data + 12, MVT_U16Quat, 8);
+		htonmemcpy(val + Q_ANGV, data + 20, MVT_U16Vec3, 6);
+		for (S32 q = 0; q < Q_COUNT; ++q)
+		{
+			mQuantized[q][i] = val[q];
+		}
+	}
+
+	// Dequantize one component at a time, with the ranges the simulator
+	// packs the terse update with.
+	for (S32 c = 0; c < 3; ++c)
+	{
+		const U16* vel = &mQuantized[Q_VEL + c][0];
+		const U16* acc = &mQuantized[Q_ACC + c][0];
+		const U16* angv = &mQuantized[Q_ANGV + c][0];
+		for (S32 i = 0; i < count; ++i)
+		{
+			mVelocities[i].mV[c] = U16_to_F32(vel[i], -128.f, 128.f);
+		}
+		for (S32 i = 0; i < count; ++i)
+		{
+			mAccelerations[i].mV[c] = U16_to_F32(acc[i], -64.f, 64.f);
+		}
+		for (S32 i = 0; i < count; ++i)
+		{
+			mAngularVelocities[i].mV[c] = U16_to_F32(angv[i], -64.f, 64.f);
+		}
+	}
+
+	for (S32 c = 0; c < 4; ++c)
+	{
+		const U16* rot = &mQuantized[Q_ROT + c][0];
+		for (S32 i = 0; i < count; ++i)
+		{
+			mRotations[i].mQ[c] = U16_to_F32(rot[i], -1.f, 1.f);
+		}
+	}
+}
+
+const LLVector4* LLObjectUpdateBatch::getFootPlane(S32 row) const
+{
+	S32 index = mFootPlaneIndex[row];
+	return index < 0 ? NULL : &mFootPlanes[index];
+}
+
+void LLObjectUpdateBatch::appendLLSD(LLSD& sd) const
+{
+	for (size_t i = 0; i < mRawSizes.size(); ++i)
+	{
+		const U8* data = &mRaw[i * TERSE_AVATAR_SIZE];
+		sd.append(LLSD::Binary(data, data + mRawSizes[i]));
+	}
+}
+
+void LLObjectUpdateBatch::fromLLSD(const LLSD& sd)
+{
+	clear();
+	for (LLSD::array_const_iterator iter = sd.beginArray(); iter != sd.endArray(); ++iter)
+	{
+		const LLSD::Binary& data = iter->asBinary();
+		addBlock(data.empty() ? NULL : &data[0], (S32)data.size());
+	}
+}
@@ -0,0 +1,121 @@
+/**
+ * @file llobjectupdatebatch.h
+ * @brief Column oriented decoding of ImprovedTerseObjectUpdate messages.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLOBJECTUPDATEBATCH_H
+#define LL_LLOBJECTUPDATEBATCH_H
+
+#include "llmath.h"
+#include "llquaternion.h"
+#include "v3math.h"
+#include "v4math.h"
+
+#include <vector>
+
+class LLMessageSystem;
+class LLSD;
+
+// Decodes every ObjectData block of an ImprovedTerseObjectUpdate at once.
+//
+// The Data blob of each block is copied into a fixed size row of a staging
+// array, then each field is pulled out of all rows by its own loop, so the
+// dequantization of velocities, accelerations, rotations and angular
+// velocities runs as straight loops over flat arrays instead of one data
+// packer call per value per object.
+//
+// The avatar foot plane, which only avatars carry, is kept aside by row, and
+// the TextureEntry field is left in the message for the object to read when
+// the update is applied.
+//
+// The columns are only valid until the next clear() or decode.
+class LLObjectUpdateBatch
+{
+public:
+	enum
+	{
+		TERSE_SIZE = 44,				// LocalID, State, IsAvatar, Pos, Vel, Acc, Rot, AngVel
+		TERSE_AVATAR_SIZE = 44 + 16,	// with the avatar's collision plane after IsAvatar
+	};
+
+	LLObjectUpdateBatch();
+
+	void clear();
+
+	// Appends the Data blob of one block.  Blocks of the wrong size are kept
+	// as invalid rows so that row numbers stay block numbers.
+	void addBlock(const U8* data, S32 size);
+
+	// Dequantizes the rows added since the last clear().
+	void decode();
+
+	// Clears the batch, reads the RegionData and every ObjectData block of
+	// the message currently being processed and decodes them.
+	void decodeMessage(LLMessageSystem* msg);
+
+	S32 getCount() const						{ return (S32)mLocalIDs.size(); }
+
+	// Foot plane of an avatar row, or NULL.
+	const LLVector4* getFootPlane(S32 row) const;
+
+	// Replay support: every row's raw blob as an LLSD array of binaries, and
+	// the reverse (which does not decode).
+	void appendLLSD(LLSD& sd) const;
+	void fromLLSD(const LLSD& sd);
+
+public:
+	U64		mRegionHandle;
+	F32		mTimeDilation;
+
+	std::vector<U8>				mValid;
+	std::vector<U32>			mLocalIDs;
+	std::vector<U8>				mStates;
+	std::vector<LLVector3>		mPositions;
+	std::vector<LLVector3>		mVelocities;
+	std::vector<LLVector3>		mAccelerations;
+	std::vector<LLQuaternion>	mRotations;
+	std::vector<LLVector3>		mAngularVelocities;
+
+private:
+	enum
+	{
+		Q_VEL,		// three components each, rotation has four
+		Q_ACC = Q_VEL + 3,
+		Q_ROT = Q_ACC + 3,
+		Q_ANGV = Q_ROT + 4,
+		Q_COUNT = Q_ANGV + 3
+	};
+
+	// Raw blobs, TERSE_AVATAR_SIZE bytes per row, and their sizes
+	std::vector<U8>		mRaw;
+	std::vector<U8>		mRawSizes;
+
+	// Quantized fields, one array per component
+	std::vector<U16>	mQuantized[Q_COUNT];
+
+	std::vector<S32>		mFootPlaneIndex;	// into mFootPlanes, or -1
+	std::vector<LLVector4>	mFootPlanes;
+};
+
+#endif // LL_LLOBJECTUPDATEBATCH_H
@@ -0,0 +1,201 @@
+/**
+ * @file aicurlperservice_test.cpp
+ * @brief Checks the per service connection and stream limits, and times
+ *        requests to a local server with and without HTTP/2 multiplexing.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../aicurl.h"
+#include "../aicurlperservice.h"
+#include "lltimer.h"
+
+#include <cstdlib>
+
+#undef AICurlPrivate
+
+// The benchmark runs when LL_HTTP2_BENCH_URL points at a file on a local
+// server that speaks both HTTP/1.1 and HTTP/2 over TLS, for example nghttpx
+// from nghttp2 in front of any web server that serves a texture sized file:
+//
+//   nghttpx -f127.0.0.1,8443 -b127.0.0.1,8080 server.key server.crt
+//   LL_HTTP2_BENCH_URL=https://localhost:8443/texture.j2c
+namespace
+{
+	size_t discard(char* ptr, size_t size, size_t nmemb, void* userdata)
+	{
+		return size * nmemb;
+	}
+
+	// Fetches url count times with at most in_flight requests at a time,
+	// like the curl thread does for one service, and returns the requests
+	// per second.
+	F64 fetch(const std::string& url, S32 count, S32 in_flight, bool multiplex, S32& failed)
+	{
+#if AICURL_HTTP2
+		CURLM* multi = curl_multi_init();
+		curl_multi_setopt(multi, CURLMOPT_PIPELINING, multiplex ? (long)CURLPIPE_MULTIPLEX : (long)CURLPIPE_NOTHING);
+		S32 started = 0;
+		S32 done = 0;
+		LLTimer timer;
+		while (done < count)
+		{
+			while (started < count && started - done < in_flight)
+			{
+				CURL* easy = curl_easy_init();
+				curl_easy_setopt(easy, CURLOPT_URL, url.c_str());
+				curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &discard);
+				curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+				curl_easy_setopt(easy, CURLOPT_SSL_VERIFYPEER, 0L);
+				curl_easy_setopt(easy, CURLOPT_SSL_VERIFYHOST, 0L);
+				curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, multiplex ? (long)CURL_HTTP_VERSION_2TLS : (long)CURL_HTTP_VERSION_1_1);
+				curl_easy_setopt(easy, CURLOPT_PIPEWAIT, multiplex ? 1L : 0L);
+				curl_multi_add_handle(multi, easy);
+				++started;
+			}
+			int running;
+			curl_multi_perform(multi, &running);
+			CURLMsg* msg;
+			int left;
+			while ((msg = curl_multi_info_read(multi, &left)))
+			{
+				if (msg->msg != CURLMSG_DONE)
+				{
+					continue;
+				}
+				CURL* easy = msg->easy_handle;
+				long status = 0;
+				curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+				if (msg->data.result != CURLE_OK || status != 200)
+				{
+					++failed;
+				}
+				curl_multi_remove_handle(multi, easy);
+				curl_easy_cleanup(easy);
+				++done;
+			}
+			curl_multi_wait(multi, NULL, 0, 100, NULL);
+		}
+		F64 elapsed = timer.getElapsedTimeF64();
+		curl_multi_cleanup(multi);
+		return count / elapsed;
+#else
+		failed = count;
+		return 0.0;
+#endif
+	}
+}
+
+namespace tut
+{
+	struct perservice_test
+	{
+		perservice_test()
+		{
+			AICurlPrivate::CurlConcurrentConnectionsPerService = 8;
+			AICurlPrivate::CurlConcurrentStreamsPerService = 24;
+		}
+	};
+	typedef test_group<perservice_test> perservice_group_t;
+	typedef perservice_group_t::object perservice_object_t;
+	tut::perservice_group_t perservice_instance("curl_per_service");
+
+	// Adds requests until the service is throttled, returns how many were added.
+	S32 add_until_throttled(AIPerServicePtr const& service)
+	{
+		PerService_wat per_service_w(*service);
+		S32 added = 0;
+		while (!per_service_w->throttled(cap_texture) && added < 1000)
+		{
+			per_service_w->added_to_multi_handle(cap_texture, false);
+			++added;
+		}
+		return added;
+	}
+
+	void remove_all(AIPerServicePtr const& service, S32 count)
+	{
+		PerService_wat per_service_w(*service);
+		for (S32 i = 0; i < count; ++i)
+		{
+			per_service_w->removed_from_multi_handle(cap_texture, false, false, true);
+		}
+	}
+
+	// A service is limited by connections until it answers over HTTP/2, then by streams
+	template<> template<>
+	void perservice_object_t::test<1>()
+	{
+		AIPerServicePtr service = AIPerService::instance("texture-cdn.example.com:443");
+		S32 added = add_until_throttled(service);
+		ensure_equals("connections", added, 8);
+
+		{
+			PerService_wat per_service_w(*service);
+			ensure("switches to streams", per_service_w->set_multiplexed(true));
+			ensure("already multiplexed", !per_service_w->set_multiplexed(true));
+		}
+		added += add_until_throttled(service);
+		ensure_equals("streams", added, 24);
+
+		// CurlConcurrentStreamsPerService changed
+		AICurlPrivate::CurlConcurrentStreamsPerService = 32;
+		AIPerService::adjust_concurrent_streams(8);
+		added += add_until_throttled(service);
+		ensure_equals("more streams", added, 32);
+
+		// Lost HTTP/2, for example behind another proxy: back to connections
+		{
+			PerService_wat per_service_w(*service);
+			ensure("switches to connections", per_service_w->set_multiplexed(false));
+			ensure("over the connection limit", per_service_w->throttled(cap_texture));
+		}
+		remove_all(service, added);
+		ensure_equals("connections again", add_until_throttled(service), 8);
+		remove_all(service, 8);
+	}
+
+	template<> template<>
+	void perservice_object_t::test<2>()
+	{
+		const char* url = getenv("LL_HTTP2_BENCH_URL");
+		if (!url)
+		{
+			return;
+		}
+		const S32 COUNT = 2000;
+		curl_global_init(CURL_GLOBAL_ALL);
+		S32 http1_failed = 0;
+		F64 http1_rate = fetch(url, COUNT, AICurlPrivate::CurlConcurrentConnectionsPerService, false, http1_failed);
+		S32 http2_failed = 0;
+		F64 http2_rate = fetch(url, COUNT, AICurlPrivate::CurlConcurrentStreamsPerService, true, http2_failed);
+		curl_global_cleanup();
+
+		LL_INFOS() << "Requests to " << url << ": " << AICurlPrivate::CurlConcurrentConnectionsPerService << " HTTP/1.1 connections "
+				   << http1_rate << " requests/s (" << http1_failed << " failed), " << AICurlPrivate::CurlConcurrentStreamsPerService
+				   << " HTTP/2 streams " << http2_rate << " requests/s (" << http2_failed << " failed)" << LL_ENDL;
+		ensure_equals("HTTP/2 requests succeed", http2_failed, 0);
+	}
+}
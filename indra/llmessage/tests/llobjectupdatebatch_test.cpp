@@ -0,0 +1,269 @@
+/**
+ * @file llobjectupdatebatch_test.cpp
+ * @brief Checks and times the column decode of terse object updates against
+ *        the per block data packer decode.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../lldatapacker.h"
+#include "../llobjectupdatebatch.h"
+#include "llquantize.h"
+#include "llrand.h"
+#include "llsdserialize.h"
+#include "lltimer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+// The messages are either recorded by the viewer (set
+// ObjectUpdateRecordPackets and point LL_TERSE_UPDATES at the
+// terse_updates.xml it writes in the log directory), or generated: full
+// messages of moving prims with an avatar now and then.
+namespace
+{
+	typedef std::vector<LLSD::Binary> message_t;
+	typedef std::vector<message_t> message_list_t;
+
+	void load_messages(message_list_t& messages)
+	{
+		const char* file = getenv("LL_TERSE_UPDATES");
+		if (file)
+		{
+			std::ifstream input(file);
+			LLSD sd;
+			if (input.is_open() && LLSDSerialize::fromXML(sd, input) > 0)
+			{
+				for (LLSD::array_iterator iter = sd.beginArray(); iter != sd.endArray(); ++iter)
+				{
+					message_t message;
+					for (LLSD::array_iterator block = iter->beginArray(); block != iter->endArray(); ++block)
+					{
+						message.push_back(block->asBinary());
+					}
+					messages.push_back(message);
+				}
+				return;
+			}
+		}
+
+		for (S32 m = 0; m < 500; ++m)
+		{
+			message_t message;
+			for (S32 i = 0; i < 24; ++i)
+			{
+				const bool avatar = ll_rand(16) == 0;
+				U8 buffer[LLObjectUpdateBatch::TERSE_AVATAR_SIZE];
+				LLDataPackerBinaryBuffer dp(buffer, sizeof(buffer));
+				dp.packU32(1000 + m * 24 + i, "LocalID");
+				dp.packU8(0, "State");
+				dp.packU8(avatar, "IsAvatar");
+				if (avatar)
+				{
+					dp.packVector4(LLVector4(0.f, 0.f, 1.f, ll_frand(30.f)), "Plane");
+				}
+				dp.packVector3(LLVector3(ll_frand(256.f), ll_frand(256.f), ll_frand(100.f)), "Pos");
+				// mostly at rest, as in a real region
+				const S32 moving = ll_rand(4) == 0;
+				for (S32 q = 0; q < 3; ++q)
+				{
+					dp.packU16(F32_to_U16(moving * (ll_frand(20.f) - 10.f), -128.f, 128.f), "Vel");
+				}
+				for (S32 q = 0; q < 3; ++q)
+				{
+					dp.packU16(F32_to_U16(moving * (ll_frand(2.f) - 1.f), -64.f, 64.f), "Acc");
+				}
+				LLQuaternion rot(ll_frand(F_TWO_PI), LLVector3(ll_frand(), ll_frand(), 1.f));
+				for (S32 q = 0; q < 4; ++q)
+				{
+					dp.packU16(F32_to_U16(rot.mQ[q], -1.f, 1.f), "Rot");
+				}
+				for (S32 q = 0; q < 3; ++q)
+				{
+					dp.packU16(F32_to_U16(moving * (ll_frand(2.f) - 1.f), -64.f, 64.f), "AngVel");
+				}
+				message.push_back(LLSD::Binary(buffer, buffer + dp.getCurrentSize()));
+			}
+			messages.push_back(message);
+		}
+	}
+
+	struct TerseUpdate
+	{
+		U32				mLocalID;
+		U8				mState;
+		LLVector4		mFootPlane;
+		LLVector3		mPosition;
+		LLVector3		mVelocity;
+		LLVector3		mAcceleration;
+		LLQuaternion	mRotation;
+		LLVector3		mAngularVelocity;
+	};
+
+	// One block as LLViewerObject::processUpdateMessage unpacks it without a
+	// batch
+	void unpack_block(const LLSD::Binary& data, TerseUpdate& update)
+	{
+		LLDataPackerBinaryBuffer dp(const_cast<U8*>(&data[0]), (S32)data.size());
+		U16 val[4];
+		U8 value;
+
+		dp.unpackU32(update.mLocalID, "LocalID");
+		dp.unpackU8(update.mState, "State");
+		dp.unpackU8(value, "agent");
+		if (value)
+		{
+			dp.unpackVector4(update.mFootPlane, "Plane");
+		}
+		dp.unpackVector3(update.mPosition, "Pos");
+		dp.unpackU16(val[VX], "VelX");
+		dp.unpackU16(val[VY], "VelY");
+		dp.unpackU16(val[VZ], "VelZ");
+		update.mVelocity.setVec(U16_to_F32(val[VX], -128.f, 128.f),
+								U16_to_F32(val[VY], -128.f, 128.f),
+								U16_to_F32(val[VZ], -128.f, 128.f));
+		dp.unpackU16(val[VX], "AccX");
+		dp.unpackU16(val[VY], "AccY");
+		dp.unpackU16(val[VZ], "AccZ");
+		update.mAcceleration.setVec(U16_to_F32(val[VX], -64.f, 64.f),
+									U16_to_F32(val[VY], -64.f, 64.f),
+									U16_to_F32(val[VZ], -64.f, 64.f));
+		dp.unpackU16(val[VX], "ThetaX");
+		dp.unpackU16(val[VY], "ThetaY");
+		dp.unpackU16(val[VZ], "ThetaZ");
+		dp.unpackU16(val[VS], "ThetaS");
+		update.mRotation.mQ[VX] = U16_to_F32(val[VX], -1.f, 1.f);
+		update.mRotation.mQ[VY] = U16_to_F32(val[VY], -1.f, 1.f);
+		update.mRotation.mQ[VZ] = U16_to_F32(val[VZ], -1.f, 1.f);
+		update.mRotation.mQ[VS] = U16_to_F32(val[VS], -1.f, 1.f);
+		dp.unpackU16(val[VX], "AccX");
+		dp.unpackU16(val[VY], "AccY");
+		dp.unpackU16(val[VZ], "AccZ");
+		update.mAngularVelocity.setVec(U16_to_F32(val[VX], -64.f, 64.f),
+									   U16_to_F32(val[VY], -64.f, 64.f),
+									   U16_to_F32(val[VZ], -64.f, 64.f));
+	}
+
+	void fill_batch(LLObjectUpdateBatch& batch, const message_t& message)
+	{
+		batch.clear();
+		for (message_t::const_iterator iter = message.begin(); iter != message.end(); ++iter)
+		{
+			batch.addBlock(iter->empty() ? NULL : &(*iter)[0], (S32)iter->size());
+		}
+	}
+}
+
+namespace tut
+{
+	struct objectupdatebatch_test
+	{
+	};
+	typedef test_group<objectupdatebatch_test> objectupdatebatch_group_t;
+	typedef objectupdatebatch_group_t::object objectupdatebatch_object_t;
+	tut::objectupdatebatch_group_t objectupdatebatch_instance("object_update_batch");
+
+	template<> template<>
+	void objectupdatebatch_object_t::test<1>()
+	{
+		message_list_t messages;
+		load_messages(messages);
+		ensure("have messages", !messages.empty());
+
+		S32 blocks = 0;
+		S32 avatars = 0;
+		LLObjectUpdateBatch batch;
+		for (message_list_t::const_iterator iter = messages.begin(); iter != messages.end(); ++iter)
+		{
+			fill_batch(batch, *iter);
+			batch.decode();
+			ensure_equals("one row per block", batch.getCount(), (S32)iter->size());
+
+			for (S32 i = 0; i < batch.getCount(); ++i, ++blocks)
+			{
+				const LLSD::Binary& data = (*iter)[i];
+				if (!batch.mValid[i])
+				{
+					ensure("only bad sizes are invalid", data.size() != LLObjectUpdateBatch::TERSE_SIZE &&
+														 data.size() != LLObjectUpdateBatch::TERSE_AVATAR_SIZE);
+					continue;
+				}
+
+				TerseUpdate update;
+				unpack_block(data, update);
+				ensure_equals("local id", batch.mLocalIDs[i], update.mLocalID);
+				ensure_equals("state", batch.mStates[i], update.mState);
+				ensure("position", batch.mPositions[i] == update.mPosition);
+				ensure("velocity", batch.mVelocities[i] == update.mVelocity);
+				ensure("acceleration", batch.mAccelerations[i] == update.mAcceleration);
+				ensure("rotation", batch.mRotations[i] == update.mRotation);
+				ensure("angular velocity", batch.mAngularVelocities[i] == update.mAngularVelocity);
+				const LLVector4* plane = batch.getFootPlane(i);
+				if (plane)
+				{
+					ensure("foot plane", *plane == update.mFootPlane);
+					++avatars;
+				}
+			}
+		}
+
+		// Replay the messages a few times with each decoder
+		const S32 PASSES = 20;
+		TerseUpdate update;
+		LLTimer timer;
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			for (message_list_t::const_iterator iter = messages.begin(); iter != messages.end(); ++iter)
+			{
+				for (message_t::const_iterator block = iter->begin(); block != iter->end(); ++block)
+				{
+					if (block->size() == LLObjectUpdateBatch::TERSE_SIZE ||
+						block->size() == LLObjectUpdateBatch::TERSE_AVATAR_SIZE)
+					{
+						unpack_block(*block, update);
+					}
+				}
+			}
+		}
+		F64 packer_time = timer.getElapsedTimeF64() * 1000.0;
+
+		timer.reset();
+		for (S32 pass = 0; pass < PASSES; ++pass)
+		{
+			for (message_list_t::const_iterator iter = messages.begin(); iter != messages.end(); ++iter)
+			{
+				fill_batch(batch, *iter);
+				batch.decode();
+			}
+		}
+		F64 batch_time = timer.getElapsedTimeF64() * 1000.0;
+
+		LL_INFOS() << "Terse updates: " << messages.size() << " messages, " << blocks << " blocks, "
+				   << avatars << " avatars" << LL_ENDL;
+		LL_INFOS() << "Terse updates: " << PASSES << " replays, data packer " << packer_time
+				   << " ms, column decode " << batch_time << " ms" << LL_ENDL;
+	}
+}
@@ -384,6 +384,11 @@ PFNGLENDTRANSFORMFEEDBACKPROC glEndTransformFeedback = NULL;
 PFNGLTRANSFORMFEEDBACKVARYINGSPROC glTransformFeedbackVaryings = NULL;
 PFNGLBINDBUFFERRANGEPROC glBindBufferRange = NULL;
 
+//GL_ARB_get_program_binary (4.1 core)
+PFNGLGETPROGRAMBINARYPROC glGetProgramBinary = NULL;
+PFNGLPROGRAMBINARYPROC glProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERIPROC glProgramParameteri = NULL;
+
 //GL_ARB_debug_output
 PFNGLDEBUGMESSAGECONTROLARBPROC glDebugMessageControlARB = NULL;
 PFNGLDEBUGMESSAGEINSERTARBPROC glDebugMessageInsertARB = NULL;
@@ -528,6 +533,7 @@ LLGLManager::LLGLManager() :
 	mHasVertexBufferObject(FALSE),
 	mHasVertexArrayObject(FALSE),
 	mHasMapBufferRange(FALSE),
+	mHasPixelBufferObject(FALSE),
 	mHasFlushBufferRange(FALSE),
 	mHasShaderObjects(FALSE),
 	mHasVertexShader(FALSE),
@@ -544,6 +550,7 @@ LLGLManager::LLGLManager() :
 	mHasARBEnvCombine(FALSE),
 	mHasCubeMap(FALSE),
 	mHasDebugOutput(FALSE),
+	mHasProgramBinary(FALSE),
 
 	mHasGpuShader5(FALSE),
 	mHasAdaptiveVsync(FALSE),
@@ -1092,6 +1099,7 @@ void LLGLManager::initExtensions()
 	mHasVertexArrayObject = mGLVersion >= 3.f || ExtensionExists("GL_ARB_vertex_array_object");
 	mHasSync = mGLVersion >= 3.2f || ExtensionExists("GL_ARB_sync");
 	mHasMapBufferRange = mGLVersion >= 3.f || ExtensionExists("GL_ARB_map_buffer_range");
+	mHasPixelBufferObject = mHasVertexBufferObject && (mGLVersion >= 2.1f || ExtensionExists("GL_ARB_pixel_buffer_object"));
 	mHasFlushBufferRange = ExtensionExists("GL_APPLE_flush_buffer_range");
 	mHasDepthClamp = mGLVersion >= 3.2f || ExtensionExists("GL_ARB_depth_clamp") || ExtensionExists("GL_NV_depth_clamp");
 	// mask out FBO support when packed_depth_stencil isn't there 'cause we need it for LLRenderTarget -Brad
@@ -1113,6 +1121,7 @@ void LLGLManager::initExtensions()
 	mHasTransformFeedback = mGLVersion >= 4.f || ExtensionExists("GL_EXT_transform_feedback");
 #if !LL_DARWIN
 	mHasPointParameters = mGLVersion >= 2.f || (!mIsATI && ExtensionExists("GL_ARB_point_parameters"));
+	mHasProgramBinary = mGLVersion >= 4.1f || ExtensionExists("GL_ARB_get_program_binary");
 #endif
 	mHasShaderObjects = mGLVersion >= 2.f || ExtensionExists("GL_ARB_shader_objects") && (LLRender::sGLCoreProfile || ExtensionExists("GL_ARB_shading_language_100"));
 	mHasVertexShader = mGLVersion >= 2.f || (ExtensionExists("GL_ARB_vertex_program") && ExtensionExists("GL_ARB_vertex_shader")
@@ -1416,6 +1425,13 @@ void LLGLManager::initExtensions()
 		glDebugMessageCallbackARB = (PFNGLDEBUGMESSAGECALLBACKARBPROC)GLH_EXT_GET_PROC_ADDRESS_CORE(4.3, "glDebugMessageCallback");
 		glGetDebugMessageLogARB = (PFNGLGETDEBUGMESSAGELOGARBPROC)GLH_EXT_GET_PROC_ADDRESS_CORE(4.3, "glGetDebugMessageLog");
 	}
+	if (mHasProgramBinary)
+	{
+		glGetProgramBinary = (PFNGLGETPROGRAMBINARYPROC)GLH_EXT_GET_PROC_ADDRESS("glGetProgramBinary");
+		glProgramBinary = (PFNGLPROGRAMBINARYPROC)GLH_EXT_GET_PROC_ADDRESS("glProgramBinary");
+		glProgramParameteri = (PFNGLPROGRAMPARAMETERIPROC)GLH_EXT_GET_PROC_ADDRESS("glProgramParameteri");
+		mHasProgramBinary = glGetProgramBinary && glProgramBinary && glProgramParameteri;
+	}
 #if !LL_LINUX || LL_LINUX_NV_GL_HEADERS
 	// This is expected to be a static symbol on Linux GL implementations, except if we use the nvidia headers - bah
 	glDrawRangeElements = (PFNGLDRAWRANGEELEMENTSPROC)GLH_EXT_GET_PROC_ADDRESS("glDrawRangeElements");
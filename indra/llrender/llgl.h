@@ -93,6 +93,7 @@ public:
 	BOOL mHasVertexArrayObject;
 	BOOL mHasSync;
 	BOOL mHasMapBufferRange;
+	BOOL mHasPixelBufferObject;
 	BOOL mHasFlushBufferRange;
 	BOOL mHasShaderObjects;
 	BOOL mHasVertexShader;
@@ -111,6 +112,7 @@ public:
 	BOOL mHasARBEnvCombine;
 	BOOL mHasCubeMap;
 	BOOL mHasDebugOutput;
+	BOOL mHasProgramBinary;
 	BOOL mHasGpuShader5;
 	BOOL mHasAdaptiveVsync;
 	BOOL mHasTextureSwizzle;
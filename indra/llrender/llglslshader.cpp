@@ -30,6 +30,7 @@
 
 #include "llshadermgr.h"
 #include "llfile.h"
+#include "llmd5.h"
 #include "llrender.h"
 #include "llcontrol.h"
 #include "llvertexbuffer.h"
@@ -391,17 +392,20 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 		glDeleteProgram(mProgramObject);
 	// Create program
 	mProgramObject = glCreateProgramObjectARB();
+	mAttachedSourceHashes.clear();
+	mAttachedObjects.clear();
 	
 #if LL_DARWIN
     // work-around missing mix(vec3,vec3,bvec3)
     mDefines["OLD_SELECT"] = "1";
 #endif
 	
-	//compile new source
+	//load new source, it's only compiled if the program isn't in the program binary cache
+	const bool use_binary_cache = LLShaderMgr::instance()->useProgramBinaryCache();
 	vector< pair<string,GLenum> >::iterator fileIter = mShaderFiles.begin();
 	for ( ; fileIter != mShaderFiles.end(); fileIter++ )
 	{
-		GLhandleARB shaderhandle = LLShaderMgr::instance()->loadShaderFile((*fileIter).first, mShaderLevel, (*fileIter).second, &mDefines, mFeatures.mIndexedTextureChannels);
+		GLhandleARB shaderhandle = LLShaderMgr::instance()->loadShaderFile((*fileIter).first, mShaderLevel, (*fileIter).second, &mDefines, mFeatures.mIndexedTextureChannels, use_binary_cache);
 		LL_DEBUGS("ShaderLoading") << "SHADER FILE: " << (*fileIter).first << " mShaderLevel=" << mShaderLevel << LL_ENDL;
 		if (shaderhandle > 0)
 		{
@@ -435,15 +439,34 @@ BOOL LLGLSLShader::createShader(std::vector<LLStaticHashedString> * attributes,
 	}
 #endif
 
+	// Restore a previously linked binary of the same sources instead of linking
+	std::string binary_key;
+	bool from_binary = false;
+	if (success && use_binary_cache)
+	{
+		binary_key = getProgramBinaryKey(varying_count, varyings);
+		from_binary = LLShaderMgr::instance()->loadProgramBinary(mProgramObject, binary_key);
+	}
+
+	// Missed or rejected, compile what is still uncompiled and link as usual
+	for (U32 i = 0; success && !from_binary && i < mAttachedObjects.size(); ++i)
+	{
+		success = LLShaderMgr::instance()->compileShaderObject(mAttachedObjects[i]);
+	}
+
 	// Map attributes and uniforms
 	if (success)
 	{
-		success = mapAttributes(attributes);
+		success = mapAttributes(attributes, !from_binary);
 	}
 	if (success)
 	{
 		success = mapUniforms(uniforms);
 	}
+	if (success && !binary_key.empty() && !from_binary)
+	{
+		LLShaderMgr::instance()->saveProgramBinary(mProgramObject, binary_key);
+	}
 	if( !success )
 	{
 		if(mProgramObject)
@@ -481,6 +504,8 @@ BOOL LLGLSLShader::attachObject(std::string object)
 		if((*it).first == object)
 		{
 			glAttachObjectARB(mProgramObject, (*it).second.mHandle);
+			mAttachedSourceHashes += (*it).second.mSourceHash;
+			mAttachedObjects.push_back((*it).second.mHandle);
 			stop_glerror();
 			return TRUE;
 		}
@@ -501,6 +526,8 @@ void LLGLSLShader::attachObject(GLhandleARB object)
 			if((*it).second.mHandle == object)
 			{
 				LL_INFOS("ShaderLoading") << "Attached: " << (*it).first << LL_ENDL;
+				mAttachedSourceHashes += (*it).second.mSourceHash;
+				mAttachedObjects.push_back(object);
 				break;
 			}
 		}
@@ -527,7 +554,34 @@ void LLGLSLShader::attachObjects(GLhandleARB* objects, S32 count)
 	}
 }
 
-BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attributes)
+std::string LLGLSLShader::getProgramBinaryKey(U32 varying_count, const char** varyings) const
+{
+	// Anything that changes the linked program: the driver, the sources of
+	// every attached object, and the state applied before linking.
+	LLMD5 md5;
+	md5.update(gGLManager.mGLVendor);
+	md5.update(gGLManager.mGLRenderer);
+	md5.update(gGLManager.mGLVersionString);
+	md5.update(mAttachedSourceHashes);
+	for (U32 i = 0; i < LLShaderMgr::instance()->mReservedAttribs.size(); ++i)
+	{
+		md5.update(LLShaderMgr::instance()->mReservedAttribs[i]);
+	}
+	if (varyings)
+	{
+		for (U32 i = 0; i < varying_count; ++i)
+		{
+			md5.update(std::string(varyings[i]));
+		}
+	}
+	md5.finalize();
+
+	char key[MD5HEX_STR_SIZE];
+	md5.hex_digest(key);
+	return std::string(key);
+}
+
+BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attributes, bool link_program)
 {
 	//before linking, make sure reserved attributes always have consistent locations
 	for (U32 i = 0; i < LLShaderMgr::instance()->mReservedAttribs.size(); i++)
@@ -536,8 +590,8 @@ BOOL LLGLSLShader::mapAttributes(const std::vector<LLStaticHashedString> * attri
 		glBindAttribLocationARB(mProgramObject, i, (const GLcharARB *) name);
 	}
 	
-	//link the program
-	BOOL res = link();
+	//link the program, unless it was restored from the program binary cache
+	BOOL res = link_program ? link() : TRUE;
 
 	mAttribute.clear();
 	U32 numAttributes = (attributes == NULL) ? 0 : attributes->size();
@@ -112,7 +112,8 @@ public:
 	BOOL attachObject(std::string object);
 	void attachObject(GLhandleARB object);
 	void attachObjects(GLhandleARB* objects = NULL, S32 count = 0);
-	BOOL mapAttributes(const std::vector<LLStaticHashedString> * attributes);
+	BOOL mapAttributes(const std::vector<LLStaticHashedString> * attributes, bool link_program = true);
+	std::string getProgramBinaryKey(U32 varying_count, const char** varyings) const;
 	BOOL mapUniforms(const std::vector<LLStaticHashedString> *);
 	void mapUniform(const gl_uniform_data_t& gl_uniform, const std::vector<LLStaticHashedString> *);
 	S32 getUniformFromIndex(const U32 index)
@@ -442,6 +443,8 @@ public:
 	std::vector< std::pair< std::string, GLenum > > mShaderFiles;
 	std::string mName;
 	std::map<std::string, std::string> mDefines;
+	std::string mAttachedSourceHashes; //source hashes of the attached shader objects, in attach order
+	std::vector<GLhandleARB> mAttachedObjects; //attached shader objects known to LLShaderMgr, compiled on a program binary miss
 
 	//statistcis for profiling shader performance
 	U32 mTimerQuery;
@@ -317,6 +317,13 @@ BOOL LLGLTexture::getIsAlphaMask(const F32 max_rmse, const F32 max_mid) const
 	return mGLTexturep->getIsAlphaMask(max_rmse, max_mid) ;
 }
 
+BOOL LLGLTexture::getIsOpaque() const
+{
+	llassert(mGLTexturep.notNull()) ;
+
+	return mGLTexturep->getIsOpaque() ;
+}
+
 BOOL LLGLTexture::getMask(const LLVector2 &tc)
 {
 	llassert(mGLTexturep.notNull()) ;
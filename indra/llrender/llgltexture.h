@@ -141,6 +141,7 @@ public:
 	S32Bytes   getTextureMemory() const ;
 	LLGLenum   getPrimaryFormat() const;
 	BOOL       getIsAlphaMask(const F32 max_rmse, const F32 max_mid) const ;
+	BOOL       getIsOpaque() const ;
 	LLTexUnit::eTextureType getTarget(void) const ;
 	BOOL       getMask(const LLVector2 &tc);
 	F32        getTimePassedSinceLastBound();
@@ -38,6 +38,7 @@
 #include "llgl.h"
 #include "llglslshader.h"
 #include "llrender.h"
+#include "lltimer.h"
 
 //----------------------------------------------------------------------------
 const F32 MIN_TEXTURE_LIFETIME = 10.f;
@@ -60,6 +61,11 @@ F32 LLImageGL::sLastFrameTime			= 0.f;
 BOOL LLImageGL::sAllowReadBackRaw       = FALSE ;
 LLImageGL* LLImageGL::sDefaultGLTexture = NULL ;
 bool LLImageGL::sCompressTextures = false;
+bool LLImageGL::sUsePixelBuffers = true;
+U64 LLImageGL::sBytesUploaded = 0;
+U64 LLImageGL::sCurBytesUploaded = 0;
+F32 LLImageGL::sUploadTime = 0.f;
+F32 LLImageGL::sCurUploadTime = 0.f;
 
 std::set<LLImageGL*> LLImageGL::sImageList;
 
@@ -89,6 +95,145 @@ std::vector<S64Bytes> LLImageGL::sTextureCurMemByCategoryBound ;
 //static std::vector<U32> sActiveTextureNames;
 //static std::vector<U32> sDeletedTextureNames;
 
+//----------------------------------------------------------------------------
+// Streaming texture uploads.
+//
+// Pixel data is copied into one of a small ring of pixel unpack buffers and
+// the texture is specified from that buffer, so glTexImage2D returns without
+// the driver copying client memory and the transfer to the GPU overlaps the
+// rest of the frame.  A buffer is orphaned before it is refilled, which lets
+// the driver keep feeding a transfer still in flight from the old storage.
+namespace
+{
+	const U32 UPLOAD_BUFFER_COUNT = 4;
+	const U32 MIN_BUFFERED_UPLOAD_BYTES = 16 * 1024;	// smaller uploads are cheaper straight from client memory
+
+	class LLTextureUploadRing
+	{
+	public:
+		LLTextureUploadRing()
+		:	mNext(0),
+			mBound(false)
+		{
+			memset(mBuffers, 0, sizeof(mBuffers));
+		}
+
+		// Returns what to hand GL in place of pixels: an offset into the bound
+		// unpack buffer, or pixels itself if the data was not staged.
+		const void* stage(const void* pixels, U32 bytes)
+		{
+			LLImageGL::sCurBytesUploaded += bytes;
+			if (!pixels || bytes < MIN_BUFFERED_UPLOAD_BYTES ||
+				!LLImageGL::sUsePixelBuffers || !gGLManager.mHasPixelBufferObject)
+			{
+				return pixels;
+			}
+
+			GLuint& buffer = mBuffers[mNext];
+			mNext = (mNext + 1) % UPLOAD_BUFFER_COUNT;
+			if (!buffer)
+			{
+				glGenBuffersARB(1, &buffer);
+			}
+			glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, buffer);
+			mBound = true;
+
+			glBufferDataARB(GL_PIXEL_UNPACK_BUFFER_ARB, bytes, NULL, GL_STREAM_DRAW_ARB);
+			void* dst = gGLManager.mHasMapBufferRange ?
+				glMapBufferRange(GL_PIXEL_UNPACK_BUFFER_ARB, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT) :
+				glMapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, GL_WRITE_ONLY_ARB);
+			if (!dst)
+			{
+				unbind();
+				return pixels;
+			}
+			memcpy(dst, pixels, bytes);
+			if (!glUnmapBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB))
+			{	// buffer contents were lost (mode switch), upload from client memory instead
+				unbind();
+				return pixels;
+			}
+			return NULL;
+		}
+
+		void unbind()
+		{
+			if (mBound)
+			{
+				glBindBufferARB(GL_PIXEL_UNPACK_BUFFER_ARB, 0);
+				mBound = false;
+			}
+		}
+
+		void destroyGL()
+		{
+			unbind();
+			for (U32 i = 0; i < UPLOAD_BUFFER_COUNT; ++i)
+			{
+				if (mBuffers[i])
+				{
+					glDeleteBuffersARB(1, &mBuffers[i]);
+					mBuffers[i] = 0;
+				}
+			}
+		}
+
+	private:
+		GLuint mBuffers[UPLOAD_BUFFER_COUNT];
+		U32 mNext;
+		bool mBound;
+	};
+
+	LLTextureUploadRing sUploadRing;
+
+	// Bytes glTexImage2D reads for a tightly packed image (GL_UNPACK_ALIGNMENT
+	// is 1 throughout the viewer), or 0 for layouts we don't stage.
+	U32 unpacked_image_bytes(S32 width, S32 height, U32 pixformat, U32 pixtype)
+	{
+		U32 components = 0;
+		switch (pixformat)
+		{
+			case GL_RED:
+			case GL_ALPHA:
+			case GL_LUMINANCE:
+				components = 1;
+				break;
+			case GL_RG:
+			case GL_LUMINANCE_ALPHA:
+				components = 2;
+				break;
+			case GL_RGB:
+			case GL_BGR:
+				components = 3;
+				break;
+			case GL_RGBA:
+			case GL_BGRA:
+				components = 4;
+				break;
+			default:
+				return 0;
+		}
+
+		U32 pixel_bytes = 0;
+		switch (pixtype)
+		{
+			case GL_UNSIGNED_BYTE:
+				pixel_bytes = components;
+				break;
+			case GL_UNSIGNED_INT_8_8_8_8:
+			case GL_UNSIGNED_INT_8_8_8_8_REV:
+				pixel_bytes = 4;
+				break;
+			case GL_FLOAT:
+				pixel_bytes = components * 4;
+				break;
+			default:
+				return 0;
+		}
+		return (U32)(width * height) * pixel_bytes;
+	}
+}
+
 // **************************************************************************************
 //below are functions for debug use
 //do not delete them even though they are not currently being used.
@@ -297,6 +442,10 @@ void LLImageGL::updateStats(F32 current_time)
 	sLastFrameTime = current_time;
 	sBoundTextureMemory = sCurBoundTextureMemory;
 	sCurBoundTextureMemory = S64Bytes(0);
+	sBytesUploaded = sCurBytesUploaded;
+	sCurBytesUploaded = 0;
+	sUploadTime = sCurUploadTime;
+	sCurUploadTime = 0.f;
 
 	if(gAuditTexture)
 	{
@@ -332,6 +481,7 @@ S32 LLImageGL::updateBoundTexMem(const S32Bytes mem, const S32 ncomponents, S32
 void LLImageGL::destroyGL(BOOL save_state)
 {
 	LLTexUnit::sWhiteTexture = 0;
+	sUploadRing.destroyGL();
 	if (save_state)
 	{
 		U32 count = 0;
@@ -506,6 +656,7 @@ void LLImageGL::init(BOOL usemipmaps, bool allow_compression)
 	mAutoGenMips = FALSE;
 
 	mIsMask = FALSE;
+	mIsOpaque = FALSE;
 	mMaskRMSE = 1.f ;
 	mMaskMidPercentile = 1.f;
 
@@ -714,6 +865,7 @@ static LLTrace::BlockTimerStatHandle FTM_SET_IMAGE("setImage");
 void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 {
 	LL_RECORD_BLOCK_TIME(FTM_SET_IMAGE);
+	LLTimer upload_timer;
 	bool is_compressed = false;
 	if (mFormatPrimary >= GL_COMPRESSED_RGBA_S3TC_DXT1_EXT && mFormatPrimary <= GL_COMPRESSED_RGBA_S3TC_DXT5_EXT)
 	{
@@ -760,7 +912,9 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 				if (is_compressed)
 				{
  					S32 tex_size = dataFormatBytes(mFormatPrimary, w, h);
-					glCompressedTexImage2DARB(mTarget, gl_level, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
+					const void* pixels = sUploadRing.stage(data_in, tex_size);
+					glCompressedTexImage2DARB(mTarget, gl_level, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)pixels);
+					sUploadRing.unbind();
 					stop_glerror();
 					mIsCompressed = true;
 				}
@@ -935,7 +1089,9 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 		if (is_compressed)
 		{
 			S32 tex_size = dataFormatBytes(mFormatPrimary, w, h);
-			glCompressedTexImage2DARB(mTarget, 0, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)data_in);
+			const void* pixels = sUploadRing.stage(data_in, tex_size);
+			glCompressedTexImage2DARB(mTarget, 0, mFormatPrimary, w, h, 0, tex_size, (GLvoid *)pixels);
+			sUploadRing.unbind();
 			stop_glerror();
 			mIsCompressed = true;
 		}
@@ -965,6 +1121,7 @@ void LLImageGL::setImage(const U8* data_in, BOOL data_hasmips)
 	}
 	stop_glerror();
 	mGLTextureCreated = true;
+	sCurUploadTime += upload_timer.getElapsedTimeF32();
 }
 
 BOOL LLImageGL::setSubImage(const U8* datap, S32 data_width, S32 data_height, S32 x_pos, S32 y_pos, S32 width, S32 height, BOOL force_fast_update)
@@ -1039,16 +1196,23 @@ BOOL LLImageGL::setSubImage(const U8* datap, S32 data_width, S32 data_height, S3
 			stop_glerror();
 		}
 
+		LLTimer upload_timer;
 		datap += (y_pos * data_width + x_pos) * getComponents();
 		// Update the GL texture
 		BOOL res = gGL.getTexUnit(0)->bindManual(mBindTarget, getTexName());
 		if (!res) LL_ERRS() << "LLImageGL::setSubImage(): bindTexture failed" << LL_ENDL;
 		stop_glerror();
 
+		// Rows are data_width apart, the last one only needs width pixels
+		U32 row_bytes = unpacked_image_bytes(data_width, 1, mFormatPrimary, mFormatType);
+		U32 bytes = row_bytes ? row_bytes * (height - 1) + unpacked_image_bytes(width, 1, mFormatPrimary, mFormatType) : 0;
+		const void* pixels = bytes ? sUploadRing.stage(datap, bytes) : datap;
 		glTexSubImage2D(mTarget, 0, x_pos, y_pos, 
-						width, height, mFormatPrimary, mFormatType, datap);
+						width, height, mFormatPrimary, mFormatType, pixels);
+		sUploadRing.unbind();
 		gGL.getTexUnit(0)->disable();
 		stop_glerror();
+		sCurUploadTime += upload_timer.getElapsedTimeF32();
 
 		if(mFormatSwapBytes)
 		{
@@ -1336,7 +1500,13 @@ bool LLImageGL::setManualImage(U32 target, S32 miplevel, S32 intformat, S32 widt
 	}
 
 	stop_glerror();
+	U32 bytes = pixels ? unpacked_image_bytes(width, height, pixformat, pixtype) : 0;
+	if (bytes)
+	{
+		pixels = sUploadRing.stage(pixels, bytes);
+	}
 	glTexImage2D(target, miplevel, intformat, width, height, 0, pixformat, pixtype, pixels);
+	sUploadRing.unbind();
 	stop_glerror();
 	return compressed;
 }
@@ -2025,6 +2195,8 @@ void LLImageGL::analyzeAlpha(const void* data_in, U32 w, U32 h)
 		mIsMask = TRUE;
 	}
 
+	mIsOpaque = alphatotal == 255 * length;
+
 	mMaskMidPercentile = (F32)mids / (F32)(w * h);
 	mMaskRMSE = ((max-min)%255)==0 ? sqrt(sum)/255.0 : FLT_MAX;
 	
@@ -191,6 +191,8 @@ public:
 	LLGLuint getTexName() const { return mTexName ? mTexName->getTexName() : 0; }
 
 	BOOL getIsAlphaMask(const F32 max_rmse, const F32 max_mid) const { return mNeedsAlphaAndPickMask && (max_rmse < 0.f ? (bool)mIsMask : (mMaskRMSE <= max_rmse && mMaskMidPercentile <= max_mid)); }
+	// TRUE only once analyzeAlpha() has seen every alpha sample at 255.
+	BOOL getIsOpaque() const { return mNeedsAlphaAndPickMask && mIsOpaque; }
 
 	BOOL getIsResident(BOOL test_now = FALSE); // not const
 
@@ -244,6 +246,7 @@ private:
 	S8 mAutoGenMips;
 
 	BOOL mIsMask;
+	BOOL mIsOpaque;
 	F32  mMaskRMSE;
 	F32  mMaskMidPercentile;
 	BOOL mNeedsAlphaAndPickMask;
@@ -296,6 +299,11 @@ public:
 	static BOOL sGlobalUseAnisotropic;
 	static LLImageGL* sDefaultGLTexture ;	
  	static bool sCompressTextures;			//use GL texture compression
+	static bool sUsePixelBuffers;			//stream uploads through pixel unpack buffers
+	static U64 sBytesUploaded;				// Texture bytes uploaded during the last completed frame
+	static U64 sCurBytesUploaded;			// Texture bytes uploaded during the current frame
+	static F32 sUploadTime;					// Seconds spent uploading textures during the last completed frame
+	static F32 sCurUploadTime;				// Seconds spent uploading textures during the current frame
 
 #if DEBUG_MISS
 	BOOL mMissed; // Missed on last bind?
@@ -33,6 +33,8 @@
 #include "llrender.h"
 #include "llcontrol.h"	//for LLCachedControl
 #include "lldir.h"		//for gDirUtilp
+#include "llmd5.h"
+#include "lldiriterator.h"
 
 #if LL_DARWIN
 #include "OpenGL/OpenGL.h"
@@ -53,6 +55,8 @@ using std::string;
 LLShaderMgr * LLShaderMgr::sInstance = NULL;
 
 LLShaderMgr::LLShaderMgr()
+:	mProgramBinaryHits(0),
+	mProgramBinaryMisses(0)
 {
 	{
 		const std::string dumpdir = gDirUtilp->getExpandedFilename(LL_PATH_LOGS,"shader_dump")+gDirUtilp->getDirDelimiter();
@@ -533,7 +537,7 @@ void LLShaderMgr::dumpObjectLog(GLhandleARB ret, bool isProgram, bool warns)
 	}
 }
 
-GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines, S32 texture_index_channels)
+GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines, S32 texture_index_channels, bool defer_compile)
 {
 	std::pair<std::multimap<std::string, CachedObjectInfo >::iterator, std::multimap<std::string, CachedObjectInfo>::iterator> range;
 	range = mShaderObjects.equal_range(filename);
@@ -834,6 +838,30 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 		}
 	}
 
+	//hash the preprocessed source, it's part of the program binary cache key
+	char source_hash[MD5HEX_STR_SIZE] = { 0 };
+	if (ret)
+	{
+		LLMD5 md5;
+		for (GLuint i = 0; i < count; i++)
+		{
+			md5.update((const unsigned char*)text[i], strlen(text[i]));
+		}
+		md5.finalize();
+		md5.hex_digest(source_hash);
+	}
+
+	if (ret && defer_compile)
+	{
+		//compiled by compileShaderObject() only if the program isn't restored from the binary cache
+		for (GLuint i = 0; i < count; i++)
+		{
+			free(text[i]);
+		}
+		mShaderObjects.insert(make_pair(filename,CachedObjectInfo(ret,try_gpu_class,type, texture_index_channels,defines,source_hash,false)));
+		return ret;
+	}
+
 	//compile source
 	if(ret)
 	{
@@ -931,7 +959,7 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 	if (ret)
 	{
 		// Add shader file to map
-		mShaderObjects.insert(make_pair(filename,CachedObjectInfo(ret,try_gpu_class,type, texture_index_channels,defines)));
+		mShaderObjects.insert(make_pair(filename,CachedObjectInfo(ret,try_gpu_class,type, texture_index_channels,defines,source_hash,true)));
 		shader_level = try_gpu_class;
 	}
 	else
@@ -939,13 +967,46 @@ GLhandleARB LLShaderMgr::loadShaderFile(const std::string& filename, S32 & shade
 		if (shader_level > 1)
 		{
 			shader_level--;
-			return loadShaderFile(filename,shader_level,type, defines, texture_index_channels);
+			return loadShaderFile(filename,shader_level,type, defines, texture_index_channels, defer_compile);
 		}
 		LL_WARNS("ShaderLoading") << "Failed to load " << filename << LL_ENDL;	
 	}
 	return ret;
 }
 
+BOOL LLShaderMgr::compileShaderObject(GLhandleARB object)
+{
+	std::multimap<std::string, CachedObjectInfo>::iterator it = mShaderObjects.begin();
+	for (; it != mShaderObjects.end(); ++it)
+	{
+		if ((*it).second.mHandle == object)
+		{
+			break;
+		}
+	}
+	if (it == mShaderObjects.end() || (*it).second.mCompiled)
+	{
+		return it != mShaderObjects.end();
+	}
+
+	glCompileShaderARB(object);
+
+	GLint success = GL_TRUE;
+	glGetShaderiv(object, GL_COMPILE_STATUS, &success);
+	if (success == GL_FALSE)
+	{
+		LL_WARNS("ShaderLoading") << "GLSL Compilation Error in " << (*it).first << " class " << (*it).second.mLevel << LL_ENDL;
+		dumpObjectLog(object, false);
+		glDeleteShader(object); //no longer need handle
+		mShaderObjects.erase(it);
+		return FALSE;
+	}
+
+	dumpObjectLog(object, false, false);
+	(*it).second.mCompiled = true;
+	return TRUE;
+}
+
 void LLShaderMgr::unloadShaders()
 {
 	//Instead of manually unloading, shaders are now automatically accumulated in a list.
@@ -1069,6 +1130,222 @@ BOOL LLShaderMgr::linkProgramObject(GLhandleARB obj, BOOL suppress_errors)
 	return success;
 }
 
+namespace
+{
+	const U32 PROGRAM_BINARY_MAGIC = 0x4250474c;	// "LGPB"
+	const U32 PROGRAM_BINARY_VERSION = 2;
+
+	struct ProgramBinaryHeader
+	{
+		U32 mMagic;
+		U32 mVersion;
+		U32 mFormat;
+		U32 mLength;
+		char mDriver[MD5HEX_STR_SIZE];	// program_binary_driver() of the driver that wrote it
+	};
+
+	std::string program_binary_filename(const std::string& key)
+	{
+		return gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache", key + ".bin");
+	}
+
+	// Identifies the driver, which only loads binaries it wrote itself.
+	const std::string& program_binary_driver()
+	{
+		static std::string driver;
+		if (driver.empty())
+		{
+			LLMD5 md5;
+			md5.update(gGLManager.mGLVendor);
+			md5.update(gGLManager.mGLRenderer);
+			md5.update(gGLManager.mGLVersionString);
+			md5.finalize();
+
+			char hex[MD5HEX_STR_SIZE];
+			md5.hex_digest(hex);
+			driver = hex;
+		}
+		return driver;
+	}
+}
+
+bool LLShaderMgr::useProgramBinaryCache() const
+{
+	static const LLCachedControl<bool> use_cache("RenderShaderCache", true);
+	return use_cache && gGLManager.mHasProgramBinary;
+}
+
+bool LLShaderMgr::loadProgramBinary(GLhandleARB program, const std::string& key)
+{
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	const std::string filename = program_binary_filename(key);
+	bool loaded = false;
+
+	LLFILE* file = LLFile::fopen(filename, "rb");
+	if (file)
+	{
+		ProgramBinaryHeader header;
+		std::vector<U8> binary;
+		if (fread(&header, sizeof(header), 1, file) == 1 &&
+			header.mMagic == PROGRAM_BINARY_MAGIC &&
+			header.mVersion == PROGRAM_BINARY_VERSION &&
+			header.mLength > 0 &&
+			program_binary_driver().compare(0, std::string::npos, header.mDriver, strnlen(header.mDriver, sizeof(header.mDriver))) == 0)
+		{
+			binary.resize(header.mLength);
+			if (fread(&binary[0], 1, header.mLength, file) != header.mLength)
+			{
+				binary.clear();
+			}
+		}
+		fclose(file);
+
+		if (!binary.empty())
+		{
+			glProgramBinary(program, header.mFormat, &binary[0], header.mLength);
+			GLint success = GL_FALSE;
+			glGetProgramiv(program, GL_LINK_STATUS, &success);
+			loaded = success == GL_TRUE;
+		}
+		// Clear any error from a binary the driver no longer accepts.
+		glGetError();
+
+		if (!loaded)
+		{
+			// Stale (driver update) or truncated, relink from source and replace it.
+			LL_INFOS("ShaderLoading") << "Discarding program binary " << key << LL_ENDL;
+			LLFile::remove(filename);
+		}
+	}
+
+	if (loaded)
+	{
+		++mProgramBinaryHits;
+	}
+	else
+	{
+		++mProgramBinaryMisses;
+		glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	}
+	return loaded;
+#else
+	return false;
+#endif
+}
+
+void LLShaderMgr::saveProgramBinary(GLhandleARB program, const std::string& key)
+{
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	GLint length = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+	if (length <= 0)
+	{
+		return;
+	}
+
+	std::vector<U8> binary(length);
+	GLenum format = 0;
+	glGetProgramBinary(program, length, &length, &format, &binary[0]);
+	if (glGetError() != GL_NO_ERROR || length <= 0)
+	{
+		return;
+	}
+
+	LLFile::mkdir(gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache"));
+
+	// Write to a temporary and rename so a crash never leaves a truncated binary behind.
+	const std::string filename = program_binary_filename(key);
+	const std::string temp_filename = filename + ".tmp";
+	LLFILE* file = LLFile::fopen(temp_filename, "wb");
+	if (!file)
+	{
+		return;
+	}
+
+	ProgramBinaryHeader header = { PROGRAM_BINARY_MAGIC, PROGRAM_BINARY_VERSION, (U32)format, (U32)length };
+	strncpy(header.mDriver, program_binary_driver().c_str(), sizeof(header.mDriver) - 1);
+	header.mDriver[sizeof(header.mDriver) - 1] = '\0';
+	bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+				   fwrite(&binary[0], 1, length, file) == (size_t)length;
+	fclose(file);
+
+	if (written)
+	{
+		LLFile::remove(filename, ENOENT);
+	}
+	if (!written || LLFile::rename(temp_filename, filename) != 0)
+	{
+		LL_WARNS("ShaderLoading") << "Failed to write program binary " << filename << LL_ENDL;
+		LLFile::remove(temp_filename);
+	}
+#endif
+}
+
+void LLShaderMgr::pruneProgramBinaryCache()
+{
+#ifdef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+	const std::string dir = gDirUtilp->getExpandedFilename(LL_PATH_CACHE, "shader_cache");
+	if (!LLFile::isdir(dir))
+	{
+		return;
+	}
+
+	// Left behind by a crash while saving.
+	gDirUtilp->deleteFilesInDir(dir, "*.tmp");
+
+	GLint num_formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &num_formats);
+	std::vector<GLint> formats(llmax(num_formats, 0));
+	if (!formats.empty())
+	{
+		glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, &formats[0]);
+	}
+
+	// The key covers the driver, so a binary written by another driver or an
+	// older viewer is never loaded again and would stay forever.
+	S32 pruned = 0;
+	std::vector<std::string> stale;
+	std::string name;
+	LLDirIterator iter(dir, "*.bin");
+	while (iter.next(name))
+	{
+		const std::string filename = gDirUtilp->add(dir, name);
+		ProgramBinaryHeader header;
+		bool usable = false;
+
+		LLFILE* file = LLFile::fopen(filename, "rb");
+		if (file)
+		{
+			usable = fread(&header, sizeof(header), 1, file) == 1 &&
+					 header.mMagic == PROGRAM_BINARY_MAGIC &&
+					 header.mVersion == PROGRAM_BINARY_VERSION &&
+					 program_binary_driver().compare(0, std::string::npos, header.mDriver, strnlen(header.mDriver, sizeof(header.mDriver))) == 0 &&
+					 std::find(formats.begin(), formats.end(), (GLint)header.mFormat) != formats.end();
+			fclose(file);
+		}
+
+		if (!usable)
+		{
+			stale.push_back(filename);
+		}
+	}
+
+	for (std::vector<std::string>::const_iterator it = stale.begin(); it != stale.end(); ++it)
+	{
+		if (LLFile::remove(*it) == 0)
+		{
+			++pruned;
+		}
+	}
+
+	if (pruned)
+	{
+		LL_INFOS("ShaderLoading") << "Pruned " << pruned << " program binaries the driver can't load" << LL_ENDL;
+	}
+	glGetError();
+#endif
+}
+
 BOOL LLShaderMgr::validateProgramObject(GLhandleARB obj)
 {
 	//check program validity against current GL
@@ -231,10 +231,23 @@ DISPLAY_GAMMA,
 	void dumpObjectLog(GLhandleARB ret, bool isProgram, bool warns = TRUE);
 	BOOL	linkProgramObject(GLhandleARB obj, BOOL suppress_errors = FALSE);
 	BOOL	validateProgramObject(GLhandleARB obj);
-	GLhandleARB loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines = NULL, S32 texture_index_channels = -1);
+	GLhandleARB loadShaderFile(const std::string& filename, S32 & shader_level, GLenum type, std::map<std::string, std::string>* defines = NULL, S32 texture_index_channels = -1, bool defer_compile = false);
+	// Compiles a shader object loaded with defer_compile, if it isn't yet.
+	// On failure the object is deleted and dropped from mShaderObjects.
+	BOOL compileShaderObject(GLhandleARB object);
 	void unloadShaders();
 	void unloadShaderObjects();
 
+	// On-disk cache of linked programs (GL_ARB_get_program_binary), keyed by
+	// LLGLSLShader::getProgramBinaryKey().  loadProgramBinary() returns true if
+	// the program was restored and linked; on a miss it flags the program so
+	// its binary can be read back by saveProgramBinary() once it is linked.
+	bool useProgramBinaryCache() const;
+	bool loadProgramBinary(GLhandleARB program, const std::string& key);
+	void saveProgramBinary(GLhandleARB program, const std::string& key);
+	// Deletes the cached binaries the current driver can't load.
+	void pruneProgramBinaryCache();
+
 	// Implemented in the application to actually point to the shader directory.
 	virtual std::string getShaderDirPrefix(void) = 0; // Pure Virtual
 
@@ -245,13 +258,15 @@ DISPLAY_GAMMA,
 public:
 	struct CachedObjectInfo
 	{
-		CachedObjectInfo(GLhandleARB handle, U32 level, GLenum type, U32 texture_index_channels, std::map<std::string,std::string> *definitions) : 
-			mHandle(handle), mLevel(level), mType(type), mIndexChannels(texture_index_channels), mDefinitions(definitions ? *definitions : std::map<std::string,std::string>()){}
+		CachedObjectInfo(GLhandleARB handle, U32 level, GLenum type, U32 texture_index_channels, std::map<std::string,std::string> *definitions, const std::string& source_hash, bool compiled) : 
+			mHandle(handle), mLevel(level), mType(type), mIndexChannels(texture_index_channels), mDefinitions(definitions ? *definitions : std::map<std::string,std::string>()), mSourceHash(source_hash), mCompiled(compiled){}
 		GLhandleARB mHandle;	//Actual handle of the opengl shader object.
 		U32 mLevel;				//Level /might/ not be needed, but it's stored to ensure there's no change in behavior.
 		GLenum mType;			//GL_VERTEX_SHADER_ARB or GL_FRAGMENT_SHADER_ARB. Tracked because some utility shaders can be loaded as both types (carefully).
 		U32 mIndexChannels;     //LLShaderFeatures::mIndexedTextureChannels
 		std::map<std::string,std::string> mDefinitions;
+		std::string mSourceHash;	//MD5 of the preprocessed source, part of the program binary cache key.
+		bool mCompiled;			//False until compileShaderObject() if loaded with defer_compile.
 	};
 	// Map of shader names to compiled
 	std::multimap<std::string, CachedObjectInfo > mShaderObjects;	//Singu Note: Packing more info here. Doing such provides capability to skip unneeded duplicate loading..
@@ -267,6 +282,10 @@ public:
 	//preprocessor definitions (name/value)
 	std::map<std::string, std::string> mDefinitions;
 
+	//programs restored from / linked and written to the program binary cache
+	U32 mProgramBinaryHits;
+	U32 mProgramBinaryMisses;
+
 protected:
 	void cleanupShaderSources();
 
@@ -88,6 +88,9 @@ LLVBOPool LLVertexBuffer::sDynamicVBOPool(GL_DYNAMIC_DRAW_ARB, GL_ARRAY_BUFFER_A
 LLVBOPool LLVertexBuffer::sStreamIBOPool(GL_STREAM_DRAW_ARB, GL_ELEMENT_ARRAY_BUFFER_ARB);
 LLVBOPool LLVertexBuffer::sDynamicIBOPool(GL_DYNAMIC_DRAW_ARB, GL_ELEMENT_ARRAY_BUFFER_ARB);
 
+LLVBOSuballocator LLVertexBuffer::sStaticVBOSuballocator(GL_ARRAY_BUFFER_ARB);
+LLVBOSuballocator LLVertexBuffer::sStaticIBOSuballocator(GL_ELEMENT_ARRAY_BUFFER_ARB);
+
 U64 LLVBOPool::sBytesPooled = 0;
 U64 LLVBOPool::sIndexBytesPooled = 0;
 std::vector<U32> LLVBOPool::sPendingDeletions;
@@ -108,6 +111,7 @@ bool LLVertexBuffer::sEnableVBOs = true;
 U32 LLVertexBuffer::sGLRenderBuffer = 0;
 U32 LLVertexBuffer::sGLRenderArray = 0;
 U32 LLVertexBuffer::sGLRenderIndices = 0;
+const LLVertexBuffer* LLVertexBuffer::sGLRenderSetup = nullptr;
 U32 LLVertexBuffer::sLastMask = 0;
 bool LLVertexBuffer::sVBOActive = false;
 bool LLVertexBuffer::sIBOActive = false;
@@ -117,6 +121,7 @@ bool LLVertexBuffer::sMapped = false;
 bool LLVertexBuffer::sUseStreamDraw = true;
 bool LLVertexBuffer::sUseVAO = false;
 bool LLVertexBuffer::sPreferStreamDraw = false;
+bool LLVertexBuffer::sUseSuballocation = true;
 LLVertexBuffer* LLVertexBuffer::sUtilityBuffer = nullptr;
 
 static std::vector<U32> sActiveBufferNames;
@@ -259,7 +264,7 @@ volatile U8* LLVBOPool::allocate(U32& name, U32 size, U32 seed)
 		if (LLVertexBuffer::sDisableVBOMapping || mUsage != GL_DYNAMIC_DRAW_ARB)
 		{
 			glBufferDataARB(mType, size, nullptr, mUsage);
-			ret = (U8*)ll_aligned_malloc<64>(size);
+			ret = (U8*)LLSizeClassAllocator::allocate(size, 64, LLSizeClassAllocator::VERTEX_BUFFER);
 		}
 		else
 		{ //always use a true hint of static draw when allocating non-client-backed buffers
@@ -315,7 +320,7 @@ void LLVBOPool::release(U32 name, volatile U8* buffer, U32 size)
 	llassert(vbo_block_size(size) == size);
 
 	deleteBuffer(name);
-	ll_aligned_free<64>((U8*) buffer);
+	LLSizeClassAllocator::free((U8*) buffer);
 
 	if (mType == GL_ARRAY_BUFFER_ARB)
 	{
@@ -392,7 +397,7 @@ void LLVBOPool::cleanup()
 			
 			if (r.mClientData)
 			{
-				ll_aligned_free<64>((void*) r.mClientData);
+				LLSizeClassAllocator::free((void*) r.mClientData);
 			}
 
 			l.pop_front();
@@ -417,6 +422,223 @@ void LLVBOPool::cleanup()
 	deleteReleasedBuffers();
 }
 
+//============================================================================
+
+LLVBOSuballocator::LLVBOSuballocator(U32 vboType)
+: mType(vboType), mUsedBytes(0), mAllocationCount(0)
+{
+}
+
+void LLVBOSuballocator::addFreeRange(Slab& slab, U32 offset, U32 size)
+{
+	slab.mFreeByOffset[offset] = size;
+	slab.mFreeBySize.emplace(size, offset);
+}
+
+void LLVBOSuballocator::removeFreeRange(Slab& slab, std::map<U32, U32>::iterator range)
+{
+	auto by_size = slab.mFreeBySize.equal_range(range->second);
+	for (auto iter = by_size.first; iter != by_size.second; ++iter)
+	{
+		if (iter->second == range->first)
+		{
+			slab.mFreeBySize.erase(iter);
+			break;
+		}
+	}
+	slab.mFreeByOffset.erase(range);
+}
+
+bool LLVBOSuballocator::allocate(U32& name, U32& offset, U32 size)
+{
+	llassert(size % ALIGNMENT == 0);
+
+	if (size == 0 || size > MAX_ALLOCATION)
+	{
+		return false;
+	}
+
+	//best fit over all slabs, so small buffers fill the holes left by released ones
+	Slab* best_slab = nullptr;
+	std::multimap<U32, U32>::iterator best;
+	for (Slab& slab : mSlabs)
+	{
+		auto iter = slab.mFreeBySize.lower_bound(size);
+		if (iter != slab.mFreeBySize.end() && (!best_slab || iter->first < best->first))
+		{
+			best_slab = &slab;
+			best = iter;
+			if (iter->first == size)
+			{
+				break;
+			}
+		}
+	}
+
+	if (!best_slab)
+	{
+		Slab slab;
+		slab.mGLName = 0;
+		slab.mUsed = 0;
+		glGenBuffersARB(1, &slab.mGLName);
+
+		//binding the element array buffer would change whatever VAO is bound
+		LLVertexBuffer::unbind();
+		glBindBufferARB(mType, slab.mGLName);
+		glBufferDataARB(mType, SLAB_SIZE, nullptr, GL_STATIC_DRAW_ARB);
+		glBindBufferARB(mType, 0);
+
+		if (mType == GL_ARRAY_BUFFER_ARB)
+		{
+			LLVertexBuffer::sAllocatedBytes += SLAB_SIZE;
+		}
+		else
+		{
+			LLVertexBuffer::sAllocatedIndexBytes += SLAB_SIZE;
+		}
+
+		addFreeRange(slab, 0, SLAB_SIZE);
+		mSlabs.push_back(slab);
+
+		best_slab = &mSlabs.back();
+		best = best_slab->mFreeBySize.begin();
+	}
+
+	U32 range_offset = best->second;
+	U32 range_size = best->first;
+
+	removeFreeRange(*best_slab, best_slab->mFreeByOffset.find(range_offset));
+	if (range_size > size)
+	{
+		addFreeRange(*best_slab, range_offset + size, range_size - size);
+	}
+
+	best_slab->mUsed += size;
+	mUsedBytes += size;
+	++mAllocationCount;
+
+	name = best_slab->mGLName;
+	offset = range_offset;
+	return true;
+}
+
+void LLVBOSuballocator::release(U32 name, U32 offset, U32 size)
+{
+	for (std::vector<Slab>::iterator slab = mSlabs.begin(); slab != mSlabs.end(); ++slab)
+	{
+		if (slab->mGLName != name)
+		{
+			continue;
+		}
+
+		llassert(slab->mUsed >= size);
+		slab->mUsed -= size;
+		mUsedBytes -= size;
+		--mAllocationCount;
+
+		//merge with the free ranges on either side
+		auto next = slab->mFreeByOffset.lower_bound(offset);
+		if (next != slab->mFreeByOffset.end() && next->first == offset + size)
+		{
+			size += next->second;
+			removeFreeRange(*slab, next);
+		}
+
+		auto prev = slab->mFreeByOffset.lower_bound(offset);
+		if (prev != slab->mFreeByOffset.begin())
+		{
+			--prev;
+			if (prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				size += prev->second;
+				removeFreeRange(*slab, prev);
+			}
+		}
+
+		addFreeRange(*slab, offset, size);
+
+		if (slab->mUsed == 0 && mSlabs.size() > 1)
+		{ //keep one slab around so a single buffer coming and going doesn't churn GL names
+			if (LLVertexBuffer::sGLRenderBuffer == name || LLVertexBuffer::sGLRenderIndices == name)
+			{
+				LLVertexBuffer::unbind();
+			}
+			LLVBOPool::sPendingDeletions.emplace_back(name);
+
+			if (mType == GL_ARRAY_BUFFER_ARB)
+			{
+				LLVertexBuffer::sAllocatedBytes -= SLAB_SIZE;
+			}
+			else
+			{
+				LLVertexBuffer::sAllocatedIndexBytes -= SLAB_SIZE;
+			}
+
+			mSlabs.erase(slab);
+		}
+		return;
+	}
+
+	LL_WARNS() << "Released range " << offset << ":" << size << " of unknown buffer " << name << LL_ENDL;
+}
+
+void LLVBOSuballocator::cleanup()
+{
+	for (const Slab& slab : mSlabs)
+	{
+		if (LLVertexBuffer::sGLRenderBuffer == slab.mGLName || LLVertexBuffer::sGLRenderIndices == slab.mGLName)
+		{
+			LLVertexBuffer::unbind();
+		}
+		LLVBOPool::sPendingDeletions.emplace_back(slab.mGLName);
+
+		if (mType == GL_ARRAY_BUFFER_ARB)
+		{
+			LLVertexBuffer::sAllocatedBytes -= SLAB_SIZE;
+		}
+		else
+		{
+			LLVertexBuffer::sAllocatedIndexBytes -= SLAB_SIZE;
+		}
+	}
+
+	mSlabs.clear();
+	mUsedBytes = 0;
+	mAllocationCount = 0;
+	LLVBOPool::deleteReleasedBuffers();
+}
+
+U32 LLVBOSuballocator::getFreeRangeCount() const
+{
+	U32 count = 0;
+	for (const Slab& slab : mSlabs)
+	{
+		count += slab.mFreeByOffset.size();
+	}
+	return count;
+}
+
+F32 LLVBOSuballocator::getFragmentation() const
+{
+	U64 free_bytes = 0;
+	U32 largest = 0;
+	for (const Slab& slab : mSlabs)
+	{
+		free_bytes += SLAB_SIZE - slab.mUsed;
+		if (!slab.mFreeBySize.empty())
+		{
+			largest = llmax(largest, slab.mFreeBySize.rbegin()->first);
+		}
+	}
+
+	if (free_bytes == 0)
+	{
+		return 0.f;
+	}
+	return 1.f - (F32) largest / (F32) free_bytes;
+}
+
 
 //NOTE: each component must be AT LEAST 4 bytes in size to avoid a performance penalty on AMD hardware
 S32 LLVertexBuffer::sTypeSize[LLVertexBuffer::TYPE_MAX] =
@@ -981,6 +1203,7 @@ void LLVertexBuffer::unbind()
 
 	sGLRenderBuffer = 0;
 	sGLRenderIndices = 0;
+	sGLRenderSetup = nullptr;
 
 	setupClientArrays(0);
 }
@@ -994,6 +1217,8 @@ void LLVertexBuffer::cleanupClass()
 	sDynamicIBOPool.cleanup();
 	sStreamVBOPool.cleanup();
 	sDynamicVBOPool.cleanup();
+	sStaticVBOSuballocator.cleanup();
+	sStaticIBOSuballocator.cleanup();
 	//clean_validate_buffers();
 
 	if (!sAvailableVAOName.empty())
@@ -1072,6 +1297,9 @@ LLVertexBuffer::LLVertexBuffer(U32 typemask, S32 usage) :
 	mIndexLocked(false),
 	mFinal(false),
 	mEmpty(true),
+	mStaticDraw(usage == GL_STATIC_DRAW_ARB),
+	mSuballocatedVertices(false),
+	mSuballocatedIndices(false),
 	mMappable(false),
 	mFence(nullptr)
 {
@@ -1146,6 +1374,11 @@ LLVertexBuffer::~LLVertexBuffer()
 
 	sCount--;
 
+	if (sGLRenderSetup == this)
+	{
+		sGLRenderSetup = nullptr;
+	}
+
 	if (mFence)
 	{
 		delete mFence;
@@ -1185,8 +1418,33 @@ void LLVertexBuffer::waitFence() const
 
 //----------------------------------------------------------------------------
 
+bool LLVertexBuffer::canSuballocate() const
+{
+	return sUseSuballocation && mStaticDraw && useVBOs() && !mMappable;
+}
+
 void LLVertexBuffer::genBuffer(U32 size)
 {
+	if (canSuballocate())
+	{
+		mSize = (size + LLVBOSuballocator::ALIGNMENT - 1) & ~(LLVBOSuballocator::ALIGNMENT - 1);
+
+		U32 offset = 0;
+		if (sStaticVBOSuballocator.allocate(mGLBuffer, offset, mSize))
+		{
+			mAlignedOffset = offset;
+			mSuballocatedVertices = true;
+			mMappedData = (U8*) LLSizeClassAllocator::allocate(mSize, 64, LLSizeClassAllocator::VERTEX_BUFFER);
+			if (!mMappedData)
+			{
+				LL_ERRS() << "mMappedData allocation failedd" << LL_ENDL;
+			}
+
+			sGLCount++;
+			return;
+		}
+	}
+
 	mSize = vbo_block_size(size);
 
 	if (mUsage == GL_STREAM_DRAW_ARB)
@@ -1207,6 +1465,26 @@ void LLVertexBuffer::genBuffer(U32 size)
 
 void LLVertexBuffer::genIndices(U32 size)
 {
+	if (canSuballocate())
+	{
+		mIndicesSize = (size + LLVBOSuballocator::ALIGNMENT - 1) & ~(LLVBOSuballocator::ALIGNMENT - 1);
+
+		U32 offset = 0;
+		if (sStaticIBOSuballocator.allocate(mGLIndices, offset, mIndicesSize))
+		{
+			mAlignedIndexOffset = offset;
+			mSuballocatedIndices = true;
+			mMappedIndexData = (U8*) LLSizeClassAllocator::allocate(mIndicesSize, 64, LLSizeClassAllocator::VERTEX_BUFFER);
+			if (!mMappedIndexData)
+			{
+				LL_ERRS() << "mMappedIndexData allocation failedd" << LL_ENDL;
+			}
+
+			sGLCount++;
+			return;
+		}
+	}
+
 	mIndicesSize = vbo_block_size(size);
 
 	if (mUsage == GL_STREAM_DRAW_ARB)
@@ -1227,7 +1505,14 @@ void LLVertexBuffer::genIndices(U32 size)
 
 void LLVertexBuffer::releaseBuffer()
 {
-	if (mUsage == GL_STREAM_DRAW_ARB)
+	if (mSuballocatedVertices)
+	{
+		sStaticVBOSuballocator.release(mGLBuffer, mAlignedOffset, mSize);
+		LLSizeClassAllocator::free((U8*) mMappedData);
+		mSuballocatedVertices = false;
+		mAlignedOffset = 0;
+	}
+	else if (mUsage == GL_STREAM_DRAW_ARB)
 	{
 		sStreamVBOPool.release(mGLBuffer, mMappedData, mSize);
 	}
@@ -1239,12 +1524,24 @@ void LLVertexBuffer::releaseBuffer()
 	mGLBuffer = 0;
 	mMappedData = nullptr;
 
+	if (sGLRenderSetup == this)
+	{ //another buffer may reuse the same name with different pointers
+		sGLRenderSetup = nullptr;
+	}
+
 	sGLCount--;
 }
 
 void LLVertexBuffer::releaseIndices()
 {
-	if (mUsage == GL_STREAM_DRAW_ARB)
+	if (mSuballocatedIndices)
+	{
+		sStaticIBOSuballocator.release(mGLIndices, mAlignedIndexOffset, mIndicesSize);
+		LLSizeClassAllocator::free((U8*) mMappedIndexData);
+		mSuballocatedIndices = false;
+		mAlignedIndexOffset = 0;
+	}
+	else if (mUsage == GL_STREAM_DRAW_ARB)
 	{
 		sStreamIBOPool.release(mGLIndices, mMappedIndexData, mIndicesSize);
 	}
@@ -1284,7 +1581,7 @@ void LLVertexBuffer::createGLBuffer(U32 size)
 	{
 		static int gl_buffer_idx = 0;
 		mGLBuffer = ++gl_buffer_idx;
-		mMappedData = (U8*)ll_aligned_malloc_16(size);
+		mMappedData = (U8*)LLSizeClassAllocator::allocate(size, 16, LLSizeClassAllocator::VERTEX_BUFFER);
 		mSize = size;
 	}
 }
@@ -1317,7 +1614,7 @@ void LLVertexBuffer::createGLIndices(U32 size)
 	}
 	else
 	{
-		mMappedIndexData = (U8*)ll_aligned_malloc_16(size);
+		mMappedIndexData = (U8*)LLSizeClassAllocator::allocate(size, 16, LLSizeClassAllocator::VERTEX_BUFFER);
 		static int gl_buffer_idx = 0;
 		mGLIndices = ++gl_buffer_idx;
 		mIndicesSize = size;
@@ -1334,7 +1631,7 @@ void LLVertexBuffer::destroyGLBuffer()
 		}
 		else
 		{
-			ll_aligned_free_16((void*) mMappedData);
+			LLSizeClassAllocator::free((void*) mMappedData);
 			mMappedData = nullptr;
 			mEmpty = true;
 		}
@@ -1354,7 +1651,7 @@ void LLVertexBuffer::destroyGLIndices()
 		}
 		else
 		{
-			ll_aligned_free_16((void*) mMappedIndexData);
+			LLSizeClassAllocator::free((void*) mMappedIndexData);
 			mMappedIndexData = nullptr;
 			mEmpty = true;
 		}
@@ -1376,6 +1673,11 @@ void LLVertexBuffer::updateNumVerts(S32 nverts)
 
 	U32 needed_size = (U32)calcOffsets(mTypeMask, mOffsets, nverts);
 
+	if (sGLRenderSetup == this)
+	{ //offsets may have moved
+		sGLRenderSetup = nullptr;
+	}
+
 	if (needed_size > (U32)mSize || needed_size <= (U32)mSize/2)
 	{
 		createGLBuffer(needed_size);
@@ -1528,13 +1830,13 @@ void LLVertexBuffer::setupVertexArray()
 				//glVertexattribIPointer requires GLSL 1.30 or later
 				if (gGLManager.mGLSLVersionMajor > 1 || gGLManager.mGLSLVersionMinor >= 30)
 				{
-					glVertexAttribIPointer(i, attrib_size[i], attrib_type[i], sTypeSize[i], reinterpret_cast<void*>(static_cast<intptr_t>(mOffsets[i]))); 
+					glVertexAttribIPointer(i, attrib_size[i], attrib_type[i], sTypeSize[i], reinterpret_cast<void*>(static_cast<intptr_t>(mAlignedOffset + mOffsets[i]))); 
 				}
 #endif
 			}
 			else
 			{
-				glVertexAttribPointerARB(i, attrib_size[i], attrib_type[i], attrib_normalized[i], sTypeSize[i], reinterpret_cast<void*>(static_cast<intptr_t>(mOffsets[i])));
+				glVertexAttribPointerARB(i, attrib_size[i], attrib_type[i], attrib_normalized[i], sTypeSize[i], reinterpret_cast<void*>(static_cast<intptr_t>(mAlignedOffset + mOffsets[i])));
 			}
 		}
 		else
@@ -1998,7 +2300,26 @@ void LLVertexBuffer::unmapBuffer()
 		bindGLBuffer();
 		updated_all = mIndexLocked; //both vertex and index buffers done updating
 
-		if(!mMappable)
+		if (mSuballocatedVertices)
+		{ //never orphan a shared slab, only replace this buffer's range of it
+			stop_glerror();
+			if (!mMappedVertexRegions.empty())
+			{
+				for (U32 i = 0; i < mMappedVertexRegions.size(); ++i)
+				{
+					const MappedRegion& region = mMappedVertexRegions[i];
+					glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, mAlignedOffset + region.mOffset, region.mLength, (U8*)mMappedData + region.mOffset);
+				}
+
+				mMappedVertexRegions.clear();
+			}
+			else
+			{
+				glBufferSubDataARB(GL_ARRAY_BUFFER_ARB, mAlignedOffset, getSize(), (U8*) mMappedData);
+			}
+			stop_glerror();
+		}
+		else if(!mMappable)
 		{
 			if (!mMappedVertexRegions.empty())
 			{
@@ -2075,7 +2396,26 @@ void LLVertexBuffer::unmapBuffer()
 	{
 		//LL_RECORD_BLOCK_TIME(FTM_IBO_UNMAP);
 		bindGLIndices();
-		if(!mMappable)
+		if (mSuballocatedIndices)
+		{
+			stop_glerror();
+			if (!mMappedIndexRegions.empty())
+			{
+				for (U32 i = 0; i < mMappedIndexRegions.size(); ++i)
+				{
+					const MappedRegion& region = mMappedIndexRegions[i];
+					glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mAlignedIndexOffset + region.mOffset, region.mLength, (U8*)mMappedIndexData + region.mOffset);
+				}
+
+				mMappedIndexRegions.clear();
+			}
+			else
+			{
+				glBufferSubDataARB(GL_ELEMENT_ARRAY_BUFFER_ARB, mAlignedIndexOffset, getIndicesSize(), (U8*) mMappedIndexData);
+			}
+			stop_glerror();
+		}
+		else if(!mMappable)
 		{
 			if (!mMappedIndexRegions.empty())
 			{
@@ -2417,7 +2757,9 @@ void LLVertexBuffer::setBuffer(U32 data_mask)
 			const bool bindBuffer = bindGLBuffer();
 			const bool bindIndices = bindGLIndices();
 			
-			setup = setup || bindBuffer || bindIndices;
+			//buffers suballocated from one slab share a GL name, so a bind alone
+			//doesn't tell whether the pointers are still this buffer's
+			setup = setup || bindBuffer || bindIndices || sGLRenderSetup != this;
 		}
 
 		if (gDebugGL && !mGLArray)
@@ -2505,6 +2847,7 @@ void LLVertexBuffer::setBuffer(U32 data_mask)
 		if (data_mask && setup)
 		{
 			setupVertexBuffer(data_mask); // subclass specific setup (virtual function)
+			sGLRenderSetup = this;
 			sSetCount++;
 		}
 	}
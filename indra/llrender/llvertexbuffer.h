@@ -37,6 +37,7 @@
 #include <set>
 #include <vector>
 #include <list>
+#include <map>
 
 #define LL_MAX_VERTEX_ATTRIB_LOCATION 64
 
@@ -94,6 +95,57 @@ public:
 
 };
 
+//============================================================================
+// ranges inside a few large shared buffers, for static geometry
+//
+// Each slab is one GL buffer of SLAB_SIZE bytes.  Free space is kept per slab
+// both by offset (to merge neighbours on release) and by size (for a best fit
+// on allocation).  Slabs that become empty are deleted, except the last one.
+class LLVBOSuballocator
+{
+public:
+	static const U32 SLAB_SIZE = 4 * 1024 * 1024;
+	static const U32 MAX_ALLOCATION = SLAB_SIZE / 4; // larger buffers get a GL buffer of their own
+	static const U32 ALIGNMENT = 64;
+
+	LLVBOSuballocator(U32 vboType);
+
+	const U32 mType;
+
+	//find size bytes in a slab, creating one if needed
+	//returns false if size is larger than MAX_ALLOCATION
+	bool allocate(U32& name, U32& offset, U32 size);
+
+	//size MUST be the size provided to allocate that returned the given name and offset
+	void release(U32 name, U32 offset, U32 size);
+
+	//destroy all slabs
+	void cleanup();
+
+	U32 getSlabCount() const				{ return mSlabs.size(); }
+	U64 getReservedBytes() const			{ return (U64) mSlabs.size() * SLAB_SIZE; }
+	U64 getUsedBytes() const				{ return mUsedBytes; }
+	U32 getAllocationCount() const			{ return mAllocationCount; }
+	U32 getFreeRangeCount() const;
+	//1 - (largest free range / free bytes); 0 means all free space is in one range
+	F32 getFragmentation() const;
+
+private:
+	struct Slab
+	{
+		U32 mGLName;
+		U32 mUsed;
+		std::map<U32, U32> mFreeByOffset;		// offset -> size
+		std::multimap<U32, U32> mFreeBySize;	// size -> offset
+	};
+
+	void addFreeRange(Slab& slab, U32 offset, U32 size);
+	void removeFreeRange(Slab& slab, std::map<U32, U32>::iterator range);
+
+	std::vector<Slab> mSlabs;
+	U64 mUsedBytes;
+	U32 mAllocationCount;
+};
 
 //============================================================================
 // base class 
@@ -129,12 +181,16 @@ public:
 	static LLVBOPool sStreamIBOPool;
 	static LLVBOPool sDynamicIBOPool;
 
+	static LLVBOSuballocator sStaticVBOSuballocator;
+	static LLVBOSuballocator sStaticIBOSuballocator;
+
 	static std::vector<U32> sAvailableVAOName;
 	static U32 sCurVAOName;
 
 	static bool	sUseStreamDraw;
 	static bool sUseVAO;
 	static bool	sPreferStreamDraw;
+	static bool sUseSuballocation;
 
 	static void seedPools();
 
@@ -207,6 +263,7 @@ protected:
 	virtual void setupVertexBuffer(U32 data_mask); // pure virtual, called from mapBuffer()
 	void setupVertexArray();
 	
+	bool	canSuballocate() const;
 	void	genBuffer(U32 size);
 	void	genIndices(U32 size);
 	bool	bindGLBuffer(bool force_bind = false);
@@ -315,6 +372,9 @@ protected:
 	U32		mIndexLocked : 1;			// if true, index buffer is being or has been written to in client memory
 	U32		mFinal : 1;			// if true, buffer can not be mapped again
 	U32		mEmpty : 1;			// if true, client buffer is empty (or NULL). Old values have been discarded.	
+	U32		mStaticDraw : 1;	// if true, created for GL_STATIC_DRAW and may live in a shared slab
+	U32		mSuballocatedVertices : 1;	// if true, mGLBuffer is a shared slab and mAlignedOffset is this buffer's range in it
+	U32		mSuballocatedIndices : 1;	// if true, mGLIndices is a shared slab and mAlignedIndexOffset is this buffer's range in it
 	
 	mutable bool	mMappable;     // if true, use memory mapping to upload data (otherwise doublebuffer and use glBufferSubData)
 
@@ -344,6 +404,7 @@ public:
 	static U32 sGLRenderBuffer;
 	static U32 sGLRenderArray;
 	static U32 sGLRenderIndices;
+	static const LLVertexBuffer* sGLRenderSetup; // buffer the current attribute pointers were set up for
 	static bool sVBOActive;
 	static bool sIBOActive;
 	static U32 sLastMask;
@@ -30,6 +30,7 @@
 #include "llscrolllistctrl.h"
 
 #include <algorithm>
+#include <set>
 
 #include "llstl.h"
 #include "llboost.h"
@@ -2493,6 +2494,56 @@ void LLScrollListCtrl::updateSort() const
 	}
 }
 
+void LLScrollListCtrl::updateSortPositions(const std::vector<LLScrollListItem*>& items)
+{
+	if (!hasSortOrder() || items.empty())
+	{
+		return;
+	}
+
+	// Past a point, one stable sort beats removing and reinserting every item.
+	if (items.size() * 4 > mItemList.size())
+	{
+		setNeedsSort();
+		updateSort();
+		return;
+	}
+
+	std::set<LLScrollListItem*> moved(items.begin(), items.end());
+	mItemList.erase(std::remove_if(mItemList.begin(), mItemList.end(),
+								   [&moved](LLScrollListItem* item) { return moved.count(item) != 0; }),
+					mItemList.end());
+
+	SortScrollListItem comparator(mSortColumns, mSortCallback);
+	for (std::set<LLScrollListItem*>::const_iterator iter = moved.begin(); iter != moved.end(); ++iter)
+	{
+		mItemList.insert(std::upper_bound(mItemList.begin(), mItemList.end(), *iter, comparator), *iter);
+	}
+	mSorted = true;
+}
+
+void LLScrollListCtrl::setCell(LLScrollListItem* item, const LLScrollListCell::Params& cell_p)
+{
+	LLScrollListColumn* columnp = getColumn(cell_p.column);
+	if (!item || !columnp)
+	{
+		return;
+	}
+
+	LLScrollListCell::Params p = cell_p;
+	if (!p.width.isProvided())
+	{
+		p.width = columnp->getWidth();
+	}
+	p.font_halign = columnp->mFontAlignment;
+
+	if (LLScrollListCell* cell = LLScrollListCell::create(p))
+	{
+		item->setColumn(columnp->mIndex, cell);
+		setNeedsSortColumn(columnp->mIndex);
+	}
+}
+
 // for one-shot sorts, does not save sort column/order
 void LLScrollListCtrl::sortOnce(S32 column, BOOL ascending)
 {
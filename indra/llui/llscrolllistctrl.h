@@ -368,6 +368,14 @@ public:
 	// sorts a list without affecting the permanent sort order (so further list insertions can be unsorted, for example)
 	void			sortOnce(S32 column, BOOL ascending);
 
+	// Moves items to where the sort order puts them. Cheaper than a full sort when only a few
+	// items were added or edited in place; the rest of the list must already be sorted.
+	void			updateSortPositions(const std::vector<LLScrollListItem*>& items);
+
+	// Replaces one cell of an existing item, as addRow() would have created it.
+	// Flags the list for resorting if the cell is in a sort column.
+	void			setCell(LLScrollListItem* item, const LLScrollListCell::Params& cell_p);
+
 	// manually call this whenever editing list items in place to flag need for resorting
 	void			setNeedsSort(bool val = true) { mSorted = !val; }
 	void			setNeedsSortColumn(S32 col)
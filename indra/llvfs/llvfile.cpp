@@ -124,7 +124,7 @@ BOOL LLVFile::read(U8 *buffer, S32 bytes, BOOL async, F32 priority)
 }
 
 //static
-U8* LLVFile::readFile(LLVFS *vfs, LLPrivateMemoryPool* poolp, const LLUUID &uuid, LLAssetType::EType type, S32* bytes_read)
+U8* LLVFile::readFile(LLVFS *vfs, U32 subsystem, const LLUUID &uuid, LLAssetType::EType type, S32* bytes_read)
 {
 	U8 *data;
 	LLVFile file(vfs, uuid, type, LLVFile::READ);
@@ -136,12 +136,12 @@ U8* LLVFile::readFile(LLVFS *vfs, LLPrivateMemoryPool* poolp, const LLUUID &uuid
 	}
 	else
 	{
-		data = (U8*)ALLOCATE_MEM(poolp, file_size);
+		data = (U8*)ALLOCATE_MEM(subsystem, file_size);
 		file.read(data, file_size);	/* Flawfinder: ignore */ 
 		
 		if (file.getLastBytesRead() != (S32)file_size)
 		{
-			FREE_MEM(poolp, data);
+			FREE_MEM(subsystem, data);
 			data = NULL;
 			file_size = 0;
 		}
@@ -83,6 +83,7 @@ void AIServiceBar::draw()
   int event_polls;
   int established_connections;
   int concurrent_connections;
+  bool multiplexed;
   size_t bandwidth;
   {
 	PerService_rat per_service_r(*mPerService);
@@ -92,6 +93,7 @@ void AIServiceBar::draw()
 	event_polls = per_service_r->mEventPolls;
 	established_connections = per_service_r->mEstablishedConnections;
 	concurrent_connections = per_service_r->mConcurrentConnections;
+	multiplexed = per_service_r->is_multiplexed();
 	bandwidth = per_service_r->bandwidth().truncateData(AIHTTPView::getTime_40ms());
 	cts = per_service_r->mCapabilityType;	// Not thread-safe, but we're only reading from it and only using the results to show in a debug console.
   }
@@ -150,9 +152,9 @@ void AIServiceBar::draw()
   }
   start = mHTTPView->updateColumn(mc_col, start);
 #ifdef CWDEBUG
-  text = llformat(" | %d,%d,%d/%d", total_added, event_polls, established_connections, concurrent_connections);
+  text = llformat(" | %d,%d,%d/%d%s", total_added, event_polls, established_connections, concurrent_connections, multiplexed ? " h2" : "");
 #else
-  text = llformat(" | %d/%d", total_added, concurrent_connections);
+  text = llformat(" | %d/%d%s", total_added, concurrent_connections, multiplexed ? " h2" : "");
 #endif
   LLFontGL::getFontMonospace()->renderUTF8(text, 0, start, height, text_color, LLFontGL::LEFT, LLFontGL::TOP);
   start += LLFontGL::getFontMonospace()->getWidth(text);
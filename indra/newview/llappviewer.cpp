@@ -121,6 +121,7 @@
 #include "llviewerkeyboard.h"
 #include "lllfsthread.h"
 #include "llworkerthread.h"
+#include "lljobsystem.h"
 #include "lltexturecache.h"
 #include "lltexturefetch.h"
 #include "llimageworker.h"
@@ -213,6 +214,7 @@
 #include "llviewernetwork.h"
 
 #include <random>
+#include <thread>
 
 #ifdef USE_CRASHPAD
 #pragma warning(disable:4265)
@@ -280,7 +282,7 @@ extern BOOL gRandomizeFramerate;
 extern BOOL gPeriodicSlowFrame;
 extern BOOL gDebugGL;
 
-extern void startEngineThread(void);
+extern void startEngineThread(S32 thread_count);
 extern void stopEngineThread(void);
 
 ////////////////////////////////////////////////////////////
@@ -493,6 +495,7 @@ static void settings_to_globals()
 
 	LLImageGL::sGlobalUseAnisotropic	= gSavedSettings.getBOOL("RenderAnisotropic");
 	LLImageGL::sCompressTextures		= gSavedSettings.getBOOL("RenderCompressTextures");
+	LLImageGL::sUsePixelBuffers			= gSavedSettings.getBOOL("RenderTexturePixelBuffers");
 	LLVOVolume::sLODFactor				= gSavedSettings.getF32("RenderVolumeLODFactor");
 	LLVOVolume::sDistanceFactor			= 1.f-LLVOVolume::sLODFactor * 0.1f;
 	LLVolumeImplFlexible::sUpdateFactor = gSavedSettings.getF32("RenderFlexTimeFactor");
@@ -868,7 +871,7 @@ bool LLAppViewer::init()
 	//set the max heap size.
 	initMaxHeapSize() ;
 
-	LLPrivateMemoryPoolManager::initClass((BOOL)gSavedSettings.getBOOL("MemoryPrivatePoolEnabled"), (U32)gSavedSettings.getU32("MemoryPrivatePoolSize")) ;
+	LLError::setAsyncLogging(gSavedSettings.getBOOL("AsyncLogging"));
 
 	AIEngine::setMaxCount(gSavedSettings.getU32("StateMachineMaxTime"));
 
@@ -1299,6 +1302,7 @@ static LLTrace::BlockTimerStatHandle FTM_SERVICE_CALLBACK("Callback");
 static LLTrace::BlockTimerStatHandle FTM_AGENT_AUTOPILOT("Autopilot");
 static LLTrace::BlockTimerStatHandle FTM_AGENT_UPDATE("Update");
 static LLTrace::BlockTimerStatHandle FTM_STATEMACHINE("State Machine");
+static LLTrace::BlockTimerStatHandle FTM_MAIN_THREAD_JOBS("Main Thread Jobs");
 
 bool LLAppViewer::mainLoop()
 {
@@ -1819,6 +1823,7 @@ bool LLAppViewer::cleanup()
 		LL_WARNS() << "Remaining references in the volume manager!" << LL_ENDL;
 	}
 	LLPrimitive::cleanupVolumeManager();
+	LLVolume::cleanupClass();
 
 	LL_INFOS() << "Additional Cleanup..." << LL_ENDL;
 	
@@ -1957,6 +1962,10 @@ bool LLAppViewer::cleanup()
 	delete sImageDecodeThread;
     sImageDecodeThread = nullptr;
 
+	// After everything that could still hand it jobs
+	delete gJobSystem;
+	gJobSystem = nullptr;
+
 
 
 	LL_INFOS() << "Cleaning up Media and Textures" << LL_ENDL;
@@ -2029,13 +2038,16 @@ bool LLAppViewer::cleanup()
 
 	LLMainLoopRepeater::instance().stop();
 
-	//release all private memory pools.
-	LLPrivateMemoryPoolManager::destroyClass() ;
+	//give the main thread's cached image, volume and vertex buffer blocks back.
+	LLSizeClassAllocator::releaseThreadCache();
 
 	ll_close_fail_log();
 
 	LLError::LLCallStacks::cleanup();
 
+	// write out whatever the log sink still has queued
+	LLError::setAsyncLogging(false);
+
 	removeMarkerFiles();
 
 	MEM_TRACK_RELEASE
@@ -2080,8 +2092,17 @@ bool LLAppViewer::initThreads()
 		LLWatchdog::getInstance()->init(watchdog_killer_callback);
 	}
 
-	// State machine thread.
-	startEngineThread();
+	// Workers shared by the CPU-bound work of the other subsystems, one per
+	// core besides the main thread's unless set otherwise.
+	S32 job_threads = gSavedSettings.getU32("JobSystemThreads");
+	if (job_threads == 0)
+	{
+		job_threads = (S32)std::thread::hardware_concurrency() - 1;
+	}
+	gJobSystem = new LLJobSystem("Job", llclamp(job_threads, 1, 32));
+
+	// State machine threads.
+	startEngineThread(gSavedSettings.getU32("StateMachineThreads"));
 
 	AICurlInterface::startCurlThread(&gSavedSettings);
 
@@ -2092,6 +2113,10 @@ bool LLAppViewer::initThreads()
 
 	// Image decoding
 	LLAppViewer::sImageDecodeThread = new LLImageDecodeThread(enable_threads && true);
+	LLAppViewer::sImageDecodeThread->setResumable(gSavedSettings.getBOOL("TextureResumableDecode"));
+	LLImageJ2C::setDecodeThreadCount(gSavedSettings.getU32("TextureDecodeThreads"));
+	LLImageJ2C::setDecodeCacheLimit(gSavedSettings.getU32("TextureResumableDecodeMaxMB"));
+	LLImageJ2C::setEncodeIndexed(gSavedSettings.getBOOL("IndexedJ2CUpload"));
 	LLAppViewer::sTextureCache = new LLTextureCache(enable_threads && true);
 	LLAppViewer::sTextureFetch = new LLTextureFetch(LLAppViewer::getTextureCache(),
 													sImageDecodeThread,
@@ -2650,6 +2675,7 @@ bool LLAppViewer::initConfiguration()
 	LLVolumeMgr* volume_manager = new LLVolumeMgr();
 	volume_manager->useMutex();	// LLApp and LLMutex magic must be manually enabled
 	LLPrimitive::setVolumeManager(volume_manager);
+	LLVolume::setFaceThreadCount(gSavedSettings.getU32("RenderVolumeFaceThreads"));
 
 	// Note: this is where we used to initialize gFeatureManagerp.
 
@@ -3088,6 +3114,9 @@ void LLAppViewer::handleViewerCrash()
 
 	// Close the debug file
 	pApp->writeDebugInfo(false);  //false answers the isStatic question with the least overhead.
+
+	// Get the messages still queued for the log sink into the log before the process goes away
+	LLError::flushAsyncLogging();
 }
 
 // static
@@ -4099,6 +4128,17 @@ void LLAppViewer::idle()
 		gMainThreadEngine.mainloop();
 	}
 
+	//////////////////////////////////////
+	//
+	// Complete the work of the job system
+	//
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_MAIN_THREAD_JOBS);
+		const F32 MAX_MAIN_THREAD_JOBS_TIME = 0.005f;
+		gJobSystem->runMainThreadJobs(MAX_MAIN_THREAD_JOBS_TIME);
+	}
+
 	// Must wait until both have avatar object and mute list, so poll
 	// here.
 	{
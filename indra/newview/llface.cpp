@@ -1177,32 +1177,6 @@ void push_for_transform(LLVertexBuffer* buff, U32 source_count, U32 dest_count)
 	}
 }
 static LLTrace::BlockTimerStatHandle FTM_FACE_GET_GEOM("Face Geom");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_POSITION("Position");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_NORMAL("Normal");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_TEXTURE("Texture");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_COLOR("Color");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_EMISSIVE("Emissive");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_WEIGHTS("Weights");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_TANGENT("Binormal");
-
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK("Face Feedback");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_POSITION("Feedback Position");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_NORMAL("Feedback  Normal");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_TEXTURE("Feedback  Texture");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_COLOR("Feedback  Color");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_EMISSIVE("Feedback  Emissive");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_FEEDBACK_BINORMAL("Feedback Binormal");
-
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_INDEX("Index");
-static LLTrace::BlockTimerStatHandle FTM_FACE_GEOM_INDEX_TAIL("Tail");
-static LLTrace::BlockTimerStatHandle FTM_FACE_POSITION_STORE("Pos");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEXTURE_INDEX_STORE("TexIdx");
-static LLTrace::BlockTimerStatHandle FTM_FACE_POSITION_PAD("Pad");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_DEFAULT("Default");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK("Quick");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_NO_XFORM("No Xform");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_XFORM("Xform");
-static LLTrace::BlockTimerStatHandle FTM_FACE_TEX_QUICK_PLANAR("Quick Planar");
 
 BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							   const S32 &f,
@@ -1211,6 +1185,48 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 								bool force_rebuild)
 {
 	LL_RECORD_BLOCK_TIME(FTM_FACE_GET_GEOM);
+
+	GeometryTarget target;
+	if (!prepareGeometryVolume(volume, f, force_rebuild, target))
+	{
+		return FALSE;
+	}
+
+	fillGeometryVolume(volume, f, mat_vert_in, mat_norm_in, index_offset, target);
+	applyGeometryVolume(target);
+	return TRUE;
+}
+
+LLFace::GeometryTarget::GeometryTarget()
+:	mBumpSRay(0.f, 0.f, 0.f),
+	mBumpTRay(0.f, 0.f, 0.f),
+	mColor(LLColor4U::white),
+	mGeomCount(0),
+	mTextureIndex(0),
+	mGlow(0),
+	mTexGen(LLTextureEntry::TEX_GEN_DEFAULT),
+	mDoXform(false),
+	mDoTexMat(false),
+	mNormalMapped(false),
+	mRenderDeferred(false),
+	mActive(false),
+	mTangentRotation(0.f),
+	mClearTextureAnim(false),
+	mScale(1.f, 1.f, 1.f),
+	mRebuildIndices(false),
+	mRebuildPos(false),
+	mRebuildNormal(false),
+	mRebuildTangent(false),
+	mRebuildWeights(false),
+	mRebuildColor(false),
+	mRebuildEmissive(false),
+	mRebuildTCoord(false),
+	mDoBump(false)
+{
+}
+
+BOOL LLFace::prepareGeometryVolume(const LLVolume& volume, S32 f, bool force_rebuild, GeometryTarget& target)
+{
 	llassert(verify());
 	const LLVolumeFace &vf = volume.getVolumeFace(f);
 	S32 num_vertices = (S32)vf.mNumVertices;
@@ -1252,51 +1268,42 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		}
 	}
 
-	LLStrider<LLVector3> vert;
-	LLStrider<LLVector2> tex_coords0;
-	LLStrider<LLVector2> tex_coords1;
-	LLStrider<LLVector3> norm;
-	LLStrider<LLColor4U> colors;
-	LLStrider<LLVector3> tangent;
-	LLStrider<U16> indicesp;
-	LLStrider<LLVector4a> wght;
-
 	BOOL full_rebuild = force_rebuild || mDrawablep->isState(LLDrawable::REBUILD_VOLUME);
 	
 	BOOL global_volume = mDrawablep->getVOVolume()->isVolumeGlobal();
-	LLVector3 scale;
-	if (global_volume)
-	{
-		scale.setVec(1,1,1);
-	}
-	else
+	if (!global_volume)
 	{
-		scale = mVObjp->getScale();
+		target.mScale = mVObjp->getScale();
 	}
 	
 	bool rebuild_pos = full_rebuild || mDrawablep->isState(LLDrawable::REBUILD_POSITION);
 	bool rebuild_color = full_rebuild || mDrawablep->isState(LLDrawable::REBUILD_COLOR);
-	bool rebuild_emissive = rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_EMISSIVE);
 	bool rebuild_tcoord = full_rebuild || mDrawablep->isState(LLDrawable::REBUILD_TCOORD);
-	bool rebuild_normal = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_NORMAL);
-	bool rebuild_tangent = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TANGENT);
-	bool rebuild_weights = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_WEIGHT4);
+
+	target.mRebuildIndices = full_rebuild;
+	target.mRebuildPos = rebuild_pos;
+	target.mRebuildEmissive = rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_EMISSIVE);
+	target.mRebuildTCoord = rebuild_tcoord;
+	target.mRebuildNormal = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_NORMAL);
+	target.mRebuildTangent = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TANGENT);
+	target.mRebuildWeights = rebuild_pos && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_WEIGHT4) && vf.mWeights;
 
 	const LLTextureEntry *tep = mVObjp->getTE(f);
 	const U8 bump_code = tep ? tep->getBumpmap() : 0;
 
+	//resolved here, taking the material pointer by value is not thread safe
+	LLMaterial* mat = tep ? tep->getMaterialParams().get() : NULL;
+	target.mNormalMapped = mat && mat->getNormalID().notNull();
+
 	if ( bump_code && rebuild_tcoord && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TANGENT) )
 	{
-		LLMaterial* mat = tep->getMaterialParams().get();
-		if( !mat || mat->getNormalID().isNull() )
-			rebuild_tangent = true;
+		if (!target.mNormalMapped)
+			target.mRebuildTangent = true;
 	}
 
 	BOOL is_static = mDrawablep->isStatic();
 	BOOL is_global = is_static;
 
-	LLVector3 center_sum(0.f, 0.f, 0.f);
-	
 	if (is_global)
 	{
 		setState(GLOBAL);
@@ -1306,9 +1313,83 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 		clearState(GLOBAL);
 	}
 
-	LLColor4U color = (tep ? LLColor4U(tep->getColor()) : LLColor4U::white);
+	//map every stream that will be written and make sure the volume has the
+	//tangents the fill reads, both touch state shared with other faces
+	if (target.mRebuildIndices)
+	{
+		mVertexBuffer->getIndexStrider(target.mIndices, mIndicesIndex, mIndicesCount, map_range);
+	}
+
+	if (rebuild_tcoord)
+	{
+		U8 texgen = getTextureEntry()->getTexGen();
+		if ((!LLPipeline::sRenderDeferred && bump_code) || texgen != LLTextureEntry::TEX_GEN_DEFAULT)
+		{ //bump offsets and planar texgen need binormals
+			mVObjp->getVolume()->genTangents(f);
+		}
+
+		bool do_bump = bump_code && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1);
+
+		if (mat && !do_bump)
+		{
+			do_bump  = mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1)
+					 || mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2);
+		}
+		target.mDoBump = do_bump;
+
+		mVertexBuffer->getTexCoord0Strider(target.mTexCoords[0], mGeomIndex, mGeomCount, map_range);
+		if (do_bump && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
+		{
+			mVertexBuffer->getTexCoord1Strider(target.mTexCoords[1], mGeomIndex, mGeomCount, map_range);
+		}
+		if (do_bump && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2))
+		{
+			mVertexBuffer->getTexCoord2Strider(target.mTexCoords[2], mGeomIndex, mGeomCount, map_range);
+		}
+	}
+
+	if (rebuild_pos)
+	{
+		llassert(num_vertices > 0);
+		mVertexBuffer->getVertexStrider(target.mVertices, mGeomIndex, mGeomCount, map_range);
+	}
+
+	if (target.mRebuildNormal)
+	{
+		mVertexBuffer->getNormalStrider(target.mNormals, mGeomIndex, mGeomCount, map_range);
+	}
+
+	if (target.mRebuildTangent)
+	{
+		mVertexBuffer->getTangentStrider(target.mTangents, mGeomIndex, mGeomCount, map_range);
+		mVObjp->getVolume()->genTangents(f);
+	}
+
+	if (target.mRebuildWeights)
+	{
+		mVertexBuffer->getWeight4Strider(target.mWeights, mGeomIndex, mGeomCount, map_range);
+	}
+
+	target.mRebuildColor = rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_COLOR);
+	if (target.mRebuildColor)
+	{
+		mVertexBuffer->getColorStrider(target.mColors, mGeomIndex, mGeomCount, map_range);
+	}
+
+	if (target.mRebuildEmissive)
+	{
+		mVertexBuffer->getEmissiveStrider(target.mEmissive, mGeomIndex, mGeomCount, map_range);
+	}
+
+	target.mGeomCount = mGeomCount;
+	target.mTextureIndex = mTextureIndex < 255 ? mTextureIndex : 0;
+
+	if (tep)
+	{
+		target.mColor = LLColor4U(tep->getColor());
+	}
 
-	if (rebuild_color)	// FALSE if tep == NULL
+	if (target.mRebuildColor)	// FALSE if tep == NULL
 	{ //decide if shiny goes in alpha channel of color
 
 		if(mShinyInAlpha)
@@ -1316,16 +1397,224 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			// Singu Note: Avoid casing. Store as LLColor4U.
 			static const LLColor4U shine_steps(LLColor4(0.f, .25f, .5f, 7.5f));
 			llassert(tep->getShiny() <= 3);
-			color.mV[3] = shine_steps.mV[tep->getShiny()];
+			target.mColor.mV[3] = shine_steps.mV[tep->getShiny()];
 		}
 	}
 
-	// INDICES
-	if (full_rebuild)
+	if (target.mRebuildEmissive)
+	{
+		target.mGlow = (U8) llclamp((S32) (getTextureEntry()->getGlow()*255), 0, 255);
+	}
+
+	//transform of the last texture coordinate channel the fill writes, the
+	//extents and the tangent rotation are taken from it
+	F32 last_rotation = 0.f;
+
+	if (rebuild_tcoord)
 	{
-		LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_INDEX);
-		mVertexBuffer->getIndexStrider(indicesp, mIndicesIndex, mIndicesCount, map_range);
+		prepareTexCoords(tep, bump_code, mat, target);
+
+		U32 last = 0;
+		if (target.mDoBump)
+		{
+			last = target.mTexCoords[2].get() ? 2 : (target.mTexCoords[1].get() ? 1 : 0);
+		}
+
+		const GeometryTarget::TexTransform& xf = target.mTexTransform[last];
+		F32 cos_ang = cos(xf.mRotation);
+		F32 sin_ang = sin(xf.mRotation);
+		last_rotation = xf.mRotation;
 
+		target.mTexExtents[0].setVec(0,0);
+		target.mTexExtents[1].setVec(1,1);
+		xform(target.mTexExtents[0], cos_ang, sin_ang, xf.mOffsetS, xf.mOffsetT, xf.mScaleS, xf.mScaleT);
+		xform(target.mTexExtents[1], cos_ang, sin_ang, xf.mOffsetS, xf.mOffsetT, xf.mScaleS, xf.mScaleT);
+
+		F32 es = vf.mTexCoordExtents[1].mV[0] - vf.mTexCoordExtents[0].mV[0] ;
+		F32 et = vf.mTexCoordExtents[1].mV[1] - vf.mTexCoordExtents[0].mV[1] ;
+		target.mTexExtents[0][0] *= es ;
+		target.mTexExtents[1][0] *= es ;
+		target.mTexExtents[0][1] *= et ;
+		target.mTexExtents[1][1] *= et ;
+	}
+
+	if (target.mRebuildTangent)
+	{
+		target.mTangentRotation = RAD_TO_DEG * (target.mNormalMapped ? mat->getNormalRotation() : last_rotation);
+	}
+
+	return TRUE;
+}
+
+void LLFace::prepareTexCoords(const LLTextureEntry* tep, U8 bump_code, LLMaterial* mat, GeometryTarget& target)
+{
+	target.mTexGen = getTextureEntry()->getTexGen();
+	target.mRenderDeferred = LLPipeline::sRenderDeferred;
+
+	GeometryTarget::TexTransform& xf = target.mTexTransform[0];
+	xf.mRotation = xf.mOffsetS = xf.mOffsetT = xf.mScaleS = xf.mScaleT = 0.f;
+	if (tep)
+	{
+		xf.mRotation = tep->getRotation();
+		xf.mOffsetS = tep->mOffsetS;
+		xf.mOffsetT = tep->mOffsetT;
+		xf.mScaleS = tep->mScaleS;
+		xf.mScaleT = tep->mScaleT;
+
+		target.mDoXform = cos(xf.mRotation) != 1.f ||
+						  sin(xf.mRotation) != 0.f ||
+						  xf.mOffsetS != 0.f ||
+						  xf.mOffsetT != 0.f ||
+						  xf.mScaleS != 1.f ||
+						  xf.mScaleT != 1.f;
+	}
+
+	LLVOVolume* vobj = (LLVOVolume*) (LLViewerObject*) mVObjp;
+	U8 tex_mode = vobj->mTexAnimMode;
+
+	//texture animation is in play, override specular and normal map tex coords with diffuse texcoords
+	bool tex_anim = vobj->mTextureAnimp != NULL;
+
+	if (isState(TEXTURE_ANIM))
+	{
+		if (!tex_mode)
+		{
+			target.mClearTextureAnim = true;
+		}
+		else
+		{
+			xf.mRotation = xf.mOffsetS = xf.mOffsetT = 0.f;
+			xf.mScaleS = xf.mScaleT = 1.f;
+			target.mDoXform = false;
+		}
+
+		if (getVirtualSize() >= MIN_TEX_ANIM_SIZE || isState(LLFace::RIGGED))
+		{ //don't override texture transform during tc bake
+			tex_mode = 0;
+		}
+	}
+
+	target.mDoTexMat = tex_mode && mTextureMatrix;
+	if (target.mDoTexMat)
+	{
+		target.mTextureMatrix = *mTextureMatrix;
+	}
+
+	target.mTexTransform[1] = target.mTexTransform[0];
+	if (mat && !tex_anim)
+	{
+		GeometryTarget::TexTransform& normal = target.mTexTransform[1];
+		normal.mRotation = mat->getNormalRotation();
+		mat->getNormalOffset(normal.mOffsetS, normal.mOffsetT);
+		mat->getNormalRepeat(normal.mScaleS, normal.mScaleT);
+	}
+
+	target.mTexTransform[2] = target.mTexTransform[1];
+	if (mat && !tex_anim)
+	{
+		GeometryTarget::TexTransform& specular = target.mTexTransform[2];
+		specular.mRotation = mat->getSpecularRotation();
+		mat->getSpecularOffset(specular.mOffsetS, specular.mOffsetT);
+		mat->getSpecularRepeat(specular.mScaleS, specular.mScaleT);
+	}
+
+	if (!target.mRenderDeferred)
+	{
+		target.mActive = mDrawablep->isActive();
+		if (target.mActive)
+		{
+			target.mBumpQuat = LLQuaternion(LLMatrix4(mDrawablep->getRenderMatrix().getF32ptr()));
+		}
+
+		if (bump_code)
+		{
+			F32 offset_multiple;
+			switch (bump_code)
+			{
+			case BE_NO_BUMP:
+				offset_multiple = 0.f;
+				break;
+			case BE_BRIGHTNESS:
+			case BE_DARKNESS:
+				if (mTexture[LLRender::DIFFUSE_MAP].notNull() && mTexture[LLRender::DIFFUSE_MAP]->hasGLTexture())
+				{
+					// Offset by approximately one texel
+					S32 cur_discard = mTexture[LLRender::DIFFUSE_MAP]->getDiscardLevel();
+					S32 max_size = llmax(mTexture[LLRender::DIFFUSE_MAP]->getWidth(), mTexture[LLRender::DIFFUSE_MAP]->getHeight());
+					max_size <<= cur_discard;
+					const F32 ARTIFICIAL_OFFSET = 2.f;
+					offset_multiple = ARTIFICIAL_OFFSET / (F32)max_size;
+				}
+				else
+				{
+					offset_multiple = 1.f / 256;
+				}
+				break;
+
+			default:  // Standard bumpmap textures.  Assumed to be 256x256
+				offset_multiple = 1.f / 256;
+				break;
+			}
+
+			F32 s_scale = 1.f;
+			F32 t_scale = 1.f;
+			if (tep)
+			{
+				tep->getScale(&s_scale, &t_scale);
+			}
+			// Use the nudged south when coming from above sun angle, such
+			// that emboss mapping always shows up on the upward faces of cubes when 
+			// it's noon (since a lot of builders build with the sun forced to noon).
+			LLVector3   sun_ray = gSky.mVOSkyp->mBumpSunDir;
+			LLVector3   moon_ray = gSky.getMoonDirection();
+			LLVector3& primary_light_ray = (sun_ray.mV[VZ] > 0) ? sun_ray : moon_ray;
+
+			target.mBumpSRay = offset_multiple * s_scale * primary_light_ray;
+			target.mBumpTRay = offset_multiple * t_scale * primary_light_ray;
+		}
+	}
+}
+
+void LLFace::applyGeometryVolume(const GeometryTarget& target)
+{
+	if (target.mClearTextureAnim)
+	{
+		clearState(TEXTURE_ANIM);
+	}
+
+	if (target.mRebuildTCoord)
+	{
+		mTexExtents[0] = target.mTexExtents[0];
+		mTexExtents[1] = target.mTexExtents[1];
+	}
+}
+
+void LLFace::fillGeometryVolume(const LLVolume& volume, S32 f,
+								const LLMatrix4a& mat_vert_in, const LLMatrix4a& mat_norm_in,
+								U16 index_offset, const GeometryTarget& target)
+{
+	//no fast timers or GL in here, this runs on the geometry workers
+	const LLVolumeFace &vf = volume.getVolumeFace(f);
+	S32 num_vertices = (S32)vf.mNumVertices;
+	S32 num_indices = (S32) vf.mNumIndices;
+
+	LLStrider<LLVector3> vert = target.mVertices;
+	LLStrider<LLVector2> tex_coords0 = target.mTexCoords[0];
+	LLStrider<LLVector2> tex_coords1 = target.mTexCoords[1];
+	LLStrider<LLVector3> norm = target.mNormals;
+	LLStrider<LLColor4U> colors = target.mColors;
+	LLStrider<LLVector3> tangent = target.mTangents;
+	LLStrider<U16> indicesp = target.mIndices;
+	LLStrider<LLVector4a> wght = target.mWeights;
+
+	const LLVector3& scale = target.mScale;
+	bool rebuild_tcoord = target.mRebuildTCoord;
+
+	const LLColor4U& color = target.mColor;
+
+	// INDICES
+	if (target.mRebuildIndices)
+	{
 		volatile __m128i* dst = (__m128i*) indicesp.get();
 		__m128i* src = (__m128i*) vf.mIndices;
 		__m128i offset = _mm_set1_epi16(index_offset);
@@ -1338,59 +1627,28 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			_mm_storeu_si128((__m128i*) dst++, res);
 		}
 
-		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_INDEX_TAIL);
-			U16* idx = (U16*) dst;
-
-			for (S32 i = end*8; i < num_indices; ++i)
-			{
-				*idx++ = vf.mIndices[i]+index_offset;
-			}
-		}
+		U16* idx = (U16*) dst;
 
-		if (map_range)
+		for (S32 i = end*8; i < num_indices; ++i)
 		{
-			mVertexBuffer->flush();
+			*idx++ = vf.mIndices[i]+index_offset;
 		}
 	}
 	
 	const LLMatrix4a& mat_normal = mat_norm_in;
 	
-	F32 r = 0, os = 0, ot = 0, ms = 0, mt = 0, cos_ang = 0, sin_ang = 0;
-	bool do_xform = false;
+	F32 os = 0, ot = 0, ms = 0, mt = 0, cos_ang = 0, sin_ang = 0;
 	if (rebuild_tcoord)
 	{
-		if (tep)
-		{
-			r  = tep->getRotation();
-			os = tep->mOffsetS;
-			ot = tep->mOffsetT;
-			ms = tep->mScaleS;
-			mt = tep->mScaleT;
-			cos_ang = cos(r);
-			sin_ang = sin(r);
-
-			if (cos_ang != 1.f || 
-				sin_ang != 0.f ||
-				os != 0.f ||
-				ot != 0.f ||
-				ms != 1.f ||
-				mt != 1.f)
-			{
-				do_xform = true;
-			}
-			else
-			{
-				do_xform = false;
-			}	
-		}
-		else
-		{
-			do_xform = false;
-		}
+		const GeometryTarget::TexTransform& xf = target.mTexTransform[0];
+		os = xf.mOffsetS;
+		ot = xf.mOffsetT;
+		ms = xf.mScaleS;
+		mt = xf.mScaleT;
+		cos_ang = cos(xf.mRotation);
+		sin_ang = sin(xf.mRotation);
 	}
 	
-	static LLCachedControl<bool> use_transform_feedback("RenderUseTransformFeedback", false);
 	{
 		//if it's not fullbright and has no normals, bake sunlight based on face normal
 		//bool bake_sunlight = !getTextureEntry()->getFullbright() &&
@@ -1398,145 +1656,36 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 		if (rebuild_tcoord)
 		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_TEXTURE);
 									
 			//bump setup
 			LLVector4a binormal_dir( -sin_ang, cos_ang, 0.f );
-			LLVector4a bump_s_primary_light_ray(0.f, 0.f, 0.f);
-			LLVector4a bump_t_primary_light_ray(0.f, 0.f, 0.f);
-
-			LLQuaternion bump_quat;
-
-			if (!LLPipeline::sRenderDeferred)
-			{
-				if (mDrawablep->isActive())
-				{
-					bump_quat = LLQuaternion(LLMatrix4(mDrawablep->getRenderMatrix().getF32ptr()));
-				}
-
-				if (bump_code)
-				{
-					mVObjp->getVolume()->genTangents(f);
-					F32 offset_multiple;
-					switch (bump_code)
-					{
-					case BE_NO_BUMP:
-						offset_multiple = 0.f;
-						break;
-					case BE_BRIGHTNESS:
-					case BE_DARKNESS:
-						if (mTexture[LLRender::DIFFUSE_MAP].notNull() && mTexture[LLRender::DIFFUSE_MAP]->hasGLTexture())
-						{
-							// Offset by approximately one texel
-							S32 cur_discard = mTexture[LLRender::DIFFUSE_MAP]->getDiscardLevel();
-							S32 max_size = llmax(mTexture[LLRender::DIFFUSE_MAP]->getWidth(), mTexture[LLRender::DIFFUSE_MAP]->getHeight());
-							max_size <<= cur_discard;
-							const F32 ARTIFICIAL_OFFSET = 2.f;
-							offset_multiple = ARTIFICIAL_OFFSET / (F32)max_size;
-						}
-						else
-						{
-							offset_multiple = 1.f / 256;
-						}
-						break;
-
-					default:  // Standard bumpmap textures.  Assumed to be 256x256
-						offset_multiple = 1.f / 256;
-						break;
-					}
-
-					F32 s_scale = 1.f;
-					F32 t_scale = 1.f;
-					if (tep)
-					{
-						tep->getScale(&s_scale, &t_scale);
-					}
-					// Use the nudged south when coming from above sun angle, such
-					// that emboss mapping always shows up on the upward faces of cubes when 
-					// it's noon (since a lot of builders build with the sun forced to noon).
-					LLVector3   sun_ray = gSky.mVOSkyp->mBumpSunDir;
-					LLVector3   moon_ray = gSky.getMoonDirection();
-					LLVector3& primary_light_ray = (sun_ray.mV[VZ] > 0) ? sun_ray : moon_ray;
-
-					bump_s_primary_light_ray.load3((offset_multiple * s_scale * primary_light_ray).mV);
-					bump_t_primary_light_ray.load3((offset_multiple * t_scale * primary_light_ray).mV);
-				}
-			}
-
-			U8 texgen = getTextureEntry()->getTexGen();
-			if (rebuild_tcoord && texgen != LLTextureEntry::TEX_GEN_DEFAULT)
-			{ //planar texgen needs binormals
-				mVObjp->getVolume()->genTangents(f);
-			}
-
-			U8 tex_mode = 0;
-	
-			bool tex_anim = false;
-
-			LLVOVolume* vobj = (LLVOVolume*) (LLViewerObject*) mVObjp;	
-			tex_mode = vobj->mTexAnimMode;
-
-			if (vobj->mTextureAnimp)
-			{ //texture animation is in play, override specular and normal map tex coords with diffuse texcoords
-				tex_anim = true;
-			}
-
-			if (isState(TEXTURE_ANIM))
-			{
-				if (!tex_mode)
-				{
-					clearState(TEXTURE_ANIM);
-				}
-				else
-				{
-					os = ot = 0.f;
-					r = 0.f;
-					cos_ang = 1.f;
-					sin_ang = 0.f;
-					ms = mt = 1.f;
-
-					do_xform = false;
-				}
+			LLVector4a bump_s_primary_light_ray;
+			LLVector4a bump_t_primary_light_ray;
+			bump_s_primary_light_ray.load3(target.mBumpSRay.mV);
+			bump_t_primary_light_ray.load3(target.mBumpTRay.mV);
 
-				if (getVirtualSize() >= MIN_TEX_ANIM_SIZE || isState(LLFace::RIGGED))
-				{ //don't override texture transform during tc bake
-					tex_mode = 0;
-				}
-			}
+			const U8 texgen = target.mTexGen;
 
 			LLVector4a scalea;
 			scalea.load3(scale.mV);
 
-			LLMaterial* mat = tep->getMaterialParams().get();
-
-			bool do_bump = bump_code && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1);
-
-			if (mat && !do_bump)
-			{
-				do_bump  = mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1)
-					     || mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2);
-			}
+			bool do_bump = target.mDoBump;
 			
-			bool do_tex_mat = tex_mode && mTextureMatrix;
+			bool do_tex_mat = target.mDoTexMat;
 
 			if (!do_bump)
 			{ //not in atlas or not bump mapped, might be able to do a cheap update
-				mVertexBuffer->getTexCoord0Strider(tex_coords0, mGeomIndex, mGeomCount);
-
 				if (texgen != LLTextureEntry::TEX_GEN_PLANAR)
 				{
-					LL_RECORD_BLOCK_TIME(FTM_FACE_TEX_QUICK);
 					if (!do_tex_mat)
 					{
-						if (!do_xform)
+						if (!target.mDoXform)
 						{
-							LL_RECORD_BLOCK_TIME(FTM_FACE_TEX_QUICK_NO_XFORM);
 							S32 tc_size = (num_vertices*2*sizeof(F32)+0xF) & ~0xF;
 							LLVector4a::memcpyNonAliased16((F32*) tex_coords0.get(), (F32*) vf.mTexCoords, tc_size);
 						}
 						else
 						{
-							LL_RECORD_BLOCK_TIME(FTM_FACE_TEX_QUICK_XFORM);
 							F32* dst = (F32*) tex_coords0.get();
 							LLVector4a* src = (LLVector4a*) vf.mTexCoords;
 
@@ -1578,14 +1727,13 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							//LLVector4a& norm = vf.mNormals[i];
 							//LLVector4a& center = *(vf.mCenter);
 							LLVector4a tc(vf.mTexCoords[i].mV[VX],vf.mTexCoords[i].mV[VY],0.f);
-							mTextureMatrix->affineTransform(tc,tc);
+							target.mTextureMatrix.affineTransform(tc,tc);
 							(tex_coords0++)->set(tc.getF32ptr());
 						}
 					}
 				}
 				else
 				{ //no bump, no atlas, tex gen planar
-					LL_RECORD_BLOCK_TIME(FTM_FACE_TEX_QUICK_PLANAR);
 					if (do_tex_mat)
 					{
 						for (S32 i = 0; i < num_vertices; i++)
@@ -1598,7 +1746,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							planarProjection(tc, norm, center, vec);
 						
 							LLVector4a tmp(tc.mV[VX],tc.mV[VY],0.f);
-							mTextureMatrix->affineTransform(tmp,tmp);
+							target.mTextureMatrix.affineTransform(tmp,tmp);
 							(tex_coords0++)->set(tmp.getF32ptr());
 						}
 					}
@@ -1619,19 +1767,12 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 						}
 					}
 				}
-
-				if (map_range)
-				{
-					mVertexBuffer->flush();
-				}
 			}
 			else
 			{ //either bump mapped or in atlas, just do the whole expensive loop
-				LL_RECORD_BLOCK_TIME(FTM_FACE_TEX_DEFAULT);
-
 				std::vector<LLVector2> bump_tc;
 
-				if (mat && !mat->getNormalID().isNull())
+				if (target.mNormalMapped)
 				{ //writing out normal and specular texture coordinates, not bump offsets
 					do_bump = false;
 				}
@@ -1640,52 +1781,19 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 				for (U32 ch = 0; ch < 3; ++ch)
 				{
-					switch (ch)
+					dst = target.mTexCoords[ch];
+					if (!dst.get())
 					{
-						case 0: 
-							mVertexBuffer->getTexCoord0Strider(dst, mGeomIndex, mGeomCount, map_range); 
-							break;
-						case 1:
-							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD1))
-							{
-								mVertexBuffer->getTexCoord1Strider(dst, mGeomIndex, mGeomCount, map_range);
-								if (mat && !tex_anim)
-								{
-									r  = mat->getNormalRotation();
-									mat->getNormalOffset(os, ot);
-									mat->getNormalRepeat(ms, mt);
-
-									cos_ang = cos(r);
-									sin_ang = sin(r);
-
-								}
-							}
-							else
-							{
-								continue;
-							}
-							break;
-						case 2:
-							if (mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_TEXCOORD2))
-							{
-								mVertexBuffer->getTexCoord2Strider(dst, mGeomIndex, mGeomCount, map_range);
-								if (mat && !tex_anim)
-								{
-									r  = mat->getSpecularRotation();
-									mat->getSpecularOffset(os, ot);
-									mat->getSpecularRepeat(ms, mt);
-
-									cos_ang = cos(r);
-									sin_ang = sin(r);
-								}
-							}
-							else
-							{
-								continue;
-							}
-							break;
+						continue;
 					}
-					
+
+					const GeometryTarget::TexTransform& xf = target.mTexTransform[ch];
+					os = xf.mOffsetS;
+					ot = xf.mOffsetT;
+					ms = xf.mScaleS;
+					mt = xf.mScaleT;
+					cos_ang = cos(xf.mRotation);
+					sin_ang = sin(xf.mRotation);
 
 					for (S32 i = 0; i < num_vertices; i++)
 					{	
@@ -1707,10 +1815,10 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 							}
 						}
 
-						if (tex_mode && mTextureMatrix)
+						if (do_tex_mat)
 						{
 							LLVector4a tmp(tc.mV[VX],tc.mV[VY],0.f);
-							mTextureMatrix->affineTransform(tmp,tmp);
+							target.mTextureMatrix.affineTransform(tmp,tmp);
 							tc.set(tmp.getF32ptr());
 						}
 						else
@@ -1726,15 +1834,9 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 					}
 				}
 
-				if (map_range)
+				if ( !target.mRenderDeferred && do_bump && tex_coords1.get() )
 				{
-					mVertexBuffer->flush();
-				}
 
-				if ( !LLPipeline::sRenderDeferred && do_bump )
-				{
-					mVertexBuffer->getTexCoord1Strider(tex_coords1, mGeomIndex, mGeomCount, map_range);
-		
 					for (S32 i = 0; i < num_vertices; i++)
 					{
 						LLVector4a tangent = vf.mTangents[i];
@@ -1751,11 +1853,11 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 						mat_normal.rotate(t, binormal);
 						
 						//VECTORIZE THIS
-						if (mDrawablep->isActive())
+						if (target.mActive)
 						{
 							LLVector3 t;
 							t.set(binormal.getF32ptr());
-							t *= bump_quat;
+							t *= target.mBumpQuat;
 							binormal.load3(t.mV);
 						}
 
@@ -1766,16 +1868,11 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 					
 						*tex_coords1++ = tc;
 					}
-
-					if (map_range)
-					{
-						mVertexBuffer->flush();
-					}
 				}
 			}
 		}
 
-		if (rebuild_pos)
+		if (target.mRebuildPos)
 		{
 			LLVector4a* src = vf.mPositions;
 			
@@ -1784,15 +1881,10 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			LLVector4a* end = src+num_vertices;
 			//LLVector4a* end_64 = end-4;
 
-			//LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_POSITION);
-			llassert(num_vertices > 0);
-		
-			mVertexBuffer->getVertexStrider(vert, mGeomIndex, mGeomCount, map_range);
-			
 			const LLMatrix4a& mat_vert = mat_vert_in;
 
 			F32* dst = (F32*) vert.get();
-			F32* end_f32 = dst+mGeomCount*4;
+			F32* end_f32 = dst+target.mGeomCount*4;
 
 			//_mm_prefetch((char*)dst, _MM_HINT_NTA);
 			//_mm_prefetch((char*)src, _MM_HINT_NTA);
@@ -1804,7 +1896,7 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 
 			LLVector4a texIdx;
 
-			S32 index = mTextureIndex < 255 ? mTextureIndex : 0;
+			S32 index = target.mTextureIndex;
 
 			F32 val = 0.f;
 			S32* vp = (S32*) &val;
@@ -1821,8 +1913,6 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			LLVector4a tmp;
 
 			{
-				//LL_RECORD_BLOCK_TIME(FTM_FACE_POSITION_STORE);
-
 				/*if (num_vertices > 4)
 				{ //more than 64 bytes
 					while (src < end_64)
@@ -1861,25 +1951,17 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 			}
 
 			{
-				//LL_RECORD_BLOCK_TIME(FTM_FACE_POSITION_PAD);
 				while (dst < end_f32)
 				{
 					res0.store4a((F32*) dst);
 					dst += 4;
 				}
 			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 
 		
-		if (rebuild_normal)
+		if (target.mRebuildNormal)
 		{
-			//LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_NORMAL);
-			mVertexBuffer->getNormalStrider(norm, mGeomIndex, mGeomCount, map_range);
 			F32* normals = (F32*) norm.get();
 			LLVector4a* src = vf.mNormals;
 			LLVector4a* end = src+num_vertices;
@@ -1891,28 +1973,18 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				normal.store4a(normals);
 				normals += 4;
 			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 		
-		if (rebuild_tangent)
+		if (target.mRebuildTangent)
 		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_TANGENT);
-			mVertexBuffer->getTangentStrider(tangent, mGeomIndex, mGeomCount, map_range);
 			F32* tangents = (F32*) tangent.get();
-			
-			mVObjp->getVolume()->genTangents(f);
-			
+
 			LLVector4a* src = vf.mTangents;
 			LLVector4a* end = vf.mTangents+num_vertices;
 			LLVector4a* src2 = vf.mNormals;
 			LLVector4a* end2 = vf.mNormals+num_vertices;
 
-			LLMaterial* mat = tep->getMaterialParams().get();
-			F32 rot = RAD_TO_DEG * ( (mat && mat->getNormalID().notNull()) ? mat->getNormalRotation() : r);
+			F32 rot = target.mTangentRotation;
 			bool rotate_tangent = src2 && !is_approx_equal(rot, 360.f) && !is_approx_zero(rot);
 
 			while (src < end)
@@ -1930,31 +2002,18 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				src++;
 				tangents += 4;
 			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 	
-		if (rebuild_weights && vf.mWeights)
+		if (target.mRebuildWeights)
 		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_WEIGHTS);
-			mVertexBuffer->getWeight4Strider(wght, mGeomIndex, mGeomCount, map_range);
 			for(S32 i=0;i<num_vertices;++i)
 			{
 				*(wght++) = vf.mWeights[i];
 			}
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 
-		if (rebuild_color && mVertexBuffer->hasDataType(LLVertexBuffer::TYPE_COLOR) )
+		if (target.mRebuildColor)
 		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_COLOR);
-			mVertexBuffer->getColorStrider(colors, mGeomIndex, mGeomCount, map_range);
 
 			LLVector4a src;
 
@@ -1975,20 +2034,13 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				src.store4a(dst);
 				dst += 4;
 			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 
-		if (rebuild_emissive)
+		if (target.mRebuildEmissive)
 		{
-			LL_RECORD_BLOCK_TIME(FTM_FACE_GEOM_EMISSIVE);
-			LLStrider<LLColor4U> emissive;
-			mVertexBuffer->getEmissiveStrider(emissive, mGeomIndex, mGeomCount, map_range);
+			LLStrider<LLColor4U> emissive = target.mEmissive;
 
-			U8 glow = (U8) llclamp((S32) (getTextureEntry()->getGlow()*255), 0, 255);
+			U8 glow = target.mGlow;
 
 			LLVector4a src;
 
@@ -2015,31 +2067,8 @@ BOOL LLFace::getGeometryVolume(const LLVolume& volume,
 				src.store4a(dst);
 				dst += 4;
 			}
-
-			if (map_range)
-			{
-				mVertexBuffer->flush();
-			}
 		}
 	}
-
-	if (rebuild_tcoord)
-	{
-		mTexExtents[0].setVec(0,0);
-		mTexExtents[1].setVec(1,1);
-		xform(mTexExtents[0], cos_ang, sin_ang, os, ot, ms, mt);
-		xform(mTexExtents[1], cos_ang, sin_ang, os, ot, ms, mt);
-		
-		F32 es = vf.mTexCoordExtents[1].mV[0] - vf.mTexCoordExtents[0].mV[0] ;
-		F32 et = vf.mTexCoordExtents[1].mV[1] - vf.mTexCoordExtents[0].mV[1] ;
-		mTexExtents[0][0] *= es ;
-		mTexExtents[1][0] *= es ;
-		mTexExtents[0][1] *= et ;
-		mTexExtents[1][1] *= et ;
-	}
-
-
-	return TRUE;
 }
 
 //check if the face has a media
@@ -49,6 +49,7 @@ class LLTextureEntry;
 class LLVertexProgram;
 class LLViewerTexture;
 class LLGeometryManager;
+class LLMaterial;
 
 const F32 MIN_ALPHA_SIZE = 1024.f;
 const F32 MIN_TEX_ANIM_SIZE = 512.f;
@@ -176,6 +177,77 @@ public:
 						const U16 &index_offset,
 						bool force_rebuild = false);
 
+	// getGeometryVolume() in two steps so the vertex generation can run off
+	// the render thread.  prepareGeometryVolume() must run on the render
+	// thread: it decides what to rebuild, generates tangents on the volume
+	// and maps the streams into target.  fillGeometryVolume() only writes
+	// the mapped memory and may run on a worker, at most one per face.
+	struct GeometryTarget
+	{
+		GeometryTarget();
+
+		LLStrider<U16>			mIndices;
+		LLStrider<LLVector3>	mVertices;
+		LLStrider<LLVector3>	mNormals;
+		LLStrider<LLVector3>	mTangents;
+		LLStrider<LLVector4a>	mWeights;
+		LLStrider<LLColor4U>	mColors;
+		LLStrider<LLColor4U>	mEmissive;
+		LLStrider<LLVector2>	mTexCoords[3];
+
+		// Offset, scale and rotation of one texture coordinate channel.
+		struct TexTransform
+		{
+			F32		mRotation;
+			F32		mOffsetS;
+			F32		mOffsetT;
+			F32		mScaleS;
+			F32		mScaleT;
+		};
+
+		// Everything the fill reads from the face, its object, its
+		// textures or the sky, copied by prepareGeometryVolume() since the
+		// fill may run on a geometry worker.
+		LL_ALIGN_16(LLMatrix4a	mTextureMatrix);
+		TexTransform	mTexTransform[3];
+		LLQuaternion	mBumpQuat;
+		LLVector3		mBumpSRay;
+		LLVector3		mBumpTRay;
+		LLColor4U		mColor;
+		U16				mGeomCount;
+		U8				mTextureIndex;
+		U8				mGlow;
+		U8				mTexGen;
+		bool			mDoXform;
+		bool			mDoTexMat;
+		bool			mNormalMapped;
+		bool			mRenderDeferred;
+		bool			mActive;
+
+		// Face state written back by applyGeometryVolume() on the main
+		// thread once the fill is done.
+		LLVector2		mTexExtents[2];
+		F32				mTangentRotation;
+		bool			mClearTextureAnim;
+
+		LLVector3	mScale;
+		bool		mRebuildIndices;
+		bool		mRebuildPos;
+		bool		mRebuildNormal;
+		bool		mRebuildTangent;
+		bool		mRebuildWeights;
+		bool		mRebuildColor;
+		bool		mRebuildEmissive;
+		bool		mRebuildTCoord;
+		bool		mDoBump;
+	};
+
+	BOOL prepareGeometryVolume(const LLVolume& volume, S32 f, bool force_rebuild, GeometryTarget& target);
+	void fillGeometryVolume(const LLVolume& volume, S32 f,
+						const LLMatrix4a& mat_vert, const LLMatrix4a& mat_normal,
+						U16 index_offset, const GeometryTarget& target);
+	void applyGeometryVolume(const GeometryTarget& target);
+
 	// For avatar
 	U16			 getGeometryAvatar(
 									LLStrider<LLVector3> &vertices,
@@ -244,6 +316,7 @@ public: //aligned members
 	LL_ALIGN_16(LLVector4a		mExtents[2]);
 
 private:	
+	void		prepareTexCoords(const LLTextureEntry* tep, U8 bump_code, LLMaterial* mat, GeometryTarget& target);
 	F32         adjustPartialOverlapPixelArea(F32 cos_angle_to_view_dir, F32 radius );
 	BOOL        calcPixelArea(F32& cos_angle_to_view_dir, F32& radius);
 public:
@@ -73,6 +73,11 @@ typedef LLTreeDFSIter<LLFastTimer::NamedTimer, LLFastTimer::NamedTimer::child_co
 
 BOOL LLFastTimerView::sAnalyzePerformance = FALSE;
 
+static bool by_self_time(const LLFastTimer::ThreadTimerTotals& a, const LLFastTimer::ThreadTimerTotals& b)
+{
+	return a.mSelfTime > b.mSelfTime;
+}
+
 static timer_tree_iterator_t begin_timer_tree(LLFastTimer::NamedTimer& id) 
 { 
 	return timer_tree_iterator_t(&id, 
@@ -107,6 +112,7 @@ LLFastTimerView::LLFastTimerView(const std::string& name, const LLRect& rect)
 	mOverLegend = false;
 	mScrollOffset = 0;
 	// </FS:LO>
+	mShowThreads = false;
 	LLUICtrlFactory::getInstance()->buildFloater(this, "floater_fast_timers.xml");
 }
 
@@ -131,12 +137,44 @@ void LLFastTimerView::onPauseHandler(void *data)
 	((LLFastTimerView*)data)->onPause();
 }
 
+void LLFastTimerView::onThreads()
+{
+	mShowThreads = !mShowThreads;
+	getChild<LLButton>("threads_btn")->setLabel(getString(mShowThreads ? "frame" : "threads"));
+	mLastThreadSummaries.clear();
+	mThreadRates.clear();
+	mThreadSampleTimer.reset();
+}
+
+void LLFastTimerView::onThreadsHandler(void *data)
+{
+	((LLFastTimerView*)data)->onThreads();
+}
+
+//static
+void LLFastTimerView::onTraceHandler(void *data)
+{
+	static const LLCachedControl<F32> trace_seconds(gSavedSettings, "FastTimerTraceSeconds", 5.f);
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "fast_timer_trace.json");
+	llofstream os(filename.c_str());
+	if (!os.is_open())
+	{
+		LL_WARNS() << "Unable to write " << filename << LL_ENDL;
+		return;
+	}
+	LLFastTimer::writeChromeTrace(os, llmax((F32)trace_seconds, 0.1f));
+	LL_INFOS() << "Wrote fast timer trace to " << filename << LL_ENDL;
+}
+
 BOOL LLFastTimerView::postBuild()
 {
 	LLButton& pause_btn = getChildRef<LLButton>("pause_btn");
 
 	pause_btn.setClickedCallback(&LLFastTimerView::onPauseHandler,this);
 	//pause_btn.setCommitCallback(boost::bind(&LLFastTimerView::onPause, this));
+	getChildRef<LLButton>("threads_btn").setClickedCallback(&LLFastTimerView::onThreadsHandler, this);
+	getChildRef<LLButton>("trace_btn").setClickedCallback(&LLFastTimerView::onTraceHandler, this);
 
 	return TRUE;
 }
@@ -191,6 +229,11 @@ BOOL LLFastTimerView::handleDoubleClick(S32 x, S32 y, MASK mask)
 
 BOOL LLFastTimerView::handleMouseDown(S32 x, S32 y, MASK mask)
 {
+	if (mShowThreads)
+	{
+		return LLFloater::handleMouseDown(x, y, mask);
+	}
+
 	if (x < mBarRect.mLeft) 
 	{
 		LLFastTimer::NamedTimer* idp = getLegendID(y);
@@ -326,7 +369,7 @@ BOOL LLFastTimerView::handleHover(S32 x, S32 y, MASK mask)
 BOOL LLFastTimerView::handleToolTip(S32 x, S32 y, std::string& msg, LLRect* sticky_rect_screen)
 {
 	std::string tool_tip;
-	if(LLFastTimer::sPauseHistory && mBarRect.pointInRect(x, y))
+	if(!mShowThreads && LLFastTimer::sPauseHistory && mBarRect.pointInRect(x, y))
 	{
 		// tooltips for timer bars
 		if (mHoverTimer)
@@ -473,6 +516,15 @@ void LLFastTimerView::draw()
 		y -= (texth + 2);
 	}
 
+	if (mShowThreads)
+	{
+		drawThreadSummaries(y);
+		mHoverID = NULL;
+		mHoverBarIndex = -1;
+		LLView::draw();
+		return;
+	}
+
 	S32 histmax = llmin(LLFastTimer::getLastFrameIndex()+1, MAX_VISIBLE_HISTORY);
 		
 	// Draw the legend
@@ -1118,6 +1170,111 @@ void LLFastTimerView::draw()
 	LLView::draw();
 }
 
+void LLFastTimerView::drawThreadSummaries(S32 y)
+{
+	const S32 MAX_TIMERS_PER_THREAD = 8;
+	const S32 margin = 10;
+	const S32 texth = (S32)LLFontGL::getFontMonospace()->getLineHeight();
+
+	// The totals only ever grow, so rates are the difference between two
+	// samples a second apart.
+	if (mLastThreadSummaries.empty() || mThreadSampleTimer.getElapsedTimeF32() >= 1.f)
+	{
+		F64 elapsed = llmax((F64)mThreadSampleTimer.getElapsedTimeF32(), 0.001);
+		std::vector<LLFastTimer::ThreadSummary> summaries;
+		LLFastTimer::getThreadSummaries(summaries);
+
+		mThreadRates.clear();
+		if (!mLastThreadSummaries.empty())
+		{
+			for (size_t t = 0; t < summaries.size(); ++t)
+			{
+				LLFastTimer::ThreadSummary rates;
+				rates.mName = summaries[t].mName;
+
+				// a thread that took over the slot of an exited one has a
+				// new name, and starts from zero
+				const LLFastTimer::ThreadSummary* last = NULL;
+				for (size_t l = 0; l < mLastThreadSummaries.size(); ++l)
+				{
+					if (mLastThreadSummaries[l].mName == summaries[t].mName)
+					{
+						last = &mLastThreadSummaries[l];
+						break;
+					}
+				}
+
+				for (size_t i = 0; i < summaries[t].mTimers.size(); ++i)
+				{
+					LLFastTimer::ThreadTimerTotals totals = summaries[t].mTimers[i];
+					if (last)
+					{
+						for (size_t j = 0; j < last->mTimers.size(); ++j)
+						{
+							const LLFastTimer::ThreadTimerTotals& prev = last->mTimers[j];
+							if (prev.mTimer == totals.mTimer && prev.mSelfTime <= totals.mSelfTime && prev.mCalls <= totals.mCalls)
+							{
+								totals.mSelfTime -= prev.mSelfTime;
+								totals.mCalls -= prev.mCalls;
+								break;
+							}
+						}
+					}
+					if (totals.mCalls)
+					{
+						totals.mSelfTime = (U64)((F64)totals.mSelfTime / elapsed);
+						totals.mCalls = (U32)((F64)totals.mCalls / elapsed + 0.5);
+						rates.mTimers.push_back(totals);
+					}
+				}
+				mThreadRates.push_back(rates);
+			}
+		}
+		mLastThreadSummaries.swap(summaries);
+		mThreadSampleTimer.reset();
+	}
+
+	const F64 ms_per_count = 1000.0 / (F64)LLFastTimer::countsPerSecond64();
+	S32 x = margin;
+	y -= texth + 2;
+	LLFontGL::getFontMonospace()->renderUTF8(std::string("Timers of other threads, self time in ms per second and calls per second:"),
+											 0, x, y, LLColor4::white, LLFontGL::LEFT, LLFontGL::TOP);
+	y -= 2 * (texth + 2);
+
+	for (size_t t = 0; t < mThreadRates.size() && y > margin; ++t)
+	{
+		LLFastTimer::ThreadSummary& rates = mThreadRates[t];
+		U64 busy = 0;
+		for (size_t i = 0; i < rates.mTimers.size(); ++i)
+		{
+			busy += rates.mTimers[i].mSelfTime;
+		}
+		LLFontGL::getFontMonospace()->renderUTF8(llformat("%s: %.1f ms/s", rates.mName.c_str(), (F64)busy * ms_per_count),
+												 0, x, y, LLColor4::yellow, LLFontGL::LEFT, LLFontGL::TOP);
+		y -= texth + 2;
+
+		std::sort(rates.mTimers.begin(), rates.mTimers.end(), by_self_time);
+		S32 count = llmin((S32)rates.mTimers.size(), MAX_TIMERS_PER_THREAD);
+		for (S32 i = 0; i < count && y > margin; ++i)
+		{
+			const LLFastTimer::ThreadTimerTotals& totals = rates.mTimers[i];
+			std::string line = llformat("    %-40.40s %8.2f ms/s %8u calls/s", totals.mTimer->getName().c_str(),
+										(F64)totals.mSelfTime * ms_per_count, totals.mCalls);
+			LLFontGL::getFontMonospace()->renderUTF8(line, 0, x, y, LLColor4::white, LLFontGL::LEFT, LLFontGL::TOP);
+			y -= texth + 2;
+		}
+		y -= texth / 2;
+	}
+}
+
+void LLFastTimerView::setVisible(BOOL visible)
+{
+	// Begin/end events are only worth recording while somebody can ask for
+	// a trace.
+	LLFastTimer::sTraceEvents = visible;
+	LLFloater::setVisible(visible);
+}
+
 F64 LLFastTimerView::getTime(const std::string& name)
 {
 	const LLFastTimer::NamedTimer* timerp = LLFastTimer::getTimerByName(name);
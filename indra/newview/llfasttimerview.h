@@ -53,6 +53,10 @@ private:
 	static void exportCharts(const std::string& base, const std::string& target);
 	void onPause();
 	static void onPauseHandler(void *data);
+	void onThreads();
+	static void onThreadsHandler(void *data);
+	static void onTraceHandler(void *data);
+	void drawThreadSummaries(S32 y);
 
 public:
 
@@ -64,6 +68,7 @@ public:
 	virtual BOOL handleToolTip(S32 x, S32 y, std::string& msg, LLRect* sticky_rect_screen);
 	virtual BOOL handleScrollWheel(S32 x, S32 y, S32 clicks);
 	virtual void draw();
+	/*virtual*/ void setVisible(BOOL visible);
 
 	LLFastTimer::NamedTimer* getLegendID(S32 y);
 	F64 getTime(const std::string& name);
@@ -104,6 +109,12 @@ private:
 	bool mOverLegend;
 	S32 mScrollOffset;
 	// </FS:LO>
+
+	// Threads mode: per thread timer totals, as rates over the last second
+	bool mShowThreads;
+	LLFrameTimer mThreadSampleTimer;
+	std::vector<LLFastTimer::ThreadSummary> mLastThreadSummaries;
+	std::vector<LLFastTimer::ThreadSummary> mThreadRates;
 };
 
 #endif
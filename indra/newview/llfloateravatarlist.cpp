@@ -255,6 +255,7 @@ LLFloaterAvatarList::LLFloaterAvatarList() :  LLFloater(std::string("radar")),
 	mTracking(false),
 	mUpdate("RadarUpdateEnabled"),
 	mDirtyAvatarSorting(false),
+	mRebuildRows(false),
 	mAvatarList(NULL)
 {
 	LLUICtrlFactory::getInstance()->buildFloater(this, "floater_radar.xml");
@@ -271,6 +272,7 @@ LLFloaterAvatarList::~LLFloaterAvatarList()
 	}
 
 	gSavedSettings.setLLSD("RadarSortOrder", sort);
+	mAvatarIndex.clear();
 	mAvatars.clear();
 }
 
@@ -569,6 +571,9 @@ void LLFloaterAvatarList::assessColumns()
 	}
 
 	mAvatarList->updateLayout();
+
+	// Hidden columns don't get cells, so the rows need rebuilding
+	mRebuildRows = true;
 }
 
 void updateParticleActivity(LLDrawable *drawablep)
@@ -610,13 +615,24 @@ void LLFloaterAvatarList::updateAvatarList(const LLViewerRegion* region, bool fi
 		const LLVector3d& origin(region->getOriginGlobal());
 		const F32 max_range(radar_range_radius() * radar_range_radius());
 
+		// Coarse locations come bucketed by region, use that as a grid for the range check:
+		// when the whole region is out of range, none of its avatars need looking at.
+		bool region_in_range(true);
+		if (max_range)
+		{
+			const F64 width(region->getWidth());
+			const F64 dx(llmax(0.0, llmax(origin.mdV[VX] - mypos.mdV[VX], mypos.mdV[VX] - (origin.mdV[VX] + width))));
+			const F64 dy(llmax(0.0, llmax(origin.mdV[VY] - mypos.mdV[VY], mypos.mdV[VY] - (origin.mdV[VY] + width))));
+			region_in_range = dx * dx + dy * dy <= max_range;
+		}
+
 		static LLCachedControl<bool> announce(gSavedSettings, "RadarChatKeys");
 		std::queue<LLUUID> announce_keys;
 
 		bool no_names(gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMETAGS));
 		bool anon_names(!no_names && gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES));
 		const std::string& rlv_hidden(RlvStrings::getString(RLV_STRING_HIDDEN));
-		for (size_t i = 0, size = map_avs.size(); i < size; ++i)
+		for (size_t i = 0, size = region_in_range ? map_avs.size() : 0; i < size; ++i)
 		{
 			const LLUUID& avid = map_avids[i];
 			LLVector3d position(unpackLocalToGlobalPosition(map_avs[i], origin));
@@ -637,6 +653,7 @@ void LLFloaterAvatarList::updateAvatarList(const LLViewerRegion* region, bool fi
 				// Avatar not there yet, add it
 				if (announce && gAgent.getRegion()->pointInRegionGlobal(position)) announce_keys.push(avid);
 				mAvatars.push_back(LLAvatarListEntryPtr(entry = new LLAvatarListEntry(avid, name, position)));
+				mAvatarIndex[avid] = entry;
 			}
 
 			// Announce position
@@ -680,17 +697,15 @@ void LLFloaterAvatarList::expireAvatarList(const std::list<LLUUID>& ids)
 {
 	if (!ids.empty())
 	{
-		uuid_vec_t existing_avs;
+		uuid_set_t existing_avs;
 		std::vector<LLViewerRegion*> neighbors;
 		gAgent.getRegion()->getNeighboringRegions(neighbors);
 		for (const LLViewerRegion* region : neighbors)
-			existing_avs.insert(existing_avs.end(), region->mMapAvatarIDs.begin(), region->mMapAvatarIDs.end());
+			existing_avs.insert(region->mMapAvatarIDs.begin(), region->mMapAvatarIDs.end());
 		for (const LLUUID& id : ids)
 		{
-			if (std::find(existing_avs.begin(), existing_avs.end(), id) != existing_avs.end()) continue; // Now in another region we know.
-			av_list_t::iterator it(std::find_if(mAvatars.begin(), mAvatars.end(), LLAvatarListEntry::uuidMatch(id)));
-			if (it != mAvatars.end())
-				mAvatars.erase(it);
+			if (existing_avs.count(id)) continue; // Now in another region we know.
+			removeAvatarEntry(id);
 		}
 	}
 
@@ -705,16 +720,74 @@ void LLFloaterAvatarList::updateAvatarSorting()
 		mDirtyAvatarSorting = false;
 		if (mAvatars.size() <= 1) return; // Nothing to sort.
 
+		// Order entries like their rows, entries without a row go last
 		const std::vector<LLScrollListItem*> list = mAvatarList->getAllData();
-		av_list_t::iterator insert_it = mAvatars.begin();
-		for(std::vector<LLScrollListItem*>::const_iterator it = list.begin(); it != list.end(); ++it)
+		std::map<const LLAvatarListEntry*, size_t> row_order;
+		for (size_t i = 0; i < list.size(); ++i)
 		{
-			av_list_t::iterator av_it = std::find_if(mAvatars.begin(),mAvatars.end(),LLAvatarListEntry::uuidMatch((*it)->getUUID()));
-			if (av_it == mAvatars.end()) continue;
-			std::iter_swap(insert_it++, av_it);
-			if (insert_it+1 == mAvatars.end()) return; // We've run out of elements to sort
+			av_index_t::const_iterator it = mAvatarIndex.find(list[i]->getUUID());
+			if (it != mAvatarIndex.end()) row_order[it->second] = i;
 		}
+		std::stable_sort(mAvatars.begin(), mAvatars.end(), [&row_order](const LLAvatarListEntryPtr& a, const LLAvatarListEntryPtr& b)
+		{
+			std::map<const LLAvatarListEntry*, size_t>::const_iterator ia = row_order.find(a.get()), ib = row_order.find(b.get());
+			return (ia == row_order.end() ? SIZE_MAX : ia->second) < (ib == row_order.end() ? SIZE_MAX : ib->second);
+		});
+	}
+}
+
+void LLFloaterAvatarList::removeAvatarEntry(const LLUUID& id)
+{
+	av_index_t::iterator it = mAvatarIndex.find(id);
+	if (it == mAvatarIndex.end()) return;
+	LLAvatarListEntry* entry = it->second;
+	mAvatarIndex.erase(it);
+	if (entry->mRow)
+	{
+		mAvatarList->deleteSingleItem(mAvatarList->getItemIndex(entry->mRow));
 	}
+	mAvatars.erase(std::find_if(mAvatars.begin(), mAvatars.end(), [entry](const LLAvatarListEntryPtr& ptr) { return ptr.get() == entry; }));
+}
+
+namespace
+{
+	// What a cell was built from, to find out whether it needs replacing.
+	std::string radar_cell_key(const LLScrollListCell::Params& cell)
+	{
+		std::ostringstream key;
+		key << cell.type() << '\t' << cell.value().asString() << '\t' << cell.font_style() << '\t' << cell.tool_tip();
+		if (cell.color.isProvided()) key << '\t' << cell.color();
+		return key.str();
+	}
+}
+
+bool LLFloaterAvatarList::updateAvatarRow(LLAvatarListEntry* entry, const LLScrollListItem::Params& element)
+{
+	bool moved(false);
+	if (!entry->mRow)
+	{
+		entry->mRow = mAvatarList->addRow(element);
+		entry->mCellKeys.clear();
+		for (LLInitParam::ParamIterator<LLScrollListCell::Params>::const_iterator it = element.columns.begin(); it != element.columns.end(); ++it)
+			entry->mCellKeys.push_back(radar_cell_key(*it));
+		moved = true;
+	}
+	else
+	{
+		size_t i = 0;
+		for (LLInitParam::ParamIterator<LLScrollListCell::Params>::const_iterator it = element.columns.begin(); it != element.columns.end(); ++it, ++i)
+		{
+			std::string key(radar_cell_key(*it));
+			if (i < entry->mCellKeys.size() && entry->mCellKeys[i] == key) continue;
+			mAvatarList->setCell(entry->mRow, *it);
+			if (i < entry->mCellKeys.size()) entry->mCellKeys[i].swap(key);
+			else entry->mCellKeys.push_back(key);
+		}
+		moved = !mAvatarList->isSorted();
+	}
+	// The caller repositions moved rows, keep the rest of the list flagged as sorted
+	mAvatarList->setNeedsSort(false);
+	return moved;
 }
 
 bool getCustomColorRLV(const LLUUID& id, LLColor4& color, LLViewerRegion* parent_estate, bool name_restricted);
@@ -724,18 +797,29 @@ bool getCustomColorRLV(const LLUUID& id, LLColor4& color, LLViewerRegion* parent
  * Only does anything if the avatar list is visible.
  * @author Dale Glass
  */
+static LLTrace::BlockTimerStatHandle FTM_RADAR_REFRESH("Radar Refresh");
 void LLFloaterAvatarList::refreshAvatarList() 
 {
 	// Don't update when interface is hidden
 	if (!getVisible()) return;
 
-	// We rebuild the list fully each time it's refreshed
-	// The assumption is that it's faster to refill it and sort than
-	// to rebuild the whole list.
-	uuid_vec_t selected = mAvatarList->getSelectedIDs();
-	S32 scrollpos = mAvatarList->getScrollPos();
+	LL_RECORD_BLOCK_TIME(FTM_RADAR_REFRESH);
 
-	mAvatarList->deleteAllItems();
+	// Rows are kept from one refresh to the next: only cells whose content changed get replaced,
+	// and only rows that were added or changed in a sort column get moved to their sorted position.
+	// This keeps selection and scroll position without having to restore them.
+	if (mRebuildRows)
+	{
+		mRebuildRows = false;
+		mAvatarList->deleteAllItems();
+		for (auto& entry : mAvatars)
+		{
+			entry->mRow = nullptr;
+			entry->mCellKeys.clear();
+		}
+	}
+	mAvatarList->updateSort();
+	std::vector<LLScrollListItem*> moved_rows;
 
 	LLVector3d mypos = gAgent.getPositionGlobal();
 	LLVector3d posagent;
@@ -1054,12 +1138,13 @@ void LLFloaterAvatarList::refreshAvatarList()
 			element.columns.add(viewer);
 		}
 
-		// Add to list
-		mAvatarList->addRow(element);
+		// Add to list, or update the existing row
+		if (updateAvatarRow(entry.get(), element))
+			moved_rows.push_back(entry->mRow);
 	}
 
 	for (auto& dead : dead_entries)
-		mAvatars.erase(std::remove(mAvatars.begin(), mAvatars.end(), dead), mAvatars.end());
+		removeAvatarEntry(dead->getID());
 
 	if (mAvatars.empty())
 		setTitle(getString("Title"));
@@ -1073,11 +1158,11 @@ void LLFloaterAvatarList::refreshAvatarList()
 	}
 
 	// finish
-	mAvatarList->updateSort();
-	mAvatarList->selectMultiple(selected);
-	mAvatarList->setScrollPos(scrollpos);
-	
-	mDirtyAvatarSorting = true;
+	if (!moved_rows.empty())
+	{
+		mAvatarList->updateSortPositions(moved_rows);
+		mDirtyAvatarSorting = true;
+	}
 
 //	LL_INFOS() << "radar refresh: done" << LL_ENDL;
 }
@@ -1180,8 +1265,8 @@ void LLFloaterAvatarList::trackAvatar(const LLAvatarListEntry* entry) const
 
 LLAvatarListEntry* LLFloaterAvatarList::getAvatarEntry(const LLUUID& avatar) const
 {
-	av_list_t::const_iterator iter = std::find_if(mAvatars.begin(),mAvatars.end(),LLAvatarListEntry::uuidMatch(avatar));
-	return (iter != mAvatars.end()) ? iter->get() : NULL;
+	av_index_t::const_iterator iter = mAvatarIndex.find(avatar);
+	return (iter != mAvatarIndex.end()) ? iter->second : NULL;
 }
 
 BOOL LLFloaterAvatarList::handleKeyHere(KEY key, MASK mask)
@@ -1246,10 +1331,10 @@ void LLFloaterAvatarList::setFocusAvatar(const LLUUID& id)
 
 void LLFloaterAvatarList::setFocusAvatarInternal(const LLUUID& id)
 {
-	av_list_t::iterator iter = std::find_if(mAvatars.begin(),mAvatars.end(),LLAvatarListEntry::uuidMatch(id));
-	if (iter == mAvatars.end()) return;
+	LLAvatarListEntry* entry = getAvatarEntry(id);
+	if (!entry) return;
 	removeFocusFromAll();
-	(*iter)->setFocus(true);
+	entry->setFocus(true);
 }
 
 // Simple function to decrement iterators, wrapping back if needed
@@ -28,6 +28,7 @@
 #include <set>
 
 #include <boost/shared_ptr.hpp>
+#include <boost/unordered_map.hpp>
 
 class LLFloaterAvatarList;
 
@@ -154,6 +155,13 @@ private:
 	ACTIVITY_TYPE mActivityType;
 
 	LLTimer mActivityTimer;
+
+	/**
+	 * @brief Row showing this entry in the radar list, and a key per cell of what it was built from.
+	 * Lets refreshAvatarList() replace only the cells that changed.
+	 */
+	LLScrollListItem* mRow = nullptr;
+	std::vector<std::string> mCellKeys;
 };
 
 
@@ -325,12 +333,26 @@ public:
 private:
 	void setFocusAvatarInternal(const LLUUID& id);
 
+	/**
+	 * @brief Removes an entry, and its row in the list.
+	 */
+	void removeAvatarEntry(const LLUUID& id);
+
+	/**
+	 * @brief Brings the row of an entry up to date with element.
+	 * @returns true if the row has to move to keep the list sorted.
+	 */
+	bool updateAvatarRow(LLAvatarListEntry* entry, const LLScrollListItem::Params& element);
+
 	/**
 	 * @brief Pointer to the avatar scroll list
 	 */
 	LLScrollListCtrl*			mAvatarList;
 	av_list_t	mAvatars;
+	typedef boost::unordered_map<LLUUID, LLAvatarListEntry*> av_index_t;
+	av_index_t	mAvatarIndex;	// Entries of mAvatars by id
 	bool		mDirtyAvatarSorting;
+	bool		mRebuildRows;	// Column layout changed, rebuild all rows on next refresh
 	bool		mCleanup = false;
 
 	/**
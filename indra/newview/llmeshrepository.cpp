@@ -65,6 +65,7 @@
 #include "lluploadfloaterobservers.h"
 #include "aicurl.h"
 
+#include <algorithm>
 #include <mutex>
 
 #ifndef LL_WINDOWS
@@ -86,6 +87,13 @@ LLMeshRepository gMeshRepo;
 
 const U32 MAX_MESH_REQUESTS_PER_SECOND = 100;
 
+// Bytes fetched for a mesh header alone.  Headers don't get bigger.
+const S32 MESH_HEADER_SIZE = 4096;
+
+// Most asset bytes kept from speculative header fetches until their LODs
+// are requested
+const U32 MAX_MESH_PREFIX_BYTES = 4 * 1024 * 1024;
+
 // Maximum mesh version to support.  Three least significant digits are reserved for the minor version, 
 // with major version changes indicating a format change that is not backwards compatible and should not
 // be parsed by viewers that don't specifically support that version. For example, if the integer "1" is 
@@ -103,6 +111,8 @@ U32 LLMeshRepository::sLODPending = 0;
 U32 LLMeshRepository::sCacheBytesRead = 0;
 U32 LLMeshRepository::sCacheBytesWritten = 0;
 U32 LLMeshRepository::sPeakKbps = 0;
+U32 LLMeshRepository::sSpeculativeFetchCount = 0;
+U32 LLMeshRepository::sRoundTripsSaved = 0;
 
 const U32 MAX_TEXTURE_UPLOAD_RETRIES = 5;
 
@@ -214,16 +224,18 @@ LLViewerFetchedTexture* LLMeshUploadThread::FindViewerTexture(const LLImportMate
 S32 LLMeshRepoThread::sActiveHeaderRequests = 0;
 S32 LLMeshRepoThread::sActiveLODRequests = 0;
 U32	LLMeshRepoThread::sMaxConcurrentRequests = 1;
+U32 LLMeshRepoThread::sSpeculativeFetchBytes = 0;
 
 class LLMeshHeaderResponder : public LLHTTPClient::ResponderWithCompleted
 {
 public:
 	LLVolumeParams mMeshParams;
+	S32 mRequestedBytes;
 	bool mProcessed;
 	void retry();
 
-	LLMeshHeaderResponder(const LLVolumeParams& mesh_params)
-		: mMeshParams(mesh_params)
+	LLMeshHeaderResponder(const LLVolumeParams& mesh_params, S32 requested_bytes)
+		: mMeshParams(mesh_params), mRequestedBytes(requested_bytes)
 	{
 		LLMeshRepoThread::incActiveHeaderRequests();
 		mProcessed = false;
@@ -563,7 +575,8 @@ public:
 };
 
 LLMeshRepoThread::LLMeshRepoThread()
-: LLThread("mesh repo") 
+: LLThread("mesh repo"),
+  mMeshPrefixBytes(0)
 { 
 	mMutex = new LLMutex();
 	mHeaderMutex = new LLMutex();
@@ -850,6 +863,48 @@ bool LLMeshRepoThread::loadInfoFromVFS(const LLUUID& mesh_id, MeshHeaderInfo& in
 	return false;
 }
 
+bool LLMeshRepoThread::loadInfoFromPrefix(const LLUUID& mesh_id, MeshHeaderInfo& info, boost::function<bool(const LLUUID&, U8*, S32)> fn)
+{
+	std::vector<U8> buffer;
+	{
+		LLMutexLock lock(mHeaderMutex);
+		std::map<LLUUID, std::vector<U8> >::iterator iter = mMeshPrefix.find(mesh_id);
+		if (iter == mMeshPrefix.end() || info.mOffset + info.mSize > (S32)iter->second.size())
+		{
+			return false;
+		}
+		buffer.assign(iter->second.begin() + info.mOffset, iter->second.begin() + info.mOffset + info.mSize);
+	}
+
+	//the block came with the header, no request needed
+	if (fn(mesh_id, &buffer[0], info.mSize))
+	{
+		LLMeshRepository::sRoundTripsSaved++;
+		return true;
+	}
+	return false;
+}
+
+void LLMeshRepoThread::BlockEndEstimate::add(S32 end)
+{
+	mEnds[mCount++ % SAMPLES] = end;
+}
+
+S32 LLMeshRepoThread::BlockEndEstimate::get() const
+{
+	if (mCount < MIN_SAMPLES)
+	{
+		return 0;
+	}
+	U32 count = llmin(mCount, (U32)SAMPLES);
+	S32 ends[SAMPLES];
+	std::copy(mEnds, mEnds + count, ends);
+	// four in five blocks seen ended there or before
+	S32* end = ends + count * 4 / 5;
+	std::nth_element(ends, end, ends + count);
+	return *end;
+}
+
 bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 {
 	MeshHeaderInfo info;
@@ -860,8 +915,9 @@ bool LLMeshRepoThread::fetchMeshSkinInfo(const LLUUID& mesh_id)
 
 	if (info.mHeaderSize > 0 && info.mVersion <= MAX_MESH_VERSION && info.mOffset >= 0 && info.mSize > 0)
 	{
-		//check VFS for mesh skin info
-		if (loadInfoFromVFS(mesh_id, info, boost::bind(&LLMeshRepoThread::skinInfoReceived, this, _1, _2, _3 )))
+		//check the bytes fetched with the header, then VFS for mesh skin info
+		boost::function<bool(const LLUUID&, U8*, S32)> fn = boost::bind(&LLMeshRepoThread::skinInfoReceived, this, _1, _2, _3 );
+		if (loadInfoFromPrefix(mesh_id, info, fn) || loadInfoFromVFS(mesh_id, info, fn))
 			return true;
 
 		//reading from VFS failed for whatever reason, fetch from sim
@@ -891,7 +947,8 @@ bool LLMeshRepoThread::fetchMeshDecomposition(const LLUUID& mesh_id)
 
 	if (info.mHeaderSize > 0 && info.mVersion <= MAX_MESH_VERSION && info.mOffset >= 0 && info.mSize > 0)
 	{
-		if (loadInfoFromVFS(mesh_id, info, boost::bind(&LLMeshRepoThread::decompositionReceived, this, _1, _2, _3 )))
+		boost::function<bool(const LLUUID&, U8*, S32)> fn = boost::bind(&LLMeshRepoThread::decompositionReceived, this, _1, _2, _3 );
+		if (loadInfoFromPrefix(mesh_id, info, fn) || loadInfoFromVFS(mesh_id, info, fn))
 			return true;
 
 		//reading from VFS failed for whatever reason, fetch from sim
@@ -923,7 +980,8 @@ bool LLMeshRepoThread::fetchMeshPhysicsShape(const LLUUID& mesh_id)
 	{
 		if (info.mVersion <= MAX_MESH_VERSION && info.mOffset >= 0 && info.mSize > 0)
 		{
-			if (loadInfoFromVFS(mesh_id, info, boost::bind(&LLMeshRepoThread::physicsShapeReceived, this, _1, _2, _3 )))
+			boost::function<bool(const LLUUID&, U8*, S32)> fn = boost::bind(&LLMeshRepoThread::physicsShapeReceived, this, _1, _2, _3 );
+			if (loadInfoFromPrefix(mesh_id, info, fn) || loadInfoFromVFS(mesh_id, info, fn))
 				return true;
 
 			//reading from VFS failed for whatever reason, fetch from sim
@@ -987,8 +1045,8 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, U32& c
 
 		if (size > 0)
 		{ //NOTE -- if the header size is ever more than 4KB, this will break
-			U8 buffer[4096];
-			S32 bytes = llmin(size, 4096);
+			U8 buffer[MESH_HEADER_SIZE];
+			S32 bytes = llmin(size, MESH_HEADER_SIZE);
 			LLMeshRepository::sCacheBytesRead += bytes;	
 			file.read(buffer, bytes);
 			if (headerReceived(mesh_params, buffer, bytes))
@@ -1008,10 +1066,35 @@ bool LLMeshRepoThread::fetchMeshHeader(const LLVolumeParams& mesh_params, U32& c
 		//grab first 4KB if we're going to bother with a fetch.  Cache will prevent future fetches if a full mesh fits
 		//within the first 4KB
 		//NOTE -- this will break of headers ever exceed 4KB		
-		retval = LLHTTPClient::getByteRange(http_url, headers, 0, 4096, new LLMeshHeaderResponder(mesh_params));
+		S32 bytes = MESH_HEADER_SIZE;
+		if (sSpeculativeFetchBytes > (U32)MESH_HEADER_SIZE)
+		{ //grab as far as the wanted LOD usually ends too, so that it needs no request of its own
+			S32 lod = -1;
+			{
+				LLMutexLock lock(mMutex);
+				pending_lod_map::iterator pending = mPendingLOD.find(mesh_params);
+				if (pending != mPendingLOD.end())
+				{
+					for (U32 i = 0; i < pending->second.size(); ++i)
+					{
+						lod = llmax(lod, pending->second[i]);
+					}
+				}
+			}
+			if (lod >= 0 && lod < LLModel::LOD_PHYSICS)
+			{
+				LLMutexLock lock(mHeaderMutex);
+				bytes = llclamp(mLODEnds[lod].get(), MESH_HEADER_SIZE, (S32)sSpeculativeFetchBytes);
+			}
+		}
+		retval = LLHTTPClient::getByteRange(http_url, headers, 0, bytes, new LLMeshHeaderResponder(mesh_params, bytes));
 		if (retval)
 		{
 			LLMeshRepository::sHTTPRequestCount++;
+			if (bytes > MESH_HEADER_SIZE)
+			{
+				LLMeshRepository::sSpeculativeFetchCount++;
+			}
 		}
 		count++;
 	}
@@ -1034,7 +1117,8 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 	{
 		if(info.mVersion <= MAX_MESH_VERSION && info.mOffset >= 0 && info.mSize > 0)
 		{
-			if (loadInfoFromVFS(mesh_id, info, boost::bind(&LLMeshRepoThread::lodReceived, this, mesh_params, lod, _2, _3 )))
+			boost::function<bool(const LLUUID&, U8*, S32)> fn = boost::bind(&LLMeshRepoThread::lodReceived, this, mesh_params, lod, _2, _3 );
+			if (loadInfoFromPrefix(mesh_id, info, fn) || loadInfoFromVFS(mesh_id, info, fn))
 				return true;
 
 			//reading from VFS failed for whatever reason, fetch from sim
@@ -1064,11 +1148,12 @@ bool LLMeshRepoThread::fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod,
 	return true;
 }
 
-bool LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size)
+bool LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size, bool speculative)
 {
 	LLSD header;
 	
 	U32 header_size = 0;
+	S32 received = data_size;
 	if (data_size > 0)
 	{
 		std::string res_str((char*) data, data_size);
@@ -1106,6 +1191,40 @@ bool LLMeshRepoThread::headerReceived(const LLVolumeParams& mesh_params, U8* dat
 			LLMutexLock lock(mHeaderMutex);
 			mMeshHeaderSize[mesh_id] = header_size;
 			mMeshHeader[mesh_id] = header;
+
+			if (header_size > 0)
+			{ //learn where LODs end, to know how much to fetch with the next headers
+				for (S32 i = 0; i < LLModel::LOD_PHYSICS; ++i)
+				{
+					const LLSD& block = header[header_lod[i]];
+					if (block["size"].asInteger() > 0)
+					{
+						mLODEnds[i].add(header_size + block["offset"].asInteger() + block["size"].asInteger());
+					}
+				}
+			}
+
+			if (speculative && received > (S32)header_size)
+			{ //keep what came past the header for the requests that follow
+				std::vector<U8>& prefix = mMeshPrefix[mesh_id];
+				if (prefix.empty())
+				{
+					mMeshPrefixOrder.push_back(mesh_id);
+				}
+				mMeshPrefixBytes -= prefix.size();
+				prefix.assign(data, data + received);
+				mMeshPrefixBytes += prefix.size();
+				while (mMeshPrefixBytes > MAX_MESH_PREFIX_BYTES && !mMeshPrefixOrder.empty())
+				{
+					std::map<LLUUID, std::vector<U8> >::iterator oldest = mMeshPrefix.find(mMeshPrefixOrder.front());
+					mMeshPrefixOrder.pop_front();
+					if (oldest != mMeshPrefix.end())
+					{
+						mMeshPrefixBytes -= oldest->second.size();
+						mMeshPrefix.erase(oldest);
+					}
+				}
+			}
 		}
 
 		LLMutexLock lock(mMutex); // make sure only one thread access mPendingLOD at the same time.
@@ -2307,10 +2426,10 @@ void LLMeshHeaderResponder::completedRaw(LLChannelDescriptors const& channels,
 		buffer->readAfter(channels.in(), NULL, &data[0], data_size);
 	}
 
-	LLMeshRepository::sBytesReceived += llmin(data_size, 4096);
+	LLMeshRepository::sBytesReceived += llmin(data_size, mRequestedBytes);
 
 	AIStateMachine::StateTimer timer("headerReceived");
-	bool success = gMeshRepo.mThread->headerReceived(mMeshParams, &data[0], data_size);
+	bool success = gMeshRepo.mThread->headerReceived(mMeshParams, &data[0], data_size, mRequestedBytes > MESH_HEADER_SIZE);
 	
 	llassert(success);
 
@@ -2535,6 +2654,8 @@ void LLMeshRepository::notifyLoadedMeshes()
 { //called from main thread
 	static const LLCachedControl<U32> max_concurrent_requests("MeshMaxConcurrentRequests");
 	LLMeshRepoThread::sMaxConcurrentRequests = max_concurrent_requests;
+	static const LLCachedControl<U32> speculative_fetch_bytes("MeshSpeculativeFetchBytes");
+	LLMeshRepoThread::sSpeculativeFetchBytes = speculative_fetch_bytes;
 
 	//update inventory
 	if (!mInventoryQ.empty())
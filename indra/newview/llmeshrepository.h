@@ -178,6 +178,9 @@ public:
 	static S32 sActiveHeaderRequests;
 	static S32 sActiveLODRequests;
 	static U32 sMaxConcurrentRequests;
+	// Most bytes of an asset to fetch along with its header, in the hope of
+	// getting the wanted LOD in the same request
+	static U32 sSpeculativeFetchBytes;
 
 	LLMutex*	mMutex;
 	LLMutex*	mHeaderMutex;
@@ -189,6 +192,31 @@ public:
 	
 	std::map<LLUUID, U32> mMeshHeaderSize;
 
+	// Where the blocks of one LOD ended in the last headers seen, to guess
+	// how much of an asset to fetch with its header.  Protected by
+	// mHeaderMutex.
+	class BlockEndEstimate
+	{
+	public:
+		BlockEndEstimate() : mCount(0) {}
+		void add(S32 end);
+		// End that most of the blocks seen were within, 0 while there were
+		// too few of them to tell
+		S32 get() const;
+
+	private:
+		enum { SAMPLES = 64, MIN_SAMPLES = 8 };
+		S32 mEnds[SAMPLES];
+		U32 mCount;
+	};
+	BlockEndEstimate mLODEnds[LLModel::LOD_PHYSICS];
+
+	// Asset bytes past the header that came with a speculative header fetch,
+	// oldest first in mMeshPrefixOrder.  Protected by mHeaderMutex.
+	std::map<LLUUID, std::vector<U8> > mMeshPrefix;
+	std::deque<LLUUID> mMeshPrefixOrder;
+	U32 mMeshPrefixBytes;
+
 	struct MeshRequest
 	{
 		LLTimer mTimer;
@@ -318,7 +346,7 @@ public:
 	void loadMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
 	bool fetchMeshHeader(const LLVolumeParams& mesh_params, U32& count);
 	bool fetchMeshLOD(const LLVolumeParams& mesh_params, S32 lod, U32& count);
-	bool headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size);
+	bool headerReceived(const LLVolumeParams& mesh_params, U8* data, S32 data_size, bool speculative = false);
 	bool lodReceived(const LLVolumeParams& mesh_params, S32 lod, U8* data, S32 data_size);
 	bool skinInfoReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
 	bool decompositionReceived(const LLUUID& mesh_id, U8* data, S32 data_size);
@@ -327,6 +355,7 @@ public:
 
 	bool getMeshHeaderInfo(const LLUUID& mesh_id, const char* block_name, MeshHeaderInfo& info);
 	bool loadInfoFromVFS(const LLUUID& mesh_id, MeshHeaderInfo& info, boost::function<bool(const LLUUID&, U8*, S32)> fn);
+	bool loadInfoFromPrefix(const LLUUID& mesh_id, MeshHeaderInfo& info, boost::function<bool(const LLUUID&, U8*, S32)> fn);
 
 	void notifyLoadedMeshes();
 	S32 getActualMeshLOD(const LLVolumeParams& mesh_params, S32 lod);
@@ -516,6 +545,8 @@ public:
 	static U32 sCacheBytesRead;
 	static U32 sCacheBytesWritten;
 	static U32 sPeakKbps;
+	static U32 sSpeculativeFetchCount;
+	static U32 sRoundTripsSaved;
 	
 	// Estimated triangle count of the largest LOD
 	F32 getEstTrianglesMax(LLUUID mesh_id);
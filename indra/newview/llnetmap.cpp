@@ -201,11 +201,14 @@ LLNetMap::LLNetMap(const std::string& name) :
 	mObjectImageCenterGlobal( gAgentCamera.getCameraPositionGlobal() ),
 	mObjectRawImagep(),
 	mObjectImagep(),
+	mObjectImageGeneration(0),
+	mObjectImageAltitude(0.0),
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3.0)
 	mParcelImageCenterGlobal( gAgentCamera.getCameraPositionGlobal() ),
 	mParcelRawImagep(),
 	mParcelImagep(),
 // [/SL:KB]
+	mParcelImageRegionKey(0),
 	mClosestAgentToCursor(),
 	mPopupMenu(NULL)
 {
@@ -324,13 +327,24 @@ void mm_setcolor(LLUUID key,LLColor4 col)
 {
 	mm_MarkerColors[key] = col;
 }
+static LLTrace::BlockTimerStatHandle FTM_MINIMAP_TERRAIN("Minimap Terrain");
+static LLTrace::BlockTimerStatHandle FTM_MINIMAP_OBJECTS("Minimap Objects");
+static LLTrace::BlockTimerStatHandle FTM_MINIMAP_PARCELS("Minimap Parcels");
+static LLTrace::BlockTimerStatHandle FTM_MINIMAP_AVATARS("Minimap Avatars");
+
+// Minimum time between two redraws of the object layer while objects are moving.
+const F32 OBJECT_IMAGE_MIN_INTERVAL = 0.5f;
+// Redraw the object layer once the view has moved this many map pixels away from its center.
+const F32 OBJECT_IMAGE_RECENTER_PIXELS = 2.f;
+// Redraw the object layer once the agent changed altitude by this much, when altitude filtering is on.
+const F64 OBJECT_IMAGE_ALTITUDE_SLOP = 1.0;
+
 void LLNetMap::draw()
 {
 	LLViewerRegion* region = gAgent.getRegion();
 
 	if (region == NULL) return;
 
- 	static LLFrameTimer map_timer;
 	static LLUIColor map_track_color = gTrackColor;
 	static const LLCachedControl<LLColor4> map_frustum_color(gColors, "NetMapFrustum", LLColor4::white);
 	static const LLCachedControl<LLColor4> map_frustum_rotating_color(gColors, "NetMapFrustumRotating", LLColor4::white);
@@ -407,6 +421,7 @@ void LLNetMap::draw()
 			 iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
 		{
 			LLViewerRegion* regionp = *iter;
+			LL_RECORD_BLOCK_TIME(FTM_MINIMAP_TERRAIN);
 
 			// Find x and y position relative to camera's center.
 			LLVector3 origin_agent = regionp->getOriginAgent();
@@ -521,9 +536,24 @@ void LLNetMap::draw()
 		LLVector3d posCenterGlobal = viewPosToGlobal(llfloor(posCenter.mV[VX]), llfloor(posCenter.mV[VY]));
 
 		static LLCachedControl<bool> s_fShowObjects(gSavedSettings, "ShowMiniMapObjects") ;
-		if ( (s_fShowObjects) && ((mUpdateObjectImage) || ((map_timer.getElapsedTimeF32() > 0.5f))) )
+		bool fObjectsChanged = mUpdateObjectImage;
+		if ( (s_fShowObjects) && (!fObjectsChanged) && (mObjectImageTimer.getElapsedTimeF32() > OBJECT_IMAGE_MIN_INTERVAL) )
+		{
+			// Only redraw the object layer when something it shows changed, rather than on a fixed timer.
+			static const LLCachedControl<U32> s_nAltitudeDelta(gSavedSettings, "MiniMapPrimMaxAltitudeDelta");
+			static const LLCachedControl<U32> s_nAltitudeDeltaOwn(gSavedSettings, "MiniMapPrimMaxAltitudeDeltaOwn");
+			const F32 fRecenterMeters = OBJECT_IMAGE_RECENTER_PIXELS * REGION_WIDTH_METERS / mScale;
+			fObjectsChanged = (gObjectList.getMapGeneration() != mObjectImageGeneration) ||
+				(dist_vec_squared2D(mObjectImageCenterGlobal, posCenterGlobal) > fRecenterMeters * fRecenterMeters) ||
+				( (s_nAltitudeDelta || s_nAltitudeDeltaOwn) &&
+				  (fabs(gAgent.getPositionGlobal().mdV[VZ] - mObjectImageAltitude) > OBJECT_IMAGE_ALTITUDE_SLOP) );
+		}
+		if ( (s_fShowObjects) && (fObjectsChanged) )
 		{
+			LL_RECORD_BLOCK_TIME(FTM_MINIMAP_OBJECTS);
 			mUpdateObjectImage = false;
+			mObjectImageGeneration = gObjectList.getMapGeneration();
+			mObjectImageAltitude = gAgent.getPositionGlobal().mdV[VZ];
 // [/SL:KB]
 
 //			// Locate the centre of the object layer, accounting for panning
@@ -544,14 +574,31 @@ void LLNetMap::draw()
 			gObjectList.renderObjectsForMap(*this);
 
 			mObjectImagep->setSubImage(mObjectRawImagep, 0, 0, mObjectImagep->getWidth(), mObjectImagep->getHeight());
-			map_timer.reset();
+			mObjectImageTimer.reset();
+		}
+		else if (!s_fShowObjects)
+		{
+			// Nothing is tracked while the layer is hidden
+			mUpdateObjectImage = true;
 		}
 
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3.0)
 		static LLCachedControl<bool> s_fShowPropertyLines(gSavedSettings, "MiniMapPropertyLines") ;
-		if ( (s_fShowPropertyLines) && ((mUpdateParcelImage) || (dist_vec_squared2D(mParcelImageCenterGlobal, posCenterGlobal) > 9.0f)) )
+		U32 nRegionKey = 0;
+		if (s_fShowPropertyLines)
 		{
+			// Regions coming and going (or dying) change the parcel layer too; parcel overlay updates flag it directly.
+			for (const LLViewerRegion* pRegion : LLWorld::getInstance()->getRegionList())
+			{
+				const U64 nHandle = pRegion->getHandle();
+				nRegionKey = nRegionKey * 31 + (U32)(nHandle ^ (nHandle >> 32)) + (pRegion->isAlive() ? 1 : 0);
+			}
+		}
+		if ( (s_fShowPropertyLines) && ((mUpdateParcelImage) || (nRegionKey != mParcelImageRegionKey) || (dist_vec_squared2D(mParcelImageCenterGlobal, posCenterGlobal) > 9.0f)) )
+		{
+			LL_RECORD_BLOCK_TIME(FTM_MINIMAP_PARCELS);
 			mUpdateParcelImage = false;
+			mParcelImageRegionKey = nRegionKey;
 			mParcelImageCenterGlobal = posCenterGlobal;
 
 			U8* pTextureData = mParcelRawImagep->getData();
@@ -571,6 +618,10 @@ void LLNetMap::draw()
 
 			mParcelImagep->setSubImage(mParcelRawImagep, 0, 0, mParcelImagep->getWidth(), mParcelImagep->getHeight());
 		}
+		else if (!s_fShowPropertyLines)
+		{
+			mUpdateParcelImage = true;
+		}
 // [/SL:KB]
 
 		LLVector3 map_center_agent = gAgent.getPosAgentFromGlobal(mObjectImageCenterGlobal);
@@ -643,6 +694,8 @@ void LLNetMap::draw()
 // [RLVa:KB] - Version: 1.23.4 | Alternate: Snowglobe-1.2.4 | Checked: 2009-07-08 (RLVa-1.0.0e) | Modified: RLVa-0.2.0b
 		bool show_friends = !gRlvHandler.hasBehaviour(RLV_BHVR_SHOWNAMES);
 // [/RLVa:KB]
+		// Avatars move all the time, so they are drawn directly every frame.
+		LL_RECORD_BLOCK_TIME(FTM_MINIMAP_AVATARS);
 		LLWorld::pos_map_t positions;
 
 		LLWorld::getInstance()->getAvatars(&positions, gAgentCamera.getCameraPositionGlobal());
@@ -34,6 +34,7 @@
 #define LL_LLNETMAP_H
 
 #include "lfidbearer.h"
+#include "llframetimer.h"
 #include "llpanel.h"
 
 
@@ -141,11 +142,16 @@ private:
 	LLVector3d		mObjectImageCenterGlobal;
 	LLPointer<LLImageRaw> mObjectRawImagep;
 	LLPointer<LLViewerTexture>	mObjectImagep;
+	// Inputs the object layer was last rendered with; it is only redrawn once one of them changes.
+	U32				mObjectImageGeneration;	// gObjectList.getMapGeneration()
+	F64				mObjectImageAltitude;	// agent altitude, for the MiniMapPrimMaxAltitudeDelta filters
+	LLFrameTimer	mObjectImageTimer;		// rate limits redraws while objects are moving
 // [SL:KB] - Patch: World-MinimapOverlay | Checked: 2012-06-20 (Catznip-3.3.0)
 	LLVector3d		mParcelImageCenterGlobal;
 	LLPointer<LLImageRaw> mParcelRawImagep;
 	LLPointer<LLViewerTexture>	mParcelImagep;
 // [/SL:KB]
+	U32				mParcelImageRegionKey;	// hash of the region list and alive states the parcel layer was drawn for
 
 	static std::map<LLUUID, LLVector3d> mClosestAgentsToCursor; // <exodus/>
 	static uuid_vec_t					mClosestAgentsAtLastClick; // <exodus/>
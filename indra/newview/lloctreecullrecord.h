@@ -0,0 +1,124 @@
+/**
+ * @file lloctreecullrecord.h
+ * @brief Splits an octree cull into a frustum pass for worker threads and an occlusion pass for the main thread.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLOCTREECULLRECORD_H
+#define LL_LLOCTREECULLRECORD_H
+
+#include <vector>
+
+class LLCamera;
+
+// A group the sequential cull reached, in the order it reached them.
+template<class GROUP>
+struct LLOctreeCullEntry
+{
+	GROUP*	mGroup;
+	U32		mSubtreeEnd;		// Index of the first entry that is not a descendant of mGroup.
+	bool	mSoftwareOccluded;	// Rejected by LLSoftwareOcclusion, the children were not tested.
+	bool	mProcess;			// Passed the frustum test, gets processed.
+};
+
+// Frustum half of the cull T, safe to run off the main thread: every group
+// that the sequential traversal would reach is recorded instead of processed,
+// and LLOctreeCullApply later replays the list with the occlusion tests.
+// Groups under GPU occluded nodes are still frustum tested here, as the
+// occlusion state is only known once the main thread has checked it.
+//
+// T is an LLViewerOctreeCull: it names its node and group types node_t and
+// group_t, and has a static softwareOcclusionFail(GROUP*) that does not touch
+// any main thread state.
+template<class T, class GROUP>
+class LLOctreeCullRecord : public T
+{
+public:
+	typedef std::vector<LLOctreeCullEntry<GROUP> > entry_list_t;
+
+	LLOctreeCullRecord(LLCamera* camera, entry_list_t& entries)
+		: T(camera), mEntries(entries) { }
+
+	virtual void traverse(const typename T::node_t* n)
+	{
+		U32 index = mEntries.size();
+		T::traverse(n);
+		mEntries[index].mSubtreeEnd = mEntries.size();
+	}
+
+	virtual bool earlyFail(typename T::group_t* base_group)
+	{
+		LLOctreeCullEntry<GROUP> entry;
+		entry.mGroup = (GROUP*)base_group;
+		entry.mSubtreeEnd = 0;
+		entry.mSoftwareOccluded = T::softwareOcclusionFail(entry.mGroup);
+		entry.mProcess = false;
+		mEntries.push_back(entry);
+		return entry.mSoftwareOccluded;
+	}
+
+	virtual void processGroup(typename T::group_t* base_group)
+	{
+		//called right after earlyFail() for the same group, before any child is recorded
+		mEntries.back().mProcess = true;
+	}
+
+private:
+	entry_list_t& mEntries;
+};
+
+// Main thread half of the cull T, see LLOctreeCullRecord. Each recorded group
+// goes through T::earlyFailRecorded(group, software_occluded), which is
+// T::earlyFail() with the software occlusion result already known, and the
+// ones that pass and passed the frustum test through T::processGroup().
+template<class T, class GROUP>
+class LLOctreeCullApply : public T
+{
+public:
+	typedef std::vector<LLOctreeCullEntry<GROUP> > entry_list_t;
+
+	LLOctreeCullApply(LLCamera* camera) : T(camera) { }
+
+	void apply(const entry_list_t& entries)
+	{
+		U32 i = 0;
+		while (i < entries.size())
+		{
+			const LLOctreeCullEntry<GROUP>& entry = entries[i];
+			if (T::earlyFailRecorded(entry.mGroup, entry.mSoftwareOccluded))
+			{
+				i = entry.mSubtreeEnd;
+			}
+			else
+			{
+				if (entry.mProcess)
+				{
+					T::processGroup(entry.mGroup);
+				}
+				++i;
+			}
+		}
+	}
+};
+
+#endif // LL_LLOCTREECULLRECORD_H
@@ -0,0 +1,535 @@
+/**
+ * @file llsoftwareocclusion.cpp
+ * @brief CPU depth buffer of large occluders, used to reject spatial groups before the GPU occlusion queries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "llviewerprecompiledheaders.h"
+
+#include "llsoftwareocclusion.h"
+
+#include "lldrawable.h"
+#include "lldrawpool.h"
+#include "llface.h"
+#include "llframetimer.h"
+#include "llspatialpartition.h"
+#include "llsurface.h"
+#include "llviewerregion.h"
+#include "llvovolume.h"
+#include "llworld.h"
+
+static LLTrace::BlockTimerStatHandle FTM_SOFTWARE_OCCLUSION("Software Occlusion");
+
+// Terrain occluders are blocks of CELL_METERS by CELL_METERS.
+const F32 CELL_METERS = 16.f;
+// Terrain heights are sampled again after this many seconds, to pick up terraforming.
+const F64 TERRAIN_REFRESH_SECONDS = 10.0;
+// Closest clip space w an occluder is drawn at.
+const F32 NEAR_W = 0.1f;
+// Number of box prims kept as occluders, and the smallest radius/distance ratio they need.
+const U32 MAX_OCCLUDERS = 32;
+const F32 MIN_OCCLUDER_SIZE = 0.1f;
+// An occluder has to be this much closer than a box before the box is considered hidden.
+const F32 DEPTH_BIAS = 1.001f;
+
+LLAtomicU32 LLSoftwareOcclusion::sGroupsTested = 0;
+U32 LLSoftwareOcclusion::sSoftwareCulled = 0;
+U32 LLSoftwareOcclusion::sQueryCulled = 0;
+
+LLSoftwareOcclusion::LLSoftwareOcclusion() :
+	mActive(false)
+{
+	mViewProj.setIdentity();
+	mDepth = (F32*)ll_aligned_malloc_16(WIDTH * HEIGHT * sizeof(F32));
+	memset(mDepth, 0, WIDTH * HEIGHT * sizeof(F32));
+}
+
+LLSoftwareOcclusion::~LLSoftwareOcclusion()
+{
+	ll_aligned_free_16(mDepth);
+}
+
+void LLSoftwareOcclusion::cleanup()
+{
+	mActive = false;
+	mOccluders.clear();
+	mTerrain.clear();
+}
+
+void LLSoftwareOcclusion::update(const LLMatrix4a& modelview, const LLMatrix4a& projection, const LLVector3& camera_agent, F32 far_clip)
+{
+	LL_RECORD_BLOCK_TIME(FTM_SOFTWARE_OCCLUSION);
+
+	mViewProj.setMul(projection, modelview);
+	memset(mDepth, 0, WIDTH * HEIGHT * sizeof(F32));
+
+	drawTerrain(camera_agent, far_clip);
+
+	for (drawable_list_t::iterator iter = mOccluders.begin(); iter != mOccluders.end(); ++iter)
+	{
+		LLDrawable* drawable = *iter;
+		if (!drawable->isDead() && !drawable->isActive())
+		{
+			drawBox(drawable->getWorldMatrix());
+		}
+	}
+
+	mActive = true;
+}
+
+bool LLSoftwareOcclusion::isOccluded(const LLVector4a* extents) const
+{
+	sGroupsTested++;
+
+	LLVector4a min_screen(F32_MAX, F32_MAX, 0.f);
+	LLVector4a max_screen(-F32_MAX, -F32_MAX, 0.f);
+	F32 max_inv_w = 0.f;
+	for (U32 i = 0; i < 8; ++i)
+	{
+		LLVector4a corner;
+		corner.set(extents[i & 1].getF32ptr()[0], extents[(i >> 1) & 1].getF32ptr()[1], extents[(i >> 2) & 1].getF32ptr()[2]);
+		LLVector4a clip;
+		mViewProj.affineTransform(corner, clip);
+		const F32 w = clip.getF32ptr()[3];
+		if (w < NEAR_W)
+		{	// Reaches the camera.
+			return false;
+		}
+		const F32 inv_w = 1.f / w;
+		LLVector4a screen((clip.getF32ptr()[0] * inv_w * 0.5f + 0.5f) * WIDTH,
+						  (clip.getF32ptr()[1] * inv_w * 0.5f + 0.5f) * HEIGHT, 0.f);
+		min_screen.setMin(min_screen, screen);
+		max_screen.setMax(max_screen, screen);
+		max_inv_w = llmax(max_inv_w, inv_w);
+	}
+
+	// Every pixel the box may touch.
+	const S32 x0 = llmax(llfloor(min_screen.getF32ptr()[0]), 0);
+	const S32 y0 = llmax(llfloor(min_screen.getF32ptr()[1]), 0);
+	const S32 x1 = llmin(llceil(max_screen.getF32ptr()[0]), (S32)WIDTH - 1);
+	const S32 y1 = llmin(llceil(max_screen.getF32ptr()[1]), (S32)HEIGHT - 1);
+	if (x0 > x1 || y0 > y1)
+	{	// Off screen, leave that to the frustum check.
+		return false;
+	}
+
+	// Hidden when every occluder pixel is closer (larger 1/w) than the closest corner.
+	const __m128 threshold = _mm_set1_ps(max_inv_w * DEPTH_BIAS);
+	const __m128i first = _mm_set1_epi32(x0);
+	const __m128i last = _mm_set1_epi32(x1);
+	const __m128i lane = _mm_set_epi32(3, 2, 1, 0);
+	const S32 start = x0 & ~3;
+	for (S32 y = y0; y <= y1; ++y)
+	{
+		const F32* row = mDepth + y * WIDTH;
+		for (S32 x = start; x <= x1; x += 4)
+		{
+			const __m128i px = _mm_add_epi32(_mm_set1_epi32(x), lane);
+			// Lanes inside [x0, x1].
+			const __m128i inside = _mm_andnot_si128(_mm_or_si128(_mm_cmplt_epi32(px, first), _mm_cmpgt_epi32(px, last)), _mm_set1_epi32(-1));
+			const __m128 visible = _mm_cmple_ps(_mm_load_ps(row + x), threshold);
+			if (_mm_movemask_ps(_mm_and_ps(visible, _mm_castsi128_ps(inside))))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void LLSoftwareOcclusion::drawTerrain(const LLVector3& camera_agent, F32 far_clip)
+{
+	LLWorld* world = LLWorld::getInstance();
+
+	// Underground the blocks would be in front of everything.
+	if (camera_agent.mV[VZ] < world->resolveLandHeightAgent(camera_agent))
+	{
+		return;
+	}
+
+	const F64 now = LLFrameTimer::getElapsedSeconds();
+	const F32 far_squared = far_clip * far_clip;
+	terrain_map_t live;
+	for (LLWorld::region_list_t::const_iterator iter = world->getRegionList().begin();
+		 iter != world->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+		terrain_map_t::iterator cells_iter = mTerrain.find(region->getHandle());
+		TerrainCells& cells = live[region->getHandle()];
+		if (cells_iter != mTerrain.end())
+		{
+			cells.mCellsPerEdge = cells_iter->second.mCellsPerEdge;
+			cells.mCellWidth = cells_iter->second.mCellWidth;
+			cells.mUpdateTime = cells_iter->second.mUpdateTime;
+			cells.mMinHeight.swap(cells_iter->second.mMinHeight);
+		}
+		if (cells.mMinHeight.empty() || now - cells.mUpdateTime > TERRAIN_REFRESH_SECONDS)
+		{
+			updateTerrainCells(region, cells);
+			cells.mUpdateTime = now;
+		}
+
+		const LLVector3 origin = region->getOriginAgent();
+		const S32 count = cells.mCellsPerEdge;
+		const F32 width = cells.mCellWidth;
+		for (S32 j = 0; j < count; ++j)
+		{
+			for (S32 i = 0; i < count; ++i)
+			{
+				const F32 x0 = origin.mV[VX] + i * width;
+				const F32 y0 = origin.mV[VY] + j * width;
+				const F32 x1 = x0 + width;
+				const F32 y1 = y0 + width;
+				const F32 z = origin.mV[VZ] + cells.mMinHeight[i + j * count];
+
+				const F32 dx = x0 + 0.5f * width - camera_agent.mV[VX];
+				const F32 dy = y0 + 0.5f * width - camera_agent.mV[VY];
+				if (dx * dx + dy * dy > far_squared)
+				{
+					continue;
+				}
+
+				// Top of the block.
+				drawQuad(LLVector4a(x0, y0, z), LLVector4a(x1, y0, z), LLVector4a(x1, y1, z), LLVector4a(x0, y1, z));
+
+				// Steps up to the next cells east and north. Every point on a shared edge is at least
+				// as high as both cells' minimum, so these are below the ground too.
+				if (i + 1 < count)
+				{
+					const F32 z_east = origin.mV[VZ] + cells.mMinHeight[i + 1 + j * count];
+					if (z_east != z)
+					{
+						const F32 low = llmin(z, z_east), high = llmax(z, z_east);
+						drawQuad(LLVector4a(x1, y0, low), LLVector4a(x1, y1, low), LLVector4a(x1, y1, high), LLVector4a(x1, y0, high));
+					}
+				}
+				if (j + 1 < count)
+				{
+					const F32 z_north = origin.mV[VZ] + cells.mMinHeight[i + (j + 1) * count];
+					if (z_north != z)
+					{
+						const F32 low = llmin(z, z_north), high = llmax(z, z_north);
+						drawQuad(LLVector4a(x0, y1, low), LLVector4a(x1, y1, low), LLVector4a(x1, y1, high), LLVector4a(x0, y1, high));
+					}
+				}
+			}
+		}
+	}
+	// Drops regions that went away.
+	mTerrain.swap(live);
+}
+
+void LLSoftwareOcclusion::updateTerrainCells(LLViewerRegion* region, TerrainCells& cells)
+{
+	const LLSurface& land = region->getLand();
+	const S32 grids_per_edge = land.getGridsPerEdge();
+	const F32 meters_per_grid = land.getMetersPerGrid();
+
+	cells.mCellsPerEdge = llmax(1, ll_round(region->getWidth() / CELL_METERS));
+	cells.mCellWidth = region->getWidth() / cells.mCellsPerEdge;
+	cells.mMinHeight.assign(cells.mCellsPerEdge * cells.mCellsPerEdge, F32_MAX);
+
+	const S32 grids_per_cell = llmax(1, ll_round(cells.mCellWidth / meters_per_grid));
+	for (S32 j = 0; j < cells.mCellsPerEdge; ++j)
+	{
+		for (S32 i = 0; i < cells.mCellsPerEdge; ++i)
+		{
+			F32& min_height = cells.mMinHeight[i + j * cells.mCellsPerEdge];
+			// Includes the grid points on the cell edges.
+			const S32 gx1 = llmin((i + 1) * grids_per_cell, grids_per_edge - 1);
+			const S32 gy1 = llmin((j + 1) * grids_per_cell, grids_per_edge - 1);
+			for (S32 gy = j * grids_per_cell; gy <= gy1; ++gy)
+			{
+				for (S32 gx = i * grids_per_cell; gx <= gx1; ++gx)
+				{
+					min_height = llmin(min_height, land.getZ(gx, gy));
+				}
+			}
+			if (min_height == F32_MAX)
+			{
+				min_height = 0.f;
+			}
+		}
+	}
+}
+
+void LLSoftwareOcclusion::drawBox(const LLMatrix4a& world)
+{
+	LLMatrix4a transform;
+	transform.setMul(mViewProj, world);
+
+	LLVector4a corners[8];
+	for (U32 i = 0; i < 8; ++i)
+	{
+		LLVector4a corner((i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f, (i & 4) ? 0.5f : -0.5f);
+		transform.affineTransform(corner, corners[i]);
+	}
+
+	static const U8 faces[6][4] = {
+		{ 0, 2, 3, 1 },	// -z
+		{ 4, 5, 7, 6 },	// +z
+		{ 0, 1, 5, 4 },	// -y
+		{ 2, 6, 7, 3 },	// +y
+		{ 0, 4, 6, 2 },	// -x
+		{ 1, 3, 7, 5 },	// +x
+	};
+	for (U32 i = 0; i < 6; ++i)
+	{
+		drawTriangle(corners[faces[i][0]], corners[faces[i][1]], corners[faces[i][2]]);
+		drawTriangle(corners[faces[i][0]], corners[faces[i][2]], corners[faces[i][3]]);
+	}
+}
+
+void LLSoftwareOcclusion::drawQuad(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2, const LLVector4a& v3)
+{
+	LLVector4a c0, c1, c2, c3;
+	mViewProj.affineTransform(v0, c0);
+	mViewProj.affineTransform(v1, c1);
+	mViewProj.affineTransform(v2, c2);
+	mViewProj.affineTransform(v3, c3);
+	drawTriangle(c0, c1, c2);
+	drawTriangle(c0, c2, c3);
+}
+
+void LLSoftwareOcclusion::drawTriangle(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2)
+{
+	const LLVector4a* in[3] = { &v0, &v1, &v2 };
+
+	// Clip against w = NEAR_W; at most 4 vertices come out.
+	LLVector4a out[4];
+	U32 count = 0;
+	for (U32 i = 0; i < 3; ++i)
+	{
+		const LLVector4a& a = *in[i];
+		const LLVector4a& b = *in[(i + 1) % 3];
+		const F32 wa = a.getF32ptr()[3];
+		const F32 wb = b.getF32ptr()[3];
+		if (wa >= NEAR_W)
+		{
+			out[count++] = a;
+		}
+		if ((wa >= NEAR_W) != (wb >= NEAR_W))
+		{
+			LLVector4a mid;
+			mid.setLerp(a, b, (NEAR_W - wa) / (wb - wa));
+			out[count++] = mid;
+		}
+	}
+	if (count < 3)
+	{
+		return;
+	}
+
+	LLVector4a screen[4];
+	for (U32 i = 0; i < count; ++i)
+	{
+		const F32* v = out[i].getF32ptr();
+		const F32 inv_w = 1.f / v[3];
+		screen[i].set((v[0] * inv_w * 0.5f + 0.5f) * WIDTH, (v[1] * inv_w * 0.5f + 0.5f) * HEIGHT, inv_w);
+	}
+	rasterize(screen[0], screen[1], screen[2]);
+	if (count == 4)
+	{
+		rasterize(screen[0], screen[2], screen[3]);
+	}
+}
+
+void LLSoftwareOcclusion::rasterize(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2)
+{
+	const F32* a = v0.getF32ptr();
+	const F32* b = v1.getF32ptr();
+	const F32* c = v2.getF32ptr();
+
+	F32 area = (b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]);
+	if (fabsf(area) < 1e-6f)
+	{
+		return;
+	}
+	if (area < 0.f)
+	{	// Occluders are drawn from both sides.
+		std::swap(b, c);
+		area = -area;
+	}
+
+	S32 x0 = llmax(llfloor(llmin(a[0], llmin(b[0], c[0]))), 0);
+	S32 y0 = llmax(llfloor(llmin(a[1], llmin(b[1], c[1]))), 0);
+	S32 x1 = llmin(llceil(llmax(a[0], llmax(b[0], c[0]))), (S32)WIDTH - 1);
+	S32 y1 = llmin(llceil(llmax(a[1], llmax(b[1], c[1]))), (S32)HEIGHT - 1);
+	if (x0 > x1 || y0 > y1)
+	{
+		return;
+	}
+	x0 &= ~3;
+
+	// Edge functions e(x, y) = ex * x + ey * y + e0, positive inside.
+	const F32 e0x = b[1] - c[1], e0y = c[0] - b[0], e00 = b[0] * c[1] - b[1] * c[0];	// opposite a
+	const F32 e1x = c[1] - a[1], e1y = a[0] - c[0], e10 = c[0] * a[1] - c[1] * a[0];	// opposite b
+	const F32 e2x = a[1] - b[1], e2y = b[0] - a[0], e20 = a[0] * b[1] - a[1] * b[0];	// opposite c
+
+	// 1/w is linear in screen space: the barycentric weights are the edge functions over the area.
+	const F32 inv_area = 1.f / area;
+	const F32 zx = (e0x * a[2] + e1x * b[2] + e2x * c[2]) * inv_area;
+	const F32 zy = (e0y * a[2] + e1y * b[2] + e2y * c[2]) * inv_area;
+	const F32 z0 = (e00 * a[2] + e10 * b[2] + e20 * c[2]) * inv_area;
+
+	const __m128 step = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 v_e0x = _mm_set1_ps(e0x), v_e1x = _mm_set1_ps(e1x), v_e2x = _mm_set1_ps(e2x), v_zx = _mm_set1_ps(zx);
+	for (S32 y = y0; y <= y1; ++y)
+	{
+		const F32 py = y + 0.5f;
+		const __m128 r0 = _mm_set1_ps(e0y * py + e00);
+		const __m128 r1 = _mm_set1_ps(e1y * py + e10);
+		const __m128 r2 = _mm_set1_ps(e2y * py + e20);
+		const __m128 rz = _mm_set1_ps(zy * py + z0);
+		F32* row = mDepth + y * WIDTH;
+		for (S32 x = x0; x <= x1; x += 4)
+		{
+			const __m128 px = _mm_add_ps(_mm_set1_ps((F32)x), step);
+			const __m128 w0 = _mm_add_ps(_mm_mul_ps(v_e0x, px), r0);
+			const __m128 w1 = _mm_add_ps(_mm_mul_ps(v_e1x, px), r1);
+			const __m128 w2 = _mm_add_ps(_mm_mul_ps(v_e2x, px), r2);
+			const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(w0, zero), _mm_cmpge_ps(w1, zero)), _mm_cmpge_ps(w2, zero));
+			if (!_mm_movemask_ps(inside))
+			{
+				continue;
+			}
+			const __m128 depth = _mm_load_ps(row + x);
+			const __m128 z = _mm_add_ps(_mm_mul_ps(v_zx, px), rz);
+			// Keep the nearest (largest 1/w) of the two, only inside the triangle.
+			_mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, _mm_max_ps(depth, z)), _mm_andnot_ps(inside, depth)));
+		}
+	}
+}
+
+// static
+bool LLSoftwareOcclusion::isBoxOccluder(LLDrawable* drawable)
+{
+	if (drawable->isDead() || drawable->isActive())
+	{
+		return false;
+	}
+	LLVOVolume* volume = drawable->getVOVolume();
+	if (!volume || volume->isAttachment() || volume->isFlexible() || volume->isSculpted() || volume->isMesh() || !volume->getVolume())
+	{
+		return false;
+	}
+
+	// Only a plain box is known to fill its bounding box.
+	const LLVolumeParams& params = volume->getVolume()->getParams();
+	const LLProfileParams& profile = params.getProfileParams();
+	const LLPathParams& path = params.getPathParams();
+	if (profile.getCurveType() != LL_PCODE_PROFILE_SQUARE || profile.getBegin() != 0.f || profile.getEnd() != 1.f || profile.getHollow() != 0.f ||
+		path.getCurveType() != LL_PCODE_PATH_LINE || path.getBegin() != 0.f || path.getEnd() != 1.f ||
+		path.getScaleX() != 1.f || path.getScaleY() != 1.f || path.getShearX() != 0.f || path.getShearY() != 0.f ||
+		path.getTwistBegin() != 0.f || path.getTwistEnd() != 0.f)
+	{
+		return false;
+	}
+
+	// Every face has to be drawn opaque.
+	if (drawable->getNumFaces() == 0)
+	{
+		return false;
+	}
+	for (S32 i = 0; i < drawable->getNumFaces(); ++i)
+	{
+		LLFace* face = drawable->getFace(i);
+		if (!face)
+		{
+			return false;
+		}
+		switch (face->getPoolType())
+		{
+			case LLDrawPool::POOL_SIMPLE:
+			case LLDrawPool::POOL_FULLBRIGHT:
+			case LLDrawPool::POOL_BUMP:
+			case LLDrawPool::POOL_MATERIALS:
+				break;
+			default:
+				return false;
+		}
+		const LLTextureEntry* te = face->getTextureEntry();
+		if (!te || te->getColor().mV[VALPHA] < 1.f)
+		{
+			return false;
+		}
+		// Deferred rendering puts alpha masked materials in POOL_MATERIALS too.
+		const LLMaterial* mat = te->getMaterialParams().get();
+		if (mat && (mat->getDiffuseAlphaMode() == LLMaterial::DIFFUSE_ALPHA_MODE_MASK ||
+					mat->getDiffuseAlphaMode() == LLMaterial::DIFFUSE_ALPHA_MODE_BLEND))
+		{
+			return false;
+		}
+		// An alpha channel can still cut holes through an auto masked face.
+		const LLViewerTexture* tex = face->getTexture();
+		if (!tex || !tex->hasGLTexture() || (tex->getComponents() == 4 && !tex->getIsOpaque()))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void LLSoftwareOcclusion::gatherOccluders(const LLCullResult& result, const LLVector3& camera_agent)
+{
+	LL_RECORD_BLOCK_TIME(FTM_SOFTWARE_OCCLUSION);
+
+	typedef std::pair<F32, LLDrawable*> candidate_t;
+	std::vector<candidate_t> candidates;
+	for (LLCullResult::sg_iterator iter = result.beginVisibleGroups(); iter != result.endVisibleGroups(); ++iter)
+	{
+		LLSpatialGroup* group = *iter;
+		if (group->getSpatialPartition()->mPartitionType != LLViewerRegion::PARTITION_VOLUME)
+		{
+			continue;
+		}
+		for (LLSpatialGroup::element_iter i = group->getDataBegin(); i != group->getDataEnd(); ++i)
+		{
+			LLDrawable* drawable = (LLDrawable*)(*i)->getDrawable();
+			if (!drawable)
+			{
+				continue;
+			}
+			const F32 distance = llmax(dist_vec(drawable->getPositionAgent(), camera_agent), 1.f);
+			const F32 size = drawable->getRadius() / distance;
+			if (size >= MIN_OCCLUDER_SIZE && isBoxOccluder(drawable))
+			{
+				candidates.push_back(candidate_t(size, drawable));
+			}
+		}
+	}
+
+	if (candidates.size() > MAX_OCCLUDERS)
+	{
+		std::nth_element(candidates.begin(), candidates.begin() + MAX_OCCLUDERS, candidates.end(),
+						 [](const candidate_t& lhs, const candidate_t& rhs) { return lhs.first > rhs.first; });
+		candidates.resize(MAX_OCCLUDERS);
+	}
+
+	mOccluders.clear();
+	for (std::vector<candidate_t>::iterator iter = candidates.begin(); iter != candidates.end(); ++iter)
+	{
+		mOccluders.push_back(iter->second);
+	}
+}
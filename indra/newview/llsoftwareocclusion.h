@@ -0,0 +1,114 @@
+/**
+ * @file llsoftwareocclusion.h
+ * @brief CPU depth buffer of large occluders, used to reject spatial groups before the GPU occlusion queries.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#ifndef LL_LLSOFTWAREOCCLUSION_H
+#define LL_LLSOFTWAREOCCLUSION_H
+
+#include <map>
+#include <vector>
+#include "llatomic.h"
+#include "llmatrix4a.h"
+#include "llpointer.h"
+#include "v3math.h"
+
+class LLCullResult;
+class LLDrawable;
+class LLViewerRegion;
+
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// LLSoftwareOcclusion
+//
+// Every world cull, a handful of large occluders are rasterized into a small
+// inverse depth buffer with SSE: the terrain (as blocks at the lowest height
+// of every 16m cell, so that they are always inside the ground) and the
+// biggest opaque box prims that were visible last frame. LLOctreeCull then
+// rejects groups whose bounding box lies entirely behind that buffer, which
+// works on the very frame a view is revealed, unlike the GPU queries whose
+// results come back frames later.
+//
+// Only occluders that are known to be solid are drawn, so a rejected group is
+// really hidden (up to the resolution of the buffer).
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+class LLSoftwareOcclusion
+{
+public:
+	enum { WIDTH = 256, HEIGHT = 128 };
+
+	LLSoftwareOcclusion();
+	~LLSoftwareOcclusion();
+
+	// Clears the buffer and draws the occluders as seen through the given (agent space) matrices.
+	void update(const LLMatrix4a& modelview, const LLMatrix4a& projection, const LLVector3& camera_agent, F32 far_clip);
+	// Stops testing until the next update().
+	void reset()								{ mActive = false; }
+	bool isActive() const						{ return mActive; }
+
+	// True when the agent space box extents[0]..extents[1] is hidden behind the occluders.
+	bool isOccluded(const LLVector4a* extents) const;
+
+	// Picks the largest opaque box prims out of the visible groups of result, to be drawn next frame.
+	void gatherOccluders(const LLCullResult& result, const LLVector3& camera_agent);
+
+	void cleanup();
+
+	// Per frame statistics, reset by the debug text display.
+	static LLAtomicU32 sGroupsTested;	// tested from the cull workers
+	static U32 sSoftwareCulled;		// groups rejected by this buffer
+	static U32 sQueryCulled;		// groups rejected by the GPU occlusion queries
+
+private:
+	struct TerrainCells
+	{
+		S32					mCellsPerEdge;
+		F32					mCellWidth;
+		F64					mUpdateTime;
+		std::vector<F32>	mMinHeight;		// Lowest terrain height in each cell, row major.
+	};
+
+	void drawTerrain(const LLVector3& camera_agent, F32 far_clip);
+	void updateTerrainCells(LLViewerRegion* region, TerrainCells& cells);
+	void drawBox(const LLMatrix4a& world);
+	void drawQuad(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2, const LLVector4a& v3);
+	// Clip space triangle: clips against the near plane, then rasterizes.
+	void drawTriangle(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2);
+	// Screen space triangle (x, y, 1/w).
+	void rasterize(const LLVector4a& v0, const LLVector4a& v1, const LLVector4a& v2);
+
+	static bool isBoxOccluder(LLDrawable* drawable);
+
+private:
+	bool			mActive;
+	LLMatrix4a		mViewProj;
+	F32*			mDepth;			// 1/w of the nearest occluder for every pixel, 0 when there is none.
+
+	typedef std::map<U64, TerrainCells> terrain_map_t;
+	terrain_map_t	mTerrain;		// Keyed by region handle.
+
+	typedef std::vector<LLPointer<LLDrawable> > drawable_list_t;
+	drawable_list_t	mOccluders;
+};
+
+#endif // LL_LLSOFTWAREOCCLUSION_H
@@ -937,12 +937,41 @@ public:
 	virtual bool earlyFail(LLViewerOctreeGroup* base_group)
 	{
 		LLSpatialGroup* group = (LLSpatialGroup*)base_group;
+		return earlyFailRecorded(group, softwareOcclusionFail(group));
+	}
+
+	// earlyFail() with the result of softwareOcclusionFail() already known, see LLOctreeCullApply.
+	bool earlyFailRecorded(LLSpatialGroup* group, bool software_occluded)
+	{
 		group->checkOcclusion();
 
+		if (software_occluded)
+		{
+			++LLSoftwareOcclusion::sSoftwareCulled;
+			return true;
+		}
+
+		return occlusionFail(group);
+	}
+
+	static bool softwareOcclusionFail(LLSpatialGroup* group)
+	{
+		return group->getOctreeNode()->getParent() &&	//never occlusion cull the root node
+			gPipeline.mSoftwareOcclusion.isActive() &&
+			!group->getSpatialPartition()->isBridge() &&	//bridge bounds are not in agent space
+			gPipeline.mSoftwareOcclusion.isOccluded(group->getExtents());
+	}
+
+	bool occlusionFail(LLSpatialGroup* group)
+	{
 		if (group->getOctreeNode()->getParent() &&	//never occlusion cull the root node
 		  	LLPipeline::sUseOcclusion &&			//ignore occlusion if disabled
 			group->isOcclusionState(LLSpatialGroup::OCCLUDED))
 		{
+			if (LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD)
+			{
+				++LLSoftwareOcclusion::sQueryCulled;
+			}
 			gPipeline.markOccluder(group);
 			return true;
 		}
@@ -1392,6 +1421,40 @@ S32 LLSpatialPartition::cull(LLCamera &camera, bool do_occlusion)
 	return 0;
 }
 
+void LLSpatialPartition::cullRebound()
+{
+	LL_RECORD_BLOCK_TIME(FTM_CULL_REBOUND);		
+	LLSpatialGroup* group = (LLSpatialGroup*) mOctree->getListener(0);
+	group->rebound();
+}
+
+void LLSpatialPartition::cullFrustum(LLCamera& camera, LLCullFragment& fragment)
+{
+	fragment.clear();
+
+	if (LLPipeline::sShadowRender)
+	{
+		LLOctreeCullRecord<LLOctreeCullShadow, LLSpatialGroup> culler(&camera, fragment.mEntries);
+		culler.traverse(mOctree);
+	}
+	else if (mInfiniteFarClip || !LLPipeline::sUseFarClip)
+	{
+		LLOctreeCullRecord<LLOctreeCullNoFarClip, LLSpatialGroup> culler(&camera, fragment.mEntries);
+		culler.traverse(mOctree);
+	}
+	else
+	{
+		LLOctreeCullRecord<LLOctreeCull, LLSpatialGroup> culler(&camera, fragment.mEntries);
+		culler.traverse(mOctree);
+	}
+}
+
+void LLSpatialPartition::cullApply(LLCamera& camera, const LLCullFragment& fragment)
+{
+	LLOctreeCullApply<LLOctreeCull, LLSpatialGroup> culler(&camera);
+	culler.apply(fragment.mEntries);
+}
+
 void pushVerts(LLDrawInfo* params, U32 mask)
 {
 	LLRenderPass::applyModelMatrix(*params);
@@ -3651,6 +3714,8 @@ void LLCullResult::clear()
 	{
 		mRenderMap[i].clear();
 	}
+
+	mMergedDrawInfo.clear();
 }
 
 void LLCullResult::assertDrawMapsEmpty()
@@ -3664,5 +3729,262 @@ void LLCullResult::assertDrawMapsEmpty()
 	}
 }
 
+//static
+LLCullResult::BatchStats LLCullResult::sBatchStats[LLRenderPass::NUM_RENDER_TYPES];
+
+//static
+void LLCullResult::resetBatchStats()
+{
+	memset(sBatchStats, 0, sizeof(sBatchStats));
+}
+
+namespace
+{
+	// Passes whose output doesn't depend on draw order: opaque or alpha masked
+	// geometry with depth writes, and additive glow.  Blended passes keep the
+	// order they were collected in.
+	bool is_order_independent(U32 type)
+	{
+		switch (type)
+		{
+		case LLRenderPass::PASS_SIMPLE:
+		case LLRenderPass::PASS_GRASS:
+		case LLRenderPass::PASS_FULLBRIGHT:
+		case LLRenderPass::PASS_FULLBRIGHT_SHINY:
+		case LLRenderPass::PASS_SHINY:
+		case LLRenderPass::PASS_BUMP:
+		case LLRenderPass::PASS_MATERIAL:
+		case LLRenderPass::PASS_MATERIAL_ALPHA_MASK:
+		case LLRenderPass::PASS_SPECMAP:
+		case LLRenderPass::PASS_SPECMAP_MASK:
+		case LLRenderPass::PASS_NORMMAP:
+		case LLRenderPass::PASS_NORMMAP_MASK:
+		case LLRenderPass::PASS_NORMSPEC:
+		case LLRenderPass::PASS_NORMSPEC_MASK:
+		case LLRenderPass::PASS_GLOW:
+		case LLRenderPass::PASS_ALPHA_MASK:
+		case LLRenderPass::PASS_FULLBRIGHT_ALPHA_MASK:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	inline U64 pointer_bits(const void* ptr, U32 bits)
+	{
+		U64 p = (U64) (uintptr_t) ptr;
+		return ((p >> 4) ^ (p >> (4 + bits))) & ((1ULL << bits) - 1);
+	}
+
+	// Key bits, high to low: model matrix (12), texture GL name (20), vertex
+	// buffer (16), index offset (16).  Distinct pointers may share bits, which
+	// only costs a missed batch; equal state always gets equal bits.
+	U64 batch_key(const LLDrawInfo& params)
+	{
+		U64 tex = params.mTexture.notNull() ? (U64) (params.mTexture->getTexName() & 0xFFFFF) : 0;
+		return (pointer_bits(params.mModelMatrix, 12) << 52) |
+			   (tex << 32) |
+			   (pointer_bits(params.mVertexBuffer.get(), 16) << 16) |
+			   llmin(params.mOffset, (U32) 0xFFFF);
+	}
+
+	bool same_state(const LLDrawInfo& a, const LLDrawInfo& b)
+	{
+		return a.mModelMatrix == b.mModelMatrix &&
+			   a.mTexture == b.mTexture &&
+			   a.mVertexBuffer == b.mVertexBuffer;
+	}
+
+	U32 count_state_changes(const LLCullResult::drawinfo_list_t& list)
+	{
+		U32 changes = 0;
+		const LLDrawInfo* last = NULL;
+		for (LLCullResult::drawinfo_list_t::const_iterator iter = list.begin(); iter != list.end(); ++iter)
+		{
+			const LLDrawInfo* params = *iter;
+			if (params && (!last || !same_state(*last, *params)))
+			{
+				++changes;
+			}
+			last = params ? params : last;
+		}
+		return changes;
+	}
+
+	// b draws the index range right after a with nothing that pushBatch or a
+	// pool's override would set differently
+	bool can_merge(const LLDrawInfo& a, const LLDrawInfo& b)
+	{
+		return same_state(a, b) &&
+			   a.mDrawMode == LLRender::TRIANGLES && b.mDrawMode == LLRender::TRIANGLES &&
+			   a.mOffset + a.mCount == b.mOffset &&
+			   a.mGroup == b.mGroup &&
+			   a.mTextureMatrix == b.mTextureMatrix &&
+			   a.mTextureList == b.mTextureList &&
+			   a.mFullbright == b.mFullbright &&
+			   a.mBump == b.mBump &&
+			   a.mShiny == b.mShiny &&
+			   a.mParticle == b.mParticle &&
+			   a.mMaterial == b.mMaterial &&
+			   a.mMaterialID == b.mMaterialID &&
+			   a.mShaderMask == b.mShaderMask &&
+			   a.mBlendFuncSrc == b.mBlendFuncSrc &&
+			   a.mBlendFuncDst == b.mBlendFuncDst &&
+			   a.mHasGlow == b.mHasGlow &&
+			   a.mSpecularMap == b.mSpecularMap &&
+			   a.mNormalMap == b.mNormalMap &&
+			   a.mSpecColor == b.mSpecColor &&
+			   a.mEnvIntensity == b.mEnvIntensity &&
+			   a.mAlphaMaskCutoff == b.mAlphaMaskCutoff &&
+			   a.mDiffuseAlphaMode == b.mDiffuseAlphaMode;
+	}
+}
+
+static LLTrace::BlockTimerStatHandle FTM_BATCH_RENDER_MAPS("Batch Draw Info");
+
+void LLCullResult::batchRenderMaps()
+{
+	LL_RECORD_BLOCK_TIME(FTM_BATCH_RENDER_MAPS);
+
+	for (U32 i = 0; i < LLRenderPass::NUM_RENDER_TYPES; i++)
+	{
+		if (is_order_independent(i) && mRenderMap[i].size() > 1)
+		{
+			batchRenderMap(i);
+		}
+	}
+}
+
+void LLCullResult::batchRenderMap(U32 type)
+{
+	drawinfo_list_t& list = mRenderMap[type];
+	BatchStats& stats = sBatchStats[type];
+
+	stats.mDraws += list.size();
+	stats.mStateChanges += count_state_changes(list);
+
+	//least significant digit radix sort, 8 bits at a time; stable, so draws
+	//with equal keys keep the order they had within their group
+	std::vector<std::pair<U64, LLDrawInfo*> >& src = mSortScratch[0];
+	std::vector<std::pair<U64, LLDrawInfo*> >& dst = mSortScratch[1];
+	src.clear();
+	for (drawinfo_list_t::iterator iter = list.begin(); iter != list.end(); ++iter)
+	{
+		if (*iter)
+		{
+			src.push_back(std::make_pair(batch_key(**iter), *iter));
+		}
+	}
+	if (src.empty())
+	{
+		return;
+	}
+	dst.resize(src.size());
+
+	U32 histogram[8][256];
+	memset(histogram, 0, sizeof(histogram));
+	for (size_t j = 0; j < src.size(); ++j)
+	{
+		U64 key = src[j].first;
+		for (U32 digit = 0; digit < 8; ++digit)
+		{
+			++histogram[digit][(key >> (digit * 8)) & 0xFF];
+		}
+	}
+
+	for (U32 digit = 0; digit < 8; ++digit)
+	{
+		U32* counts = histogram[digit];
+		U32 shift = digit * 8;
+		if (counts[(src[0].first >> shift) & 0xFF] == src.size())
+		{ //every key has the same byte here
+			continue;
+		}
+
+		U32 sum = 0;
+		for (U32 b = 0; b < 256; ++b)
+		{
+			U32 count = counts[b];
+			counts[b] = sum;
+			sum += count;
+		}
+
+		for (size_t j = 0; j < src.size(); ++j)
+		{
+			dst[counts[(src[j].first >> shift) & 0xFF]++] = src[j];
+		}
+		src.swap(dst);
+	}
+
+	//rebuild the list, folding runs of mergeable draws
+	list.clear();
+	for (size_t j = 0; j < src.size(); )
+	{
+		LLDrawInfo* first = src[j].second;
+		size_t run_end = j + 1;
+		U32 count = first->mCount;
+		while (run_end < src.size() && can_merge(*src[run_end - 1].second, *src[run_end].second))
+		{
+			count += src[run_end].second->mCount;
+			++run_end;
+		}
+
+		if (run_end - j == 1)
+		{
+			list.push_back(first);
+		}
+		else
+		{
+			U16 start = first->mStart;
+			U16 end = first->mEnd;
+			F32 vsize = first->mVSize;
+			LLVector4a extents[2] = { first->mExtents[0], first->mExtents[1] };
+			for (size_t k = j + 1; k < run_end; ++k)
+			{
+				const LLDrawInfo* params = src[k].second;
+				start = llmin(start, params->mStart);
+				end = llmax(end, params->mEnd);
+				vsize = llmax(vsize, params->mVSize);
+				extents[0].setMin(extents[0], params->mExtents[0]);
+				extents[1].setMax(extents[1], params->mExtents[1]);
+			}
+
+			LLPointer<LLDrawInfo> merged = new LLDrawInfo(start, end, count, first->mOffset,
+														  first->mTexture, first->mVertexBuffer,
+														  first->mFullbright, first->mBump, first->mParticle, first->mPartSize);
+			merged->mExtents[0] = extents[0];
+			merged->mExtents[1] = extents[1];
+			merged->mTextureList = first->mTextureList;
+			merged->mTextureMatrix = first->mTextureMatrix;
+			merged->mModelMatrix = first->mModelMatrix;
+			merged->mShiny = first->mShiny;
+			merged->mVSize = vsize;
+			merged->mGroup = first->mGroup;
+			merged->mDistance = first->mDistance;
+			merged->mDrawMode = first->mDrawMode;
+			merged->mMaterial = first->mMaterial;
+			merged->mMaterialID = first->mMaterialID;
+			merged->mShaderMask = first->mShaderMask;
+			merged->mBlendFuncSrc = first->mBlendFuncSrc;
+			merged->mBlendFuncDst = first->mBlendFuncDst;
+			merged->mHasGlow = first->mHasGlow;
+			merged->mSpecularMap = first->mSpecularMap;
+			merged->mNormalMap = first->mNormalMap;
+			merged->mSpecColor = first->mSpecColor;
+			merged->mEnvIntensity = first->mEnvIntensity;
+			merged->mAlphaMaskCutoff = first->mAlphaMaskCutoff;
+			merged->mDiffuseAlphaMode = first->mDiffuseAlphaMode;
+
+			mMergedDrawInfo.push_back(merged);
+			list.push_back(merged);
+		}
+
+		j = run_end;
+	}
+
+	stats.mBatchedDraws += list.size();
+	stats.mBatchedStateChanges += count_state_changes(list);
+}
+
 
 
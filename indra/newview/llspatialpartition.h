@@ -38,6 +38,7 @@
 #include "llmemory.h"
 #include "lldrawable.h"
 #include "lloctree.h"
+#include "lloctreecullrecord.h"
 #include "llpointer.h"
 #include "llrefcount.h"
 #include "llvertexbuffer.h"
@@ -56,6 +57,7 @@ class LLViewerOctreePartition;
 class LLSpatialPartition;
 class LLSpatialBridge;
 class LLSpatialGroup;
+class LLCullFragment;
 class LLViewerRegion;
 
 void pushVerts(LLFace* face, U32 mask);
@@ -414,6 +416,13 @@ public:
 	BOOL visibleObjectsInFrustum(LLCamera& camera);
 	/*virtual*/ S32 cull(LLCamera &camera, bool do_occlusion=false); // Cull on arbitrary frustum
 	S32 cull(LLCamera &camera, std::vector<LLDrawable *>* results); // Cull on arbitrary frustum
+
+	// cull() split in three, so that the frustum tests of several partitions can run in parallel:
+	// cullRebound() and cullApply() on the main thread, cullFrustum() on any thread in between
+	// (nothing may touch the octree meanwhile).
+	void cullRebound();
+	void cullFrustum(LLCamera& camera, LLCullFragment& fragment);
+	void cullApply(LLCamera& camera, const LLCullFragment& fragment);
 	
 	BOOL isVisible(const LLVector3& v);
 	bool isHUDPartition() ;
@@ -473,6 +482,19 @@ public:
 	LLDrawable* mDrawable;
 };
 
+// Frustum test results of one partition, in the order the sequential cull visits the groups.
+// Occlusion and visibility are left to LLSpatialPartition::cullApply(), which needs GL.
+class LLCullFragment
+{
+public:
+	typedef LLOctreeCullEntry<LLSpatialGroup> Entry;
+	typedef std::vector<Entry> entry_list_t;
+
+	void clear()									{ mEntries.clear(); }
+
+	entry_list_t mEntries;
+};
+
 class LLCullResult 
 {
 public:
@@ -523,9 +545,27 @@ public:
 	void pushBridge(LLSpatialBridge* bridge)			  {  mVisibleBridge.push_back(bridge); }
 	void pushDrawInfo(U32 type, LLDrawInfo* draw_info)	  {  mRenderMap[type].push_back(draw_info); }
 
+	// Reorder the draw infos of every pass whose result doesn't depend on draw
+	// order so that draws sharing a model matrix, texture and vertex buffer are
+	// consecutive, then fold consecutive draws of adjacent index ranges with
+	// identical state into one.
+	void batchRenderMaps();
+
 	void assertDrawMapsEmpty();
 
+	struct BatchStats
+	{
+		U32 mDraws;					// draws in the pass as collected from the groups
+		U32 mStateChanges;			// matrix, texture or vertex buffer changes between them
+		U32 mBatchedDraws;			// draws after sorting and merging
+		U32 mBatchedStateChanges;
+	};
+	static BatchStats sBatchStats[LLRenderPass::NUM_RENDER_TYPES];
+	static void resetBatchStats();
+
 private:
+	void batchRenderMap(U32 type);
+
 	sg_list_t			mVisibleGroups;
 	sg_list_t			mAlphaGroups;
 	sg_list_t			mOcclusionGroups;
@@ -533,6 +573,8 @@ private:
 	drawable_list_t		mVisibleList;
 	bridge_list_t		mVisibleBridge;
 	drawinfo_list_t		mRenderMap[LLRenderPass::NUM_RENDER_TYPES];
+	std::vector<LLPointer<LLDrawInfo> > mMergedDrawInfo;	// draws created by batchRenderMaps, valid until clear()
+	std::vector<std::pair<U64, LLDrawInfo*> > mSortScratch[2];
 };
 
 
@@ -191,6 +191,8 @@
 #include "llviewerthrottle.h"
 #include "llviewerwindow.h"
 #include "llvoavatarself.h"
+#include "lltexlayer.h"
+#include "lltexlayercompositor.h"
 #include "llvoclouds.h"
 #include "llweb.h"
 #include "llwind.h"
@@ -1672,6 +1674,9 @@ bool idle_startup()
 
 		// init the shader managers
 
+		LLAvatarAppearance::sUseDefinitionCache = gSavedSettings.getBOOL("AvatarDefinitionCache");
+		LLTexLayerSet::sUseCPUCompositor = gSavedSettings.getBOOL("AvatarBakeOnCPU");
+		LLTexLayerCompositor::setThreadCount(gSavedSettings.getS32("AvatarBakeCompositorThreads"));
 		LLAvatarAppearance::initClass();
 		display_startup();
 
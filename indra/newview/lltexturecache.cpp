@@ -116,7 +116,7 @@ public:
 	~LLTextureCacheWorker()
 	{
 		llassert_always(!haveWork());
-		FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+		FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 	}
 
 	// override this interface
@@ -218,7 +218,7 @@ bool LLTextureCacheLocalFileWorker::doRead()
 			mDataSize = 0;
 			return true;
 		}
-		mReadData = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), mDataSize);
+		mReadData = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, mDataSize);
 		mBytesRead = -1;
 		mBytesToRead = mDataSize;
 		setPriority(LLWorkerThread::PRIORITY_LOW | mPriority);
@@ -236,7 +236,7 @@ bool LLTextureCacheLocalFileWorker::doRead()
 // 						<< " Bytes: " << mDataSize << " Offset: " << mOffset
 // 						<< " / " << mDataSize << LL_ENDL;
 				mDataSize = 0; // failed
-				FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+				FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 				mReadData = NULL;
 			}
 			return true;
@@ -251,7 +251,7 @@ bool LLTextureCacheLocalFileWorker::doRead()
 	{
 		mDataSize = local_size;
 	}
-	mReadData = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), mDataSize);
+	mReadData = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, mDataSize);
 	
 	S32 bytes_read = LLAPRFile::readEx(mFileName, mReadData, mOffset, mDataSize);
 
@@ -261,7 +261,7 @@ bool LLTextureCacheLocalFileWorker::doRead()
 // 				<< " Bytes: " << mDataSize << " Offset: " << mOffset
 // 				<< " / " << mDataSize << LL_ENDL;
 		mDataSize = 0;
-		FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+		FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 		mReadData = NULL;
 	}
 	else
@@ -380,7 +380,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 			mDataSize = local_size/*	- mOffset*/;
 		}
 		// Allocate read buffer
-		mReadData = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), mDataSize);
+		mReadData = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, mDataSize);
 		S32 bytes_read = LLAPRFile::readEx(local_filename, mReadData, mOffset, mDataSize);
 		if (bytes_read != mDataSize)
 		{
@@ -388,7 +388,7 @@ bool LLTextureCacheRemoteWorker::doRead()
  					<< " Bytes: " << mDataSize << " Offset: " << mOffset
  					<< " / " << mDataSize << LL_ENDL;
 			mDataSize = 0;
-			FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+			FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 			mReadData = NULL;
 		}
 		else
@@ -431,14 +431,14 @@ bool LLTextureCacheRemoteWorker::doRead()
 		S32 size = TEXTURE_CACHE_ENTRY_SIZE - mOffset;
 		size = llmin(size, mDataSize);
 		// Allocate the read buffer
-		mReadData = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), size);
+		mReadData = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, size);
 		S32 bytes_read = LLAPRFile::readEx(mCache->mHeaderDataFileName, mReadData, offset, size);
 		if (bytes_read != size)
 		{
 			LL_WARNS() << "LLTextureCacheWorker: "  << mID
 					<< " incorrect number of bytes read from header: " << bytes_read
 					<< " / " << size << LL_ENDL;
-			FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+			FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 			mReadData = NULL;
 			mDataSize = -1; // failed
 			done = true;
@@ -468,7 +468,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 			S32 data_offset, file_size, file_offset;
 			
 			// Reserve the whole data buffer first
-			U8* data = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), mDataSize);
+			U8* data = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, mDataSize);
 
 			// Set the data file pointers taking the read offset into account. 2 cases:
 			if (mOffset < TEXTURE_CACHE_ENTRY_SIZE)
@@ -481,7 +481,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 				// Copy the raw data we've been holding from the header cache into the new sized buffer
 				llassert_always(mReadData);
 				memcpy(data, mReadData, data_offset);
-				FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+				FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 				mReadData = NULL;
 			}
 			else
@@ -506,7 +506,7 @@ bool LLTextureCacheRemoteWorker::doRead()
 				LL_DEBUGS("TextureCache") << "LLTextureCacheWorker: "  << mID
 						<< " incorrect number of bytes read from body: " << bytes_read
 						<< " / " << file_size << LL_ENDL;
-				FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+				FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 				mReadData = NULL;
 				mDataSize = -1; // failed
 				done = true;
@@ -598,11 +598,11 @@ bool LLTextureCacheRemoteWorker::doWrite()
 		{
 			// We need to write a full record in the header cache so, if the amount of data is smaller
 			// than a record, we need to transfer the data to a buffer padded with 0 and write that
-			U8* padBuffer = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), TEXTURE_CACHE_ENTRY_SIZE);
+			U8* padBuffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, TEXTURE_CACHE_ENTRY_SIZE);
 			memset(padBuffer, 0, TEXTURE_CACHE_ENTRY_SIZE);		// Init with zeros
 			memcpy(padBuffer, mWriteData, mDataSize);			// Copy the write buffer
 			bytes_written = LLAPRFile::writeEx(mCache->mHeaderDataFileName, padBuffer, offset, size);
-			FREE_MEM(LLImageBase::getPrivatePool(), padBuffer);
+			FREE_MEM(LLSizeClassAllocator::IMAGE, padBuffer);
 		}
 		else
 		{
@@ -697,7 +697,7 @@ void LLTextureCacheWorker::finishWork(S32 param, bool completed)
 			}
 			else
 			{
-				FREE_MEM(LLImageBase::getPrivatePool(), mReadData);
+				FREE_MEM(LLSizeClassAllocator::IMAGE, mReadData);
 				mReadData = NULL;
 			}
 		}
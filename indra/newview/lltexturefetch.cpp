@@ -206,6 +206,7 @@ private:
 	
 	void setImagePriority(F32 priority);
 	void setDesiredDiscard(S32 discard, S32 size);
+	bool setDesiredSizeFromIndex();
 	bool insertPacket(S32 index, U8* data, S32 size);
 	void clearPackets();
 	void setupPacketData();
@@ -1004,6 +1005,26 @@ void LLTextureFetchWorker::setDesiredDiscard(S32 discard, S32 size)
 	}
 }
 
+// Ask for exactly the bytes of the desired discard level when the codestream
+// we have tells where it ends, rather than the estimate createRequest() made.
+// Returns true if it did.
+// mWorkMutex is locked
+bool LLTextureFetchWorker::setDesiredSizeFromIndex()
+{
+	if (mDesiredDiscard <= 0 || mFormattedImage.isNull() || mFormattedImage->getCodec() != IMG_CODEC_J2C)
+	{
+		// Full requests get everything there is anyway
+		return false;
+	}
+	S32 indexed_size = ((LLImageJ2C*)mFormattedImage.get())->calcIndexedDataSize(mDesiredDiscard);
+	if (indexed_size <= 0)
+	{
+		return false;
+	}
+	mDesiredSize = llmax(indexed_size, TEXTURE_CACHE_ENTRY_SIZE);
+	return true;
+}
+
 void LLTextureFetchWorker::setImagePriority(F32 priority)
 {
 // 	llassert_always(priority >= 0 && priority <= LLViewerTexture::maxDecodePriority());
@@ -1195,6 +1216,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 	if (mState == CACHE_POST)
 	{
 		mCachedSize = mFormattedImage.notNull() ? mFormattedImage->getDataSize() : 0;
+		setDesiredSizeFromIndex();
 		// Successfully loaded
 		if ((mCachedSize >= mDesiredSize) || mHaveAllData)
 		{
@@ -1428,6 +1450,16 @@ bool LLTextureFetchWorker::doWork(S32 param)
 			}
 		}
 
+		if (setDesiredSizeFromIndex() && cur_size >= mDesiredSize)
+		{
+			// The codestream says we already have the desired discard level
+			mFetcher->removeFromNetworkQueue(this, false);
+			mLoadedDiscard = mDesiredDiscard;
+			setPriority(LLWorkerThread::PRIORITY_HIGH | mWorkPriority);
+			setState(DECODE_IMAGE);
+			return false;
+		}
+
 		// Let AICurl decide if we can process more HTTP requests at the moment or not.
 
 		// AIPerService::approveHTTPRequestFor returns approvement for ONE request.
@@ -1746,7 +1778,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 				mFileSize = total_size + 1 ; //flag the file is not fully loaded.
 			}
 			
-			U8* buffer = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), total_size);
+			U8* buffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, total_size);
 			if (cur_size > 0)
 			{
 				memcpy(buffer, mFormattedImage->getData(), cur_size);
@@ -1833,7 +1865,7 @@ bool LLTextureFetchWorker::doWork(S32 param)
 		LL_DEBUGS(LOG_TXT) << mID << ": Decoding. Bytes: " << mFormattedImage->getDataSize() << " Discard: " << discard
 				<< " All Data: " << mHaveAllData << LL_ENDL;
 		mDecodeHandle = mFetcher->mImageDecodeThread->decodeImage(mFormattedImage, image_priority, discard, mNeedsAux,
-																  new DecodeResponder(mFetcher, mID, this));
+																  new DecodeResponder(mFetcher, mID, this), mDesiredDiscard);
 		// fall though
 	}
 	
@@ -2067,7 +2099,7 @@ bool LLTextureFetchWorker::processSimulatorPackets()
 			if (buffer_size > cur_size)
 			{
 				/// We have new data
-				U8* buffer = (U8*)ALLOCATE_MEM(LLImageBase::getPrivatePool(), buffer_size);
+				U8* buffer = (U8*)ALLOCATE_MEM(LLSizeClassAllocator::IMAGE, buffer_size);
 				S32 offset = 0;
 				if (cur_size > 0 && mFirstPacket > 0)
 				{
@@ -3282,17 +3314,15 @@ S32 LLTextureFetch::getFetchState(const LLUUID& id, F32& data_progress_p, F32& r
 void LLTextureFetch::dump()
 {
 	LL_INFOS(LOG_TXT) << "LLTextureFetch REQUESTS:" << LL_ENDL;
-	for (request_queue_t::iterator iter = mRequestQueue.begin();
-		 iter != mRequestQueue.end(); ++iter)
+	mRequestQueue.forEach([](LLQueuedThread::QueuedRequest* qreq)
 	{
-		LLQueuedThread::QueuedRequest* qreq = *iter;
 		LLWorkerThread::WorkRequest* wreq = (LLWorkerThread::WorkRequest*)qreq;
 		LLTextureFetchWorker* worker = (LLTextureFetchWorker*)wreq->getWorkerClass();
 		LL_INFOS(LOG_TXT) << " ID: " << worker->mID
 				<< " PRI: " << llformat("0x%08x",wreq->getPriority())
 				<< " STATE: " << worker->sStateDescs[worker->mState]
 				<< LL_ENDL;
-	}
+	});
 
 	LL_INFOS(LOG_TXT) << "LLTextureFetch ACTIVE_HTTP:" << LL_ENDL;
 	for (queue_t::const_iterator iter(mHTTPTextureQueue.begin());
@@ -46,10 +46,13 @@
 #include "lldrawpoolterrain.h"
 #include "llflexibleobject.h"
 #include "llfeaturemanager.h"
+#include "llimagej2c.h"
 #include "llviewershadermgr.h"
 #include "llpanelgeneral.h"
 #include "llpanelinput.h"
 #include "llsky.h"
+#include "lltexlayer.h"
+#include "lltexlayercompositor.h"
 #include "llvieweraudio.h"
 #include "llviewertexturelist.h"
 #include "llviewerthrottle.h"
@@ -250,6 +253,36 @@ static bool handleAnisotropicChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleTexturePixelBuffersChanged(const LLSD& newvalue)
+{
+	LLImageGL::sUsePixelBuffers = newvalue.asBoolean();
+	return true;
+}
+
+static bool handleVolumeFaceThreadsChanged(const LLSD& newvalue)
+{
+	LLVolume::setFaceThreadCount((S32) newvalue.asInteger());
+	return true;
+}
+
+static bool handleTextureDecodeThreadsChanged(const LLSD& newvalue)
+{
+	LLImageJ2C::setDecodeThreadCount((S32) newvalue.asInteger());
+	return true;
+}
+
+static bool handleIndexedJ2CUploadChanged(const LLSD& newvalue)
+{
+	LLImageJ2C::setEncodeIndexed(newvalue.asBoolean());
+	return true;
+}
+
+static bool handleTextureResumableDecodeMaxMBChanged(const LLSD& newvalue)
+{
+	LLImageJ2C::setDecodeCacheLimit((U32) newvalue.asInteger());
+	return true;
+}
+
 static bool handleVolumeLODChanged(const LLSD& newvalue)
 {
 	LLVOVolume::sLODFactor = (F32) newvalue.asReal();
@@ -275,6 +308,18 @@ static bool handleAvatarMaxVisibleChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleAvatarBakeOnCPUChanged(const LLSD& newvalue)
+{
+	LLTexLayerSet::sUseCPUCompositor = newvalue.asBoolean();
+	return true;
+}
+
+static bool handleAvatarBakeCompositorThreadsChanged(const LLSD& newvalue)
+{
+	LLTexLayerCompositor::setThreadCount(newvalue.asInteger());
+	return true;
+}
+
 static bool handleTerrainLODChanged(const LLSD& newvalue)
 {
 		LLVOSurfacePatch::sLODFactor = (F32)newvalue.asReal();
@@ -541,6 +586,12 @@ static bool handleLogFileChanged(const LLSD& newvalue)
 	return true;
 }
 
+static bool handleAsyncLoggingChanged(const LLSD& newvalue)
+{
+	LLError::setAsyncLogging(newvalue.asBoolean());
+	return true;
+}
+
 bool handleHideGroupTitleChanged(const LLSD& newvalue)
 {
 	gAgent.setHideGroupTitle(newvalue);
@@ -707,6 +758,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderSpecularResY")->getSignal()->connect(boost::bind(&handleLUTBufferChanged, _2));
 	gSavedSettings.getControl("RenderSpecularExponent")->getSignal()->connect(boost::bind(&handleLUTBufferChanged, _2));
 	gSavedSettings.getControl("RenderAnisotropic")->getSignal()->connect(boost::bind(&handleAnisotropicChanged, _2));
+	gSavedSettings.getControl("RenderTexturePixelBuffers")->getSignal()->connect(boost::bind(&handleTexturePixelBuffersChanged, _2));
 	gSavedSettings.getControl("RenderShadowResolutionScale")->getSignal()->connect(boost::bind(&handleReleaseGLBufferChanged, _2));
 	gSavedSettings.getControl("RenderGlow")->getSignal()->connect(boost::bind(&handleReleaseGLBufferChanged, _2));
 	gSavedSettings.getControl("RenderGlow")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
@@ -715,9 +767,15 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("WindLightUseAtmosShaders")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("RenderGammaFull")->getSignal()->connect(boost::bind(&handleSetShaderChanged, _2));
 	gSavedSettings.getControl("RenderAvatarMaxVisible")->getSignal()->connect(boost::bind(&handleAvatarMaxVisibleChanged, _2));
+	gSavedSettings.getControl("AvatarBakeOnCPU")->getSignal()->connect(boost::bind(&handleAvatarBakeOnCPUChanged, _2));
+	gSavedSettings.getControl("AvatarBakeCompositorThreads")->getSignal()->connect(boost::bind(&handleAvatarBakeCompositorThreadsChanged, _2));
 	gSavedSettings.getControl("RenderAvatarInvisible")->getSignal()->connect(boost::bind(&handleSetSelfInvisible, _2));
 	gSavedSettings.getControl("RenderAvatarComplexityLimit")->getSignal()->connect(boost::bind(&handleRenderAvatarComplexityLimitChanged, _2));
 	gSavedSettings.getControl("RenderVolumeLODFactor")->getSignal()->connect(boost::bind(&handleVolumeLODChanged, _2));
+	gSavedSettings.getControl("RenderVolumeFaceThreads")->getSignal()->connect(boost::bind(&handleVolumeFaceThreadsChanged, _2));
+	gSavedSettings.getControl("TextureDecodeThreads")->getSignal()->connect(boost::bind(&handleTextureDecodeThreadsChanged, _2));
+	gSavedSettings.getControl("IndexedJ2CUpload")->getSignal()->connect(boost::bind(&handleIndexedJ2CUploadChanged, _2));
+	gSavedSettings.getControl("TextureResumableDecodeMaxMB")->getSignal()->connect(boost::bind(&handleTextureResumableDecodeMaxMBChanged, _2));
 	gSavedSettings.getControl("RenderAvatarLODFactor")->getSignal()->connect(boost::bind(&handleAvatarLODChanged, _2));
 	gSavedSettings.getControl("RenderAvatarPhysicsLODFactor")->getSignal()->connect(boost::bind(&handleAvatarPhysicsLODChanged, _2));
 	gSavedSettings.getControl("RenderTerrainLODFactor")->getSignal()->connect(boost::bind(&handleTerrainLODChanged, _2));
@@ -781,6 +839,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("RenderUseVAO")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
 	gSavedSettings.getControl("RenderVBOMappingDisable")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
 	gSavedSettings.getControl("RenderPreferStreamDraw")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
+	gSavedSettings.getControl("RenderVBOSuballocation")->getSignal()->connect(boost::bind(&handleResetVertexBuffersChanged, _2));
 	gSavedSettings.getControl("WLSkyDetail")->getSignal()->connect(boost::bind(&handleWLSkyDetailChanged, _2));
 	gSavedSettings.getControl("NumpadControl")->getSignal()->connect(boost::bind(&handleNumpadControlChanged, _2));
 	gSavedSettings.getControl("JoystickAxis0")->getSignal()->connect(boost::bind(&handleJoystickChanged, _2));
@@ -830,6 +889,7 @@ void settings_setup_listeners()
 	gSavedSettings.getControl("BuildAxisDeadZone5")->getSignal()->connect(boost::bind(&handleJoystickChanged, _2));
 	gSavedSettings.getControl("DebugViews")->getSignal()->connect(boost::bind(&handleDebugViewsChanged, _2));
 	gSavedSettings.getControl("UserLogFile")->getSignal()->connect(boost::bind(&handleLogFileChanged, _2));
+	gSavedSettings.getControl("AsyncLogging")->getSignal()->connect(boost::bind(&handleAsyncLoggingChanged, _2));
 	gSavedSettings.getControl("RenderHideGroupTitle")->getSignal()->connect(boost::bind(handleHideGroupTitleChanged, _2));
 	gSavedSettings.getControl("EffectColor")->getSignal()->connect(boost::bind(handleEffectColorChanged, _2));
 	gSavedSettings.getControl("EnableVoiceChat")->getSignal()->connect(boost::bind(&handleVoiceClientPrefsChanged, _2));
@@ -856,6 +916,7 @@ void settings_setup_listeners()
 
 	gSavedSettings.getControl("CurlMaxTotalConcurrentConnections")->getSignal()->connect(boost::bind(&AICurlInterface::handleCurlMaxTotalConcurrentConnections, _2));
 	gSavedSettings.getControl("CurlConcurrentConnectionsPerService")->getSignal()->connect(boost::bind(&AICurlInterface::handleCurlConcurrentConnectionsPerService, _2));
+	gSavedSettings.getControl("CurlConcurrentStreamsPerService")->getSignal()->connect(boost::bind(&AICurlInterface::handleCurlConcurrentStreamsPerService, _2));
 	gSavedSettings.getControl("NoVerifySSLCert")->getSignal()->connect(boost::bind(&AICurlInterface::handleNoVerifySSLCert, _2));
 
 	gSavedSettings.getControl("CurlTimeoutDNSLookup")->getValidateSignal()->connect(boost::bind(&validateCurlTimeoutDNSLookup, _2));
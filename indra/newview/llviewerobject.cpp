@@ -101,6 +101,7 @@
 #include "llmanip.h"
 #include "llmediaentry.h"
 #include "llmeshrepository.h"
+#include "llobjectupdatebatch.h"
 // [RLVa:KB]
 #include "rlvhandler.h"
 #include "rlvlocks.h"
@@ -110,6 +111,7 @@
 
 BOOL		LLViewerObject::sVelocityInterpolate = TRUE;
 BOOL		LLViewerObject::sPingInterpolate = TRUE;
+const LLObjectUpdateBatch* LLViewerObject::sTerseUpdateBatch = NULL;
 
 U32			LLViewerObject::sNumZombieObjects = 0;
 S32			LLViewerObject::sNumObjects = 0;
@@ -1155,9 +1157,18 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 	// Coordinates of objects on simulators are region-local.
 	U64 region_handle = 0;	
 	
+	const LLObjectUpdateBatch* batch = update_type == OUT_TERSE_IMPROVED ? sTerseUpdateBatch : NULL;
+
 	if(mesgsys != NULL)
 	{
-		mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+		if (batch)
+		{
+			region_handle = batch->mRegionHandle;
+		}
+		else
+		{
+			mesgsys->getU64Fast(_PREHASH_RegionData, _PREHASH_RegionHandle, region_handle);
+		}
 		LLViewerRegion* regionp = LLWorld::getInstance()->getRegionFromHandle(region_handle);
 		if(regionp != mRegionp && regionp && mRegionp)//region cross
 		{
@@ -1195,7 +1206,12 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 	}
 
 	F32 time_dilation = 1.f;
-	if(mesgsys != NULL)
+	if (batch)
+	{
+		// Already set on the region for the whole message
+		time_dilation = batch->mTimeDilation;
+	}
+	else if(mesgsys != NULL)
 	{
 		U16 time_dilation16;
 		mesgsys->getU16Fast(_PREHASH_RegionData, _PREHASH_TimeDilation, time_dilation16);
@@ -1446,7 +1462,14 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 
 		U8		state;
 
-		dp->unpackU8(state, "State");
+		if (batch)
+		{
+			state = batch->mStates[block_num];
+		}
+		else
+		{
+			dp->unpackU8(state, "State");
+		}
 		mAttachmentState = state;
 
 		switch(update_type)
@@ -1456,6 +1479,23 @@ U32 LLViewerObject::processUpdateMessage(LLMessageSystem *mesgsys,
 #ifdef DEBUG_UPDATE_TYPE
 				LL_INFOS() << "CompTI:" << getID() << LL_ENDL;
 #endif
+				if (batch)
+				{
+					const LLVector4* collision_plane = batch->getFootPlane(block_num);
+					if (collision_plane)
+					{
+						((LLVOAvatar*)this)->setFootPlane(*collision_plane);
+					}
+					test_pos_parent = getPosition();
+					new_pos_parent = batch->mPositions[block_num];
+					setVelocity(batch->mVelocities[block_num]);
+					setAcceleration(batch->mAccelerations[block_num]);
+					new_rot = batch->mRotations[block_num];
+					new_angv = batch->mAngularVelocities[block_num];
+					setAngularVelocity(new_angv);
+					break;
+				}
+
 				U8		value;
 				dp->unpackU8(value, "agent");
 				if (value)
@@ -3647,6 +3687,10 @@ LLDrawable* LLViewerObject::createDrawable(LLPipeline *pipeline)
 
 void LLViewerObject::setScale(const LLVector3 &scale, BOOL damped)
 {
+	if (mOnMap && getScale() != scale)
+	{
+		gObjectList.dirtyMap();
+	}
 	LLPrimitive::setScale(scale);
 	if (mDrawable.notNull())
 	{
@@ -4363,6 +4407,10 @@ void LLViewerObject::setPosition(const LLVector3 &pos, BOOL damped)
 	if (getPosition() != pos)
 	{
 		setChanged(TRANSLATED | SILHOUETTE);
+		if (mOnMap)
+		{
+			gObjectList.dirtyMap();
+		}
 	}
 
 	LLXform::setPosition(pos);
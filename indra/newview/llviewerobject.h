@@ -63,6 +63,7 @@ class LLHost;
 class LLMessageSystem;
 class LLNameValue;
 class LLNetMap;
+class LLObjectUpdateBatch;
 class LLPartSysData;
 class LLPipeline;
 class LLPrimitive;
@@ -914,6 +915,11 @@ protected:
 	static void	setVelocityInterpolate(BOOL value)		{ sVelocityInterpolate = value;	}
 	static void	setPingInterpolate(BOOL value)			{ sPingInterpolate = value;	}
 
+	// Set by LLViewerObjectList while it applies a batch decoded terse update
+	// message: processUpdateMessage() then takes the terse fields of block
+	// block_num from it instead of unpacking them from dp.
+	static const LLObjectUpdateBatch* sTerseUpdateBatch;
+
 private:	
 	static S32 sNumObjects;
 
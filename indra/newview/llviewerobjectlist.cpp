@@ -63,6 +63,7 @@
 #include "llviewercamera.h"
 #include "llselectmgr.h"
 #include "llresmgr.h"
+#include "llsdserialize.h"
 #include "llsdutil.h"
 #include "llviewerregion.h"
 #include "llviewerstats.h"
@@ -139,6 +140,7 @@ LLViewerObjectList::LLViewerObjectList()
 	mNumDeadObjectUpdates = 0;
 	mNumUnknownKills = 0;
 	mNumUnknownUpdates = 0;
+	mMapGeneration = 0;
 }
 
 LLViewerObjectList::~LLViewerObjectList()
@@ -335,6 +337,42 @@ void LLViewerObjectList::processUpdateCore(LLViewerObject* objectp,
 	}
 }
 
+// This looks like it will break if the local_id of the object doesn't change
+// upon boundary crossing, but we check for region id matching later...
+// Reset object local id and region pointer if things have changed
+void LLViewerObjectList::fixLocalIDAndRegion(LLViewerObject* objectp, const LLUUID& fullid, U32 local_id, LLViewerRegion* regionp)
+{
+	if ((objectp->mLocalID != local_id) ||
+		(objectp->getRegion() != regionp))
+	{
+		//if (objectp->getRegion())
+		//{
+		//	LL_INFOS() << "Local ID change: Removing object from table, local ID " << objectp->mLocalID 
+		//			<< ", id from message " << local_id << ", from " 
+		//			<< LLHost(objectp->getRegion()->getHost().getAddress(), objectp->getRegion()->getHost().getPort())
+		//			<< ", full id " << fullid 
+		//			<< ", objects id " << objectp->getID()
+		//			<< ", regionp " << (U32) regionp << ", object region " << (U32) objectp->getRegion()
+		//			<< LL_ENDL;
+		//}
+		removeFromLocalIDTable(objectp);
+		setUUIDAndLocal(fullid,
+						local_id,
+						gMessageSystem->getSenderIP(),
+						gMessageSystem->getSenderPort());
+		
+		if (objectp->mLocalID != local_id)
+		{    // Update local ID in object with the one sent from the region
+			objectp->mLocalID = local_id;
+		}
+		
+		if (objectp->getRegion() != regionp)
+		{    // Object changed region, so update it
+			objectp->updateRegion(regionp); // for LLVOAvatar
+		}
+	}
+}
+
 static LLTrace::BlockTimerStatHandle FTM_PROCESS_OBJECTS("Process Objects");
 
 void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
@@ -403,6 +441,13 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		return;
 	}
 
+	static const LLCachedControl<bool> batch_terse_updates(gSavedSettings, "ObjectUpdateBatching", true);
+	if (compressed && update_type == OUT_TERSE_IMPROVED && batch_terse_updates)
+	{
+		processTerseUpdateBatch(mesgsys, user_data, regionp);
+		return;
+	}
+
 	U8 compressed_dpbuffer[2048];
 	LLDataPackerBinaryBuffer compressed_dp(compressed_dpbuffer, 2048);
 	LLDataPacker *cached_dpp = NULL;
@@ -498,38 +543,9 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 		}
 		objectp = findObject(fullid);
 
-		// This looks like it will break if the local_id of the object doesn't change
-		// upon boundary crossing, but we check for region id matching later...
-		// Reset object local id and region pointer if things have changed
-		if (objectp && 
-			((objectp->mLocalID != local_id) ||
-			 (objectp->getRegion() != regionp)))
-		{
-			//if (objectp->getRegion())
-			//{
-			//	LL_INFOS() << "Local ID change: Removing object from table, local ID " << objectp->mLocalID 
-			//			<< ", id from message " << local_id << ", from " 
-			//			<< LLHost(objectp->getRegion()->getHost().getAddress(), objectp->getRegion()->getHost().getPort())
-			//			<< ", full id " << fullid 
-			//			<< ", objects id " << objectp->getID()
-			//			<< ", regionp " << (U32) regionp << ", object region " << (U32) objectp->getRegion()
-			//			<< LL_ENDL;
-			//}
-			removeFromLocalIDTable(objectp);
-			setUUIDAndLocal(fullid,
-							local_id,
-							gMessageSystem->getSenderIP(),
-							gMessageSystem->getSenderPort());
-			
-			if (objectp->mLocalID != local_id)
-			{    // Update local ID in object with the one sent from the region
-				objectp->mLocalID = local_id;
-			}
-			
-			if (objectp->getRegion() != regionp)
-			{    // Object changed region, so update it
-				objectp->updateRegion(regionp); // for LLVOAvatar
-			}
+		if (objectp)
+		{
+			fixLocalIDAndRegion(objectp, fullid, local_id, regionp);
 		}
 
 		if (!objectp)
@@ -635,6 +651,129 @@ void LLViewerObjectList::processObjectUpdate(LLMessageSystem *mesgsys,
 	LLVOAvatar::cullAvatarsByPixelArea();
 }
 
+static LLTrace::BlockTimerStatHandle FTM_DECODE_TERSE_UPDATES("Decode Terse Updates");
+
+// Terse updates are most of the object traffic and never create objects, so
+// all the blocks of the message are decoded together into columns, resolved
+// to their objects in one pass and then applied in a tight loop.  The rare
+// fields stay with the objects: LLVOVolume still reads the texture entry from
+// the message.
+void LLViewerObjectList::processTerseUpdateBatch(LLMessageSystem *mesgsys,
+												 void **user_data,
+												 LLViewerRegion* regionp)
+{
+	LLObjectUpdateBatch& batch = mTerseUpdateBatch;
+	{
+		LL_RECORD_BLOCK_TIME(FTM_DECODE_TERSE_UPDATES);
+		batch.decodeMessage(mesgsys);
+	}
+
+	static const LLCachedControl<bool> record_updates(gSavedSettings, "ObjectUpdateRecordPackets", false);
+	if (record_updates)
+	{
+		recordTerseUpdates();
+	}
+
+	const S32 num_objects = batch.getCount();
+	const U32 ip = mesgsys->getSenderIP();
+	const U32 port = mesgsys->getSenderPort();
+
+	// Resolve every block first, so the object lookups don't interleave
+	// with the updates themselves
+	LLUUID fullid;
+	mTerseUpdateObjects.resize(num_objects);
+	for (S32 i = 0; i < num_objects; i++)
+	{
+		LLViewerObject* objectp = NULL;
+		if (!batch.mValid[i])
+		{
+			LL_WARNS_ONCE() << "Bad terse update block size from " << mesgsys->getSender() << LL_ENDL;
+		}
+		else
+		{
+			getUUIDFromLocal(fullid, batch.mLocalIDs[i], ip, port);
+			if (fullid.isNull())
+			{
+				LL_DEBUGS() << "update for unknown localid " << batch.mLocalIDs[i] << " host " << mesgsys->getSender() << LL_ENDL;
+				mNumUnknownUpdates++;
+			}
+			else
+			{
+				objectp = findObject(fullid);
+				if (objectp)
+				{
+					fixLocalIDAndRegion(objectp, fullid, batch.mLocalIDs[i], regionp);
+				}
+			}
+		}
+		mTerseUpdateObjects[i] = objectp;
+	}
+
+	regionp->setTimeDilation(batch.mTimeDilation);
+
+	// Objects only need a non-NULL packer to take the compressed path, the
+	// fields themselves come from the batch
+	LLDataPackerBinaryBuffer unused_dp;
+	LLViewerStatsRecorder& recorder = LLViewerStatsRecorder::instance();
+
+	LLViewerObject::sTerseUpdateBatch = &batch;
+	for (S32 i = 0; i < num_objects; i++)
+	{
+		LLViewerObject* objectp = mTerseUpdateObjects[i];
+		if (!objectp)
+		{
+			recorder.objectUpdateFailure(batch.mLocalIDs[i], OUT_TERSE_IMPROVED, 0);
+			continue;
+		}
+
+		if (objectp->isDead())
+		{
+			LL_WARNS() << "Dead object " << objectp->mID << " in UUID map 1!" << LL_ENDL;
+		}
+
+		processUpdateCore(objectp, user_data, i, OUT_TERSE_IMPROVED, &unused_dp, FALSE);
+		recorder.objectUpdateEvent(batch.mLocalIDs[i], OUT_TERSE_IMPROVED, objectp, 0);
+		objectp->setLastUpdateType(OUT_TERSE_IMPROVED);
+		objectp->setLastUpdateCached(false);
+	}
+	LLViewerObject::sTerseUpdateBatch = NULL;
+
+	recorder.log(0.2f);
+
+	LLVOAvatar::cullAvatarsByPixelArea();
+}
+
+// Appends the current terse update message to the recording and writes the
+// recording to terse_updates.xml in the log directory once it is complete,
+// for the replay benchmark in indra/llmessage/tests/llobjectupdatebatch_test.cpp.
+void LLViewerObjectList::recordTerseUpdates()
+{
+	const S32 RECORDED_MESSAGES = 500;
+
+	LLSD message = LLSD::emptyArray();
+	mTerseUpdateBatch.appendLLSD(message);
+	mRecordedTerseUpdates.append(message);
+	if (mRecordedTerseUpdates.size() < RECORDED_MESSAGES)
+	{
+		return;
+	}
+
+	gSavedSettings.setBOOL("ObjectUpdateRecordPackets", FALSE);
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "terse_updates.xml");
+	llofstream file(filename.c_str());
+	if (file.is_open())
+	{
+		LLSDSerialize::toXML(mRecordedTerseUpdates, file);
+		LL_INFOS() << "Recorded " << mRecordedTerseUpdates.size() << " terse update messages to " << filename << LL_ENDL;
+	}
+	else
+	{
+		LL_WARNS() << "Could not write " << filename << LL_ENDL;
+	}
+	mRecordedTerseUpdates.clear();
+}
+
 void LLViewerObjectList::processCompressedObjectUpdate(LLMessageSystem *mesgsys,
 											 void **user_data,
 											 const EObjectUpdateType update_type)
@@ -1407,6 +1546,7 @@ void LLViewerObjectList::killAllObjects()
 	{
 		LL_WARNS() << "Some objects still on map object list!" << LL_ENDL;
 		mMapObjects.clear();
+		dirtyMap();
 	}
 }
 
@@ -39,6 +39,7 @@
 #include "absl/container/flat_hash_map.h"
 
 // common includes
+#include "llobjectupdatebatch.h"
 #include "llstat.h"
 #include "llstring.h"
 
@@ -94,6 +95,7 @@ public:
 	void processObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type, bool cached=false, bool compressed=false);
 	void processCompressedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
 	void processCachedObjectUpdate(LLMessageSystem *mesgsys, void **user_data, EObjectUpdateType update_type);
+	void processTerseUpdateBatch(LLMessageSystem *mesgsys, void **user_data, LLViewerRegion* regionp);
 	void updateApparentAngles(LLAgent &agent);
 	void update(LLAgent &agent, LLWorld &world);
 
@@ -147,6 +149,9 @@ public:
 
 	void addToMap(LLViewerObject *objectp);
 	void removeFromMap(LLViewerObject *objectp);
+	// Bumped whenever an object drawn on the minimap is added, removed, moved or resized.
+	void dirtyMap()								{ ++mMapGeneration; }
+	U32 getMapGeneration() const				{ return mMapGeneration; }
 
 	void clearDebugText();
 
@@ -218,6 +223,7 @@ public:
 	std::vector<LLPointer<LLViewerObject> > mActiveObjects;
 
 	vobj_list_t mMapObjects;
+	U32 mMapGeneration;
 
 	uuid_set_t mDeadObjects;	
 
@@ -243,6 +249,15 @@ public:
 
 	std::set<LLViewerObject *> mSelectPickList;
 
+	// Decoded terse update message and the objects its blocks resolve to,
+	// kept between messages for their capacity
+	LLObjectUpdateBatch mTerseUpdateBatch;
+	std::vector<LLViewerObject*> mTerseUpdateObjects;
+	LLSD mRecordedTerseUpdates;
+
+	void fixLocalIDAndRegion(LLViewerObject* objectp, const LLUUID& fullid, U32 local_id, LLViewerRegion* regionp);
+	void recordTerseUpdates();
+
 	friend class LLViewerObject;
 };
 
@@ -306,6 +321,7 @@ inline LLViewerObject *LLViewerObjectList::getObject(const S32 index)
 inline void LLViewerObjectList::addToMap(LLViewerObject *objectp)
 {
 	mMapObjects.push_back(objectp);
+	dirtyMap();
 }
 
 inline void LLViewerObjectList::removeFromMap(LLViewerObject *objectp)
@@ -314,6 +330,7 @@ inline void LLViewerObjectList::removeFromMap(LLViewerObject *objectp)
 	if (iter != mMapObjects.end())
 	{
 		mMapObjects.erase(iter);
+		dirtyMap();
 	}
 }
 
@@ -363,6 +363,9 @@ public:
 class LLViewerOctreeCull : public OctreeTraveler
 {
 public:
+	typedef OctreeNode node_t;
+	typedef LLViewerOctreeGroup group_t;
+
 	LLViewerOctreeCull(LLCamera* camera)
 		: mCamera(camera), mRes(0) { }
 	
@@ -314,6 +314,17 @@ void LLViewerShaderMgr::setShaders()
 	LL_INFOS("ShaderLoading") << "\n~~~~~~~~~~~~~~~~~~\n Loading Shaders:\n~~~~~~~~~~~~~~~~~~" << LL_ENDL;
 	LL_INFOS("ShaderLoading") << llformat("Using GLSL %d.%d", gGLManager.mGLSLVersionMajor, gGLManager.mGLSLVersionMinor) << LL_ENDL;
 
+	LLTimer load_timer;
+	mProgramBinaryHits = 0;
+	mProgramBinaryMisses = 0;
+
+	static bool pruned_binary_cache = false;
+	if (!pruned_binary_cache && useProgramBinaryCache())
+	{ //once per session, the driver doesn't change while running
+		pruneProgramBinaryCache();
+		pruned_binary_cache = true;
+	}
+
 	LLVertexBuffer::unbind();
 	
 	if (want_shaders)
@@ -498,6 +509,9 @@ void LLViewerShaderMgr::setShaders()
 		//Don't worry-- they won't be deleted until no programs refrence them.
 		unloadShaderObjects();
 		cleanupShaderSources();
+
+		LL_INFOS("ShaderLoading") << llformat("Loaded shaders in %.1f ms, %d programs from the binary cache, %d linked from source",
+											  load_timer.getElapsedTimeF64() * 1000.0, mProgramBinaryHits, mProgramBinaryMisses) << LL_ENDL;
 	}
 
 	if (gViewerWindow)
@@ -348,6 +348,26 @@ class LLViewerTextureManagerBridge : public LLTextureManagerBridge
 	{
 		return LLViewerTextureManager::getFetchedTexture(image_id);
 	}
+
+	/*virtual*/ LLImageRaw* getRawImage(LLGLTexture* tex)
+	{
+		LLViewerFetchedTexture* fetched = LLViewerTextureManager::staticCastToFetchedTexture(tex);
+		if (!fetched)
+		{
+			return NULL;
+		}
+		if (fetched->hasSavedRawImage())
+		{
+			return fetched->getSavedRawImage();
+		}
+		if (fetched->isRawImageValid() && fetched->getRawImageLevel() == 0)
+		{
+			return fetched->getRawImage();
+		}
+		// Ask for the full resolution pixels to be kept around for the next bake.
+		fetched->forceToSaveRawImage(0);
+		return NULL;
+	}
 };
 
 
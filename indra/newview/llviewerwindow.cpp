@@ -568,6 +568,19 @@ public:
 			addText(xpos, ypos, llformat("%d Vertex Buffers", LLVertexBuffer::sGLCount));
 			ypos += y_inc;
 
+			if (LLVertexBuffer::sUseSuballocation)
+			{
+				const LLVBOSuballocator& vbo = LLVertexBuffer::sStaticVBOSuballocator;
+				const LLVBOSuballocator& ibo = LLVertexBuffer::sStaticIBOSuballocator;
+				addText(xpos, ypos, llformat("%d Static Buffers in %d+%d Slabs (%d/%d MB, %d Free Ranges, %.0f%%/%.0f%% Fragmented)",
+										vbo.getAllocationCount() + ibo.getAllocationCount(), vbo.getSlabCount(), ibo.getSlabCount(),
+										(S32) ((vbo.getUsedBytes() + ibo.getUsedBytes()) / (1024 * 1024)),
+										(S32) ((vbo.getReservedBytes() + ibo.getReservedBytes()) / (1024 * 1024)),
+										vbo.getFreeRangeCount() + ibo.getFreeRangeCount(),
+										vbo.getFragmentation() * 100.f, ibo.getFragmentation() * 100.f));
+				ypos += y_inc;
+			}
+
 			addText(xpos, ypos, llformat("%d Mapped Buffers", LLVertexBuffer::sMappedCount));
 			ypos += y_inc;
 
@@ -586,6 +599,30 @@ public:
 			addText(xpos, ypos, llformat("%d Render Calls", gPipeline.mBatchCount));
 			ypos += y_inc;
 
+			{
+				LLCullResult::BatchStats total = { 0, 0, 0, 0 };
+				for (U32 i = 0; i < LLRenderPass::NUM_RENDER_TYPES; ++i)
+				{
+					const LLCullResult::BatchStats& stats = LLCullResult::sBatchStats[i];
+					if (stats.mDraws > 0)
+					{
+						addText(xpos, ypos, llformat("    Pass %d: %d/%d Draws, %d/%d State Changes", i - LLRenderPass::PASS_SIMPLE,
+												stats.mBatchedDraws, stats.mDraws, stats.mBatchedStateChanges, stats.mStateChanges));
+						ypos += y_inc;
+					}
+					total.mDraws += stats.mDraws;
+					total.mStateChanges += stats.mStateChanges;
+					total.mBatchedDraws += stats.mBatchedDraws;
+					total.mBatchedStateChanges += stats.mBatchedStateChanges;
+				}
+
+				addText(xpos, ypos, llformat("%d/%d Batched Draws, %d/%d State Changes", total.mBatchedDraws, total.mDraws,
+										total.mBatchedStateChanges, total.mStateChanges));
+				ypos += y_inc;
+
+				LLCullResult::resetBatchStats();
+			}
+
 			addText(xpos, ypos, llformat("%d Matrix Ops", gPipeline.mMatrixOpCount));
 			ypos += y_inc;
 
@@ -616,6 +653,13 @@ public:
 				ypos += y_inc;
 			}
 
+			if (LLPipeline::sUseSoftwareOcclusion)
+			{
+				addText(xpos,ypos, llformat("%d/%d/%d Groups occluded software/queries/tested", LLSoftwareOcclusion::sSoftwareCulled,
+					LLSoftwareOcclusion::sQueryCulled, (U32)LLSoftwareOcclusion::sGroupsTested));
+				ypos += y_inc;
+			}
+
 
 			addText(xpos,ypos, llformat("%d Avatars visible", LLVOAvatar::sNumVisibleAvatars));
 			
@@ -686,6 +730,10 @@ public:
 					LLMeshRepository::sHTTPRetryCount));
 				ypos += y_inc;
 
+				addText(xpos, ypos, llformat("%d/%d Mesh Speculative Fetches/Round Trips Saved (%.2f per mesh)", LLMeshRepository::sSpeculativeFetchCount,
+					LLMeshRepository::sRoundTripsSaved, LLMeshRepository::sSpeculativeFetchCount ? (F32)LLMeshRepository::sRoundTripsSaved / LLMeshRepository::sSpeculativeFetchCount : 0.f));
+				ypos += y_inc;
+
 				addText(xpos, ypos, llformat("%d/%d Mesh LOD Pending/Processing", LLMeshRepository::sLODPending, (U32)LLMeshRepository::sLODProcessing));
 				ypos += y_inc;
 
@@ -698,7 +746,9 @@ public:
 
 			LLVertexBuffer::sBindCount = LLImageGL::sBindCount = 
 				LLVertexBuffer::sSetCount = LLImageGL::sUniqueCount =
-				gPipeline.mNumVisibleNodes = LLPipeline::sVisibleLightCount = 0;
+				gPipeline.mNumVisibleNodes = LLPipeline::sVisibleLightCount = 
+				LLSoftwareOcclusion::sSoftwareCulled = LLSoftwareOcclusion::sQueryCulled = 0;
+			LLSoftwareOcclusion::sGroupsTested = 0;
 		}
 
 		sMsgDataAllocSize = 0;
@@ -754,11 +804,17 @@ public:
 		static const LLCachedControl<bool> DebugShowPrivateMem("DebugShowPrivateMem",false);
 		if (DebugShowPrivateMem)
 		{
-			LLPrivateMemoryPoolManager::getInstance()->updateStatistics() ;
-			addText(xpos, ypos, llformat("Total Reserved(KB): %d", LLPrivateMemoryPoolManager::getInstance()->mTotalReservedSize / 1024));
-			ypos += y_inc;
+			for (U32 i = 0; i < LLSizeClassAllocator::SUBSYSTEM_COUNT; ++i)
+			{
+				addText(xpos, ypos, llformat("%s Allocated(KB): %d in %d blocks", LLSizeClassAllocator::getSubsystemName(i),
+											 (S32)(LLSizeClassAllocator::getAllocatedBytes(i) / 1024),
+											 (S32)LLSizeClassAllocator::getAllocationCount(i)));
+				ypos += y_inc;
+			}
 
-			addText(xpos, ypos, llformat("Total Allocated(KB): %d", LLPrivateMemoryPoolManager::getInstance()->mTotalAllocatedSize / 1024));
+			addText(xpos, ypos, llformat("Total Reserved(KB): %d, Large Mapped(KB): %d",
+										 (S32)(LLSizeClassAllocator::getReservedBytes() / 1024),
+										 (S32)(LLSizeClassAllocator::getMappedBytes() / 1024)));
 			ypos += y_inc;
 		}
 
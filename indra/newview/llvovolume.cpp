@@ -36,6 +36,7 @@
 #include "llvovolume.h"
 
 #include <sstream>
+#include <boost/align/aligned_allocator.hpp>
 
 #include "llviewercontrol.h"
 #include "lldir.h"
@@ -88,6 +89,7 @@
 #include "llvocache.h"
 #include "llmaterialmgr.h"
 #include "llsculptidsize.h"
+#include "lljobsystem.h"
 
 // [RLVa:KB] - Checked: 2010-04-04 (RLVa-1.2.0d)
 #include "rlvhandler.h"
@@ -4680,14 +4682,8 @@ void LLRiggedVolume::update(const LLMeshSkinInfo* skin, LLVOAvatar* avatar, cons
 
 		{
 			LL_RECORD_BLOCK_TIME(FTM_RIGGED_OCTREE);
-			delete dst_face.mOctree;
-			dst_face.mOctree = NULL;
-
-			LLVector4a size;
-			size.setSub(dst_face.mExtents[1], dst_face.mExtents[0]);
-			size.splat(size.getLength3().getF32()*0.5f);
-			
-			dst_face.createOctree(1.f);
+			//picking structures are rebuilt lazily on the next raycast
+			dst_face.destroyOctree();
 		}
 	}
 }
@@ -4791,6 +4787,96 @@ LLFace** LLVolumeGeometryManager::sSpecFaces = NULL;
 LLFace** LLVolumeGeometryManager::sNormSpecFaces = NULL;
 LLFace** LLVolumeGeometryManager::sAlphaFaces = NULL;
 
+static LLTrace::BlockTimerStatHandle FTM_FILL_FACE_GEOMETRY("Fill Face Geometry");
+
+namespace
+{
+	// One face's share of a group rebuild, see LLFace::prepareGeometryVolume().
+	// The transforms are copied since animated children only hold theirs
+	// while the face is being prepared.
+	struct LLFaceGeometryJob
+	{
+		LLMatrix4a				mMatVert;
+		LLMatrix4a				mMatNorm;
+		LLFace::GeometryTarget	mTarget;
+		LLFace*					mFace;
+		const LLVolume*			mVolume;
+		S32						mTE;
+		U16						mIndexOffset;
+	};
+	typedef std::vector<LLFaceGeometryJob, boost::alignment::aligned_allocator<LLFaceGeometryJob, 16> > face_geometry_job_vec_t;
+
+	// Below this many vertices waking the workers costs more than it saves
+	const U32 MIN_THREADED_GEOMETRY_VERTICES = 4096;
+
+	face_geometry_job_vec_t sGeometryJobs;
+	U32 sGeometryJobVertices = 0;
+
+	// Maps the face's streams now and queues the vertex generation for
+	// fill_face_geometry().  Returns false if the face doesn't fit its buffer.
+	bool queue_face_geometry(LLFace* facep, const LLVolume& volume, S32 te,
+							 const LLMatrix4a& mat_vert, const LLMatrix4a& mat_norm,
+							 U16 index_offset, bool force_rebuild)
+	{
+		sGeometryJobs.resize(sGeometryJobs.size() + 1);
+		LLFaceGeometryJob& job = sGeometryJobs.back();
+		if (!facep->prepareGeometryVolume(volume, te, force_rebuild, job.mTarget))
+		{
+			sGeometryJobs.pop_back();
+			return false;
+		}
+
+		job.mMatVert = mat_vert;
+		job.mMatNorm = mat_norm;
+		job.mFace = facep;
+		job.mVolume = &volume;
+		job.mTE = te;
+		job.mIndexOffset = index_offset;
+		sGeometryJobVertices += volume.getVolumeFace(te).mNumVertices;
+		return true;
+	}
+
+	// Writes the geometry of every queued face, with the job system workers when
+	// there is enough of it.  The caller flushes the buffers afterwards.
+	void fill_face_geometry()
+	{
+		if (sGeometryJobs.empty())
+		{
+			return;
+		}
+
+		LL_RECORD_BLOCK_TIME(FTM_FILL_FACE_GEOMETRY);
+
+		static LLCachedControl<U32> geometry_threads(gSavedSettings, "RenderGeometryThreads", 2U);
+		S32 threads = llmin((U32) geometry_threads, 8U);
+
+		if (gJobSystem && threads > 0 && sGeometryJobs.size() > 1 && sGeometryJobVertices >= MIN_THREADED_GEOMETRY_VERTICES)
+		{
+			gJobSystem->parallelFor((S32) sGeometryJobs.size(), [](S32 index)
+				{
+					const LLFaceGeometryJob& job = sGeometryJobs[index];
+					job.mFace->fillGeometryVolume(*job.mVolume, job.mTE, job.mMatVert, job.mMatNorm, job.mIndexOffset, job.mTarget);
+				}, threads);
+		}
+		else
+		{
+			for (face_geometry_job_vec_t::const_iterator iter = sGeometryJobs.begin(); iter != sGeometryJobs.end(); ++iter)
+			{
+				iter->mFace->fillGeometryVolume(*iter->mVolume, iter->mTE, iter->mMatVert, iter->mMatNorm, iter->mIndexOffset, iter->mTarget);
+			}
+		}
+
+		//back on the main thread, the faces can take their new state
+		for (face_geometry_job_vec_t::const_iterator iter = sGeometryJobs.begin(); iter != sGeometryJobs.end(); ++iter)
+		{
+			iter->mFace->applyGeometryVolume(iter->mTarget);
+		}
+
+		sGeometryJobs.clear();
+		sGeometryJobVertices = 0;
+	}
+}
+
 LLVolumeGeometryManager::LLVolumeGeometryManager()
 	: LLGeometryManager()
 {
@@ -6094,8 +6180,8 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 						{
 							llassert(!face->isState(LLFace::RIGGED));
 
-							if (!face->getGeometryVolume(*volume, face->getTEOffset(), 
-								vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), face->getGeomIndex()))
+							if (!queue_face_geometry(face, *volume, face->getTEOffset(),
+								vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), face->getGeomIndex(), false))
 							{ //something's gone wrong with the vertex buffer accounting, rebuild this group 
 								group->dirtyGeom();
 								gPipeline.markRebuild(group, TRUE);
@@ -6119,6 +6205,8 @@ void LLVolumeGeometryManager::rebuildMesh(LLSpatialGroup* group)
 				drawablep->clearState(LLDrawable::REBUILD_ALL);
 			}
 		}
+
+		fill_face_geometry();
 		
 		for (LLVertexBuffer** iter = locked_buffer, ** end_iter = locked_buffer+buffer_count; iter != end_iter; ++iter)
 		{
@@ -6308,6 +6396,19 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 
 	bool flexi = false;
 
+	struct FilledBuffer
+	{
+		FilledBuffer(LLVertexBuffer* buffer, U32 vertex_count, U32 index_count)
+		:	mBuffer(buffer), mVertexCount(vertex_count), mIndexCount(index_count)
+		{
+		}
+
+		LLVertexBuffer* mBuffer;
+		U32 mVertexCount;
+		U32 mIndexCount;
+	};
+	std::vector<FilledBuffer> filled_buffers;
+
 	while (face_iter != end_faces)
 	{
 		//pull off next face
@@ -7059,8 +7160,8 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 
 				llassert(!facep->isState(LLFace::RIGGED));
 
-				if (!facep->getGeometryVolume(*volume, te_idx, 
-					vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset,true))
+				if (!queue_face_geometry(facep, *volume, te_idx,
+					vobj->getRelativeXform(), vobj->getRelativeXformInvTrans(), index_offset, true))
 				{
 					LL_WARNS() << "Failed to get geometry for face!" << LL_ENDL;
 				}
@@ -7077,12 +7178,20 @@ void LLVolumeGeometryManager::genDrawInfo(LLSpatialGroup* group, U32 mask, LLFac
 			++face_iter;
 		}
 
-		if(index_offset > 0)
+		filled_buffers.push_back(FilledBuffer(buffer, index_offset, indices_index));
+	}
+
+	//generate the geometry of all buffers at once, then hand them to GL
+	fill_face_geometry();
+
+	for (std::vector<FilledBuffer>::iterator iter = filled_buffers.begin(); iter != filled_buffers.end(); ++iter)
+	{
+		if (iter->mVertexCount > 0)
 		{
-			buffer->validateRange(0,  index_offset - 1, indices_index, 0);
+			iter->mBuffer->validateRange(0, iter->mVertexCount - 1, iter->mIndexCount, 0);
 		}
 
-		buffer->flush();
+		iter->mBuffer->flush();
 	}
 
 	auto buffVec = get_val_in_pair_vec(group->mBufferVec, mask);
@@ -108,6 +108,9 @@
 #include "llwlparammanager.h"
 #include "llwaterparammanager.h"
 #include "llspatialpartition.h"
+#include "llsdserialize.h"
+#include "llsdutil_math.h"
+#include "lljobsystem.h"
 #include "llmutelist.h"
 #include "llfloatertools.h"
 #include "llpanelface.h"
@@ -306,6 +309,8 @@ BOOL	LLPipeline::sRenderHighlight = TRUE;
 LLRender::eTexIndex LLPipeline::sRenderHighlightTextureChannel = LLRender::DIFFUSE_MAP;
 BOOL	LLPipeline::sForceOldBakedUpload = FALSE;
 S32		LLPipeline::sUseOcclusion = 0;
+BOOL	LLPipeline::sUseSoftwareOcclusion = FALSE;
+U32		LLPipeline::sCullThreads = 0;
 BOOL	LLPipeline::sDelayVBUpdate = FALSE;
 BOOL	LLPipeline::sAutoMaskAlphaDeferred = TRUE;
 BOOL	LLPipeline::sAutoMaskAlphaNonDeferred = FALSE;
@@ -333,6 +338,19 @@ BOOL	LLPipeline::sRenderingHUDs = FALSE;
 
 static LLCullResult* sCull = NULL;
 
+namespace
+{
+	// One partition to cull, see LLPipeline::cullPartitions().
+	struct LLCullJob
+	{
+		LLSpatialPartition*	mPartition;
+		LLCamera*			mCamera;
+		LLCullFragment		mFragment;
+	};
+	std::vector<LLCullJob> sCullJobs;		// Only grows, so that the fragments keep their capacity.
+	std::vector<LLCamera*> sCullCameras;	// Per region copies of the camera, for the water clip planes.
+}
+
 static const U32 gl_cube_face[] = 
 {
 	GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB,
@@ -472,6 +490,8 @@ void LLPipeline::init()
 	gSavedSettings.getControl("RenderAvatarMaxVisible")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
 	//gSavedSettings.getControl("RenderDelayVBUpdate")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
 	gSavedSettings.getControl("UseOcclusion")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
+	gSavedSettings.getControl("RenderSoftwareOcclusion")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
+	gSavedSettings.getControl("RenderCullThreads")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
 	//gSavedSettings.getControl("VertexShaderEnable")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));	//Already registered to handleSetShaderChanged
 	//gSavedSettings.getControl("RenderDeferred")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));	//Already registered to handleSetShaderChanged
 	gSavedSettings.getControl("RenderFSAASamples")->getCommitSignal()->connect(boost::bind(&LLPipeline::refreshCachedSettings));
@@ -493,6 +513,12 @@ void LLPipeline::cleanup()
 	mGroupQ1.clear() ;
 	mGroupQ2.clear() ;
 
+	mSoftwareOcclusion.cleanup();
+
+	sCullJobs.clear();
+	std::for_each(sCullCameras.begin(), sCullCameras.end(), DeletePointer());
+	sCullCameras.clear();
+
 	for(pool_set_t::iterator iter = mPools.begin();
 		iter != mPools.end(); )
 	{
@@ -967,6 +993,7 @@ void LLPipeline::refreshCachedSettings()
 	LLVertexBuffer::sUseVAO = gSavedSettings.getBOOL("RenderUseVAO") && gSavedSettings.getBOOL("VertexShaderEnable"); //Temporary workaround for vaos being broken when shaders are off
 	LLVertexBuffer::sDisableVBOMapping = LLVertexBuffer::sEnableVBOs;// && gSavedSettings.getBOOL("RenderVBOMappingDisable") ; //Temporary workaround for vbo mapping being straight up broken
 	LLVertexBuffer::sPreferStreamDraw = gSavedSettings.getBOOL("RenderPreferStreamDraw");
+	LLVertexBuffer::sUseSuballocation = gSavedSettings.getBOOL("RenderVBOSuballocation");
 	LLPipeline::sRenderAttachedLights = gSavedSettings.getBOOL("RenderAttachedLights");
 	LLPipeline::sRenderAttachedParticles = gSavedSettings.getBOOL("RenderAttachedParticles");
 	LLPipeline::sTextureBindTest = gSavedSettings.getBOOL("RenderDebugTextureBind");
@@ -977,6 +1004,12 @@ void LLPipeline::refreshCachedSettings()
 			&& LLFeatureManager::getInstance()->isFeatureAvailable("UseOcclusion") 
 			&& gSavedSettings.getBOOL("UseOcclusion") 
 			&& gGLManager.mHasOcclusionQuery) ? 2 : 0;
+	LLPipeline::sUseSoftwareOcclusion = !gUseWireframe && gSavedSettings.getBOOL("RenderSoftwareOcclusion");
+	if (!LLPipeline::sUseSoftwareOcclusion)
+	{
+		gPipeline.mSoftwareOcclusion.cleanup();
+	}
+	LLPipeline::sCullThreads = llmin(gSavedSettings.getU32("RenderCullThreads"), (U32)8);
 }
 
 void LLPipeline::releaseOcclusionBuffers()
@@ -2349,29 +2382,52 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 		}
 		mCubeVB->setBuffer(LLVertexBuffer::MAP_VERTEX);
 	}
+
+	// Only the main view has occluders gathered from its last frame.
+	bool software_occlusion = sUseSoftwareOcclusion &&
+							  LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD &&
+							  !sReflectionRender && !sShadowRender;
+	if (software_occlusion)
+	{
+		mSoftwareOcclusion.update(modelview, proj, camera.getOrigin(), camera.getFar());
+	}
 	
-	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
-			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	static const LLCachedControl<bool> record_scene(gSavedSettings, "RenderCullRecordScene", false);
+	if (record_scene && LLViewerCamera::sCurCameraID == LLViewerCamera::CAMERA_WORLD && !sReflectionRender && !sShadowRender)
 	{
-		LLViewerRegion* region = *iter;
-		if (water_clip != 0)
-		{
-			LLPlane plane(LLVector3(0,0, (F32) -water_clip), (F32) water_clip*region->getWaterHeight());
-			camera.setUserClipPlane(plane);
-		}
-		else
-		{
-			camera.disableUserClipPlane();
-		}
+		gSavedSettings.setBOOL("RenderCullRecordScene", FALSE);
+		recordCullScene(camera);
+	}
 
-		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+	if (sCullThreads > 0 && gJobSystem)
+	{
+		cullPartitions(camera, water_clip);
+	}
+	else
+	{
+		for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+				iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
 		{
-			LLSpatialPartition* part = region->getSpatialPartition(i);
-			if (part)
+			LLViewerRegion* region = *iter;
+			if (water_clip != 0)
 			{
-				if (hasRenderType(part->mDrawableType))
+				LLPlane plane(LLVector3(0,0, (F32) -water_clip), (F32) water_clip*region->getWaterHeight());
+				camera.setUserClipPlane(plane);
+			}
+			else
+			{
+				camera.disableUserClipPlane();
+			}
+
+			for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+			{
+				LLSpatialPartition* part = region->getSpatialPartition(i);
+				if (part)
 				{
-					part->cull(camera);
+					if (hasRenderType(part->mDrawableType))
+					{
+						part->cull(camera);
+					}
 				}
 			}
 		}
@@ -2384,6 +2440,12 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 
 	camera.disableUserClipPlane();
 
+	if (software_occlusion)
+	{
+		mSoftwareOcclusion.reset();
+		mSoftwareOcclusion.gatherOccluders(*sCull, camera.getOrigin());
+	}
+
 	if (hasRenderType(LLPipeline::RENDER_TYPE_SKY) && 
 		gSky.mVOSkyp.notNull() && 
 		gSky.mVOSkyp->mDrawable.notNull())
@@ -2421,6 +2483,146 @@ void LLPipeline::updateCull(LLCamera& camera, LLCullResult& result, S32 water_cl
 	}
 }
 
+static LLTrace::BlockTimerStatHandle FTM_CULL_PARALLEL("Parallel Frustum Cull");
+
+// Same as the sequential loop in updateCull(), with the frustum tests of all
+// partitions spread over job system workers. Everything else happens on the main
+// thread, and the fragments are applied in partition order, so the cull result
+// is identical to the sequential one.
+void LLPipeline::cullPartitions(LLCamera& camera, S32 water_clip)
+{
+	if (water_clip == 0)
+	{
+		camera.disableUserClipPlane();
+	}
+
+	U32 count = 0;
+	U32 region_count = 0;
+	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+		LLCamera* region_camera = &camera;
+		if (water_clip != 0)
+		{
+			if (region_count == sCullCameras.size())
+			{
+				sCullCameras.push_back(new LLCamera());
+			}
+			region_camera = sCullCameras[region_count++];
+			*region_camera = camera;
+			LLPlane plane(LLVector3(0,0, (F32) -water_clip), (F32) water_clip*region->getWaterHeight());
+			region_camera->setUserClipPlane(plane);
+		}
+
+		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+		{
+			LLSpatialPartition* part = region->getSpatialPartition(i);
+			if (part && hasRenderType(part->mDrawableType))
+			{
+				part->cullRebound();
+				if (count == sCullJobs.size())
+				{
+					sCullJobs.resize(count + 1);
+				}
+				LLCullJob& job = sCullJobs[count++];
+				job.mPartition = part;
+				job.mCamera = region_camera;
+			}
+		}
+	}
+
+	{
+		LL_RECORD_BLOCK_TIME(FTM_CULL_PARALLEL);
+		gJobSystem->parallelFor(count, [](S32 index)
+			{
+				LLCullJob& job = sCullJobs[index];
+				job.mPartition->cullFrustum(*job.mCamera, job.mFragment);
+			}, sCullThreads);
+	}
+
+	for (U32 i = 0; i < count; ++i)
+	{
+		LLCullJob& job = sCullJobs[i];
+		job.mPartition->cullApply(*job.mCamera, job.mFragment);
+	}
+}
+
+class LLOctreeCollectDrawables : public OctreeTraveler
+{
+public:
+	virtual void visit(const OctreeNode* branch)
+	{
+		for (OctreeNode::const_element_iter i = branch->getDataBegin(); i != branch->getDataEnd(); ++i)
+		{
+			LLDrawable* drawable = (LLDrawable*)(*i)->getDrawable();
+			if (drawable && !drawable->isDead())
+			{
+				mDrawables.push_back(drawable);
+			}
+		}
+	}
+
+	std::vector<LLDrawable*> mDrawables;
+};
+
+// Writes the camera frustum and the bounding boxes of the drawables of every
+// partition to cull_scene.xml in the log directory, for the headless cull
+// benchmark in indra/newview/tests/lloctreecullrecord_test.cpp.
+void LLPipeline::recordCullScene(const LLCamera& camera)
+{
+	LLSD scene;
+	scene["origin"] = ll_sd_from_vector3(camera.getOrigin());
+	for (U32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; ++i)
+	{
+		scene["frustum"].append(ll_sd_from_vector3(camera.mAgentFrustum[i]));
+	}
+
+	for (LLWorld::region_list_t::const_iterator iter = LLWorld::getInstance()->getRegionList().begin(); 
+			iter != LLWorld::getInstance()->getRegionList().end(); ++iter)
+	{
+		LLViewerRegion* region = *iter;
+		for (U32 i = 0; i < LLViewerRegion::NUM_PARTITIONS; i++)
+		{
+			LLSpatialPartition* part = region->getSpatialPartition(i);
+			if (!part || !hasRenderType(part->mDrawableType))
+			{
+				continue;
+			}
+
+			LLOctreeCollectDrawables collector;
+			collector.traverse(part->mOctree);
+
+			LLSD boxes = LLSD::emptyArray();
+			for (std::vector<LLDrawable*>::iterator drawable_iter = collector.mDrawables.begin(); drawable_iter != collector.mDrawables.end(); ++drawable_iter)
+			{
+				const LLVector4a* exts = (*drawable_iter)->getSpatialExtents();
+				LLSD box;
+				for (S32 j = 0; j < 3; ++j)
+				{
+					box.append(exts[0][j]);
+				}
+				for (S32 j = 0; j < 3; ++j)
+				{
+					box.append(exts[1][j]);
+				}
+				boxes.append(box);
+			}
+			scene["partitions"].append(boxes);
+		}
+	}
+
+	std::string filename = gDirUtilp->getExpandedFilename(LL_PATH_LOGS, "cull_scene.xml");
+	llofstream file(filename.c_str());
+	if (!file.is_open())
+	{
+		LL_WARNS() << "Could not write " << filename << LL_ENDL;
+		return;
+	}
+	LLSDSerialize::toPrettyXML(scene, file);
+	LL_INFOS() << "Recorded " << scene["partitions"].size() << " partitions to " << filename << LL_ENDL;
+}
+
 void LLPipeline::markNotCulled(LLSpatialGroup* group, LLCamera& camera)
 {
 	if (group->isEmpty())
@@ -3789,6 +3991,12 @@ void LLPipeline::postSort(LLCamera& camera)
 	
 	mMeshDirtyGroup.clear();
 
+	static const LLCachedControl<bool> draw_batching("RenderDrawBatching", true);
+	if (draw_batching)
+	{
+		sCull->batchRenderMaps();
+	}
+
 	if (!sShadowRender)
 	{
 		std::sort(sCull->beginAlphaGroups(), sCull->endAlphaGroups(), LLSpatialGroup::CompareDepthGreater());
@@ -45,6 +45,7 @@
 #include "lldrawable.h"
 #include "llrendertarget.h"
 #include "llfasttimer.h"
+#include "llsoftwareocclusion.h"
 
 #include <stack>
 
@@ -430,6 +431,8 @@ public:
 	void restoreHiddenObject( const LLUUID& id );
 
 private:
+	void cullPartitions(LLCamera& camera, S32 water_clip);
+	void recordCullScene(const LLCamera& camera);
 	void unloadShaders();
 	void addToQuickLookup( LLDrawPool* new_poolp );
 	void removeFromQuickLookup( LLDrawPool* poolp );
@@ -577,6 +580,8 @@ public:
 	static BOOL				sShowHUDAttachments;
 	static BOOL				sForceOldBakedUpload; // If true will not use capabilities to upload baked textures.
 	static S32				sUseOcclusion;  // 0 = no occlusion, 1 = read only, 2 = read/write
+	static BOOL				sUseSoftwareOcclusion;
+	static U32				sCullThreads;	// job system workers helping the frustum culling, 0 to cull on the main thread only
 	static BOOL				sDelayVBUpdate;
 	static BOOL				sAutoMaskAlphaDeferred;
 	static BOOL				sAutoMaskAlphaNonDeferred;
@@ -628,6 +633,9 @@ public:
 	//utility buffer for rendering cubes, 8 vertices are corners of a cube [-1, 1]
 	LLPointer<LLVertexBuffer> mCubeVB;
 
+	//CPU occluders tested ahead of the occlusion queries (RenderSoftwareOcclusion)
+	LLSoftwareOcclusion mSoftwareOcclusion;
+
 private:
 	//sun shadow map
 	LLRenderTarget			mShadow[6];
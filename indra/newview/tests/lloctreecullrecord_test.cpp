@@ -0,0 +1,480 @@
+/**
+ * @file lloctreecullrecord_test.cpp
+ * @brief Tests and benchmark of LLOctreeCullRecord and LLOctreeCullApply.
+ *
+ * $LicenseInfo:firstyear=2026&license=viewerlgpl$
+ * Second Life Viewer Source Code
+ * Copyright (C) 2026, Linden Research, Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation;
+ * version 2.1 of the License only.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ * Linden Research, Inc., 945 Battery Street, San Francisco, CA  94111  USA
+ * $/LicenseInfo$
+ */
+
+#include "linden_common.h"
+#include "../test/lltut.h"
+
+#include "../lloctreecullrecord.h"
+
+#include "llcamera.h"
+#include "lljobsystem.h"
+#include "lloctree.h"
+#include "llsdserialize.h"
+#include "llsdutil_math.h"
+#include "lltimer.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+U32 gOctreeMaxCapacity = 128;
+F32 gOctreeMinSize = 0.01f;
+U32 gOctreeReserveCapacity = 4;
+
+// The scene is either recorded by the viewer (set RenderCullRecordScene and
+// point LL_CULL_SCENE at the cull_scene.xml it writes in the log directory),
+// or generated: nine regions of prims around a camera at ground level.
+namespace
+{
+	class CullBox : public LLRefCount
+	{
+	public:
+		CullBox(const LLVector4a& min, const LLVector4a& max) :
+			mBinIndex(-1)
+		{
+			mExtents[0] = min;
+			mExtents[1] = max;
+			mPosition.setAdd(min, max);
+			mPosition.mul(0.5f);
+			LLVector4a size;
+			size.setSub(max, min);
+			mRadius = size.getLength3().getF32() * 0.5f;
+		}
+
+		const LLVector4a& getPositionGroup() const	{ return mPosition; }
+		F32 getBinRadius() const					{ return mRadius; }
+		S32 getBinIndex() const						{ return mBinIndex; }
+		void setBinIndex(S32 index)					{ mBinIndex = index; }
+
+		LLVector4a	mExtents[2];
+
+	private:
+		LLVector4a	mPosition;
+		F32			mRadius;
+		S32			mBinIndex;
+	};
+
+	typedef LLOctreeNode<CullBox> CullNode;
+	typedef LLOctreeRoot<CullBox> CullRoot;
+
+	// Bounds of a node and everything under it, like LLViewerOctreeGroup::mBounds.
+	class CullGroup : public LLOctreeListener<CullBox>
+	{
+	public:
+		CullGroup(CullNode* node) :
+			mNode(node),
+			mSoftwareOccluded(false),
+			mQueryOccluded(false)
+		{
+			node->addListener(this);
+		}
+
+		/*virtual*/ void handleInsertion(const LLTreeNode<CullBox>* node, CullBox* data) { }
+		/*virtual*/ void handleRemoval(const LLTreeNode<CullBox>* node, CullBox* data) { }
+		/*virtual*/ void handleDestruction(const LLTreeNode<CullBox>* node) { }
+		/*virtual*/ void handleChildAddition(const CullNode* parent, CullNode* child) { new CullGroup(child); }
+		/*virtual*/ void handleChildRemoval(const CullNode* parent, const CullNode* child) { }
+
+		// Returns the extents of node, after updating the bounds of its subtree.
+		static bool rebound(const CullNode* node, LLVector4a* extents)
+		{
+			bool empty = true;
+			for (CullNode::const_element_iter i = node->getDataBegin(); i != node->getDataEnd(); ++i)
+			{
+				grow(empty, extents, (*i)->mExtents);
+			}
+			for (U32 i = 0; i < node->getChildCount(); ++i)
+			{
+				LLVector4a child_extents[2];
+				if (rebound(node->getChild(i), child_extents))
+				{
+					grow(empty, extents, child_extents);
+				}
+			}
+			if (empty)
+			{
+				extents[0] = extents[1] = node->getCenter();
+			}
+			CullGroup* group = (CullGroup*)node->getListener(0);
+			group->mBounds[0].setAdd(extents[0], extents[1]);
+			group->mBounds[0].mul(0.5f);
+			group->mBounds[1].setSub(extents[1], extents[0]);
+			group->mBounds[1].mul(0.5f);
+			return !empty;
+		}
+
+		const CullNode*	mNode;
+		LLVector4a		mBounds[2];	// center, half size
+		bool			mSoftwareOccluded;	// What LLSoftwareOcclusion would say, read from any thread.
+		bool			mQueryOccluded;		// What the GPU occlusion query says, main thread state.
+
+	private:
+		static void grow(bool& empty, LLVector4a* extents, const LLVector4a* box)
+		{
+			if (empty)
+			{
+				extents[0] = box[0];
+				extents[1] = box[1];
+				empty = false;
+			}
+			else
+			{
+				extents[0].setMin(extents[0], box[0]);
+				extents[1].setMax(extents[1], box[1]);
+			}
+		}
+	};
+
+	// Stands in for LLOctreeCull: the same traversal as LLViewerOctreeCull,
+	// with the occlusion results coming from the groups' flags and every
+	// processed group appended to mProcessed.
+	class TestCull : public LLOctreeTraveler<CullBox>
+	{
+	public:
+		typedef CullNode node_t;
+		typedef CullGroup group_t;
+
+		TestCull(LLCamera* camera) :
+			mCamera(camera),
+			mRes(0),
+			mSoftwareCulled(0),
+			mQueryCulled(0)
+		{
+		}
+
+		virtual void traverse(const CullNode* n)
+		{
+			CullGroup* group = (CullGroup*)n->getListener(0);
+			if (earlyFail(group))
+			{
+				return;
+			}
+			if (mRes == 2)
+			{
+				LLOctreeTraveler<CullBox>::traverse(n);
+			}
+			else
+			{
+				mRes = mCamera->AABBInFrustum(group->mBounds[0], group->mBounds[1]);
+				if (mRes)
+				{
+					LLOctreeTraveler<CullBox>::traverse(n);
+				}
+				mRes = 0;
+			}
+		}
+
+		virtual void visit(const CullNode* branch)
+		{
+			if (branch->getElementCount() > 0)
+			{
+				processGroup((CullGroup*)branch->getListener(0));
+			}
+		}
+
+		virtual bool earlyFail(CullGroup* group)
+		{
+			return earlyFailRecorded(group, softwareOcclusionFail(group));
+		}
+
+		static bool softwareOcclusionFail(CullGroup* group)
+		{
+			return group->mNode->getParent() && group->mSoftwareOccluded;
+		}
+
+		bool earlyFailRecorded(CullGroup* group, bool software_occluded)
+		{
+			if (software_occluded)
+			{
+				++mSoftwareCulled;
+				return true;
+			}
+			if (group->mNode->getParent() && group->mQueryOccluded)
+			{
+				++mQueryCulled;
+				return true;
+			}
+			return false;
+		}
+
+		virtual void processGroup(CullGroup* group)
+		{
+			mProcessed.push_back(group);
+		}
+
+		std::vector<CullGroup*>	mProcessed;
+		U32						mSoftwareCulled;
+		U32						mQueryCulled;
+
+	protected:
+		LLCamera*	mCamera;
+		S32			mRes;
+	};
+
+	typedef LLOctreeCullRecord<TestCull, CullGroup> CullRecord;
+	typedef LLOctreeCullApply<TestCull, CullGroup> CullApply;
+	typedef CullRecord::entry_list_t cull_fragment_t;
+
+	bool operator==(const LLOctreeCullEntry<CullGroup>& lhs, const LLOctreeCullEntry<CullGroup>& rhs)
+	{
+		return lhs.mGroup == rhs.mGroup && lhs.mSubtreeEnd == rhs.mSubtreeEnd &&
+			   lhs.mSoftwareOccluded == rhs.mSoftwareOccluded && lhs.mProcess == rhs.mProcess;
+	}
+
+	void set_occlusion(const CullNode* node, U32& seed)
+	{
+		CullGroup* group = (CullGroup*)node->getListener(0);
+		seed = seed * 1103515245 + 12345;
+		group->mSoftwareOccluded = (seed >> 8) % 16 == 0;
+		seed = seed * 1103515245 + 12345;
+		group->mQueryOccluded = (seed >> 8) % 16 == 0;
+		for (U32 i = 0; i < node->getChildCount(); ++i)
+		{
+			set_occlusion(node->getChild(i), seed);
+		}
+	}
+
+	struct CullScene
+	{
+		LLCamera					mCamera;
+		std::vector<CullRoot*>		mPartitions;
+
+		~CullScene()
+		{
+			for (std::vector<CullRoot*>::iterator iter = mPartitions.begin(); iter != mPartitions.end(); ++iter)
+			{
+				delete *iter;
+			}
+		}
+
+		void addPartition(const std::vector<LLVector4a>& boxes)
+		{
+			if (boxes.empty())
+			{
+				return;
+			}
+			LLVector4a size(64.f);
+			CullRoot* root = new CullRoot(boxes[0], size, NULL);
+			new CullGroup(root);
+			for (U32 i = 0; i + 1 < boxes.size(); i += 2)
+			{
+				root->insert(new CullBox(boxes[i], boxes[i + 1]));
+			}
+			LLVector4a extents[2];
+			CullGroup::rebound(root, extents);
+			mPartitions.push_back(root);
+		}
+
+		bool load(const std::string& filename)
+		{
+			std::ifstream file(filename.c_str());
+			LLSD scene;
+			if (!file.is_open() || LLSDSerialize::fromXML(scene, file) <= 0)
+			{
+				return false;
+			}
+
+			mCamera.setOrigin(ll_vector3_from_sd(scene["origin"]));
+			LLVector3 frustum[LLCamera::AGENT_FRUSTRUM_NUM];
+			for (S32 i = 0; i < LLCamera::AGENT_FRUSTRUM_NUM; ++i)
+			{
+				frustum[i] = ll_vector3_from_sd(scene["frustum"][i]);
+			}
+			mCamera.calcAgentFrustumPlanes(frustum);
+
+			for (LLSD::array_const_iterator part = scene["partitions"].beginArray(); part != scene["partitions"].endArray(); ++part)
+			{
+				std::vector<LLVector4a> boxes;
+				for (LLSD::array_const_iterator box = part->beginArray(); box != part->endArray(); ++box)
+				{
+					boxes.push_back(LLVector4a((*box)[0].asReal(), (*box)[1].asReal(), (*box)[2].asReal()));
+					boxes.push_back(LLVector4a((*box)[3].asReal(), (*box)[4].asReal(), (*box)[5].asReal()));
+				}
+				addPartition(boxes);
+			}
+			return true;
+		}
+
+		void generate()
+		{
+			U32 seed = 1;
+			for (S32 region = 0; region < 9; ++region)
+			{
+				F32 region_x = (region % 3) * 256.f;
+				F32 region_y = (region / 3) * 256.f;
+				// Roughly a volume, a tree and a terrain partition.
+				const S32 counts[] = { 15000, 400, 256 };
+				const F32 max_sizes[] = { 8.f, 12.f, 16.f };
+				for (S32 part = 0; part < 3; ++part)
+				{
+					std::vector<LLVector4a> boxes;
+					for (S32 i = 0; i < counts[part]; ++i)
+					{
+						seed = seed * 1103515245 + 12345;
+						F32 x = region_x + (seed >> 8) % 256;
+						seed = seed * 1103515245 + 12345;
+						F32 y = region_y + (seed >> 8) % 256;
+						seed = seed * 1103515245 + 12345;
+						F32 z = 20.f + (seed >> 8) % 64;
+						seed = seed * 1103515245 + 12345;
+						F32 size = 0.1f + max_sizes[part] * ((seed >> 8) % 1000) / 1000.f;
+						boxes.push_back(LLVector4a(x, y, z));
+						boxes.push_back(LLVector4a(x + size, y + size, z + size));
+					}
+					addPartition(boxes);
+				}
+			}
+
+			LLVector3 origin(384.f, 384.f, 30.f);
+			LLVector3 at(1.f, 0.f, 0.f);
+			LLVector3 left(0.f, 1.f, 0.f);
+			LLVector3 up(0.f, 0.f, 1.f);
+			mCamera.setOrigin(origin);
+			// Corners of a 60 degree, 16:9 frustum from 0.1m to 256m, in LLViewerCamera order.
+			const F32 tan_y = tanf(30.f * DEG_TO_RAD);
+			const F32 tan_x = tan_y * 16.f / 9.f;
+			const F32 depth[] = { 0.1f, 256.f };
+			LLVector3 frustum[LLCamera::AGENT_FRUSTRUM_NUM];
+			for (S32 i = 0; i < 2; ++i)
+			{
+				F32 d = depth[i];
+				frustum[i * 4 + 0] = origin + at * d + left * (d * tan_x) - up * (d * tan_y);
+				frustum[i * 4 + 1] = origin + at * d - left * (d * tan_x) - up * (d * tan_y);
+				frustum[i * 4 + 2] = origin + at * d - left * (d * tan_x) + up * (d * tan_y);
+				frustum[i * 4 + 3] = origin + at * d + left * (d * tan_x) + up * (d * tan_y);
+			}
+			mCamera.calcAgentFrustumPlanes(frustum);
+		}
+	};
+
+	// Records every partition of scene loops times, returns the time of one cull in ms.
+	F64 run_cull(LLJobSystem* jobs, CullScene& scene, std::vector<cull_fragment_t>& fragments, S32 loops)
+	{
+		fragments.resize(scene.mPartitions.size());
+		LLTimer timer;
+		for (S32 loop = 0; loop < loops; ++loop)
+		{
+			auto record = [&](S32 index)
+				{
+					fragments[index].clear();
+					CullRecord culler(&scene.mCamera, fragments[index]);
+					culler.traverse(scene.mPartitions[index]);
+				};
+			if (jobs)
+			{
+				jobs->parallelFor(scene.mPartitions.size(), record, jobs->getThreadCount());
+			}
+			else
+			{
+				for (S32 index = 0; index < (S32)scene.mPartitions.size(); ++index)
+				{
+					record(index);
+				}
+			}
+		}
+		return timer.getElapsedTimeF64() * 1000.0 / loops;
+	}
+}
+
+namespace tut
+{
+	struct cull_test
+	{
+	};
+	typedef test_group<cull_test> cull_group_t;
+	typedef cull_group_t::object cull_object_t;
+	tut::cull_group_t cull_instance("LLOctreeCullRecord");
+
+	template<> template<>
+	void cull_object_t::test<1>()
+	{
+		set_test_name("record and apply process what the sequential cull does");
+
+		CullScene scene;
+		scene.generate();
+		U32 seed = 7;
+		for (U32 i = 0; i < scene.mPartitions.size(); ++i)
+		{
+			set_occlusion(scene.mPartitions[i], seed);
+		}
+
+		U32 processed = 0;
+		for (U32 i = 0; i < scene.mPartitions.size(); ++i)
+		{
+			TestCull sequential(&scene.mCamera);
+			sequential.traverse(scene.mPartitions[i]);
+
+			cull_fragment_t fragment;
+			CullRecord record(&scene.mCamera, fragment);
+			record.traverse(scene.mPartitions[i]);
+			CullApply apply(&scene.mCamera);
+			apply.apply(fragment);
+
+			ensure("same groups processed in the same order", apply.mProcessed == sequential.mProcessed);
+			ensure_equals("software culled", apply.mSoftwareCulled, sequential.mSoftwareCulled);
+			ensure_equals("query culled", apply.mQueryCulled, sequential.mQueryCulled);
+			processed += sequential.mProcessed.size();
+		}
+		ensure("the scene has visible groups", processed > 0);
+	}
+
+	template<> template<>
+	void cull_object_t::test<2>()
+	{
+		set_test_name("fragments recorded on workers match the main thread");
+
+		CullScene scene;
+		const char* filename = getenv("LL_CULL_SCENE");
+		if (filename)
+		{
+			ensure("load scene", scene.load(filename));
+		}
+		else
+		{
+			scene.generate();
+		}
+
+		const S32 LOOPS = 20;
+		std::vector<cull_fragment_t> reference;
+		F64 sequential = run_cull(NULL, scene, reference, LOOPS);
+		U32 recorded = 0;
+		for (U32 i = 0; i < reference.size(); ++i)
+		{
+			recorded += reference[i].size();
+		}
+		LL_INFOS() << "Cull: " << scene.mPartitions.size() << " partitions, " << recorded << " groups reached, main thread only: "
+				   << sequential << " ms" << LL_ENDL;
+
+		for (S32 threads = 1; threads <= 4; ++threads)
+		{
+			LLJobSystem jobs("Cull test", threads);
+			std::vector<cull_fragment_t> fragments;
+			F64 parallel = run_cull(&jobs, scene, fragments, LOOPS);
+			ensure("same fragments with " + llformat("%d", threads) + " threads", fragments == reference);
+			LL_INFOS() << "Cull: " << threads << " threads: " << parallel << " ms" << LL_ENDL;
+		}
+	}
+}